@@ -0,0 +1,61 @@
+#include "AliasTable.h"
+#include <cstdlib>
+
+void AliasTable::build(const std::vector<uint16_t> &values, const std::vector<double> &weights)
+{
+    std::size_t count = values.size();
+    m_values = values;
+    m_aliases.assign(count, 0);
+    m_thresholds.assign(count, 0);
+    if (count == 0)
+        return;
+
+    double total = 0.0;
+    for (double weight : weights)
+    {
+        total += weight;
+    }
+
+    // Метод Возе: столбцы с долей меньше средней добираются псевдонимом из столбцов с избытком
+    std::vector<double> scaled(count);
+    std::vector<std::size_t> small, large;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        scaled[i] = weights[i] * count / total;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+    const double scale = static_cast<double>(RAND_MAX) + 1.0;
+    while (!small.empty() && !large.empty())
+    {
+        std::size_t less = small.back();
+        small.pop_back();
+        std::size_t more = large.back();
+        m_thresholds[less] = static_cast<uint32_t>(scaled[less] * scale);
+        m_aliases[less] = static_cast<uint16_t>(more);
+        scaled[more] -= 1.0 - scaled[less];
+        if (scaled[more] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // Остаток (и погрешность округления) - столбцы без псевдонима
+    for (std::size_t i : small)
+    {
+        m_thresholds[i] = static_cast<uint32_t>(scale);
+        m_aliases[i] = static_cast<uint16_t>(i);
+    }
+    for (std::size_t i : large)
+    {
+        m_thresholds[i] = static_cast<uint32_t>(scale);
+        m_aliases[i] = static_cast<uint16_t>(i);
+    }
+}
+
+int AliasTable::sample() const
+{
+    if (m_values.empty())
+        return -1;
+    std::size_t column = rand() % m_values.size();
+    return static_cast<uint32_t>(rand()) < m_thresholds[column] ? m_values[column] : m_values[m_aliases[column]];
+}
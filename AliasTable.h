@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Таблица псевдонимов Уолкера для взвешенного выбора за O(1): столбец выбирается равномерно,
+// затем порог решает, взять значение столбца или его псевдоним. Бросок - два rand(), без аллокаций
+class AliasTable
+{
+public:
+    // values[i] выпадает с вероятностью weights[i] / сумма весов; веса неотрицательные
+    void build(const std::vector<uint16_t> &values, const std::vector<double> &weights);
+
+    // Значение или -1 для пустой таблицы
+    int sample() const;
+
+    bool empty() const { return m_values.empty(); }
+    std::size_t size() const { return m_values.size(); }
+
+private:
+    std::vector<uint16_t> m_values;
+    std::vector<uint16_t> m_aliases;    // Номер столбца-псевдонима
+    std::vector<uint32_t> m_thresholds; // Порог для rand(): меньше - значение своего столбца
+};
@@ -0,0 +1,710 @@
+#include "Tools.h"
+#include "BattleSimulator.h"
+#include "BatchBattleKernel.h"
+#include "HeroTemplates.h"
+#include "EnemyTemplates.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Подбор характеристик шаблонов врагов под целевые доли побед игрока.
+// Каждая ячейка (пресет отряда x уровень сложности) оценивается серией безголовых боев.
+// Зерна боев зависят только от ячейки и номера пробы (общие случайные числа), поэтому
+// два набора параметров сравниваются на одних и тех же боях, а целевая функция
+// детерминирована - по ней можно вести покоординатный поиск без шума.
+
+namespace
+{
+    struct TunerOptions
+    {
+        int samples = 200;
+        int rounds = 12;
+        int difficulties = 3;
+        unsigned int threads = 1;
+        unsigned int seed = 20240601u;
+        AIPolicy policy = sweepPolicy;
+        std::vector<LocationType> locations;
+        std::string tablePath;
+        std::string reportPath;
+    };
+
+    // Целевая доля побед игрока: чем дальше локация и выше сложность, тем труднее
+    double targetWinRate(LocationType location, int difficulty)
+    {
+        double base = 0.8;
+        switch (location)
+        {
+        case LocationType::FOREST: base = 0.8; break;
+        case LocationType::CAVE: base = 0.75; break;
+        case LocationType::DEAD_CITY: base = 0.7; break;
+        case LocationType::CASTLE: base = 0.6; break;
+        }
+        return std::max(0.05, base - 0.15 * difficulty);
+    }
+
+    // Перемешивание для зерен проб (splitmix64)
+    std::uint64_t mixSeed(std::uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    unsigned int sampleSeed(unsigned int base, int location, int preset, int difficulty, int sample)
+    {
+        std::uint64_t key = base;
+        key = mixSeed(key ^ static_cast<std::uint64_t>(location));
+        key = mixSeed(key ^ static_cast<std::uint64_t>(preset));
+        key = mixSeed(key ^ static_cast<std::uint64_t>(difficulty));
+        key = mixSeed(key ^ static_cast<std::uint64_t>(sample));
+        return static_cast<unsigned int>(key);
+    }
+
+    // Настраиваемые поля шаблона
+    enum class TunedField
+    {
+        MAX_HP,
+        DAMAGE,
+        DEFENSE,
+        ATTACK,
+        INITIATIVE,
+        DAMAGE_VARIANCE
+    };
+
+    const TunedField tunedFields[] = {
+        TunedField::MAX_HP,
+        TunedField::DAMAGE,
+        TunedField::DEFENSE,
+        TunedField::ATTACK,
+        TunedField::INITIATIVE,
+        TunedField::DAMAGE_VARIANCE,
+    };
+
+    const char *tunedFieldName(TunedField field)
+    {
+        switch (field)
+        {
+        case TunedField::MAX_HP: return "maxHP";
+        case TunedField::DAMAGE: return "damage";
+        case TunedField::DEFENSE: return "defense";
+        case TunedField::ATTACK: return "attack";
+        case TunedField::INITIATIVE: return "initiative";
+        case TunedField::DAMAGE_VARIANCE: return "damageVariance";
+        }
+        return "unknown";
+    }
+
+    // Один параметр поиска: поле конкретного шаблона и его текущий шаг
+    struct TunedParameter
+    {
+        std::size_t templateIndex = 0;
+        TunedField field = TunedField::MAX_HP;
+        double step = 1.0;
+        double minStep = 1.0;
+    };
+
+    int clampInt(int value, int low, int high)
+    {
+        return std::max(low, std::min(high, value));
+    }
+
+    // Сдвинуть поле на delta с учетом границ. false - значение не изменилось
+    bool shiftField(EnemyTemplate &enemy, TunedField field, double delta)
+    {
+        int step = static_cast<int>(std::lround(delta));
+        switch (field)
+        {
+        case TunedField::MAX_HP:
+        {
+            int value = clampInt(enemy.maxHP + step, 10, 100000);
+            if (value == enemy.maxHP)
+                return false;
+            enemy.maxHP = value;
+            return true;
+        }
+        case TunedField::DAMAGE:
+        {
+            int value = clampInt(enemy.damage + step, 1, 10000);
+            if (value == enemy.damage)
+                return false;
+            enemy.damage = value;
+            return true;
+        }
+        case TunedField::DEFENSE:
+        {
+            int value = clampInt(enemy.defense + step, 0, 10000);
+            if (value == enemy.defense)
+                return false;
+            enemy.defense = value;
+            return true;
+        }
+        case TunedField::ATTACK:
+        {
+            int value = clampInt(enemy.attack + step, 0, 10000);
+            if (value == enemy.attack)
+                return false;
+            enemy.attack = value;
+            return true;
+        }
+        case TunedField::INITIATIVE:
+        {
+            int value = clampInt(enemy.initiative + step, 1, 60);
+            if (value == enemy.initiative)
+                return false;
+            enemy.initiative = value;
+            return true;
+        }
+        case TunedField::DAMAGE_VARIANCE:
+        {
+            double value = std::max(0.0, std::min(1.0, enemy.damageVariance + delta));
+            if (std::fabs(value - enemy.damageVariance) < 1e-9)
+                return false;
+            enemy.damageVariance = value;
+            return true;
+        }
+        }
+        return false;
+    }
+
+    std::vector<TunedParameter> makeParameters(const std::vector<EnemyTemplate> &templates)
+    {
+        std::vector<TunedParameter> parameters;
+        for (std::size_t i = 0; i < templates.size(); ++i)
+        {
+            for (TunedField field : tunedFields)
+            {
+                TunedParameter parameter;
+                parameter.templateIndex = i;
+                parameter.field = field;
+                switch (field)
+                {
+                case TunedField::MAX_HP:
+                    parameter.step = std::max(1, templates[i].maxHP / 10);
+                    break;
+                case TunedField::DAMAGE:
+                case TunedField::INITIATIVE:
+                    parameter.step = 2.0;
+                    break;
+                case TunedField::DEFENSE:
+                case TunedField::ATTACK:
+                    parameter.step = 1.0;
+                    break;
+                case TunedField::DAMAGE_VARIANCE:
+                    parameter.step = 0.1;
+                    parameter.minStep = 0.0125;
+                    break;
+                }
+                parameters.push_back(parameter);
+            }
+        }
+        return parameters;
+    }
+
+    // Строка отчета о сходимости
+    struct ConvergenceRow
+    {
+        int round = 0;
+        std::string phase;
+        double rmse = 0.0;
+        long long evaluations = 0;
+        int accepted = 0;
+    };
+
+    // Доли побед по ячейкам одной локации: [preset * difficulties + difficulty]
+    using CellRates = std::vector<double>;
+
+    class BalanceTuner
+    {
+    public:
+        explicit BalanceTuner(const TunerOptions &options) : m_options(options)
+        {
+            // Прототипы отрядов создаются здесь: фабрика героев печатает отладку и не потокобезопасна
+            int presetCount = static_cast<int>(HeroFactory::getPartyPresets().size());
+            for (int preset = 0; preset < presetCount; ++preset)
+            {
+                std::vector<Player> party;
+                for (Player *hero : HeroFactory::createPartyFromPreset(preset))
+                {
+                    party.push_back(*hero);
+                    delete hero;
+                }
+                m_parties.push_back(party);
+            }
+
+            for (LocationType location : m_options.locations)
+            {
+                m_templates.push_back(EnemyFactory::getTemplates(location));
+            }
+            m_scaling = EnemyFactory::getScaling();
+            m_baselineTemplates = m_templates;
+            m_baselineScaling = m_scaling;
+        }
+
+        void tune()
+        {
+            std::vector<CellRates> rates = evaluateAll(m_templates, m_scaling);
+            m_baselineRates = rates;
+            std::vector<double> losses = locationLosses(rates);
+            m_report.push_back({0, "baseline", rmse(losses), m_evaluations, 0});
+
+            std::vector<std::vector<TunedParameter>> parameters;
+            for (const std::vector<EnemyTemplate> &templates : m_templates)
+            {
+                parameters.push_back(makeParameters(templates));
+            }
+            std::vector<TunedParameter> scalingParameters = {
+                {0, TunedField::MAX_HP, 5.0, 1.0},
+                {0, TunedField::DAMAGE, 1.0, 1.0},
+                {0, TunedField::DEFENSE, 1.0, 1.0},
+            };
+
+            for (int round = 1; round <= m_options.rounds; ++round)
+            {
+                int acceptedInRound = 0;
+                for (std::size_t loc = 0; loc < m_templates.size(); ++loc)
+                {
+                    int accepted = searchLocation(loc, parameters[loc], losses);
+                    acceptedInRound += accepted;
+                    m_report.push_back({round, locationTypeName(m_options.locations[loc]), rmse(losses), m_evaluations, accepted});
+                }
+                if (m_options.difficulties > 1)
+                {
+                    int accepted = searchScaling(scalingParameters, losses);
+                    acceptedInRound += accepted;
+                    m_report.push_back({round, "scaling", rmse(losses), m_evaluations, accepted});
+                }
+
+                // Сошлось: ни одного улучшения при минимальных шагах
+                if (acceptedInRound == 0 && allAtMinimum(parameters) && allAtMinimum({scalingParameters}))
+                    break;
+            }
+
+            m_tunedRates = evaluateAll(m_templates, m_scaling);
+            rescaleExperience();
+        }
+
+        void writeTable(std::ostream &out) const
+        {
+            out << "// Generated by HuntersPath.Tools tune: samples=" << m_options.samples
+                << " difficulties=" << m_options.difficulties << " seed=" << m_options.seed << "\n";
+            out << "// EnemyScaling: hpPerLevel=" << m_scaling.hpPerLevel
+                << " damagePerLevel=" << m_scaling.damagePerLevel
+                << " defensePerLevel=" << m_scaling.defensePerLevel
+                << " expPerLevel=" << m_scaling.expPerLevel << "\n";
+            for (std::size_t loc = 0; loc < m_templates.size(); ++loc)
+            {
+                out << "    enemyTemplates[LocationType::" << locationTypeName(m_options.locations[loc]) << "] = {\n";
+                const std::vector<EnemyTemplate> &templates = m_templates[loc];
+                for (std::size_t i = 0; i < templates.size(); ++i)
+                {
+                    const EnemyTemplate &t = templates[i];
+                    out << "        {\"" << t.name << "\", " << t.maxHP << ", " << t.damage << ", " << t.defense << ", "
+                        << t.attack << ", " << t.maxStamina << ", " << t.initiative << ", " << t.attackRange
+                        << ", AbilityType::" << abilityTypeName(t.ability) << ", " << t.expValue << ", "
+                        << t.difficulty << ", \"" << t.type << "\", " << formatVariance(t.damageVariance) << ", "
+                        << t.spawnWeight << "}"
+                        << (i + 1 < templates.size() ? ",\n" : "};\n");
+                }
+                out << "\n";
+            }
+        }
+
+        void writeReport(std::ostream &out) const
+        {
+            out << "# Balance tuner convergence report\n";
+            out << "# samples=" << m_options.samples << " difficulties=" << m_options.difficulties
+                << " presets=" << m_parties.size() << " seed=" << m_options.seed
+                << " threads=" << m_options.threads << " policy=" << aiPolicyName(m_options.policy) << "\n";
+            out << "# rmse - root mean square of (win rate - target) over preset x difficulty cells\n";
+            out << "round,phase,rmse,evaluations,accepted\n";
+            out << std::fixed << std::setprecision(4);
+            for (const ConvergenceRow &row : m_report)
+            {
+                out << row.round << "," << row.phase << "," << row.rmse << "," << row.evaluations << "," << row.accepted << "\n";
+            }
+            out << std::defaultfloat << std::setprecision(6);
+
+            out << "\n# Changed template fields (expValue follows sqrt(hp x damage) ratio)\n";
+            out << "location,enemy,field,before,after\n";
+            for (std::size_t loc = 0; loc < m_templates.size(); ++loc)
+            {
+                for (std::size_t i = 0; i < m_templates[loc].size(); ++i)
+                {
+                    writeChanges(out, locationTypeName(m_options.locations[loc]), m_baselineTemplates[loc][i], m_templates[loc][i]);
+                }
+            }
+            writeScalingChange(out, "hpPerLevel", m_baselineScaling.hpPerLevel, m_scaling.hpPerLevel);
+            writeScalingChange(out, "damagePerLevel", m_baselineScaling.damagePerLevel, m_scaling.damagePerLevel);
+            writeScalingChange(out, "defensePerLevel", m_baselineScaling.defensePerLevel, m_scaling.defensePerLevel);
+
+            out << "\n# Final win rates\n";
+            out << "location,difficulty,preset,target,baseline,tuned\n";
+            const std::vector<PartyPreset> &presets = HeroFactory::getPartyPresets();
+            for (std::size_t loc = 0; loc < m_templates.size(); ++loc)
+            {
+                LocationType location = m_options.locations[loc];
+                for (int difficulty = 0; difficulty < m_options.difficulties; ++difficulty)
+                {
+                    for (std::size_t preset = 0; preset < m_parties.size(); ++preset)
+                    {
+                        std::size_t cell = preset * m_options.difficulties + difficulty;
+                        out << locationTypeName(location) << "," << difficulty << ",\"" << presets[preset].name << "\","
+                            << targetWinRate(location, difficulty) << "," << m_baselineRates[loc][cell] << ","
+                            << m_tunedRates[loc][cell] << "\n";
+                    }
+                }
+            }
+        }
+
+    private:
+        const TunerOptions &m_options;
+        std::vector<std::vector<Player>> m_parties;
+        std::vector<std::vector<EnemyTemplate>> m_templates;
+        std::vector<std::vector<EnemyTemplate>> m_baselineTemplates;
+        EnemyScaling m_scaling;
+        EnemyScaling m_baselineScaling;
+        std::vector<CellRates> m_baselineRates;
+        std::vector<CellRates> m_tunedRates;
+        std::vector<ConvergenceRow> m_report;
+        long long m_evaluations = 0;
+
+        // Все пробы всех ячеек локации идут одним параллельным циклом
+        CellRates evaluate(std::size_t loc, const std::vector<EnemyTemplate> &templates, const EnemyScaling &scaling)
+        {
+            ++m_evaluations;
+            const int samples = m_options.samples;
+            const int difficulties = m_options.difficulties;
+            const int locationId = static_cast<int>(m_options.locations[loc]);
+            const std::size_t cells = m_parties.size() * difficulties;
+            std::vector<char> wins(cells * samples, 0);
+
+            // Задача - пачка из LANES боев: при ATTACK_ONLY она целиком уходит в пакетное ядро
+            const std::size_t chunk = static_cast<std::size_t>(BatchBattleKernel::LANES);
+            parallelFor((wins.size() + chunk - 1) / chunk, m_options.threads, [&](std::size_t task)
+            {
+                std::size_t first = task * chunk;
+                std::vector<SweepBattle> battles(std::min(chunk, wins.size() - first));
+                for (std::size_t k = 0; k < battles.size(); ++k)
+                {
+                    std::size_t index = first + k;
+                    int cell = static_cast<int>(index / samples);
+                    int sample = static_cast<int>(index % samples);
+                    int preset = cell / difficulties;
+                    int difficulty = cell % difficulties;
+
+                    // Состав врагов выбирается по индексам шаблонов - правка характеристик его не меняет
+                    unsigned int seed = sampleSeed(m_options.seed, locationId, preset, difficulty, sample);
+                    std::mt19937 picker(seed);
+                    int enemyCount = 1 + static_cast<int>(picker() % 4);
+
+                    SimEncounter &encounter = battles[k].encounter;
+                    for (const Player &hero : m_parties[preset])
+                    {
+                        encounter.players.emplace_back(new Player(hero));
+                    }
+                    for (int i = 0; i < enemyCount; ++i)
+                    {
+                        const EnemyTemplate &chosen = templates[picker() % templates.size()];
+                        encounter.enemies.emplace_back(EnemyFactory::createEnemy(chosen, difficulty, scaling));
+                    }
+                    battles[k].seed = static_cast<unsigned int>(picker());
+                }
+
+                std::vector<SimResult> results = BatchBattleKernel::runSweep(battles, m_options.policy);
+                for (std::size_t k = 0; k < results.size(); ++k)
+                {
+                    wins[first + k] = results[k].playerVictory ? 1 : 0;
+                }
+            });
+
+            CellRates rates(cells, 0.0);
+            for (std::size_t cell = 0; cell < cells; ++cell)
+            {
+                int count = 0;
+                for (int sample = 0; sample < samples; ++sample)
+                {
+                    count += wins[cell * samples + sample];
+                }
+                rates[cell] = static_cast<double>(count) / samples;
+            }
+            return rates;
+        }
+
+        std::vector<CellRates> evaluateAll(const std::vector<std::vector<EnemyTemplate>> &templates, const EnemyScaling &scaling)
+        {
+            std::vector<CellRates> rates;
+            for (std::size_t loc = 0; loc < templates.size(); ++loc)
+            {
+                rates.push_back(evaluate(loc, templates[loc], scaling));
+            }
+            return rates;
+        }
+
+        // Сумма квадратов отклонений от цели по ячейкам локации
+        double loss(std::size_t loc, const CellRates &rates) const
+        {
+            double sum = 0.0;
+            for (std::size_t cell = 0; cell < rates.size(); ++cell)
+            {
+                int difficulty = static_cast<int>(cell % m_options.difficulties);
+                double delta = rates[cell] - targetWinRate(m_options.locations[loc], difficulty);
+                sum += delta * delta;
+            }
+            return sum;
+        }
+
+        std::vector<double> locationLosses(const std::vector<CellRates> &rates) const
+        {
+            std::vector<double> losses;
+            for (std::size_t loc = 0; loc < rates.size(); ++loc)
+            {
+                losses.push_back(loss(loc, rates[loc]));
+            }
+            return losses;
+        }
+
+        double rmse(const std::vector<double> &losses) const
+        {
+            double sum = 0.0;
+            for (double value : losses)
+            {
+                sum += value;
+            }
+            std::size_t cells = losses.size() * m_parties.size() * m_options.difficulties;
+            return cells > 0 ? std::sqrt(sum / cells) : 0.0;
+        }
+
+        // Один проход покоординатного поиска по шаблонам локации
+        int searchLocation(std::size_t loc, std::vector<TunedParameter> &parameters, std::vector<double> &losses)
+        {
+            int accepted = 0;
+            for (TunedParameter &parameter : parameters)
+            {
+                bool improved = false;
+                for (int direction : {1, -1})
+                {
+                    std::vector<EnemyTemplate> candidate = m_templates[loc];
+                    if (!shiftField(candidate[parameter.templateIndex], parameter.field, direction * parameter.step))
+                        continue;
+
+                    double candidateLoss = loss(loc, evaluate(loc, candidate, m_scaling));
+                    if (candidateLoss < losses[loc] - 1e-12)
+                    {
+                        m_templates[loc] = candidate;
+                        losses[loc] = candidateLoss;
+                        improved = true;
+                        ++accepted;
+                        break;
+                    }
+                }
+                if (!improved)
+                    parameter.step = std::max(parameter.minStep, parameter.step / 2.0);
+            }
+            return accepted;
+        }
+
+        // Прирост характеристик за уровень сложности общий для всех локаций
+        int searchScaling(std::vector<TunedParameter> &parameters, std::vector<double> &losses)
+        {
+            int accepted = 0;
+            for (TunedParameter &parameter : parameters)
+            {
+                bool improved = false;
+                for (int direction : {1, -1})
+                {
+                    EnemyScaling candidate = m_scaling;
+                    int delta = direction * static_cast<int>(std::lround(parameter.step));
+                    int *value = parameter.field == TunedField::MAX_HP   ? &candidate.hpPerLevel
+                                 : parameter.field == TunedField::DAMAGE ? &candidate.damagePerLevel
+                                                                         : &candidate.defensePerLevel;
+                    int shifted = std::max(0, *value + delta);
+                    if (shifted == *value)
+                        continue;
+                    *value = shifted;
+
+                    std::vector<double> candidateLosses = locationLosses(evaluateAll(m_templates, candidate));
+                    if (rmse(candidateLosses) < rmse(losses) - 1e-12)
+                    {
+                        m_scaling = candidate;
+                        losses = candidateLosses;
+                        improved = true;
+                        ++accepted;
+                        break;
+                    }
+                }
+                if (!improved)
+                    parameter.step = std::max(parameter.minStep, parameter.step / 2.0);
+            }
+            return accepted;
+        }
+
+        static bool allAtMinimum(const std::vector<std::vector<TunedParameter>> &parameters)
+        {
+            for (const std::vector<TunedParameter> &group : parameters)
+            {
+                for (const TunedParameter &parameter : group)
+                {
+                    if (parameter.step > parameter.minStep)
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        // Опыт на исход боя не влияет - не ищется, а следует за силой врага
+        void rescaleExperience()
+        {
+            for (std::size_t loc = 0; loc < m_templates.size(); ++loc)
+            {
+                for (std::size_t i = 0; i < m_templates[loc].size(); ++i)
+                {
+                    const EnemyTemplate &before = m_baselineTemplates[loc][i];
+                    EnemyTemplate &after = m_templates[loc][i];
+                    double ratio = std::sqrt(static_cast<double>(after.maxHP) * after.damage /
+                                             (static_cast<double>(before.maxHP) * before.damage));
+                    after.expValue = std::max(1, static_cast<int>(std::lround(before.expValue * ratio)));
+                }
+            }
+        }
+
+        static std::string formatVariance(double value)
+        {
+            std::ostringstream text;
+            text << std::setprecision(4) << value;
+            std::string result = text.str();
+            if (result.find('.') == std::string::npos)
+                result += ".0";
+            return result;
+        }
+
+        static void writeChanges(std::ostream &out, const char *location, const EnemyTemplate &before, const EnemyTemplate &after)
+        {
+            auto write = [&](const char *field, double from, double to)
+            {
+                if (std::fabs(from - to) > 1e-9)
+                    out << location << ",\"" << before.name << "\"," << field << "," << from << "," << to << "\n";
+            };
+            write(tunedFieldName(TunedField::MAX_HP), before.maxHP, after.maxHP);
+            write(tunedFieldName(TunedField::DAMAGE), before.damage, after.damage);
+            write(tunedFieldName(TunedField::DEFENSE), before.defense, after.defense);
+            write(tunedFieldName(TunedField::ATTACK), before.attack, after.attack);
+            write(tunedFieldName(TunedField::INITIATIVE), before.initiative, after.initiative);
+            write(tunedFieldName(TunedField::DAMAGE_VARIANCE), before.damageVariance, after.damageVariance);
+            write("expValue", before.expValue, after.expValue);
+        }
+
+        static void writeScalingChange(std::ostream &out, const char *field, int before, int after)
+        {
+            if (before != after)
+                out << "scaling,EnemyScaling," << field << "," << before << "," << after << "\n";
+        }
+    };
+
+    LocationType parseLocation(const std::string &name)
+    {
+        for (LocationType location : toolLocations)
+        {
+            if (name == locationTypeName(location))
+                return location;
+        }
+        throw std::invalid_argument("unknown location " + name);
+    }
+
+    void writeTo(const std::string &path, const std::function<void(std::ostream &)> &write)
+    {
+        if (path.empty())
+        {
+            write(std::cout);
+            return;
+        }
+        std::ofstream file(path);
+        if (!file)
+            throw std::runtime_error("cannot open " + path);
+        write(file);
+    }
+}
+
+int runBalanceTuner(int argc, char **argv)
+{
+    TunerOptions options;
+    int threads = 0;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--samples")
+        {
+            options.samples = parseIntOption(arg, value, 1, 100000);
+            ++i;
+        }
+        else if (arg == "--rounds")
+        {
+            options.rounds = parseIntOption(arg, value, 0, 1000);
+            ++i;
+        }
+        else if (arg == "--difficulties")
+        {
+            options.difficulties = parseIntOption(arg, value, 1, 20);
+            ++i;
+        }
+        else if (arg == "--threads")
+        {
+            threads = parseIntOption(arg, value, 0, 1024);
+            ++i;
+        }
+        else if (arg == "--policy")
+        {
+            options.policy = parsePolicyOption(arg, value);
+            ++i;
+        }
+        else if (arg == "--seed")
+        {
+            options.seed = static_cast<unsigned int>(parseIntOption(arg, value, 0, 2147483647));
+            ++i;
+        }
+        else if (arg == "--location" && value)
+        {
+            options.locations.push_back(parseLocation(value));
+            ++i;
+        }
+        else if (arg == "--out" && value)
+        {
+            options.tablePath = value;
+            ++i;
+        }
+        else if (arg == "--report" && value)
+        {
+            options.reportPath = value;
+            ++i;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+    options.threads = resolveThreadCount(threads);
+    if (options.locations.empty())
+        options.locations.assign(std::begin(toolLocations), std::end(toolLocations));
+
+    std::unique_ptr<BalanceTuner> tuner;
+    {
+        // HeroFactory печатает отладку при создании героев
+        ScopedSilence silence;
+        tuner.reset(new BalanceTuner(options));
+    }
+    tuner->tune();
+
+    writeTo(options.tablePath, [&](std::ostream &out) { tuner->writeTable(out); });
+    writeTo(options.reportPath, [&](std::ostream &out) { tuner->writeReport(out); });
+    return 0;
+}
@@ -0,0 +1,894 @@
+#include "BatchBattleKernel.h"
+#include <algorithm>
+#include <memory>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+BatchCombatant BatchCombatant::fromEntity(const Entity &entity)
+{
+    BatchCombatant combatant;
+    combatant.maxHP = entity.getMaxHealthPoint();
+    combatant.currentHP = entity.getCurrentHealthPoint();
+    combatant.damage = entity.getDamage();
+    combatant.defense = entity.getDefense();
+    combatant.attack = entity.getAttack();
+    combatant.maxStamina = entity.getMaxStamina();
+    combatant.initiative = entity.getInitiative();
+    combatant.attackRange = entity.getAttackRange();
+    combatant.ability = entity.getAbility();
+    combatant.damageVariance = entity.getDamageVariance();
+    return combatant;
+}
+
+BatchEncounter BatchEncounter::fromEncounter(const SimEncounter &encounter, unsigned int seed, bool antithetic)
+{
+    BatchEncounter batch;
+    batch.seed = seed;
+    batch.antithetic = antithetic;
+    for (const auto &player : encounter.players)
+    {
+        batch.players.push_back(BatchCombatant::fromEntity(*player));
+    }
+    for (const auto &enemy : encounter.enemies)
+    {
+        batch.enemies.push_back(BatchCombatant::fromEntity(*enemy));
+    }
+    return batch;
+}
+
+namespace
+{
+    // Тот же расчет, что и в Entity::attack(int, double)
+    inline int32_t scalarDamage(int32_t baseDamage, int32_t attack, int32_t defense, double variance, double roll)
+    {
+        int attackDefenseDiff = attack - defense;
+        double multiplier = 1.0;
+        if (attackDefenseDiff > 0)
+        {
+            multiplier = 1.0 + (attackDefenseDiff * 0.05);
+        }
+        else if (attackDefenseDiff < 0)
+        {
+            multiplier = 1.0 / (1.0 + (abs(attackDefenseDiff) * 0.05));
+        }
+
+        double minMultiplier = 1.0 - variance;
+        double maxMultiplier = 1.0 + variance;
+        double randomMultiplier = minMultiplier + roll * (maxMultiplier - minMultiplier);
+        double finalDamage = baseDamage * randomMultiplier * multiplier;
+        return max(1, static_cast<int>(finalDamage));
+    }
+
+    // Поле участника slot[lane] в каждой дорожке (слот -1 - значение по умолчанию). Слоты
+    // перебираются с выбором вместо косвенной адресации, поэтому проход по дорожкам векторизуется.
+    // Аргументы копируются в локальные массивы: так компилятору не нужна проверка перекрытия с полем.
+    // Поле читается до выбора: без маскированной загрузки (SSE2) условное чтение не векторизуется
+    template <typename T>
+    void gatherSlots(const T (&field)[BatchBattleKernel::SLOTS][BatchBattleKernel::LANES], const int32_t *slot, T *out)
+    {
+        alignas(64) int32_t slots[BatchBattleKernel::LANES];
+        alignas(64) T values[BatchBattleKernel::LANES] = {};
+        copy(slot, slot + BatchBattleKernel::LANES, slots);
+        for (int s = 0; s < BatchBattleKernel::SLOTS; ++s)
+        {
+            for (int lane = 0; lane < BatchBattleKernel::LANES; ++lane)
+            {
+                T value = field[s][lane];
+                values[lane] = slots[lane] == s ? value : values[lane];
+            }
+        }
+        copy(values, values + BatchBattleKernel::LANES, out);
+    }
+
+    // Записать value[lane] в поле участника slot[lane] дорожек из маски
+    template <typename T>
+    void scatterSlots(T (&field)[BatchBattleKernel::SLOTS][BatchBattleKernel::LANES], const int32_t *slot,
+                      const int32_t *mask, const T *value)
+    {
+        alignas(64) int32_t slots[BatchBattleKernel::LANES];
+        alignas(64) T values[BatchBattleKernel::LANES];
+        for (int lane = 0; lane < BatchBattleKernel::LANES; ++lane)
+        {
+            int32_t target = slot[lane];
+            slots[lane] = mask[lane] ? target : -1;
+            values[lane] = value[lane];
+        }
+        for (int s = 0; s < BatchBattleKernel::SLOTS; ++s)
+        {
+            for (int lane = 0; lane < BatchBattleKernel::LANES; ++lane)
+            {
+                T current = field[s][lane];
+                field[s][lane] = slots[lane] == s ? values[lane] : current;
+            }
+        }
+    }
+
+    const int32_t abilityLifeSteal = static_cast<int32_t>(AbilityType::LIFE_STEAL);
+    const int32_t abilityPoison = static_cast<int32_t>(AbilityType::POISON);
+    const int32_t abilityFire = static_cast<int32_t>(AbilityType::FIRE_DAMAGE);
+    const int32_t abilityIce = static_cast<int32_t>(AbilityType::ICE_DAMAGE);
+    const int32_t abilityLightning = static_cast<int32_t>(AbilityType::LIGHTNING);
+}
+
+BatchBattleKernel::BatchBattleKernel()
+{
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        clear(lane);
+    }
+}
+
+void BatchBattleKernel::clear(int lane)
+{
+    for (int slot = 0; slot < SLOTS; ++slot)
+    {
+        m_hp[slot][lane] = 0;
+        m_maxHP[slot][lane] = 0;
+        m_damage[slot][lane] = 0;
+        m_defense[slot][lane] = 0;
+        m_attack[slot][lane] = 0;
+        m_stamina[slot][lane] = 0;
+        m_maxStamina[slot][lane] = 0;
+        m_initiative[slot][lane] = 0;
+        m_range[slot][lane] = 0;
+        m_position[slot][lane] = slot % SIDE_SLOTS;
+        m_present[slot][lane] = 0;
+        m_ability[slot][lane] = static_cast<int32_t>(AbilityType::NONE);
+        m_variance[slot][lane] = 0.0;
+    }
+    m_turnCount[lane] = 0;
+    m_turnIndex[lane] = 0;
+    m_actor[lane] = -1;
+    m_playerCount[lane] = 0;
+    m_enemyCount[lane] = 0;
+    m_active[lane] = 0;
+    m_steps[lane] = 0;
+    m_antithetic[lane] = 0;
+    m_stepPass[lane] = 0;
+    m_stepAttacks[lane] = 0;
+    m_stepLightning[lane] = 0;
+}
+
+void BatchBattleKernel::load(int lane, const BatchEncounter &encounter)
+{
+    load(lane, encounter, -1);
+}
+
+void BatchBattleKernel::load(int lane, const BatchEncounter &encounter, int seedColumn)
+{
+    if (lane < 0 || lane >= LANES)
+        throw out_of_range("Batch lane index out of range");
+
+    clear(lane);
+    m_playerCount[lane] = min(static_cast<int>(encounter.players.size()), SIDE_SLOTS);
+    m_enemyCount[lane] = min(static_cast<int>(encounter.enemies.size()), SIDE_SLOTS);
+
+    int turns = 0;
+    for (int side = 0; side < 2; ++side)
+    {
+        const vector<BatchCombatant> &members = side == 0 ? encounter.players : encounter.enemies;
+        int count = side == 0 ? m_playerCount[lane] : m_enemyCount[lane];
+        for (int i = 0; i < count; ++i)
+        {
+            const BatchCombatant &c = members[i];
+            int slot = side * SIDE_SLOTS + i;
+            m_hp[slot][lane] = c.currentHP;
+            m_maxHP[slot][lane] = c.maxHP;
+            m_damage[slot][lane] = c.damage;
+            m_defense[slot][lane] = c.defense;
+            m_attack[slot][lane] = c.attack;
+            m_stamina[slot][lane] = c.maxStamina; // startBattle восстанавливает стамину всем
+            m_maxStamina[slot][lane] = c.maxStamina;
+            m_initiative[slot][lane] = c.initiative;
+            m_range[slot][lane] = c.attackRange;
+            m_position[slot][lane] = i;
+            m_present[slot][lane] = 1;
+            m_ability[slot][lane] = static_cast<int32_t>(c.ability);
+            m_variance[slot][lane] = c.damageVariance;
+            turns += max(0, c.initiative / 10);
+        }
+    }
+    // Инициатива в бою только падает (лед), так что очередь не вырастет больше начальной
+    if (turns > MAX_TURNS)
+    {
+        clear(lane);
+        throw invalid_argument("Batch encounter turn order exceeds MAX_TURNS");
+    }
+
+    if (seedColumn < 0)
+    {
+        seedRandom(lane, encounter.seed);
+    }
+    else
+    {
+        for (int i = 0; i < MT_WORDS; ++i)
+            m_mt[lane][i] = m_seedBlock[i][seedColumn];
+        m_mtIndex[lane] = 0;
+    }
+    m_antithetic[lane] = encounter.antithetic ? 1 : 0;
+    m_active[lane] = 1;
+    calculateTurnOrder(lane);
+    updateActor(lane);
+}
+
+void BatchBattleKernel::seedRandom(int lane, uint32_t seed)
+{
+    uint32_t *state = m_mt[lane];
+    state[0] = seed;
+    for (int i = 1; i < MT_WORDS; ++i)
+    {
+        state[i] = 1812433253u * (state[i - 1] ^ (state[i - 1] >> 30)) + static_cast<uint32_t>(i);
+    }
+    m_mtIndex[lane] = 0;
+}
+
+// Та же инициализация, что в seedRandom, для encounters[first..first + LANES) в столбцах m_seedBlock
+void BatchBattleKernel::seedBlock(const vector<BatchEncounter> &encounters, size_t first)
+{
+    for (int column = 0; column < LANES; ++column)
+    {
+        size_t index = first + static_cast<size_t>(column);
+        m_seedBlock[0][column] = index < encounters.size() ? encounters[index].seed : 0u;
+    }
+    for (int i = 1; i < MT_WORDS; ++i)
+    {
+        for (int column = 0; column < LANES; ++column)
+        {
+            uint32_t previous = m_seedBlock[i - 1][column];
+            m_seedBlock[i][column] = 1812433253u * (previous ^ (previous >> 30)) + static_cast<uint32_t>(i);
+        }
+    }
+}
+
+// Перемешивание слов по одному в порядке выдачи дает те же слова, что полный проход
+// std::mt19937: слово i берет уже обновленные слова перед ним и еще старые после него
+uint32_t BatchBattleKernel::nextRandom(int lane)
+{
+    uint32_t *state = m_mt[lane];
+    int i = m_mtIndex[lane];
+    uint32_t y = (state[i] & 0x80000000u) | (state[i + 1 < MT_WORDS ? i + 1 : 0] & 0x7fffffffu);
+    state[i] = state[i + 397 < MT_WORDS ? i + 397 : i + 397 - MT_WORDS] ^ (y >> 1) ^ ((y & 1u) ? 0x9908b0dfu : 0u);
+    m_mtIndex[lane] = i + 1 < MT_WORDS ? i + 1 : 0;
+
+    uint32_t z = state[i];
+    z ^= z >> 11;
+    z ^= (z << 7) & 0x9d2c5680u;
+    z ^= (z << 15) & 0xefc60000u;
+    return z ^ (z >> 18);
+}
+
+// Броски идут в том же порядке и с той же арифметикой, что и в BattleSystem
+int BatchBattleKernel::rollIndex(int lane, int count)
+{
+    if (count <= 0)
+        return 0;
+    int index = static_cast<int>(nextRandom(lane) % static_cast<uint32_t>(count));
+    return m_antithetic[lane] ? count - 1 - index : index;
+}
+
+double BatchBattleKernel::rollUnit(int lane)
+{
+    double unit = static_cast<double>(nextRandom(lane)) / 4294967295.0;
+    return m_antithetic[lane] ? 1.0 - unit : unit;
+}
+
+bool BatchBattleKernel::isVictory(int lane) const
+{
+    for (int i = 0; i < m_enemyCount[lane]; ++i)
+    {
+        int slot = SIDE_SLOTS + i;
+        if (m_present[slot][lane] && m_hp[slot][lane] > 0)
+            return false;
+    }
+    return true;
+}
+
+bool BatchBattleKernel::isDefeat(int lane) const
+{
+    for (int i = 0; i < m_playerCount[lane]; ++i)
+    {
+        if (m_present[i][lane] && m_hp[i][lane] > 0)
+            return false;
+    }
+    return true;
+}
+
+void BatchBattleKernel::calculateTurnOrder(int lane)
+{
+    struct TurnSlot
+    {
+        int slot;
+        int priority;
+    };
+    TurnSlot order[MAX_TURNS];
+    int count = 0;
+
+    for (int slot = 0; slot < SLOTS; ++slot)
+    {
+        if (m_present[slot][lane] && m_hp[slot][lane] > 0)
+        {
+            int initiative = m_initiative[slot][lane];
+            int turnWeight = initiative / 10;
+            for (int w = 0; w < turnWeight; ++w)
+            {
+                order[count++] = {slot, initiative + w};
+            }
+        }
+    }
+
+    // Тот же std::sort с тем же компаратором - порядок равных приоритетов совпадает с BattleSystem
+    sort(order, order + count,
+         [](const TurnSlot &a, const TurnSlot &b)
+         {
+             return a.priority > b.priority;
+         });
+
+    for (int i = 0; i < count; ++i)
+    {
+        m_turnOrder[lane][i] = order[i].slot;
+    }
+    m_turnCount[lane] = count;
+}
+
+void BatchBattleKernel::updateActor(int lane)
+{
+    m_actor[lane] = m_turnIndex[lane] < m_turnCount[lane] ? m_turnOrder[lane][m_turnIndex[lane]] : -1;
+}
+
+bool BatchBattleKernel::selectActions(int maxSteps)
+{
+    // Идущие дорожки: шаг засчитывается, как в цикле BattleSimulator::run
+    alignas(64) int32_t running[LANES];
+    int32_t anyRunning = 0;
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        running[lane] = m_active[lane] & (m_steps[lane] < maxSteps) & (m_actor[lane] >= 0);
+        m_steps[lane] += running[lane];
+        anyRunning |= running[lane];
+    }
+    if (!anyRunning)
+        return false;
+
+    alignas(64) int32_t stamina[LANES];
+    alignas(64) int32_t present[LANES];
+    alignas(64) int32_t position[LANES];
+    alignas(64) int32_t range[LANES];
+    alignas(64) int32_t ability[LANES];
+    gatherSlots(m_stamina, m_actor, stamina);
+    gatherSlots(m_present, m_actor, present);
+    gatherSlots(m_position, m_actor, position);
+    gatherSlots(m_range, m_actor, range);
+    gatherSlots(m_ability, m_actor, ability);
+
+    // Доступные цели - живые участники другой стороны в досягаемости (BattleSystem::canAttackTarget).
+    // Без стамины целей нет, и ход передается
+    alignas(64) int32_t eligible[SIDE_SLOTS][LANES];
+    alignas(64) int32_t targetCount[LANES] = {};
+    for (int i = 0; i < SIDE_SLOTS; ++i)
+    {
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            int32_t againstEnemies = m_actor[lane] < SIDE_SLOTS;
+            int32_t enemyPresent = m_present[SIDE_SLOTS + i][lane], playerPresent = m_present[i][lane];
+            int32_t enemyHP = m_hp[SIDE_SLOTS + i][lane], playerHP = m_hp[i][lane];
+            int32_t enemyPos = m_position[SIDE_SLOTS + i][lane], playerPos = m_position[i][lane];
+            int32_t targetPresent = againstEnemies ? enemyPresent : playerPresent;
+            int32_t targetHP = againstEnemies ? enemyHP : playerHP;
+            int32_t targetPos = againstEnemies ? enemyPos : playerPos;
+            int32_t distance = position[lane] - targetPos;
+            int32_t nearEnough = (distance <= range[lane]) & (-distance <= range[lane]);
+            int32_t inReach = range[lane] == 0 ? distance == 0 : (range[lane] == 1 ? targetPos <= 1 : nearEnough);
+            eligible[i][lane] = running[lane] & (stamina[lane] > 0) & present[lane] & targetPresent & (targetHP > 0) & inReach;
+            targetCount[lane] += eligible[i][lane];
+        }
+    }
+
+    int32_t anyAttacks = 0;
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        m_stepAttacks[lane] = targetCount[lane] > 0;
+        m_stepPass[lane] = running[lane] & !m_stepAttacks[lane];
+        int32_t actor = m_actor[lane];
+        m_stepAttacker[lane] = m_stepAttacks[lane] ? actor : -1;
+        anyAttacks |= m_stepAttacks[lane];
+    }
+    if (!anyAttacks)
+        return true;
+
+    // Броски: у каждой дорожки свой генератор, порядок как в бою - цель, разброс урона, молния.
+    // Молния бросается после урона, но других бросков между ними нет
+    alignas(64) int32_t pick[LANES];
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        pick[lane] = -1;
+        m_stepRoll[lane] = 0.0;
+        m_stepLightning[lane] = 0;
+        if (m_stepAttacks[lane])
+        {
+            pick[lane] = rollIndex(lane, targetCount[lane]);
+            m_stepRoll[lane] = rollUnit(lane);
+            m_stepLightning[lane] = ability[lane] == abilityLightning && rollIndex(lane, 100) < 20;
+        }
+    }
+
+    // Цель - pick-я из доступных в порядке позиций списка противника
+    alignas(64) int32_t seen[LANES] = {};
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        m_stepTarget[lane] = -1;
+    }
+    for (int i = 0; i < SIDE_SLOTS; ++i)
+    {
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            int32_t slot = m_actor[lane] < SIDE_SLOTS ? SIDE_SLOTS + i : i;
+            m_stepTarget[lane] = (eligible[i][lane] && seen[lane] == pick[lane]) ? slot : m_stepTarget[lane];
+            seen[lane] += eligible[i][lane];
+        }
+    }
+    return true;
+}
+
+void BatchBattleKernel::computeDamage()
+{
+    // Операнды ударов в плотные массивы (у неатакующих дорожек нули)
+    alignas(64) int32_t baseDamage[LANES];
+    alignas(64) int32_t attack[LANES];
+    alignas(64) int32_t defense[LANES];
+    alignas(64) double variance[LANES];
+    alignas(64) double roll[LANES];
+    gatherSlots(m_damage, m_stepAttacker, baseDamage);
+    gatherSlots(m_attack, m_stepAttacker, attack);
+    gatherSlots(m_variance, m_stepAttacker, variance);
+    gatherSlots(m_defense, m_stepTarget, defense);
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        roll[lane] = m_stepRoll[lane];
+    }
+
+#if defined(__AVX512F__)
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d step = _mm512_set1_pd(0.05);
+    const __m512d zero = _mm512_setzero_pd();
+    for (int lane = 0; lane < LANES; lane += 8)
+    {
+        __m256i atk = _mm256_load_si256(reinterpret_cast<const __m256i *>(attack + lane));
+        __m256i def = _mm256_load_si256(reinterpret_cast<const __m256i *>(defense + lane));
+        __m512d diff = _mm512_cvtepi32_pd(_mm256_sub_epi32(atk, def));
+
+        __mmask8 positive = _mm512_cmp_pd_mask(diff, zero, _CMP_GT_OQ);
+        __mmask8 negative = _mm512_cmp_pd_mask(diff, zero, _CMP_LT_OQ);
+        __m512d up = _mm512_add_pd(one, _mm512_mul_pd(diff, step));
+        __m512d absDiff = _mm512_sub_pd(zero, diff);
+        __m512d down = _mm512_div_pd(one, _mm512_add_pd(one, _mm512_mul_pd(absDiff, step)));
+        __m512d multiplier = _mm512_mask_blend_pd(positive, one, up);
+        multiplier = _mm512_mask_blend_pd(negative, multiplier, down);
+
+        __m512d var = _mm512_load_pd(variance + lane);
+        __m512d minMultiplier = _mm512_sub_pd(one, var);
+        __m512d maxMultiplier = _mm512_add_pd(one, var);
+        __m512d randomMultiplier = _mm512_add_pd(minMultiplier,
+                                                 _mm512_mul_pd(_mm512_load_pd(roll + lane),
+                                                               _mm512_sub_pd(maxMultiplier, minMultiplier)));
+
+        __m256i base = _mm256_load_si256(reinterpret_cast<const __m256i *>(baseDamage + lane));
+        __m512d finalDamage = _mm512_mul_pd(_mm512_mul_pd(_mm512_cvtepi32_pd(base), randomMultiplier), multiplier);
+        __m256i damage = _mm256_max_epi32(_mm512_cvttpd_epi32(finalDamage), _mm256_set1_epi32(1));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(m_stepDamage + lane), damage);
+    }
+#elif defined(__AVX2__)
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d step = _mm256_set1_pd(0.05);
+    const __m256d zero = _mm256_setzero_pd();
+    for (int lane = 0; lane < LANES; lane += 4)
+    {
+        __m128i atk = _mm_load_si128(reinterpret_cast<const __m128i *>(attack + lane));
+        __m128i def = _mm_load_si128(reinterpret_cast<const __m128i *>(defense + lane));
+        __m256d diff = _mm256_cvtepi32_pd(_mm_sub_epi32(atk, def));
+
+        __m256d positive = _mm256_cmp_pd(diff, zero, _CMP_GT_OQ);
+        __m256d negative = _mm256_cmp_pd(diff, zero, _CMP_LT_OQ);
+        __m256d up = _mm256_add_pd(one, _mm256_mul_pd(diff, step));
+        __m256d absDiff = _mm256_sub_pd(zero, diff);
+        __m256d down = _mm256_div_pd(one, _mm256_add_pd(one, _mm256_mul_pd(absDiff, step)));
+        __m256d multiplier = _mm256_blendv_pd(one, up, positive);
+        multiplier = _mm256_blendv_pd(multiplier, down, negative);
+
+        __m256d var = _mm256_load_pd(variance + lane);
+        __m256d minMultiplier = _mm256_sub_pd(one, var);
+        __m256d maxMultiplier = _mm256_add_pd(one, var);
+        __m256d randomMultiplier = _mm256_add_pd(minMultiplier,
+                                                 _mm256_mul_pd(_mm256_load_pd(roll + lane),
+                                                               _mm256_sub_pd(maxMultiplier, minMultiplier)));
+
+        __m128i base = _mm_load_si128(reinterpret_cast<const __m128i *>(baseDamage + lane));
+        __m256d finalDamage = _mm256_mul_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(base), randomMultiplier), multiplier);
+        __m128i damage = _mm_max_epi32(_mm256_cvttpd_epi32(finalDamage), _mm_set1_epi32(1));
+        _mm_store_si128(reinterpret_cast<__m128i *>(m_stepDamage + lane), damage);
+    }
+#else
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        m_stepDamage[lane] = scalarDamage(baseDamage[lane], attack[lane], defense[lane], variance[lane], roll[lane]);
+    }
+#endif
+}
+
+void BatchBattleKernel::applyHits()
+{
+    alignas(64) int32_t targetHP[LANES];
+    alignas(64) int32_t targetInitiative[LANES];
+    alignas(64) int32_t attackerHP[LANES];
+    alignas(64) int32_t attackerMaxHP[LANES];
+    alignas(64) int32_t ability[LANES];
+    gatherSlots(m_hp, m_stepTarget, targetHP);
+    gatherSlots(m_initiative, m_stepTarget, targetInitiative);
+    gatherSlots(m_hp, m_stepAttacker, attackerHP);
+    gatherSlots(m_maxHP, m_stepAttacker, attackerMaxHP);
+    gatherSlots(m_ability, m_stepAttacker, ability);
+
+    // Урон и эффекты при попадании - как в Entity::takeDamage и BattleSystem::applyAbilityEffect
+    alignas(64) int32_t targetDead[LANES];
+    alignas(64) int32_t attackerStamina[LANES];
+    // Все варианты считаются без ветвлений, способность атакующего выбирает нужный.
+    // Вампиризм - отдельным проходом: с ним в одном цикле GCC не векторизует выбор для SSE2
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        int32_t heal = static_cast<int32_t>(m_stepDamage[lane] * 0.5);
+        int32_t hpBefore = attackerHP[lane];
+        int32_t healed = min(attackerMaxHP[lane], hpBefore + heal);
+        attackerHP[lane] = ((ability[lane] == abilityLifeSteal) & (heal > 0)) ? healed : hpBefore;
+    }
+    int32_t anyTargetDead = 0;
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        int32_t damage = m_stepDamage[lane];
+        int32_t fire = static_cast<int32_t>(damage * 0.3);
+        int32_t ice = static_cast<int32_t>(damage * 0.25);
+        int32_t isIce = ability[lane] == abilityIce;
+        int32_t initiative = targetInitiative[lane];
+
+        int32_t extra = (ability[lane] == abilityPoison) * 5 + (ability[lane] == abilityFire) * fire + isIce * ice;
+        int32_t hp = max(0, max(0, targetHP[lane] - damage) - extra);
+        int32_t chilled = max(1, initiative - 1);
+        targetInitiative[lane] = (isIce & (ice > 0)) ? chilled : initiative;
+        targetHP[lane] = hp;
+        targetDead[lane] = m_stepAttacks[lane] & (hp <= 0);
+        anyTargetDead |= targetDead[lane];
+    }
+    scatterSlots(m_hp, m_stepTarget, m_stepAttacks, targetHP);
+    scatterSlots(m_initiative, m_stepTarget, m_stepAttacks, targetInitiative);
+    scatterSlots(m_hp, m_stepAttacker, m_stepAttacks, attackerHP);
+
+    // Молния: половина урона первому живому участнику стороны цели, кроме самой цели
+    alignas(64) int32_t struck[LANES];
+    alignas(64) int32_t targetSide[LANES];
+    alignas(64) int32_t target[LANES];
+    alignas(64) int32_t halfDamage[LANES];
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        struck[lane] = !m_stepLightning[lane];
+        targetSide[lane] = m_stepAttacker[lane] < SIDE_SLOTS;
+        target[lane] = m_stepTarget[lane];
+        halfDamage[lane] = m_stepDamage[lane] / 2;
+    }
+    for (int slot = 0; slot < SLOTS; ++slot)
+    {
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            int32_t hit = !struck[lane] & (slot / SIDE_SLOTS == targetSide[lane]) & m_present[slot][lane] &
+                          (slot != target[lane]) & (m_hp[slot][lane] > 0);
+            int32_t hp = m_hp[slot][lane];
+            m_hp[slot][lane] = hit ? max(0, hp - halfDamage[lane]) : hp;
+            struck[lane] |= hit;
+        }
+    }
+
+    removeDead(m_stepAttacks);
+
+    // Смерть цели пересобирает очередь, индекс хода остается (BattleSystem::attack)
+    if (anyTargetDead)
+    {
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            if (targetDead[lane])
+            {
+                calculateTurnOrder(lane);
+                if (m_turnIndex[lane] >= m_turnCount[lane])
+                {
+                    m_turnIndex[lane] = 0;
+                }
+                updateActor(lane);
+            }
+        }
+    }
+
+    gatherSlots(m_stamina, m_stepAttacker, attackerStamina);
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        attackerStamina[lane] -= 1;
+    }
+    scatterSlots(m_stamina, m_stepAttacker, m_stepAttacks, attackerStamina);
+
+    checkFinished(m_stepAttacks);
+}
+
+void BatchBattleKernel::passTurns()
+{
+    alignas(64) int32_t advance[LANES];
+    alignas(64) int32_t moved[LANES];
+    int32_t anyAdvance = 0;
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        advance[lane] = m_stepPass[lane] & (m_turnCount[lane] > 0);
+        moved[lane] = advance[lane];
+        anyAdvance |= advance[lane];
+    }
+    if (!anyAdvance)
+        return;
+
+    // Следующая запись очереди (BattleSystem::nextTurn): погибшие пропускаются,
+    // конец очереди начинает новый раунд с пересобранной очередью
+    alignas(64) int32_t actorHP[LANES];
+    while (anyAdvance)
+    {
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            m_turnIndex[lane] += advance[lane];
+        }
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            if (advance[lane] && m_turnIndex[lane] >= m_turnCount[lane])
+            {
+                calculateTurnOrder(lane);
+                m_turnIndex[lane] = 0;
+            }
+        }
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            m_actor[lane] = m_turnIndex[lane] < m_turnCount[lane] ? m_turnOrder[lane][m_turnIndex[lane]] : -1;
+        }
+        gatherSlots(m_hp, m_actor, actorHP);
+
+        anyAdvance = 0;
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            advance[lane] = advance[lane] & (m_actor[lane] >= 0) & (actorHP[lane] <= 0);
+            anyAdvance |= advance[lane];
+        }
+    }
+
+    // Начало хода: восстановление стамины; эффектов с длительностью в ядре нет
+    alignas(64) int32_t started[LANES];
+    alignas(64) int32_t maxStamina[LANES];
+    gatherSlots(m_maxStamina, m_actor, maxStamina);
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        started[lane] = moved[lane] & (m_actor[lane] >= 0);
+    }
+    scatterSlots(m_stamina, m_actor, started, maxStamina);
+    removeDead(started);
+    checkFinished(started);
+}
+
+void BatchBattleKernel::removeDead(const int32_t *mask)
+{
+    alignas(64) int32_t lanes[LANES];
+    copy(mask, mask + LANES, lanes);
+    for (int side = 0; side < 2; ++side)
+    {
+        int first = side * SIDE_SLOTS;
+        alignas(64) int32_t dead[SIDE_SLOTS][LANES];
+        for (int i = 0; i < SIDE_SLOTS; ++i)
+        {
+            for (int lane = 0; lane < LANES; ++lane)
+            {
+                dead[i][lane] = lanes[lane] & m_present[first + i][lane] & (m_hp[first + i][lane] <= 0);
+            }
+        }
+
+        // Позиции живых различны, поэтому цепочка shiftPositionsAfterDeath по погибшим
+        // равна сдвигу каждого выжившего на число погибших, стоявших перед ним
+        for (int t = 0; t < SIDE_SLOTS; ++t)
+        {
+            alignas(64) int32_t shift[LANES] = {};
+            for (int d = 0; d < SIDE_SLOTS; ++d)
+            {
+                for (int lane = 0; lane < LANES; ++lane)
+                {
+                    shift[lane] += dead[d][lane] & (m_position[first + d][lane] < m_position[first + t][lane]);
+                }
+            }
+            for (int lane = 0; lane < LANES; ++lane)
+            {
+                m_position[first + t][lane] -= (m_present[first + t][lane] & !dead[t][lane]) ? shift[lane] : 0;
+            }
+        }
+
+        for (int i = 0; i < SIDE_SLOTS; ++i)
+        {
+            for (int lane = 0; lane < LANES; ++lane)
+            {
+                m_present[first + i][lane] &= !dead[i][lane];
+            }
+        }
+    }
+}
+
+void BatchBattleKernel::checkFinished(const int32_t *mask)
+{
+    alignas(64) int32_t lanes[LANES];
+    copy(mask, mask + LANES, lanes);
+    alignas(64) int32_t players[LANES] = {};
+    alignas(64) int32_t enemies[LANES] = {};
+    for (int i = 0; i < SIDE_SLOTS; ++i)
+    {
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            players[lane] += m_present[i][lane] & (m_hp[i][lane] > 0);
+            enemies[lane] += m_present[SIDE_SLOTS + i][lane] & (m_hp[SIDE_SLOTS + i][lane] > 0);
+        }
+    }
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        m_active[lane] = (lanes[lane] & ((players[lane] == 0) | (enemies[lane] == 0))) ? 0 : m_active[lane];
+    }
+}
+
+bool BatchBattleKernel::step(int maxSteps)
+{
+    if (!selectActions(maxSteps))
+        return false;
+
+    int32_t anyAttacks = 0;
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        anyAttacks |= m_stepAttacks[lane];
+    }
+    if (anyAttacks)
+    {
+        // Урон всех атакующих дорожек за один векторный проход
+        computeDamage();
+        applyHits();
+    }
+    passTurns();
+    return true;
+}
+
+void BatchBattleKernel::run(int maxSteps)
+{
+    while (step(maxSteps))
+    {
+    }
+}
+
+SimResult BatchBattleKernel::outcome(int lane) const
+{
+    SimResult result;
+    result.steps = m_steps[lane];
+    if (!m_active[lane] && m_playerCount[lane] + m_enemyCount[lane] > 0)
+    {
+        result.playerVictory = isVictory(lane);
+        result.playerDefeat = !result.playerVictory && isDefeat(lane);
+    }
+    for (int i = 0; i < m_playerCount[lane]; ++i)
+    {
+        result.playerHPLeft += m_hp[i][lane];
+    }
+    for (int i = 0; i < m_enemyCount[lane]; ++i)
+    {
+        result.enemyHPLeft += m_hp[SIDE_SLOTS + i][lane];
+    }
+    return result;
+}
+
+vector<SimResult> BatchBattleKernel::runAll(const vector<BatchEncounter> &encounters, int maxSteps)
+{
+    vector<SimResult> results(encounters.size());
+    unique_ptr<BatchBattleKernel> kernel(new BatchBattleKernel());
+
+    // Дорожка закончившегося боя сразу получает следующий бой, а не простаивает до конца самого
+    // длинного боя пачки. Бои независимы, так что итог каждого не зависит от соседей по дорожкам
+    int loaded[LANES];
+    size_t next = 0;
+    size_t seeded = 0; // Первый бой в m_seedBlock
+    int busy = 0;
+    kernel->seedBlock(encounters, seeded);
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        loaded[lane] = -1;
+        if (next < encounters.size())
+        {
+            kernel->load(lane, encounters[next], static_cast<int>(next - seeded));
+            loaded[lane] = static_cast<int>(next++);
+            ++busy;
+        }
+    }
+
+    while (busy > 0)
+    {
+        kernel->step(maxSteps);
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            if (loaded[lane] < 0 || kernel->isLaneRunning(lane, maxSteps))
+                continue;
+
+            results[loaded[lane]] = kernel->outcome(lane);
+            if (next < encounters.size())
+            {
+                if (next - seeded == LANES)
+                {
+                    seeded = next;
+                    kernel->seedBlock(encounters, seeded);
+                }
+                kernel->load(lane, encounters[next], static_cast<int>(next - seeded));
+                loaded[lane] = static_cast<int>(next++);
+            }
+            else
+            {
+                kernel->clear(lane);
+                loaded[lane] = -1;
+                --busy;
+            }
+        }
+    }
+    return results;
+}
+
+vector<SimResult> BatchBattleKernel::runSweep(vector<SweepBattle> &battles, AIPolicy policy, int maxSteps)
+{
+    vector<SimResult> results(battles.size());
+    vector<BatchEncounter> batch;
+    vector<size_t> batchIndices;
+    for (size_t i = 0; i < battles.size(); ++i)
+    {
+        SweepBattle &battle = battles[i];
+        if (supports(battle.encounter, policy))
+        {
+            batch.push_back(BatchEncounter::fromEncounter(battle.encounter, battle.seed, battle.antithetic));
+            batchIndices.push_back(i);
+        }
+        else
+        {
+            results[i] = BattleSimulator::run(battle.encounter, battle.seed, policy, maxSteps, battle.antithetic);
+        }
+    }
+
+    vector<SimResult> batchResults = runAll(batch, maxSteps);
+    for (size_t i = 0; i < batchResults.size(); ++i)
+    {
+        results[batchIndices[i]] = batchResults[i];
+    }
+    return results;
+}
+
+bool BatchBattleKernel::supports(const SimEncounter &encounter, AIPolicy policy)
+{
+    if (policy != AIPolicy::ATTACK_ONLY || encounter.players.size() > static_cast<size_t>(SIDE_SLOTS) ||
+        encounter.enemies.size() > static_cast<size_t>(SIDE_SLOTS))
+        return false;
+    int turns = 0;
+    for (const auto &side : {&encounter.players, &encounter.enemies})
+    {
+        for (const auto &entity : *side)
+        {
+            if (!entity->getActiveEffects().empty())
+                return false;
+            turns += max(0, entity->getInitiative() / 10);
+        }
+    }
+    return turns <= MAX_TURNS;
+}
+
+const char *BatchBattleKernel::backendName()
+{
+#if defined(__AVX512F__)
+    return "avx512";
+#elif defined(__AVX2__)
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include "BattleSimulator.h"
+#include <cstdint>
+#include <vector>
+
+// Снимок характеристик участника для пакетного ядра
+struct BatchCombatant
+{
+    int maxHP = 0;
+    int currentHP = 0;
+    int damage = 0;
+    int defense = 0;
+    int attack = 0;
+    int maxStamina = 0;
+    int initiative = 0;
+    int attackRange = 0;
+    AbilityType ability = AbilityType::NONE;
+    double damageVariance = 0.0;
+
+    static BatchCombatant fromEntity(const Entity &entity);
+};
+
+// Один бой для пакетного прогона: до 4 героев против до 4 врагов
+struct BatchEncounter
+{
+    std::vector<BatchCombatant> players;
+    std::vector<BatchCombatant> enemies;
+    unsigned int seed = 0;
+    bool antithetic = false; // Антитетичные броски, как BattleSystem::setAntithetic
+
+    static BatchEncounter fromEncounter(const SimEncounter &encounter, unsigned int seed, bool antithetic = false);
+};
+
+// Бой массового прогона (баланс, турнир, чувствительность): участники, зерно и вид бросков
+struct SweepBattle
+{
+    SimEncounter encounter;
+    unsigned int seed = 0;
+    bool antithetic = false;
+};
+
+// Пакетное ядро боя: LANES независимых боев 4x4 в виде структуры массивов, которые
+// продвигаются синхронно (один шаг ИИ за итерацию). Весь шаг идет маскированными проходами
+// по дорожкам: выбор действующего и цели, урон, HP, смерти со сдвигом позиций, проверка победы
+// и передача хода. Поля участника берутся выбором по слотам, а не косвенной адресацией, поэтому
+// проходы векторизуются компилятором; урон считается явно (AVX-512 / AVX2 / скалярный путь).
+// Скалярными остаются только броски (у каждой дорожки свой mt19937) и пересборка очереди ходов
+// (раз в раунд и после смерти цели). Законченные бои маскируются, runAll сразу загружает
+// в освободившуюся дорожку следующий бой.
+//
+// Результат совпадает с BattleSimulator::run(..., AIPolicy::ATTACK_ONLY) при том же зерне:
+// поддерживаются обычные атаки и все эффекты при попадании (вампиризм, яд, огонь, лед, молния).
+// Активные способности и эффекты с длительностью не моделируются - участники грузятся без них.
+// Точное совпадение требует строгой модели плавающей точки (/fp:precise, без FMA-сжатия).
+class BatchBattleKernel
+{
+public:
+    static const int LANES = 16;
+    static const int SIDE_SLOTS = 4;             // Позиции одной стороны
+    static const int SLOTS = SIDE_SLOTS * 2;     // 0-3 игроки, 4-7 враги
+    static const int MAX_TURNS = 16;             // Записей в очереди ходов (инициатива / 10 на участника)
+
+    BatchBattleKernel();
+
+    // Загрузить бой в дорожку (дорожка сразу становится активной)
+    void load(int lane, const BatchEncounter &encounter);
+    // Освободить дорожку (в прогоне не участвует)
+    void clear(int lane);
+
+    // Прогнать все активные дорожки до конца боя или до лимита шагов
+    void run(int maxSteps = BattleSimulator::DEFAULT_MAX_STEPS);
+
+    SimResult outcome(int lane) const;
+    bool isLaneActive(int lane) const { return m_active[lane] != 0; }
+
+    // Прогнать произвольное количество боев, держа занятыми все LANES дорожек
+    static std::vector<SimResult> runAll(const std::vector<BatchEncounter> &encounters,
+                                         int maxSteps = BattleSimulator::DEFAULT_MAX_STEPS);
+
+    // Провести бои массового прогона: поддерживаемые ядром идут через runAll,
+    // остальные - через BattleSimulator::run. Итоги в порядке battles
+    static std::vector<SimResult> runSweep(std::vector<SweepBattle> &battles, AIPolicy policy,
+                                           int maxSteps = BattleSimulator::DEFAULT_MAX_STEPS);
+
+    // Можно ли провести бой ядром вместо BattleSimulator::run с тем же итогом: политика ATTACK_ONLY,
+    // не больше SIDE_SLOTS участников на сторону, без активных эффектов, очередь ходов не длиннее MAX_TURNS
+    static bool supports(const SimEncounter &encounter, AIPolicy policy);
+
+    // Какой набор инструкций выбран при компиляции
+    static const char *backendName();
+
+private:
+    // Структура массивов: [слот][дорожка]
+    alignas(64) int32_t m_hp[SLOTS][LANES];
+    alignas(64) int32_t m_maxHP[SLOTS][LANES];
+    alignas(64) int32_t m_damage[SLOTS][LANES];
+    alignas(64) int32_t m_defense[SLOTS][LANES];
+    alignas(64) int32_t m_attack[SLOTS][LANES];
+    alignas(64) int32_t m_stamina[SLOTS][LANES];
+    alignas(64) int32_t m_maxStamina[SLOTS][LANES];
+    alignas(64) int32_t m_initiative[SLOTS][LANES];
+    alignas(64) int32_t m_range[SLOTS][LANES];
+    alignas(64) int32_t m_position[SLOTS][LANES];
+    alignas(64) int32_t m_present[SLOTS][LANES]; // Слот занят живым участником (entity != nullptr)
+    alignas(64) int32_t m_ability[SLOTS][LANES]; // AbilityType
+    alignas(64) double m_variance[SLOTS][LANES];
+
+    // Очередь ходов: слоты по убыванию приоритета, как turnOrder в BattleSystem
+    alignas(64) int32_t m_turnOrder[LANES][MAX_TURNS];
+    alignas(64) int32_t m_turnCount[LANES];
+    alignas(64) int32_t m_turnIndex[LANES];
+    alignas(64) int32_t m_actor[LANES]; // Слот записи m_turnIndex, -1 - ходить некому
+
+    // Состояние каждой дорожки
+    alignas(64) int32_t m_active[LANES]; // Бой идет
+    alignas(64) int32_t m_steps[LANES];
+    int m_playerCount[LANES];
+    int m_enemyCount[LANES];
+    uint8_t m_antithetic[LANES];
+
+    // Генератор каждой дорожки: выход std::mt19937 с тем же зерном, но слово состояния
+    // перемешивается при выдаче, а не все MT_WORDS сразу - бою нужно несколько десятков бросков
+    static const int MT_WORDS = 624;
+    alignas(64) uint32_t m_mt[LANES][MT_WORDS];
+    int32_t m_mtIndex[LANES];
+    // Начальные состояния генератора для следующих LANES боев runAll: цепочка инициализации
+    // mt19937 последовательна, а LANES независимых цепочек рядом считаются векторно
+    alignas(64) uint32_t m_seedBlock[MT_WORDS][LANES];
+
+    // Данные текущего шага: маски дорожек и операнды удара
+    alignas(64) int32_t m_stepPass[LANES];    // Ход передается: нет стамины или целей
+    alignas(64) int32_t m_stepAttacks[LANES]; // Дорожка бьет на этом шаге
+    alignas(64) int32_t m_stepAttacker[LANES];
+    alignas(64) int32_t m_stepTarget[LANES];
+    alignas(64) int32_t m_stepDamage[LANES];
+    alignas(64) int32_t m_stepLightning[LANES]; // Молния атакующего сработала
+    alignas(64) double m_stepRoll[LANES];
+
+    // seedColumn - столбец m_seedBlock с уже посчитанным состоянием генератора, -1 - посчитать здесь
+    void load(int lane, const BatchEncounter &encounter, int seedColumn);
+    void seedRandom(int lane, uint32_t seed);
+    void seedBlock(const std::vector<BatchEncounter> &encounters, size_t first);
+    uint32_t nextRandom(int lane);
+    int rollIndex(int lane, int count);
+    double rollUnit(int lane);
+
+    bool isVictory(int lane) const;
+    bool isDefeat(int lane) const;
+    bool isLaneRunning(int lane, int maxSteps) const
+    {
+        return m_active[lane] && m_steps[lane] < maxSteps && m_actor[lane] >= 0;
+    }
+
+    void calculateTurnOrder(int lane);
+    void updateActor(int lane);
+
+    // Один шаг всех дорожек; false - ни одна дорожка уже не идет
+    bool step(int maxSteps);
+    bool selectActions(int maxSteps);
+    void computeDamage();
+    void applyHits();
+    void passTurns();
+    void removeDead(const int32_t *mask);
+    void checkFinished(const int32_t *mask);
+};
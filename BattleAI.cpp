@@ -0,0 +1,119 @@
+#include "BattleAI.h"
+#include "HeroTemplates.h"
+#include "DecisionCache.h"
+#include "BehaviorTree.h"
+
+const DecisionCache *BattleAI::decisionCache = nullptr;
+const BehaviorLibrary *BattleAI::behaviorLibrary = nullptr;
+
+namespace
+{
+    // Действие из кэша, если оно выполнимо в текущем бою
+    bool lookupCachedAction(BattleSystem &battle, Entity *actor, const vector<pair<Entity *, int>> &targets,
+                            const DecisionCache &cache, BattleAction &action)
+    {
+        CanonicalBattleState state = BattleStateHash::canonicalize(battle, actor);
+        const DecisionRecord *record = cache.find(state.key);
+        if (!record)
+            return false;
+
+        action = DecisionCache::decodeAction(state, actor, record->action);
+        switch (action.type)
+        {
+        case BattleActionType::ATTACK:
+            for (const auto &target : targets)
+            {
+                if (target.first == action.target)
+                    return true;
+            }
+            return false;
+        case BattleActionType::USE_ABILITY:
+            return action.ability != AbilityType::NONE &&
+                   actor->getCurrentStamina() >= HeroFactory::getAbilityInfo(action.ability).staminaCost;
+        case BattleActionType::END_TURN:
+            return true;
+        case BattleActionType::MOVE:
+            return false;
+        }
+        return false;
+    }
+}
+
+BattleAction BattleAI::chooseAction(BattleSystem &battle, Entity *actor, AIPolicy policy)
+{
+    BattleAction action;
+    if (!actor)
+        return action;
+
+    vector<pair<Entity *, int>> targets = battle.getAvailableTargetsForCurrent();
+
+    // Known situation - take the decision from the warmed cache. It goes before the behavior trees:
+    // every tree ends in an attack fallback, so a cache checked after them would never be reached
+    if (policy == AIPolicy::DEFAULT && decisionCache && lookupCachedAction(battle, actor, targets, *decisionCache, action))
+        return action;
+    action = BattleAction();
+
+    // Enemy archetype with its own behavior tree
+    const Enemy *enemy = dynamic_cast<const Enemy *>(actor);
+    if (policy == AIPolicy::DEFAULT)
+    {
+        if (enemy)
+        {
+            const BehaviorLibrary &behaviors = behaviorLibrary ? *behaviorLibrary : BehaviorLibrary::builtin();
+            int root = behaviors.findTree(enemy->getEnemyType());
+            if (root >= 0 && behaviors.tick(root, battle, actor, targets, action))
+                return action;
+            action = BattleAction();
+        }
+    }
+
+    // Attack if possible: the best target by the threat matrix or a random one
+    if (!targets.empty())
+    {
+        bool utility = policy == AIPolicy::UTILITY ||
+                       (policy == AIPolicy::DEFAULT && enemy && enemy->getDifficultyLevel() <= LOW_DIFFICULTY);
+        action.type = BattleActionType::ATTACK;
+        action.target = utility ? battle.getThreatMatrix().chooseTarget(actor, targets)
+                                : targets[battle.rollIndex(static_cast<int>(targets.size()))].first;
+        return action;
+    }
+
+    // Otherwise try the basic ability
+    if (policy != AIPolicy::ATTACK_ONLY && actor->getAbility() != AbilityType::NONE)
+    {
+        const AbilityInfo &info = HeroFactory::getAbilityInfo(actor->getAbility());
+        if (actor->getCurrentStamina() >= info.staminaCost)
+        {
+            action.type = BattleActionType::USE_ABILITY;
+            action.ability = actor->getAbility();
+            return action;
+        }
+    }
+
+    return action;
+}
+
+bool BattleAI::perform(BattleSystem &battle, Entity *actor, const BattleAction &action)
+{
+    bool done = false;
+    switch (action.type)
+    {
+    case BattleActionType::ATTACK:
+        done = battle.attack(actor, action.target);
+        break;
+    case BattleActionType::USE_ABILITY:
+        done = battle.useAbility(actor, action.ability);
+        break;
+    case BattleActionType::MOVE:
+        done = battle.movePosition(actor, action.position);
+        break;
+    case BattleActionType::END_TURN:
+        break;
+    }
+
+    if (!done)
+    {
+        battle.nextTurn();
+    }
+    return done;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "BattleSystem.h"
+
+// Тип действия на текущем шаге хода (ИИ или ввод игрока)
+enum class BattleActionType
+{
+    ATTACK,
+    USE_ABILITY,
+    END_TURN,
+    MOVE
+};
+
+// Политика ИИ: полная (атака/способность), только атаки (для пакетной симуляции)
+// или утилитарная (цель по матрице угроз боя, без деревьев и кэша - дешевая для массовых прогонов)
+enum class AIPolicy
+{
+    DEFAULT,
+    ATTACK_ONLY,
+    UTILITY
+};
+
+// Одно действие ИИ
+struct BattleAction
+{
+    BattleActionType type = BattleActionType::END_TURN;
+    Entity *target = nullptr;
+    AbilityType ability = AbilityType::NONE;
+    int position = -1; // Для MOVE
+};
+
+class DecisionCache;
+class BehaviorLibrary;
+
+// Простой ИИ боя: атакует случайную доступную цель, иначе использует способность, иначе завершает ход.
+// Случайные выборы делаются генератором боя, поэтому бой с заданным зерном воспроизводим.
+// Политика DEFAULT: если подключен кэш решений, для известных состояний действие берется из него;
+// иначе враги с деревом поведения для своего типа ходят по дереву.
+// Слабые враги (уровень сложности шаблона не выше LOW_DIFFICULTY) выбирают цель по матрице угроз.
+class BattleAI
+{
+private:
+    static const DecisionCache *decisionCache;
+    static const BehaviorLibrary *behaviorLibrary;
+
+public:
+    static const int LOW_DIFFICULTY = 1;
+
+    // Подключить кэш решений (nullptr - отключить). Кэш должен жить дольше всех боев
+    static void setDecisionCache(const DecisionCache *cache) { decisionCache = cache; }
+    static const DecisionCache *getDecisionCache() { return decisionCache; }
+
+    // Подключить деревья поведения врагов (nullptr - встроенные). Библиотека должна жить дольше всех боев
+    static void setBehaviorLibrary(const BehaviorLibrary *library) { behaviorLibrary = library; }
+
+    // Выбрать действие для текущего персонажа
+    static BattleAction chooseAction(BattleSystem &battle, Entity *actor, AIPolicy policy = AIPolicy::DEFAULT);
+
+    // Выполнить действие; END_TURN или неудачное действие передают ход дальше
+    static bool perform(BattleSystem &battle, Entity *actor, const BattleAction &action);
+};
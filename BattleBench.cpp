@@ -0,0 +1,691 @@
+#include "Tools.h"
+#include "BattleSimulator.h"
+#include "BatchBattleKernel.h"
+#include "BattleDriver.h"
+#include "BehaviorTree.h"
+#include "RoundPlanner.h"
+#include "HeroTemplates.h"
+#include "EnemyTemplates.h"
+#include "ItemTemplates.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Бенчмарк горячего пути боя: отдельные методы BattleSystem и полные бои
+// для каждого пресета отряда против каждой локации. Отчет в JSON.
+
+namespace
+{
+    using BenchClock = std::chrono::steady_clock;
+
+    struct BenchResult
+    {
+        std::string name;
+        long long iterations = 0;
+        double nsPerOp = 0.0;
+        double allocsPerOp = 0.0;
+    };
+
+    struct BattleThroughput
+    {
+        std::string preset;
+        std::string location;
+        int battles = 0;
+        double battlesPerSec = 0.0;
+        double nsPerOp = 0.0;
+        double allocsPerOp = 0.0;
+        double playerWinRate = 0.0;
+    };
+
+    const std::pair<LocationType, const char *> benchLocations[] = {
+        {LocationType::FOREST, "FOREST"},
+        {LocationType::CAVE, "CAVE"},
+        {LocationType::DEAD_CITY, "DEAD_CITY"},
+        {LocationType::CASTLE, "CASTLE"},
+    };
+
+    const std::pair<AbilityType, const char *> benchAbilities[] = {
+        {AbilityType::FLYING, "FLYING"},
+        {AbilityType::POISON, "POISON"},
+        {AbilityType::FIRE_DAMAGE, "FIRE_DAMAGE"},
+        {AbilityType::ICE_DAMAGE, "ICE_DAMAGE"},
+        {AbilityType::LIGHTNING, "LIGHTNING"},
+        {AbilityType::HEAL, "HEAL"},
+        {AbilityType::TELEPORT, "TELEPORT"},
+        {AbilityType::INVISIBLE, "INVISIBLE"},
+        {AbilityType::LIFE_STEAL, "LIFE_STEAL"},
+        {AbilityType::REGENERATION, "REGENERATION"},
+        {AbilityType::FEAR, "FEAR"},
+        {AbilityType::BERSERK, "BERSERK"},
+        {AbilityType::CHARGE, "CHARGE"},
+        {AbilityType::SHIELD_WALL, "SHIELD_WALL"},
+        {AbilityType::BATTLE_CRY, "BATTLE_CRY"},
+        {AbilityType::MAGIC_MISSILE, "MAGIC_MISSILE"},
+        {AbilityType::CHAIN_LIGHTNING, "CHAIN_LIGHTNING"},
+        {AbilityType::FLAME_BURST, "FLAME_BURST"},
+        {AbilityType::BLOOD_RITUAL, "BLOOD_RITUAL"},
+        {AbilityType::HEALING_WAVE, "HEALING_WAVE"},
+        {AbilityType::COMMAND, "COMMAND"},
+        {AbilityType::FROST_ARMOR, "FROST_ARMOR"},
+        {AbilityType::STEALTH, "STEALTH"},
+        {AbilityType::SHADOW_STEP, "SHADOW_STEP"},
+        {AbilityType::ARCANE_MISSILE, "ARCANE_MISSILE"},
+    };
+
+    // Итоги серии из t.battles боев: суммарное время, выделения и победы -> показатели на бой
+    void fillThroughput(BattleThroughput &t, BenchClock::duration total, std::size_t allocations, int victories)
+    {
+        double seconds = std::chrono::duration<double>(total).count();
+        if (t.battles > 0)
+        {
+            t.nsPerOp = seconds * 1e9 / t.battles;
+            t.allocsPerOp = static_cast<double>(allocations) / t.battles;
+            t.playerWinRate = static_cast<double>(victories) / t.battles;
+        }
+        t.battlesPerSec = seconds > 0.0 ? t.battles / seconds : 0.0;
+    }
+
+    // Бой i смешанной серии (ядро, драйвер, планировщик): пресеты и локации по кругу
+    SimEncounter createMixedEncounter(int i, unsigned int seed)
+    {
+        int presetCount = static_cast<int>(HeroFactory::getPartyPresets().size());
+        return BattleSimulator::createEncounter(i % presetCount, benchLocations[i % 4].first, 4, 0, seed);
+    }
+
+    // Участники боя в виде, в котором их принимают startBattle и BattleDriver
+    void collectEntities(SimEncounter &encounter, std::vector<Entity *> &players, std::vector<Entity *> &enemies)
+    {
+        for (auto &player : encounter.players)
+        {
+            players.push_back(player.get());
+        }
+        for (auto &enemy : encounter.enemies)
+        {
+            enemies.push_back(enemy.get());
+        }
+    }
+
+    // Замер одной операции: setup() вне замера, op() - внутри
+    template <typename Setup, typename Op>
+    BenchResult measure(const std::string &name, int iterations, Setup setup, Op op)
+    {
+        BenchResult result;
+        result.name = name;
+        result.iterations = iterations;
+
+        BenchClock::duration total(0);
+        std::size_t allocations = 0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            setup();
+            std::size_t allocationsBefore = g_allocationCount.load(std::memory_order_relaxed);
+            BenchClock::time_point start = BenchClock::now();
+            op();
+            BenchClock::time_point finish = BenchClock::now();
+            allocations += g_allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+            total += finish - start;
+        }
+
+        if (iterations > 0)
+        {
+            result.nsPerOp = std::chrono::duration<double, std::nano>(total).count() / iterations;
+            result.allocsPerOp = static_cast<double>(allocations) / iterations;
+        }
+        return result;
+    }
+
+    // Поле боя для микробенчмарков: отряд первого пресета против 4 одинаковых врагов.
+    // reset() возвращает всех участников к исходным характеристикам и заново начинает бой.
+    class BenchArena
+    {
+    public:
+        BenchArena()
+        {
+            for (Player *hero : HeroFactory::createPartyFromPreset(0))
+            {
+                m_heroes.emplace_back(hero);
+                m_heroPrototypes.push_back(*hero);
+                m_players.push_back(hero);
+            }
+            for (int i = 0; i < 4; ++i)
+            {
+                m_enemies.emplace_back(new Enemy("Bench Enemy " + std::to_string(i + 1), 120, 12, 3, 3, 3, 3, 30, 1));
+                m_enemyPrototypes.push_back(*m_enemies.back());
+                m_foes.push_back(m_enemies.back().get());
+            }
+        }
+
+        void restore(AbilityType enemyAbility = AbilityType::NONE)
+        {
+            for (size_t i = 0; i < m_heroes.size(); ++i)
+            {
+                *m_heroes[i] = m_heroPrototypes[i];
+            }
+            for (size_t i = 0; i < m_enemies.size(); ++i)
+            {
+                *m_enemies[i] = m_enemyPrototypes[i];
+            }
+            if (enemyAbility != AbilityType::NONE)
+            {
+                // Первому врагу - проверяемая способность и стамины с запасом
+                m_enemies[0]->setAbility(enemyAbility);
+                m_enemies[0]->setMaxStamina(10);
+            }
+        }
+
+        void reset(AbilityType enemyAbility = AbilityType::NONE)
+        {
+            restore(enemyAbility);
+            battle.setRandomSeed(12345);
+            battle.startBattle(m_players, m_foes);
+        }
+
+        void start() { battle.startBattle(m_players, m_foes); }
+
+        Entity *player(size_t index) { return m_players[index]; }
+        Entity *foe(size_t index) { return m_foes[index]; }
+
+        BattleSystem battle;
+
+    private:
+        std::vector<std::unique_ptr<Player>> m_heroes;
+        std::vector<Player> m_heroPrototypes;
+        std::vector<std::unique_ptr<Enemy>> m_enemies;
+        std::vector<Enemy> m_enemyPrototypes;
+        std::vector<Entity *> m_players;
+        std::vector<Entity *> m_foes;
+    };
+
+    std::vector<BenchResult> runMicroBenchmarks(int iterations)
+    {
+        std::vector<BenchResult> results;
+        BenchArena arena;
+
+        results.push_back(measure("BattleSystem::startBattle", iterations,
+                                  [&]() { arena.restore(); },
+                                  [&]() { arena.start(); }));
+        results.push_back(measure("BattleSystem::calculateTurnOrder", iterations,
+                                  [&]() { arena.reset(); },
+                                  [&]() { arena.battle.calculateTurnOrder(); }));
+        results.push_back(measure("BattleSystem::attack", iterations,
+                                  [&]() { arena.reset(); },
+                                  [&]() { arena.battle.attack(arena.player(0), arena.foe(0)); }));
+        results.push_back(measure("BattleSystem::movePosition", iterations,
+                                  [&]() { arena.reset(); },
+                                  [&]() { arena.battle.movePosition(arena.player(0), 1); }));
+
+        for (const auto &ability : benchAbilities)
+        {
+            AbilityType type = ability.first;
+            results.push_back(measure(std::string("BattleSystem::useAbility/") + ability.second, iterations,
+                                      [&]() { arena.reset(type); },
+                                      [&]() { arena.battle.useAbility(arena.foe(0), type); }));
+        }
+
+        results.push_back(measure("BattleSystem::nextTurn", iterations,
+                                  [&]() { arena.reset(); },
+                                  [&]() { arena.battle.nextTurn(); }));
+        // Смена хода при висящих эффектах: обрабатывается только ячейка колеса текущего персонажа
+        results.push_back(measure("BattleSystem::nextTurn/effects", iterations,
+                                  [&]()
+                                  {
+                                      arena.reset(AbilityType::POISON);
+                                      arena.battle.useAbility(arena.foe(0), AbilityType::POISON);
+                                      arena.battle.useAbility(arena.foe(0), AbilityType::BATTLE_CRY);
+                                  },
+                                  [&]() { arena.battle.nextTurn(); }));
+        results.push_back(measure("BattleSystem::removeDeadEntities", iterations,
+                                  [&]()
+                                  {
+                                      arena.reset();
+                                      arena.foe(0)->setCurrentHealthPoint(0);
+                                  },
+                                  [&]() { arena.battle.removeDeadEntities(); }));
+
+        // Строки состояния для экрана боя: пересборка после изменения и повторный кадр без изменений
+        results.push_back(measure("BattleSystem::getBattleStatus/rebuild", iterations,
+                                  [&]() { arena.reset(); },
+                                  [&]() { arena.battle.getBattleStatus(); }));
+        results.push_back(measure("BattleSystem::getBattleStatus/cached", iterations,
+                                  [&]()
+                                  {
+                                      arena.reset();
+                                      arena.battle.getBattleStatus();
+                                  },
+                                  [&]() { arena.battle.getBattleStatus(); }));
+        results.push_back(measure("BattleSystem::getTurnOrderString/cached", iterations,
+                                  [&]()
+                                  {
+                                      arena.reset();
+                                      arena.battle.getTurnOrderString();
+                                  },
+                                  [&]() { arena.battle.getTurnOrderString(); }));
+
+        // Итог бонусов экипировки хранится готовым и правится при смене слота
+        int bonusSink = 0;
+        results.push_back(measure("Player::getEquipmentBonuses", iterations,
+                                  [&]() {},
+                                  [&]() { bonusSink += static_cast<Player *>(arena.player(0))->getEquipmentBonuses()[StatType::DAMAGE]; }));
+
+        // Склад на тысячу предметов с построенной сортировкой по урону: забрать предмет и положить обратно
+        Inventory stash;
+        for (int i = 0; i < 1000; ++i)
+        {
+            stash.insert(ItemFactory::createItem(i % static_cast<int>(ItemFactory::getAllItems().size())));
+        }
+        stash.sortedBy(StatType::DAMAGE);
+        size_t stashCursor = 0;
+        results.push_back(measure("Inventory erase+insert/1000 sorted", iterations,
+                                  [&]() {},
+                                  [&]()
+                                  {
+                                      ItemHandle handle = stash.handleAt(stashCursor++ % stash.size());
+                                      Item item = *stash.find(handle);
+                                      stash.erase(handle);
+                                      stash.insert(item);
+                                  }));
+
+        const BehaviorLibrary &behaviors = BehaviorLibrary::builtin();
+        std::vector<std::pair<Entity *, int>> targets;
+        BattleAction action;
+
+        // Выбор цели утилитарным ИИ: матрица угроз уже построена, статы не менялись
+        results.push_back(measure("ThreatMatrix::chooseTarget", iterations,
+                                  [&]()
+                                  {
+                                      arena.reset();
+                                      targets = arena.battle.getAvailableTargetsForCurrent();
+                                  },
+                                  [&]() { arena.battle.getThreatMatrix().chooseTarget(arena.battle.getCurrentTurnEntity(), targets); }));
+        for (const auto &policy : {std::make_pair(AIPolicy::ATTACK_ONLY, "attack-only"), std::make_pair(AIPolicy::UTILITY, "utility")})
+        {
+            results.push_back(measure(std::string("BattleAI::chooseAction/") + policy.second, iterations,
+                                      [&]()
+                                      {
+                                          arena.reset();
+                                          arena.battle.rollUnit(); // Пересчет состояния mt19937 после зерна - не в замер
+                                      },
+                                      [&]() { BattleAI::chooseAction(arena.battle, arena.battle.getCurrentTurnEntity(), policy.first); }));
+        }
+
+        // Один тик скомпилированного дерева поведения (цели посчитаны заранее, как в BattleAI)
+        for (const char *archetype : {"goblin", "orc", "vampire", "wyvern", "ghost", "troglodyte"})
+        {
+            int root = behaviors.findTree(archetype);
+            results.push_back(measure(std::string("BehaviorTree::tick/") + archetype, iterations,
+                                      [&]()
+                                      {
+                                          arena.reset();
+                                          targets = arena.battle.getAvailableTargetsForCurrent();
+                                          // Первый бросок после зерна пересчитывает все состояние mt19937 - не в замер
+                                          arena.battle.rollUnit();
+                                      },
+                                      [&]()
+                                      {
+                                          behaviors.tick(root, arena.battle, arena.battle.getCurrentTurnEntity(), targets, action);
+                                      }));
+        }
+        return results;
+    }
+
+    std::vector<BattleThroughput> runBattleBenchmarks(int battlesPerPair)
+    {
+        std::vector<BattleThroughput> results;
+        const std::vector<PartyPreset> &presets = HeroFactory::getPartyPresets();
+
+        for (int preset = 0; preset < static_cast<int>(presets.size()); ++preset)
+        {
+            for (const auto &location : benchLocations)
+            {
+                BattleThroughput throughput;
+                throughput.preset = presets[preset].name;
+                throughput.location = location.second;
+                throughput.battles = battlesPerPair;
+
+                BenchClock::duration total(0);
+                std::size_t allocations = 0;
+                int victories = 0;
+                for (int i = 0; i < battlesPerPair; ++i)
+                {
+                    unsigned int seed = static_cast<unsigned int>(i + 1);
+                    SimEncounter encounter = BattleSimulator::createEncounter(preset, location.first, 4, 0, seed);
+
+                    std::size_t allocationsBefore = g_allocationCount.load(std::memory_order_relaxed);
+                    BenchClock::time_point start = BenchClock::now();
+                    SimResult result = BattleSimulator::run(encounter, seed);
+                    BenchClock::time_point finish = BenchClock::now();
+                    allocations += g_allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+                    total += finish - start;
+
+                    if (result.playerVictory)
+                        ++victories;
+                }
+
+                fillThroughput(throughput, total, allocations, victories);
+                results.push_back(throughput);
+            }
+        }
+        return results;
+    }
+
+    // Пакетное ядро против BattleSimulator на тех же боях (политика ATTACK_ONLY):
+    // итоги должны совпасть бой в бой, иначе выигрыш в скорости ничего не значит
+    struct BatchComparison
+    {
+        BattleThroughput simulator;
+        BattleThroughput kernel;
+        int mismatches = 0;
+    };
+
+    bool sameResult(const SimResult &a, const SimResult &b)
+    {
+        return a.playerVictory == b.playerVictory && a.playerDefeat == b.playerDefeat && a.steps == b.steps &&
+               a.playerHPLeft == b.playerHPLeft && a.enemyHPLeft == b.enemyHPLeft;
+    }
+
+    BatchComparison runBatchKernelBenchmark(int battles)
+    {
+        BatchComparison comparison;
+        comparison.simulator.preset = "all (BattleSimulator ATTACK_ONLY)";
+        comparison.kernel.preset = std::string("all (") + BatchBattleKernel::backendName() + ")";
+        comparison.simulator.location = comparison.kernel.location = "all";
+        comparison.simulator.battles = comparison.kernel.battles = battles;
+
+        std::vector<BatchEncounter> encounters;
+        std::vector<SimEncounter> simEncounters;
+        for (int i = 0; i < battles; ++i)
+        {
+            unsigned int seed = static_cast<unsigned int>(i + 1);
+            simEncounters.push_back(createMixedEncounter(i, seed));
+            encounters.push_back(BatchEncounter::fromEncounter(simEncounters.back(), seed));
+        }
+
+        std::size_t allocationsBefore = g_allocationCount.load(std::memory_order_relaxed);
+        BenchClock::time_point start = BenchClock::now();
+        std::vector<SimResult> results = BatchBattleKernel::runAll(encounters);
+        BenchClock::time_point finish = BenchClock::now();
+        std::size_t kernelAllocations = g_allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+        BenchClock::duration kernelTotal = finish - start;
+
+        BenchClock::duration simTotal(0);
+        std::size_t simAllocations = 0;
+        int simVictories = 0;
+        int kernelVictories = 0;
+        for (int i = 0; i < battles; ++i)
+        {
+            allocationsBefore = g_allocationCount.load(std::memory_order_relaxed);
+            start = BenchClock::now();
+            SimResult simResult = BattleSimulator::run(simEncounters[i], encounters[i].seed, AIPolicy::ATTACK_ONLY);
+            finish = BenchClock::now();
+            simAllocations += g_allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+            simTotal += finish - start;
+
+            if (!sameResult(simResult, results[i]))
+                ++comparison.mismatches;
+            if (simResult.playerVictory)
+                ++simVictories;
+            if (results[i].playerVictory)
+                ++kernelVictories;
+        }
+
+        fillThroughput(comparison.simulator, simTotal, simAllocations, simVictories);
+        fillThroughput(comparison.kernel, kernelTotal, kernelAllocations, kernelVictories);
+        return comparison;
+    }
+
+    // Безголовый драйвер на сопрограммах против BattleSimulator на одинаковых боях:
+    // итоги должны совпасть, приостановок быть не должно
+    struct DriverComparison
+    {
+        BattleThroughput simulator;
+        BattleThroughput driver;
+        long long suspensions = 0;
+        int mismatches = 0;
+    };
+
+    DriverComparison runDriverBenchmark(int battles)
+    {
+        DriverComparison comparison;
+        comparison.simulator.preset = "all (BattleSimulator)";
+        comparison.driver.preset = "all (BattleDriver headless)";
+        comparison.simulator.location = comparison.driver.location = "all";
+        comparison.simulator.battles = comparison.driver.battles = battles;
+
+        BenchClock::duration simTotal(0);
+        BenchClock::duration driverTotal(0);
+        std::size_t simAllocations = 0;
+        std::size_t driverAllocations = 0;
+        int simVictories = 0;
+        int driverVictories = 0;
+        for (int i = 0; i < battles; ++i)
+        {
+            unsigned int seed = static_cast<unsigned int>(i + 1);
+            SimEncounter simEncounter = createMixedEncounter(i, seed);
+            SimEncounter driverEncounter = createMixedEncounter(i, seed);
+
+            std::size_t allocationsBefore = g_allocationCount.load(std::memory_order_relaxed);
+            BenchClock::time_point start = BenchClock::now();
+            SimResult simResult = BattleSimulator::run(simEncounter, seed);
+            BenchClock::time_point finish = BenchClock::now();
+            simAllocations += g_allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+            simTotal += finish - start;
+
+            std::vector<Entity *> players;
+            std::vector<Entity *> enemies;
+            collectEntities(driverEncounter, players, enemies);
+            long long suspensions = 0;
+            allocationsBefore = g_allocationCount.load(std::memory_order_relaxed);
+            start = BenchClock::now();
+            SimResult driverResult = BattleDriver::runHeadless(players, enemies, seed, AIPolicy::DEFAULT,
+                                                               BattleSimulator::DEFAULT_MAX_STEPS, &suspensions);
+            finish = BenchClock::now();
+            driverAllocations += g_allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+            driverTotal += finish - start;
+
+            comparison.suspensions += suspensions;
+            if (!sameResult(simResult, driverResult))
+                ++comparison.mismatches;
+            if (simResult.playerVictory)
+                ++simVictories;
+            if (driverResult.playerVictory)
+                ++driverVictories;
+        }
+
+        fillThroughput(comparison.simulator, simTotal, simAllocations, simVictories);
+        fillThroughput(comparison.driver, driverTotal, driverAllocations, driverVictories);
+        return comparison;
+    }
+
+    // Задержка помощника "спланировать раунд" в первом ходе героя
+    struct PlannerLatency
+    {
+        int requests = 0;
+        unsigned int threads = 0;
+        int budgetMs = 0;
+        double meanMs = 0.0;
+        double maxMs = 0.0;
+        double expandedPerRequest = 0.0;
+        int truncated = 0;
+    };
+
+    PlannerLatency runPlannerBenchmark(int requests)
+    {
+        PlannerLatency latency;
+        latency.requests = requests;
+        latency.threads = resolveThreadCount(0);
+        RoundPlanner planner(latency.threads);
+        latency.budgetMs = planner.getOptions().timeBudgetMs;
+
+        double totalMs = 0.0;
+        long long expanded = 0;
+        for (int i = 0; i < requests; ++i)
+        {
+            unsigned int seed = static_cast<unsigned int>(i + 1);
+            SimEncounter encounter = createMixedEncounter(i, seed);
+            std::vector<Entity *> players;
+            std::vector<Entity *> enemies;
+            collectEntities(encounter, players, enemies);
+
+            // Враги, опередившие героев по инициативе, ходят до запроса
+            BattleSystem battle;
+            battle.setOutput(nullptr);
+            battle.setRandomSeed(seed);
+            battle.startBattle(players, enemies);
+            for (int step = 0; step < BattleSimulator::DEFAULT_MAX_STEPS && battle.isBattleActive(); ++step)
+            {
+                Entity *actor = battle.getCurrentTurnEntity();
+                if (!actor || (std::find(players.begin(), players.end(), actor) != players.end() && actor->getCurrentStamina() > 0))
+                    break;
+                if (actor->getCurrentStamina() <= 0)
+                    battle.nextTurn();
+                else
+                    BattleAI::perform(battle, actor, BattleAI::chooseAction(battle, actor));
+            }
+
+            BenchClock::time_point start = BenchClock::now();
+            planner.plan(battle);
+            double ms = std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+            totalMs += ms;
+            latency.maxMs = std::max(latency.maxMs, ms);
+            expanded += planner.getExpandedCount();
+            if (planner.wasTruncated())
+                ++latency.truncated;
+        }
+        if (requests > 0)
+        {
+            latency.meanMs = totalMs / requests;
+            latency.expandedPerRequest = static_cast<double>(expanded) / requests;
+        }
+        return latency;
+    }
+
+    std::string jsonString(const std::string &text)
+    {
+        std::string escaped = "\"";
+        for (char ch : text)
+        {
+            if (ch == '"' || ch == '\\')
+            {
+                escaped += '\\';
+                escaped += ch;
+            }
+            else if (static_cast<unsigned char>(ch) < 0x20)
+            {
+                escaped += ' ';
+            }
+            else
+            {
+                escaped += ch;
+            }
+        }
+        return escaped + "\"";
+    }
+
+    void writeThroughput(std::ostream &out, const BattleThroughput &t)
+    {
+        out << "{\"preset\": " << jsonString(t.preset)
+            << ", \"location\": " << jsonString(t.location)
+            << ", \"battles\": " << t.battles
+            << ", \"battles_per_sec\": " << t.battlesPerSec
+            << ", \"ns_per_op\": " << t.nsPerOp
+            << ", \"allocs_per_op\": " << t.allocsPerOp
+            << ", \"player_win_rate\": " << t.playerWinRate << "}";
+    }
+
+    void writeReport(std::ostream &out, const std::vector<BenchResult> &micro,
+                     const std::vector<BattleThroughput> &battles, const BatchComparison &batch,
+                     const DriverComparison &driver, const PlannerLatency &planner)
+    {
+        out << "{\n  \"micro\": [\n";
+        for (size_t i = 0; i < micro.size(); ++i)
+        {
+            const BenchResult &r = micro[i];
+            out << "    {\"name\": " << jsonString(r.name)
+                << ", \"iterations\": " << r.iterations
+                << ", \"ns_per_op\": " << r.nsPerOp
+                << ", \"allocs_per_op\": " << r.allocsPerOp << "}"
+                << (i + 1 < micro.size() ? ",\n" : "\n");
+        }
+        out << "  ],\n  \"battles\": [\n";
+        for (size_t i = 0; i < battles.size(); ++i)
+        {
+            out << "    ";
+            writeThroughput(out, battles[i]);
+            out << (i + 1 < battles.size() ? ",\n" : "\n");
+        }
+        out << "  ],\n  \"batch_kernel\": {\n    \"simulator\": ";
+        writeThroughput(out, batch.simulator);
+        out << ",\n    \"kernel\": ";
+        writeThroughput(out, batch.kernel);
+        out << ",\n    \"mismatches\": " << batch.mismatches << "\n  },\n  \"coroutine_driver\": {\n    \"simulator\": ";
+        writeThroughput(out, driver.simulator);
+        out << ",\n    \"driver\": ";
+        writeThroughput(out, driver.driver);
+        out << ",\n    \"suspensions\": " << driver.suspensions
+            << ",\n    \"mismatches\": " << driver.mismatches << "\n  },\n  \"round_planner\": {"
+            << "\"requests\": " << planner.requests
+            << ", \"threads\": " << planner.threads
+            << ", \"budget_ms\": " << planner.budgetMs
+            << ", \"mean_ms\": " << planner.meanMs
+            << ", \"max_ms\": " << planner.maxMs
+            << ", \"expanded_per_request\": " << planner.expandedPerRequest
+            << ", \"truncated\": " << planner.truncated << "}\n}\n";
+    }
+}
+
+int runBenchmark(int argc, char **argv)
+{
+    std::string outputPath;
+    int iterations = 20000;
+    int battlesPerPair = 200;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc)
+        {
+            outputPath = argv[++i];
+        }
+        else if (arg == "--quick")
+        {
+            iterations = 500;
+            battlesPerPair = 20;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+
+    std::vector<BenchResult> micro;
+    std::vector<BattleThroughput> battles;
+    BatchComparison batch;
+    DriverComparison driver;
+    PlannerLatency planner;
+    {
+        // Бой печатает каждое действие - в замер входит форматирование, но не консоль
+        ScopedSilence silence;
+        micro = runMicroBenchmarks(iterations);
+        battles = runBattleBenchmarks(battlesPerPair);
+        batch = runBatchKernelBenchmark(battlesPerPair * 16);
+        driver = runDriverBenchmark(battlesPerPair * 16);
+        planner = runPlannerBenchmark(battlesPerPair);
+    }
+
+    if (outputPath.empty())
+    {
+        writeReport(std::cout, micro, battles, batch, driver, planner);
+    }
+    else
+    {
+        std::ofstream file(outputPath);
+        if (!file)
+            throw std::runtime_error("cannot open " + outputPath);
+        writeReport(file, micro, battles, batch, driver, planner);
+    }
+    return 0;
+}
@@ -0,0 +1,333 @@
+#include "BattleDriver.h"
+#include <chrono>
+
+namespace
+{
+    // Свободные кадры сопрограмм потока. Размеров кадров всего несколько (цикл боя, ход ИИ, ход игрока),
+    // поэтому в установившемся режиме ход не выделяет память
+    struct FrameCache
+    {
+        static const int SLOTS = 8;
+        struct Slot
+        {
+            size_t size;
+            void *frame;
+        };
+        Slot slots[SLOTS];
+        int count = 0;
+
+        ~FrameCache()
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                ::operator delete(slots[i].frame);
+            }
+        }
+    };
+
+    thread_local FrameCache frameCache;
+}
+
+void *BattleTask::allocateFrame(size_t size)
+{
+    FrameCache &cache = frameCache;
+    for (int i = cache.count - 1; i >= 0; --i)
+    {
+        if (cache.slots[i].size == size)
+        {
+            void *frame = cache.slots[i].frame;
+            cache.slots[i] = cache.slots[--cache.count];
+            return frame;
+        }
+    }
+    return ::operator new(size);
+}
+
+void BattleTask::releaseFrame(void *frame, size_t size)
+{
+    FrameCache &cache = frameCache;
+    if (cache.count < FrameCache::SLOTS)
+    {
+        cache.slots[cache.count++] = {size, frame};
+        return;
+    }
+    ::operator delete(frame);
+}
+
+BattleTask &BattleTask::operator=(BattleTask &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (handle)
+            handle.destroy();
+        handle = other.handle;
+        other.handle = nullptr;
+    }
+    return *this;
+}
+
+BattleTask::~BattleTask()
+{
+    if (handle)
+        handle.destroy();
+}
+
+void BattleTask::rethrowIfFailed() const
+{
+    if (handle && handle.promise().error)
+        rethrow_exception(handle.promise().error);
+}
+
+BattleAction BattleDriver::PlayerInputAwaiter::await_resume()
+{
+    driver.hasInput = false;
+    return driver.input;
+}
+
+bool BattleDriver::AIDecisionAwaiter::await_ready()
+{
+    // Без окна решение считается на месте - приостанавливаться незачем
+    if (driver.mode == BattleDriverMode::HEADLESS)
+    {
+        action = BattleAI::chooseAction(driver.battle, actor, driver.policy);
+        return true;
+    }
+    return false;
+}
+
+void BattleDriver::AIDecisionAwaiter::await_suspend(coroutine_handle<> handle)
+{
+    BattleSystem *battle = &driver.battle;
+    Entity *entity = actor;
+    AIPolicy policy = driver.policy;
+
+    // Статы считаются лениво и кешируются при первом чтении: пересчитать их здесь, в потоке окна,
+    // иначе рабочий поток и отрисовка записали бы кеш одновременно
+    const EntityStore &entities = battle->getEntities();
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        entities.at(i)->settleStats();
+    }
+    // Пул хранит копируемые задачи, поэтому задача решения лежит в shared_ptr
+    auto task = make_shared<packaged_task<BattleAction()>>([battle, entity, policy]()
+                                                           { return BattleAI::chooseAction(*battle, entity, policy); });
+    driver.decision = task->get_future();
+    driver.aiWorker->submit([task]()
+                            { (*task)(); });
+    driver.suspend(handle, Wait::AI_DECISION);
+}
+
+BattleAction BattleDriver::AIDecisionAwaiter::await_resume()
+{
+    if (driver.decision.valid())
+        action = driver.decision.get();
+    return action;
+}
+
+void BattleDriver::AnimationAwaiter::await_suspend(coroutine_handle<> handle)
+{
+    driver.animationLeft = seconds;
+    driver.suspend(handle, Wait::ANIMATION);
+}
+
+BattleDriver::BattleDriver(BattleSystem &battle, BattleDriverMode mode, AIPolicy policy, int maxSteps)
+    : battle(battle), mode(mode), policy(policy), maxSteps(maxSteps)
+{
+    if (mode == BattleDriverMode::INTERACTIVE)
+    {
+        for (const BattlePosition &pos : battle.getPlayerPositions())
+        {
+            if (Entity *entity = battle.entityAt(pos))
+                controlled.push_back(entity);
+        }
+        aiWorker.reset(new WorkStealingPool(1));
+    }
+}
+
+BattleDriver::~BattleDriver()
+{
+    // Рабочий поток ИИ читает бой - дождаться его до разрушения сопрограмм
+    if (decision.valid())
+        decision.wait();
+}
+
+void BattleDriver::start()
+{
+    if (task.isDone() && !finished)
+    {
+        task = battleLoop();
+        task.rethrowIfFailed();
+    }
+}
+
+void BattleDriver::update(float deltaSeconds)
+{
+    switch (wait)
+    {
+    case Wait::AI_DECISION:
+        if (decision.wait_for(chrono::seconds(0)) == future_status::ready)
+            resume();
+        break;
+    case Wait::ANIMATION:
+        animationLeft -= deltaSeconds;
+        if (animationLeft <= 0.0f)
+            resume();
+        break;
+    case Wait::NONE:
+    case Wait::PLAYER_INPUT:
+        break;
+    }
+}
+
+bool BattleDriver::submit(const BattleAction &action)
+{
+    if (wait != Wait::PLAYER_INPUT)
+        return false;
+    input = action;
+    hasInput = true;
+    resume();
+    return true;
+}
+
+void BattleDriver::skipAnimation()
+{
+    if (wait == Wait::ANIMATION)
+        resume();
+}
+
+SimResult BattleDriver::runHeadless(const vector<Entity *> &players, const vector<Entity *> &enemies,
+                                    unsigned int seed, AIPolicy policy, int maxSteps, long long *suspensions)
+{
+    BattleSystem battle;
+    battle.setOutput(nullptr);
+    battle.setRandomSeed(seed);
+    battle.startBattle(players, enemies);
+
+    BattleDriver driver(battle, BattleDriverMode::HEADLESS, policy, maxSteps);
+    driver.start();
+
+    SimResult result;
+    result.steps = driver.getSteps();
+    if (!battle.isBattleActive())
+    {
+        result.playerVictory = battle.isPlayerVictory();
+        result.playerDefeat = !result.playerVictory && battle.isPlayerDefeat();
+    }
+    for (Entity *player : players)
+    {
+        result.playerHPLeft += player->getCurrentHealthPoint();
+    }
+    for (Entity *enemy : enemies)
+    {
+        result.enemyHPLeft += enemy->getCurrentHealthPoint();
+    }
+    if (suspensions)
+        *suspensions = driver.getSuspensionCount();
+    return result;
+}
+
+BattleTask BattleDriver::battleLoop()
+{
+    while (battle.isBattleActive() && !stepLimitReached())
+    {
+        Entity *current = battle.getCurrentTurnEntity();
+        if (!current)
+            break; // Ходить некому - ничья
+
+        actor = current;
+        if (isControlled(current))
+            co_await playerTurn(current, battle.getTurnSerial());
+        else
+            co_await aiTurn(current, battle.getTurnSerial());
+    }
+    actor = nullptr;
+    finished = true;
+}
+
+BattleTask BattleDriver::playerTurn(Entity *entity, uint64_t turn)
+{
+    while (turnContinues(entity, turn))
+    {
+        // Выносливость кончилась - ход переходит сам
+        if (entity->getCurrentStamina() <= 0)
+        {
+            battle.nextTurn();
+            break;
+        }
+        BattleAction action = co_await PlayerInputAwaiter{*this};
+        applyPlayerAction(entity, action);
+    }
+}
+
+BattleTask BattleDriver::aiTurn(Entity *entity, uint64_t turn)
+{
+    // Тот же порядок шагов, что в BattleSimulator::run
+    while (turnContinues(entity, turn) && !stepLimitReached())
+    {
+        ++steps;
+        if (entity->getCurrentStamina() <= 0)
+        {
+            battle.nextTurn();
+            break;
+        }
+
+        BattleAction action = co_await AIDecisionAwaiter{*this, entity, BattleAction()};
+        shownAction = action;
+        co_await AnimationAwaiter{*this, animationSeconds};
+        BattleAI::perform(battle, entity, action);
+    }
+}
+
+bool BattleDriver::isControlled(const Entity *entity) const
+{
+    for (const Entity *own : controlled)
+    {
+        if (own == entity)
+            return true;
+    }
+    return false;
+}
+
+bool BattleDriver::turnContinues(const Entity *entity, uint64_t turn) const
+{
+    return battle.isBattleActive() && battle.getTurnSerial() == turn && battle.getCurrentTurnEntity() == entity;
+}
+
+void BattleDriver::applyPlayerAction(Entity *entity, const BattleAction &action)
+{
+    // В отличие от ИИ, неудачное действие игрока хода не передает - можно выбрать другое
+    switch (action.type)
+    {
+    case BattleActionType::ATTACK:
+        battle.attack(entity, action.target);
+        break;
+    case BattleActionType::USE_ABILITY:
+        battle.useAbility(entity, action.ability);
+        break;
+    case BattleActionType::MOVE:
+        battle.movePosition(entity, action.position);
+        break;
+    case BattleActionType::END_TURN:
+        battle.nextTurn();
+        break;
+    }
+}
+
+void BattleDriver::suspend(coroutine_handle<> handle, Wait kind)
+{
+    waiting = handle;
+    wait = kind;
+    ++suspensions;
+}
+
+void BattleDriver::resume()
+{
+    coroutine_handle<> handle = waiting;
+    waiting = nullptr;
+    wait = Wait::NONE;
+    if (handle)
+    {
+        handle.resume();
+        task.rethrowIfFailed();
+    }
+}
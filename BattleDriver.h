@@ -0,0 +1,198 @@
+#pragma once
+#include "BattleSystem.h"
+#include "BattleAI.h"
+#include "BattleSimulator.h"
+#include "WorkStealingPool.h"
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <memory>
+#include <vector>
+
+// Сопрограмма боя (C++20). Стартует сразу и идет до первого настоящего ожидания;
+// если ждать нечего, выполняется целиком без приостановок.
+// Ожидающая сопрограмма продолжается сразу по завершении вложенной (симметричная передача).
+class BattleTask
+{
+public:
+    struct promise_type
+    {
+        coroutine_handle<> continuation;
+        exception_ptr error;
+
+        BattleTask get_return_object() { return BattleTask(coroutine_handle<promise_type>::from_promise(*this)); }
+        suspend_never initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+            coroutine_handle<> await_suspend(coroutine_handle<promise_type> handle) noexcept
+            {
+                coroutine_handle<> next = handle.promise().continuation;
+                return next ? next : noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { error = current_exception(); }
+
+        // Кадры ходов создаются каждый ход - память кадров переиспользуется в пределах потока
+        static void *operator new(size_t size) { return allocateFrame(size); }
+        static void operator delete(void *frame, size_t size) { releaseFrame(frame, size); }
+    };
+
+    BattleTask() = default;
+    BattleTask(BattleTask &&other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    BattleTask &operator=(BattleTask &&other) noexcept;
+    BattleTask(const BattleTask &) = delete;
+    BattleTask &operator=(const BattleTask &) = delete;
+    ~BattleTask();
+
+    bool isDone() const { return !handle || handle.done(); }
+    void rethrowIfFailed() const;
+
+    // Ожидание из другой сопрограммы: завершенная задача не приостанавливает ожидающего
+    bool await_ready() const noexcept { return isDone(); }
+    void await_suspend(coroutine_handle<> parent) noexcept { handle.promise().continuation = parent; }
+    void await_resume() const { rethrowIfFailed(); }
+
+private:
+    coroutine_handle<promise_type> handle;
+
+    explicit BattleTask(coroutine_handle<promise_type> h) : handle(h) {}
+
+    static void *allocateFrame(size_t size);
+    static void releaseFrame(void *frame, size_t size);
+};
+
+// Режим драйвера: с окном (ввод игрока, ИИ в рабочем потоке, анимации) или безголовый
+enum class BattleDriverMode
+{
+    INTERACTIVE,
+    HEADLESS
+};
+
+// Драйвер боя на сопрограммах: ход каждого участника - отдельная сопрограмма.
+// Ход может ждать ввода игрока, решения ИИ (считается в рабочем потоке драйвера) или конца анимации.
+// Сопрограммы всегда продолжаются в потоке, вызывающем update()/submit(), поэтому поток окна
+// никогда не блокируется. В безголовом режиме все ожидания готовы сразу: бой проходит
+// за один вызов start() без единой приостановки и совпадает с BattleSimulator::run.
+// Пока ИИ думает (isThinking), рабочий поток читает бой и участников. Поток окна в это время
+// может только читать (отрисовка): менять бой или участников нельзя. Ленивые статы участников
+// пересчитываются перед запуском решения, поэтому их чтение ничего не пишет. Новый ленивый кеш,
+// который читают оба потока, тоже нужно заполнить до запуска.
+class BattleDriver
+{
+public:
+    static constexpr float DEFAULT_ANIMATION_SECONDS = 0.6f;
+
+    enum class Wait
+    {
+        NONE,
+        PLAYER_INPUT,
+        AI_DECISION,
+        ANIMATION
+    };
+
+    // Бой уже должен быть начат. В интерактивном режиме ввод ждут участники стороны игрока;
+    // maxSteps = 0 - без ограничения шагов
+    BattleDriver(BattleSystem &battle, BattleDriverMode mode, AIPolicy policy = AIPolicy::DEFAULT,
+                 int maxSteps = 0);
+    ~BattleDriver();
+    BattleDriver(const BattleDriver &) = delete;
+    BattleDriver &operator=(const BattleDriver &) = delete;
+
+    // Запустить сопрограмму боя (в безголовом режиме бой завершается внутри вызова)
+    void start();
+
+    // Кадр окна: проверить решение ИИ и продвинуть анимацию
+    void update(float deltaSeconds);
+
+    // Действие игрока для текущего хода; false, если драйвер сейчас не ждет ввода
+    bool submit(const BattleAction &action);
+
+    // Досрочно завершить текущую анимацию
+    void skipAnimation();
+
+    void setAnimationSeconds(float seconds) { animationSeconds = seconds; }
+
+    bool isFinished() const { return finished; }
+    Wait getWait() const { return wait; }
+    bool isAwaitingInput() const { return wait == Wait::PLAYER_INPUT; }
+    bool isThinking() const { return wait == Wait::AI_DECISION; }
+    bool isAnimating() const { return wait == Wait::ANIMATION; }
+    Entity *getActor() const { return actor; }
+    const BattleAction &getShownAction() const { return shownAction; } // Действие в анимации
+    int getSteps() const { return steps; }
+    long long getSuspensionCount() const { return suspensions; }
+
+    // Безголовый бой через сопрограммы: те же правила и броски, что у BattleSimulator::run
+    static SimResult runHeadless(const vector<Entity *> &players, const vector<Entity *> &enemies,
+                                 unsigned int seed, AIPolicy policy = AIPolicy::DEFAULT,
+                                 int maxSteps = BattleSimulator::DEFAULT_MAX_STEPS,
+                                 long long *suspensions = nullptr);
+
+private:
+    struct PlayerInputAwaiter
+    {
+        BattleDriver &driver;
+        bool await_ready() const { return driver.hasInput; }
+        void await_suspend(coroutine_handle<> handle) { driver.suspend(handle, Wait::PLAYER_INPUT); }
+        BattleAction await_resume();
+    };
+
+    struct AIDecisionAwaiter
+    {
+        BattleDriver &driver;
+        Entity *actor;
+        BattleAction action;
+        bool await_ready();
+        void await_suspend(coroutine_handle<> handle);
+        BattleAction await_resume();
+    };
+
+    struct AnimationAwaiter
+    {
+        BattleDriver &driver;
+        float seconds;
+        bool await_ready() const { return driver.mode == BattleDriverMode::HEADLESS || seconds <= 0.0f; }
+        void await_suspend(coroutine_handle<> handle);
+        void await_resume() {}
+    };
+
+    BattleSystem &battle;
+    BattleDriverMode mode;
+    AIPolicy policy;
+    int maxSteps;
+    vector<Entity *> controlled; // Участники, которыми управляет игрок
+
+    BattleTask task;
+    coroutine_handle<> waiting;
+    Wait wait = Wait::NONE;
+    bool finished = false;
+    int steps = 0;
+    long long suspensions = 0;
+    float animationSeconds = DEFAULT_ANIMATION_SECONDS;
+    float animationLeft = 0.0f;
+
+    Entity *actor = nullptr;
+    BattleAction shownAction;
+    BattleAction input;
+    bool hasInput = false;
+    // Рабочий поток решений ИИ живет столько же, сколько драйвер (только в интерактивном режиме)
+    unique_ptr<WorkStealingPool> aiWorker;
+    future<BattleAction> decision;
+
+    BattleTask battleLoop();
+    BattleTask playerTurn(Entity *entity, uint64_t turn);
+    BattleTask aiTurn(Entity *entity, uint64_t turn);
+
+    bool isControlled(const Entity *entity) const;
+    bool turnContinues(const Entity *entity, uint64_t turn) const;
+    bool stepLimitReached() const { return maxSteps > 0 && steps >= maxSteps; }
+    void applyPlayerAction(Entity *entity, const BattleAction &action);
+    void suspend(coroutine_handle<> handle, Wait kind);
+    void resume();
+};
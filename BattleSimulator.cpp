@@ -0,0 +1,87 @@
+#include "BattleSimulator.h"
+#include "HeroTemplates.h"
+#include "EnemyTemplates.h"
+
+SimResult BattleSimulator::run(const vector<Entity *> &players, const vector<Entity *> &enemies,
+                               unsigned int seed, AIPolicy policy, int maxSteps, const SimStepObserver &observer,
+                               bool antithetic)
+{
+    BattleSystem battle;
+    battle.setOutput(nullptr);
+    battle.setRandomSeed(seed);
+    battle.setAntithetic(antithetic);
+    battle.startBattle(players, enemies);
+
+    SimResult result;
+    while (battle.isBattleActive() && result.steps < maxSteps)
+    {
+        Entity *actor = battle.getCurrentTurnEntity();
+        if (!actor)
+            break; // Nobody is able to act - draw
+
+        ++result.steps;
+        if (actor->getCurrentStamina() <= 0)
+        {
+            battle.nextTurn();
+            continue;
+        }
+
+        BattleAction action = BattleAI::chooseAction(battle, actor, policy);
+        if (observer)
+            observer(battle, actor, action);
+        BattleAI::perform(battle, actor, action);
+    }
+
+    if (!battle.isBattleActive())
+    {
+        result.playerVictory = battle.isPlayerVictory();
+        result.playerDefeat = !result.playerVictory && battle.isPlayerDefeat();
+    }
+
+    for (Entity *player : players)
+    {
+        result.playerHPLeft += player->getCurrentHealthPoint();
+    }
+    for (Entity *enemy : enemies)
+    {
+        result.enemyHPLeft += enemy->getCurrentHealthPoint();
+    }
+    return result;
+}
+
+SimResult BattleSimulator::run(SimEncounter &encounter, unsigned int seed, AIPolicy policy, int maxSteps, bool antithetic)
+{
+    vector<Entity *> players;
+    vector<Entity *> enemies;
+    for (auto &player : encounter.players)
+    {
+        players.push_back(player.get());
+    }
+    for (auto &enemy : encounter.enemies)
+    {
+        enemies.push_back(enemy.get());
+    }
+    return run(players, enemies, seed, policy, maxSteps, SimStepObserver(), antithetic);
+}
+
+SimEncounter BattleSimulator::createEncounter(int presetIndex, LocationType location, int enemyCount,
+                                              int difficultyModifier, unsigned int seed)
+{
+    SimEncounter encounter;
+    for (Player *hero : HeroFactory::createPartyFromPreset(presetIndex))
+    {
+        encounter.players.emplace_back(hero);
+    }
+
+    vector<string> names = EnemyFactory::getAvailableEnemies(location);
+    if (names.empty())
+        return encounter;
+
+    mt19937 picker(seed);
+    for (int i = 0; i < enemyCount && i < 4; ++i)
+    {
+        const string &name = names[static_cast<uint32_t>(picker()) % names.size()];
+        encounter.enemies.emplace_back(EnemyFactory::createEnemyByName(name, difficultyModifier));
+    }
+    return encounter;
+}
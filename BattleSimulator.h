@@ -0,0 +1,47 @@
+#pragma once
+#include "BattleSystem.h"
+#include "BattleAI.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Итог одного безголового (без GUI) боя
+struct SimResult
+{
+    bool playerVictory = false;
+    bool playerDefeat = false;
+    int steps = 0;          // Количество шагов ИИ (действия и передачи хода)
+    int playerHPLeft = 0;   // Суммарное HP выживших героев
+    int enemyHPLeft = 0;    // Суммарное HP выживших врагов
+};
+
+// Наблюдатель шага: вызывается перед выполнением каждого действия ИИ
+using SimStepObserver = function<void(const BattleSystem &, Entity *, const BattleAction &)>;
+
+// Набор участников боя, которым владеет симулятор
+struct SimEncounter
+{
+    std::vector<std::unique_ptr<Entity>> players;
+    std::vector<std::unique_ptr<Entity>> enemies;
+};
+
+// Безголовый прогон боя без вывода: обе стороны управляются BattleAI, все броски идут от одного зерна.
+// Эталон правил для пакетного ядра (BatchBattleKernel) и инструментов баланса.
+class BattleSimulator
+{
+public:
+    static const int DEFAULT_MAX_STEPS = 2000;
+
+    // Провести бой до конца (или до лимита шагов - тогда ничья).
+    // antithetic - антитетичные броски того же зерна (BattleSystem::setAntithetic)
+    static SimResult run(const std::vector<Entity *> &players, const std::vector<Entity *> &enemies,
+                         unsigned int seed, AIPolicy policy = AIPolicy::DEFAULT, int maxSteps = DEFAULT_MAX_STEPS,
+                         const SimStepObserver &observer = SimStepObserver(), bool antithetic = false);
+    static SimResult run(SimEncounter &encounter, unsigned int seed,
+                         AIPolicy policy = AIPolicy::DEFAULT, int maxSteps = DEFAULT_MAX_STEPS,
+                         bool antithetic = false);
+
+    // Собрать бой: отряд из пресета против enemyCount случайных врагов локации (выбор по зерну)
+    static SimEncounter createEncounter(int presetIndex, LocationType location, int enemyCount,
+                                        int difficultyModifier, unsigned int seed);
+};
@@ -0,0 +1,121 @@
+#include "BattleStateHash.h"
+
+namespace
+{
+    uint64_t mix(uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    uint64_t combine(uint64_t seed, uint64_t value)
+    {
+        return mix(seed ^ (value + 0x632BE59BD9B4E019ull + (seed << 6) + (seed >> 2)));
+    }
+
+    uint64_t hashString(const string &text)
+    {
+        // FNV-1a
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (unsigned char c : text)
+        {
+            hash ^= c;
+            hash *= 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    struct SideEntry
+    {
+        uint64_t features;
+        Entity *entity;
+    };
+
+    // Признаки стороны в отсортированном виде; ходящий исключается, он кодируется отдельно
+    vector<SideEntry> collectSide(const BattleSystem &battle, const vector<BattlePosition> &positions, const Entity *actor)
+    {
+        vector<SideEntry> side;
+        for (const BattlePosition &pos : positions)
+        {
+            Entity *entity = battle.entityAt(pos);
+            if (entity == actor && actor)
+                continue;
+            bool corpse = !entity || entity->getCurrentHealthPoint() <= 0;
+            side.push_back({BattleStateHash::entityFeatures(corpse ? nullptr : entity, pos.position, corpse),
+                            corpse ? nullptr : entity});
+        }
+        sort(side.begin(), side.end(), [](const SideEntry &a, const SideEntry &b)
+             { return a.features < b.features; });
+        return side;
+    }
+}
+
+uint64_t BattleStateHash::entityFeatures(const Entity *entity, int position, bool corpse)
+{
+    uint64_t hash = combine(0, static_cast<uint64_t>(position));
+    if (corpse || !entity)
+        return combine(hash, 0xC0C0ull);
+
+    int maxHP = max(1, entity->getMaxHealthPoint());
+    int hpBucket = (entity->getCurrentHealthPoint() * HP_BUCKETS + maxHP - 1) / maxHP;
+    hash = combine(hash, hashString(entity->getName()));
+    hash = combine(hash, static_cast<uint64_t>(hpBucket));
+    hash = combine(hash, static_cast<uint64_t>(entity->getCurrentStamina()));
+
+    // Эффекты складываются коммутативно - порядок наложения не важен
+    uint64_t effects = 0;
+    for (const Effect &effect : entity->getActiveEffects())
+    {
+        uint64_t one = combine(static_cast<uint64_t>(effect.type), static_cast<uint64_t>(effect.value));
+        effects += combine(one, static_cast<uint64_t>(entity->getEffectTurnsLeft(effect)));
+    }
+    return combine(hash, effects);
+}
+
+CanonicalBattleState BattleStateHash::canonicalize(const BattleSystem &battle, const Entity *actor)
+{
+    bool actorIsPlayer = false;
+    int actorPosition = -1;
+    EntityHandle actorHandle = battle.getHandle(actor);
+    for (const BattlePosition &pos : battle.getPlayerPositions())
+    {
+        if (actorHandle.isValid() && pos.handle == actorHandle)
+        {
+            actorIsPlayer = true;
+            actorPosition = pos.position;
+        }
+    }
+    if (!actorIsPlayer)
+    {
+        for (const BattlePosition &pos : battle.getEnemyPositions())
+        {
+            if (actorHandle.isValid() && pos.handle == actorHandle)
+                actorPosition = pos.position;
+        }
+    }
+
+    const vector<BattlePosition> &own = actorIsPlayer ? battle.getPlayerPositions() : battle.getEnemyPositions();
+    const vector<BattlePosition> &other = actorIsPlayer ? battle.getEnemyPositions() : battle.getPlayerPositions();
+    vector<SideEntry> allies = collectSide(battle, own, actor);
+    vector<SideEntry> opponents = collectSide(battle, other, nullptr);
+
+    CanonicalBattleState state;
+    uint64_t key = combine(actorIsPlayer ? 1 : 2, entityFeatures(actor, actorPosition, false));
+    key = combine(key, allies.size());
+    for (const SideEntry &entry : allies)
+    {
+        key = combine(key, entry.features);
+    }
+    key = combine(key, opponents.size());
+    for (const SideEntry &entry : opponents)
+    {
+        key = combine(key, entry.features);
+        if (entry.entity)
+            state.opponents.push_back(entry.entity);
+    }
+    state.key = key;
+    state.actorIsPlayer = actorIsPlayer;
+    return state;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "BattleSystem.h"
+#include <cstdint>
+#include <vector>
+
+// Каноническое состояние боя с точки зрения ходящего персонажа
+struct CanonicalBattleState
+{
+    uint64_t key = 0;
+    bool actorIsPlayer = false;
+    vector<Entity *> opponents; // Живые противники ходящего в каноническом порядке
+};
+
+// Хэш состояния боя, не зависящий от порядка слотов одинаковых союзников.
+// Каждый участник сводится к набору признаков (имя, доля HP, выносливость, позиция, эффекты),
+// признаки каждой стороны сортируются и только потом смешиваются в ключ.
+// HP квантуется, чтобы похожие ситуации попадали в один ключ.
+class BattleStateHash
+{
+public:
+    static const int HP_BUCKETS = 8;
+
+    static CanonicalBattleState canonicalize(const BattleSystem &battle, const Entity *actor);
+
+    // Признаки одного участника (или трупа, если entity == nullptr)
+    static uint64_t entityFeatures(const Entity *entity, int position, bool corpse);
+};
@@ -1,96 +1,191 @@
 #include "BattleSystem.h"
 #include "HeroTemplates.h"
+#include "Log.h"
 #include <algorithm>
 #include <numeric>
 #include <chrono>
 
+namespace
+{
+    // Имена эффектов способностей интернируются один раз, дальше addEffect не трогает кучу
+    struct AbilityEffectNames
+    {
+        const EffectDescriptor *berserk = EffectRegistry::intern("Berserk");
+        const EffectDescriptor *poison = EffectRegistry::intern("Яд");
+        const EffectDescriptor *battleCry = EffectRegistry::intern("Боевой клич");
+        const EffectDescriptor *fear = EffectRegistry::intern("Страх");
+        const EffectDescriptor *shieldWall = EffectRegistry::intern("Стена щитов");
+        const EffectDescriptor *bloodRitual = EffectRegistry::intern("Кровавый ритуал");
+    };
+
+    const AbilityEffectNames &abilityEffectNames()
+    {
+        static const AbilityEffectNames names;
+        return names;
+    }
+}
+
 BattleSystem::BattleSystem()
-    : currentTurnIndex(0), battleActive(false)
+    : currentTurnIndex(0), battleActive(false), stateVersion(1), turnSerial(0),
+      turnOrderCacheVersion(0), battleStatusCacheVersion(0), entitiesStatusCacheVersion(0), antithetic(false), output(&cout)
 {
     // Инициализация генератора случайных чисел
     randomGenerator.seed(static_cast<unsigned int>(
         chrono::system_clock::now().time_since_epoch().count()));
 }
 
+void BattleSystem::setRandomSeed(unsigned int seed)
+{
+    randomGenerator.seed(seed);
+}
+
+double BattleSystem::rollUnit()
+{
+    // Явное деление вместо uniform_real_distribution - одинаковая последовательность на любом компиляторе
+    double unit = static_cast<double>(static_cast<uint32_t>(randomGenerator())) / 4294967295.0;
+    return antithetic ? 1.0 - unit : unit;
+}
+
+int BattleSystem::rollIndex(int count)
+{
+    if (count <= 0)
+        return 0;
+    int index = static_cast<int>(static_cast<uint32_t>(randomGenerator()) % static_cast<uint32_t>(count));
+    return antithetic ? count - 1 - index : index;
+}
+
+ostream &BattleSystem::out() const
+{
+    if (output)
+        return *output;
+
+    // Поток без буфера: вставки в него ничего не пишут. Свой у каждого потока,
+    // чтобы параллельные симуляции не делили состояние потока вывода
+    static thread_local ostream silent(nullptr);
+    return silent;
+}
+
+BattleSystem::BattleSystem(const BattleSystem &other)
+    : entities(other.entities), playerPositions(other.playerPositions), enemyPositions(other.enemyPositions),
+      turnOrder(other.turnOrder), currentTurnIndex(other.currentTurnIndex), battleActive(other.battleActive),
+      stateVersion(other.stateVersion), turnSerial(other.turnSerial), turnOrderCacheVersion(0),
+      battleStatusCacheVersion(0), entitiesStatusCacheVersion(0), randomGenerator(other.randomGenerator),
+      antithetic(other.antithetic), effectScheduler(other.effectScheduler), threatMatrix(other.threatMatrix),
+      output(other.output)
+{
+    EntityRemap mapping = other.entities.remapTo(entities);
+    effectScheduler.remap(mapping);
+    threatMatrix.remap(mapping);
+}
+
 void BattleSystem::startBattle(const vector<Entity *> &players, const vector<Entity *> &enemies)
 {
-    // Clearing previous battle
+    // Clearing previous battle: handles of its participants become stale
+    ++stateVersion;
+    entities.clear();
     playerPositions.clear();
     enemyPositions.clear();
     turnOrder.clear();
     currentTurnIndex = 0;
+    ++turnSerial;
     battleActive = true;
 
     // Player placement (positions 0-3)
     for (int i = 0; i < players.size() && i < 4; ++i)
     {
-        playerPositions.push_back(BattlePosition(players[i], static_cast<int>(i)));
+        playerPositions.push_back(BattlePosition(entities.attach(players[i]), static_cast<int>(i)));
     }
 
     // Enemy placement (positions 0-3)
     for (int i = 0; i < enemies.size() && i < 4; ++i)
     {
-        enemyPositions.push_back(BattlePosition(enemies[i], static_cast<int>(i)));
+        enemyPositions.push_back(BattlePosition(entities.attach(enemies[i]), static_cast<int>(i)));
     }
 
-    // Stamina regeneration for all participants
+    // Stamina regeneration for all participants, effects left from previous battles go to the schedule.
+    // Ability modifiers of a participant that died before the end of its last battle are dropped here
+    effectScheduler.clear();
     for (auto &pos : playerPositions)
     {
-        if (pos.entity)
-            pos.entity->regenerateStamina();
+        if (entityAt(pos))
+        {
+            entityAt(pos)->clearTemporaryModifiers();
+            entityAt(pos)->regenerateStamina();
+            effectScheduler.adopt(entityAt(pos));
+        }
     }
     for (auto &pos : enemyPositions)
     {
-        if (pos.entity)
-            pos.entity->regenerateStamina();
+        if (entityAt(pos))
+        {
+            entityAt(pos)->clearTemporaryModifiers();
+            entityAt(pos)->regenerateStamina();
+            effectScheduler.adopt(entityAt(pos));
+        }
     }
+    threatMatrix.reset(players, enemies);
 
     // Turn order calculation
     calculateTurnOrder();
 
-    cout << "=== BATTLE STARTED ===\n";
+    out() << "=== BATTLE STARTED ===\n";
     printBattlefield();
 }
 
 void BattleSystem::endBattle()
 {
-    cout << "[DEBUG] BattleSystem::endBattle() called\n";
+    LOG_DEBUG(BATTLE, "BattleSystem::endBattle() called");
 
     // Display victory or defeat screen before clearing
     if (isPlayerVictory())
     {
-        cout << "\nVICTORY!\n";
-        cout << "\n";
+        out() << "\nVICTORY!\n";
+        out() << "\n";
     }
     else if (isPlayerDefeat())
     {
-        cout << "\nDEFEAT!\n";
-        cout << "\n";
+        out() << "\nDEFEAT!\n";
+        out() << "\n";
     }
 
+    // Модификаторы способностей живут до конца боя
+    for (auto &pos : playerPositions)
+    {
+        if (entityAt(pos))
+            entityAt(pos)->clearTemporaryModifiers();
+    }
+    for (auto &pos : enemyPositions)
+    {
+        if (entityAt(pos))
+            entityAt(pos)->clearTemporaryModifiers();
+    }
+
+    ++stateVersion;
     battleActive = false;
     playerPositions.clear();
     enemyPositions.clear();
     turnOrder.clear();
+    entities.clear();
     currentTurnIndex = 0;
-    cout << "=== BATTLE ENDED ===\n";
-    cout << "[DEBUG] BattleSystem::endBattle() completed\n";
+    out() << "=== BATTLE ENDED ===\n";
+    LOG_DEBUG(BATTLE, "BattleSystem::endBattle() completed");
 }
 
 void BattleSystem::calculateTurnOrder()
 {
+    ++stateVersion;
     turnOrder.clear();
     vector<TurnInfo> allEntities;
 
     // Добавляем всех живых игроков
     for (const auto &pos : playerPositions)
     {
-        if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+        if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
         {
-            int turnWeight = pos.entity->getInitiative() / 10;
+            int turnWeight = entityAt(pos)->getInitiative() / 10;
             for (int i = 0; i < turnWeight; ++i)
             {
-                allEntities.push_back(TurnInfo(pos.entity, pos.entity->getInitiative() + i));
+                allEntities.push_back(TurnInfo(pos.handle, entityAt(pos)->getInitiative() + i));
             }
         }
     }
@@ -98,12 +193,12 @@ void BattleSystem::calculateTurnOrder()
     // Добавляем всех живых врагов
     for (const auto &pos : enemyPositions)
     {
-        if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+        if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
         {
-            int turnWeight = pos.entity->getInitiative() / 10;
+            int turnWeight = entityAt(pos)->getInitiative() / 10;
             for (int i = 0; i < turnWeight; ++i)
             {
-                allEntities.push_back(TurnInfo(pos.entity, pos.entity->getInitiative() + i));
+                allEntities.push_back(TurnInfo(pos.handle, entityAt(pos)->getInitiative() + i));
             }
         }
     }
@@ -118,7 +213,7 @@ void BattleSystem::calculateTurnOrder()
     // Формируем очередь ходов
     for (const auto &info : allEntities)
     {
-        turnOrder.push_back(info.entity);
+        turnOrder.push_back(info.handle);
     }
 }
 
@@ -138,7 +233,7 @@ bool BattleSystem::canAttackTarget(Entity *attacker, Entity *target) const
     bool isAttackerPlayer = false;
     for (const auto &pos : playerPositions)
     {
-        if (pos.entity == attacker)
+        if (entityAt(pos) == attacker)
         {
             isAttackerPlayer = true;
             break;
@@ -149,7 +244,7 @@ bool BattleSystem::canAttackTarget(Entity *attacker, Entity *target) const
     bool isTargetPlayer = false;
     for (const auto &pos : playerPositions)
     {
-        if (pos.entity == target)
+        if (entityAt(pos) == target)
         {
             isTargetPlayer = true;
             break;
@@ -221,7 +316,7 @@ bool BattleSystem::canAttackCorpse(Entity *attacker, int targetPosition) const
     bool isAttackerPlayer = false;
     for (const auto &pos : playerPositions)
     {
-        if (pos.entity == attacker)
+        if (entityAt(pos) == attacker)
         {
             isAttackerPlayer = true;
             break;
@@ -235,7 +330,7 @@ bool BattleSystem::canAttackCorpse(Entity *attacker, int targetPosition) const
     bool hasCorpse = false;
     for (const auto &pos : opponentPositions)
     {
-        if (pos.position == targetPosition && !pos.entity && pos.corpseHP > 0)
+        if (pos.position == targetPosition && !entityAt(pos) && pos.corpseHP > 0)
         {
             hasCorpse = true;
             break;
@@ -291,14 +386,17 @@ bool BattleSystem::canAttackCorpse(Entity *attacker, int targetPosition) const
 
 int BattleSystem::getEntityPosition(Entity *entity) const
 {
+    EntityHandle handle = entities.find(entity);
+    if (!handle.isValid())
+        return -1;
     for (const auto &pos : playerPositions)
     {
-        if (pos.entity == entity)
+        if (pos.handle == handle)
             return pos.position;
     }
     for (const auto &pos : enemyPositions)
     {
-        if (pos.entity == entity)
+        if (pos.handle == handle)
             return pos.position;
     }
     return -1;
@@ -343,11 +441,11 @@ vector<pair<Entity *, int>> BattleSystem::getAvailableTargets(Entity *attacker,
 
     for (const auto &pos : opponentPositions)
     {
-        if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+        if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
         {
-            if (canAttackTarget(attacker, pos.entity))
+            if (canAttackTarget(attacker, entityAt(pos)))
             {
-                targets.push_back({pos.entity, pos.position});
+                targets.push_back({entityAt(pos), pos.position});
             }
         }
     }
@@ -357,24 +455,28 @@ vector<pair<Entity *, int>> BattleSystem::getAvailableTargets(Entity *attacker,
 
 void BattleSystem::removeDeadEntities()
 {
-    // Remove dead players (only mark as nullptr, deletion in CampaignSystem)
+    // Dead players leave their position (the handle is reset) but stay in the store: it borrows them
+    // from the caller of startBattle (CampaignSystem) or owns the clones of a battle copy
     for (auto &pos : playerPositions)
     {
-        if (pos.entity && pos.entity->getCurrentHealthPoint() <= 0)
+        if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() <= 0)
         {
-            cout << pos.entity->getName() << " fell in battle!\n";
-            pos.entity = nullptr;
+            out() << entityAt(pos)->getName() << " fell in battle!\n";
+            ++stateVersion;
+            pos.handle = EntityHandle();
             shiftPositionsAfterDeath(playerPositions, pos.position);
         }
     }
 
-    // Mark dead enemies as nullptr and create corpses (deletion in CampaignSystem)
+    // Dead enemies leave their position and become corpses; the entity itself is erased
+    // by its owner (in the campaign - CampaignSystem::releaseBattleEnemies after the battle)
     for (auto &pos : enemyPositions)
     {
-        if (pos.entity && pos.entity->getCurrentHealthPoint() <= 0)
+        if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() <= 0)
         {
-            cout << pos.entity->getName() << " defeated!\n";
-            pos.entity = nullptr;
+            out() << entityAt(pos)->getName() << " defeated!\n";
+            ++stateVersion;
+            pos.handle = EntityHandle();
             pos.corpseHP = 50; // Create corpse with 50 HP
             shiftPositionsAfterDeath(enemyPositions, pos.position);
         }
@@ -387,7 +489,7 @@ void BattleSystem::regenerateStaminaForTurn()
     if (current)
     {
         current->regenerateStamina();
-        current->updateEffects(); // Применить эффекты в начале хода
+        effectScheduler.beginTurn(current); // Эффекты, назначенные на этот ход
 
         // Проверить смерть от эффектов и окончание боя
         removeDeadEntities();
@@ -398,6 +500,11 @@ void BattleSystem::regenerateStaminaForTurn()
     }
 }
 
+void BattleSystem::addEffect(Entity *target, const Effect &effect)
+{
+    effectScheduler.schedule(target, target->addEffect(effect));
+}
+
 bool BattleSystem::attack(Entity *attacker, Entity *target)
 {
     if (!battleActive || !attacker || !target)
@@ -410,15 +517,17 @@ bool BattleSystem::attack(Entity *attacker, Entity *target)
     if (!canAttackTarget(attacker, target))
         return false;
 
+    ++stateVersion;
+
     // Расчет урона
-    int damage = attacker->attack(target->getDefense());
+    int damage = attacker->attack(target->getDefense(), rollUnit());
     target->takeDamage(damage);
 
     // Применение эффектов способности
     applyAbilityEffect(attacker, target, damage);
 
-    cout << getAttackDescription(attacker, target) << "\n";
-    cout << "Deals " << damage << " damage!\n";
+    out() << getAttackDescription(attacker, target) << "\n";
+    out() << "Deals " << damage << " damage!\n";
 
     // Проверка на смерть
     bool targetWasDead = target->getCurrentHealthPoint() <= 0;
@@ -427,6 +536,7 @@ bool BattleSystem::attack(Entity *attacker, Entity *target)
     // Пересчет очереди ходов после смерти
     if (targetWasDead)
     {
+        ++turnSerial;
         calculateTurnOrder();
         // Корректируем currentTurnIndex, чтобы он не выходил за границы
         if (currentTurnIndex >= turnOrder.size())
@@ -456,11 +566,13 @@ bool BattleSystem::movePosition(Entity *entity, int newPosition)
     if (entity->getCurrentStamina() <= 0)
         return false;
 
+    ++stateVersion;
+
     // Определяем, игрок это или враг
     bool isPlayerEntity = false;
     for (const auto &pos : playerPositions)
     {
-        if (pos.entity == entity)
+        if (entityAt(pos) == entity)
         {
             isPlayerEntity = true;
             break;
@@ -474,7 +586,7 @@ bool BattleSystem::movePosition(Entity *entity, int newPosition)
     bool hasAllyAtPosition = false;
     for (const auto &pos : sameSidePositions)
     {
-        if (pos.position == newPosition && pos.entity && pos.entity != entity)
+        if (pos.position == newPosition && entityAt(pos) && entityAt(pos) != entity)
         {
             hasAllyAtPosition = true;
             break;
@@ -485,7 +597,7 @@ bool BattleSystem::movePosition(Entity *entity, int newPosition)
     bool positionOccupied = false;
     for (const auto &pos : sameSidePositions)
     {
-        if (pos.position == newPosition && pos.entity && pos.entity != entity)
+        if (pos.position == newPosition && entityAt(pos) && entityAt(pos) != entity)
         {
             positionOccupied = true;
             break;
@@ -495,7 +607,7 @@ bool BattleSystem::movePosition(Entity *entity, int newPosition)
     {
         for (const auto &pos : opponentPositions)
         {
-            if (pos.position == newPosition && pos.entity)
+            if (pos.position == newPosition && entityAt(pos))
             {
                 positionOccupied = true;
                 break;
@@ -512,7 +624,7 @@ bool BattleSystem::movePosition(Entity *entity, int newPosition)
             int currentPosition = -1;
             for (auto &pos : positions)
             {
-                if (pos.entity == entity)
+                if (entityAt(pos) == entity)
                 {
                     currentPosition = pos.position;
                     break;
@@ -525,7 +637,7 @@ bool BattleSystem::movePosition(Entity *entity, int newPosition)
             // Find ally and swap positions
             for (auto &pos : positions)
             {
-                if (pos.position == newPosition && pos.entity && pos.entity != entity)
+                if (pos.position == newPosition && entityAt(pos) && entityAt(pos) != entity)
                 {
                     pos.position = currentPosition;
                     break;
@@ -535,11 +647,11 @@ bool BattleSystem::movePosition(Entity *entity, int newPosition)
             // Update current character's position
             for (auto &pos : positions)
             {
-                if (pos.entity == entity)
+                if (entityAt(pos) == entity)
                 {
                     pos.position = newPosition;
                     entity->spendStamina();
-                    cout << entity->getName() << " swaps places with ally to position " << newPosition << "\n";
+                    out() << entity->getName() << " swaps places with ally to position " << newPosition << "\n";
                     return true;
                 }
             }
@@ -551,7 +663,7 @@ bool BattleSystem::movePosition(Entity *entity, int newPosition)
             int currentPosition = -1;
             for (auto &pos : sameSidePositions)
             {
-                if (pos.entity == entity)
+                if (entityAt(pos) == entity)
                 {
                     currentPosition = pos.position;
                     break;
@@ -564,7 +676,7 @@ bool BattleSystem::movePosition(Entity *entity, int newPosition)
             // Find enemy and swap positions
             for (auto &pos : opponentPositions)
             {
-                if (pos.position == newPosition && pos.entity)
+                if (pos.position == newPosition && entityAt(pos))
                 {
                     pos.position = currentPosition;
                     break;
@@ -574,7 +686,7 @@ bool BattleSystem::movePosition(Entity *entity, int newPosition)
             // Update current character's position
             for (auto &pos : sameSidePositions)
             {
-                if (pos.entity == entity)
+                if (entityAt(pos) == entity)
                 {
                     pos.position = newPosition;
                     entity->spendStamina();
@@ -590,11 +702,11 @@ bool BattleSystem::movePosition(Entity *entity, int newPosition)
         vector<BattlePosition> &positions = isPlayerEntity ? playerPositions : enemyPositions;
         for (auto &pos : positions)
         {
-            if (pos.entity == entity)
+            if (entityAt(pos) == entity)
             {
                 pos.position = newPosition;
                 entity->spendStamina();
-                cout << entity->getName() << " moves to position " << newPosition << "\n";
+                out() << entity->getName() << " moves to position " << newPosition << "\n";
                 return true;
             }
         }
@@ -614,7 +726,7 @@ Entity *BattleSystem::getCurrentTurnEntity() const
 {
     if (turnOrder.empty() || currentTurnIndex >= turnOrder.size())
         return nullptr;
-    return turnOrder[currentTurnIndex];
+    return entities.get(turnOrder[currentTurnIndex]);
 }
 
 vector<pair<Entity *, int>> BattleSystem::getAvailableTargetsForCurrent() const
@@ -627,7 +739,7 @@ vector<pair<Entity *, int>> BattleSystem::getAvailableTargetsForCurrent() const
     bool isPlayer = false;
     for (const auto &pos : playerPositions)
     {
-        if (pos.entity == current)
+        if (entityAt(pos) == current)
         {
             isPlayer = true;
             break;
@@ -637,34 +749,34 @@ vector<pair<Entity *, int>> BattleSystem::getAvailableTargetsForCurrent() const
     return getAvailableTargets(current, isPlayer);
 }
 
-vector<pair<Entity *, string>> BattleSystem::getAllEntitiesWithStatus() const
+vector<pair<Entity *, string>> BattleSystem::buildAllEntitiesWithStatus() const
 {
     vector<pair<Entity *, string>> entities;
 
     // Добавляем игроков
     for (const auto &pos : playerPositions)
     {
-        if (pos.entity)
+        if (entityAt(pos))
         {
             string status = "ЖИВ";
-            entities.push_back({pos.entity, status});
+            entities.push_back({entityAt(pos), status});
         }
     }
 
     // Добавляем врагов
     for (const auto &pos : enemyPositions)
     {
-        if (pos.entity)
+        if (entityAt(pos))
         {
             string status = "ЖИВ";
-            entities.push_back({pos.entity, status});
+            entities.push_back({entityAt(pos), status});
         }
     }
 
     return entities;
 }
 
-string BattleSystem::getBattleStatus() const
+string BattleSystem::buildBattleStatus() const
 {
     if (!battleActive)
         return "Battle not active";
@@ -672,20 +784,20 @@ string BattleSystem::getBattleStatus() const
     string status = "Players:\n";
     for (const auto &pos : playerPositions)
     {
-        if (pos.entity)
+        if (entityAt(pos))
         {
-            Player *player = static_cast<Player *>(pos.entity);
+            Player *player = static_cast<Player *>(entityAt(pos));
             status += "  " + player->getName() + " (Lv." + to_string(player->getLevel()) + ")\n";
             status += "  " + player->getHealthBarString() + "\n";
             status += "  " + player->getExperienceBarString() + "\n";
             // Add effects
-            const vector<Effect> &effects = player->getActiveEffects();
+            const EffectBuffer &effects = player->getActiveEffects();
             if (!effects.empty())
             {
                 status += "  Effects: ";
                 for (size_t i = 0; i < effects.size(); ++i)
                 {
-                    status += effects[i].name + " (" + to_string(effects[i].duration) + ")";
+                    status += effects[i].getName() + " (" + to_string(player->getEffectTurnsLeft(effects[i])) + ")";
                     if (i < effects.size() - 1)
                         status += ", ";
                 }
@@ -697,18 +809,18 @@ string BattleSystem::getBattleStatus() const
     status += "\nEnemies:\n";
     for (const auto &pos : enemyPositions)
     {
-        if (pos.entity)
+        if (entityAt(pos))
         {
-            status += "  " + pos.entity->getName() + "\n";
-            status += "  " + pos.entity->getHealthBarString() + "\n";
+            status += "  " + entityAt(pos)->getName() + "\n";
+            status += "  " + entityAt(pos)->getHealthBarString() + "\n";
             // Add effects
-            const vector<Effect> &effects = pos.entity->getActiveEffects();
+            const EffectBuffer &effects = entityAt(pos)->getActiveEffects();
             if (!effects.empty())
             {
                 status += "  Effects: ";
                 for (size_t i = 0; i < effects.size(); ++i)
                 {
-                    status += effects[i].name + " (" + to_string(effects[i].duration) + ")";
+                    status += effects[i].getName() + " (" + to_string(entityAt(pos)->getEffectTurnsLeft(effects[i])) + ")";
                     if (i < effects.size() - 1)
                         status += ", ";
                 }
@@ -720,7 +832,7 @@ string BattleSystem::getBattleStatus() const
     return status;
 }
 
-string BattleSystem::getTurnOrderString() const
+string BattleSystem::buildTurnOrderString() const
 {
     if (!battleActive)
         return "";
@@ -729,18 +841,49 @@ string BattleSystem::getTurnOrderString() const
     for (int i = 0; i < turnOrder.size(); ++i)
     {
         string marker = (i == currentTurnIndex) ? " -> " : "    ";
-        status += marker + to_string(i + 1) + ". " + turnOrder[i]->getName() + "\n";
+        status += marker + to_string(i + 1) + ". " + entities.get(turnOrder[i])->getName() + "\n";
     }
 
     return status;
 }
 
+// Кэшированные представления: при неизменной версии боя строки не пересобираются
+const vector<pair<Entity *, string>> &BattleSystem::getAllEntitiesWithStatus() const
+{
+    if (entitiesStatusCacheVersion != stateVersion)
+    {
+        entitiesStatusCache = buildAllEntitiesWithStatus();
+        entitiesStatusCacheVersion = stateVersion;
+    }
+    return entitiesStatusCache;
+}
+
+const string &BattleSystem::getBattleStatus() const
+{
+    if (battleStatusCacheVersion != stateVersion)
+    {
+        battleStatusCache = buildBattleStatus();
+        battleStatusCacheVersion = stateVersion;
+    }
+    return battleStatusCache;
+}
+
+const string &BattleSystem::getTurnOrderString() const
+{
+    if (turnOrderCacheVersion != stateVersion)
+    {
+        turnOrderCache = buildTurnOrderString();
+        turnOrderCacheVersion = stateVersion;
+    }
+    return turnOrderCache;
+}
+
 bool BattleSystem::isPlayerVictory() const
 {
     // Проверяем, все ли враги мертвы
     for (const auto &pos : enemyPositions)
     {
-        if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+        if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
         {
             return false;
         }
@@ -753,7 +896,7 @@ bool BattleSystem::isPlayerDefeat() const
     // Проверяем, все ли игроки мертвы
     for (const auto &pos : playerPositions)
     {
-        if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+        if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
         {
             return false;
         }
@@ -763,21 +906,21 @@ bool BattleSystem::isPlayerDefeat() const
 
 void BattleSystem::printBattlefield() const
 {
-    cout << "\n=== BATTLEFIELD ===\n";
+    out() << "\n=== BATTLEFIELD ===\n";
 
     // Display in column: friendly positions 4-3-2-1, enemy 1-2-3-4
-    cout << "Friendly positions:\n";
+    out() << "Friendly positions:\n";
     for (int i = 3; i >= 0; --i)
     {
-        cout << (i + 1) << " friendly: ";
+        out() << (i + 1) << " friendly: ";
         string display = "[EMPTY]";
         for (const auto &pos : playerPositions)
         {
             if (pos.position == i)
             {
-                if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+                if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
                 {
-                    display = "[" + pos.entity->getName() + "]";
+                    display = "[" + entityAt(pos)->getName() + "]";
                     break; // Priority to alive
                 }
                 else if (pos.corpseHP > 0)
@@ -786,21 +929,21 @@ void BattleSystem::printBattlefield() const
                 }
             }
         }
-        cout << display << "\n";
+        out() << display << "\n";
     }
 
-    cout << "\nEnemy positions:\n";
+    out() << "\nEnemy positions:\n";
     for (int i = 0; i < 4; ++i)
     {
-        cout << (i + 1) << " enemy:     ";
+        out() << (i + 1) << " enemy:     ";
         string display = "[EMPTY]";
         for (const auto &pos : enemyPositions)
         {
             if (pos.position == i)
             {
-                if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+                if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
                 {
-                    display = "[" + pos.entity->getName() + "]";
+                    display = "[" + entityAt(pos)->getName() + "]";
                     break; // Priority to alive
                 }
                 else if (pos.corpseHP > 0)
@@ -809,9 +952,9 @@ void BattleSystem::printBattlefield() const
                 }
             }
         }
-        cout << display << "\n";
+        out() << display << "\n";
     }
-    cout << "=================\n";
+    out() << "=================\n";
 }
 
 void BattleSystem::nextTurn()
@@ -819,6 +962,9 @@ void BattleSystem::nextTurn()
     if (turnOrder.empty())
         return;
 
+    ++stateVersion;
+    ++turnSerial;
+
     currentTurnIndex++;
 
     // Если достигли конца очереди, пересчитываем очередь и начинаем с начала
@@ -829,9 +975,9 @@ void BattleSystem::nextTurn()
     }
 
     // Пропускаем мертвых персонажей
-    while (currentTurnIndex < turnOrder.size() && turnOrder[currentTurnIndex] && turnOrder[currentTurnIndex]->getCurrentHealthPoint() <= 0)
+    while (currentTurnIndex < turnOrder.size() && getCurrentTurnEntity() && getCurrentTurnEntity()->getCurrentHealthPoint() <= 0)
     {
-        cout << turnOrder[currentTurnIndex]->getName() << " is dead, skipping turn.\n";
+        out() << getCurrentTurnEntity()->getName() << " is dead, skipping turn.\n";
         currentTurnIndex++;
         if (currentTurnIndex >= turnOrder.size())
         {
@@ -841,7 +987,7 @@ void BattleSystem::nextTurn()
     }
 
     // Регенерируем стамину для текущего персонажа, если он существует
-    if (currentTurnIndex < turnOrder.size() && turnOrder[currentTurnIndex])
+    if (getCurrentTurnEntity())
     {
         regenerateStaminaForTurn();
     }
@@ -852,20 +998,20 @@ void BattleSystem::displayEntityDetails(Entity *entity) const
     if (!entity)
         return;
 
-    cout << "\n=== CHARACTERISTICS " << entity->getName() << " ===\n";
-    cout << "Health: " << entity->getCurrentHealthPoint() << "/" << entity->getMaxHealthPoint() << "\n";
-    cout << "Damage: " << entity->getDamage() << "\n";
-    cout << "Defense: " << entity->getDefense() << "\n";
-    cout << "Attack: " << entity->getAttack() << "\n";
-    cout << "Initiative: " << entity->getInitiative() << "\n";
-    cout << "Attack range: " << entity->getAttackRange() << "\n";
-    cout << "Stamina: " << entity->getCurrentStamina() << "/" << entity->getMaxStamina() << "\n";
+    out() << "\n=== CHARACTERISTICS " << entity->getName() << " ===\n";
+    out() << "Health: " << entity->getCurrentHealthPoint() << "/" << entity->getMaxHealthPoint() << "\n";
+    out() << "Damage: " << entity->getDamage() << "\n";
+    out() << "Defense: " << entity->getDefense() << "\n";
+    out() << "Attack: " << entity->getAttack() << "\n";
+    out() << "Initiative: " << entity->getInitiative() << "\n";
+    out() << "Attack range: " << entity->getAttackRange() << "\n";
+    out() << "Stamina: " << entity->getCurrentStamina() << "/" << entity->getMaxStamina() << "\n";
 
     // Check if entity is a player (check by presence in playerPositions)
     bool isPlayer = false;
     for (const auto &pos : playerPositions)
     {
-        if (pos.entity == entity)
+        if (entityAt(pos) == entity)
         {
             isPlayer = true;
             break;
@@ -873,24 +1019,24 @@ void BattleSystem::displayEntityDetails(Entity *entity) const
     }
 
     // Show active effects
-    const vector<Effect> &effects = entity->getActiveEffects();
+    const EffectBuffer &effects = entity->getActiveEffects();
     if (!effects.empty())
     {
-        cout << "\nActive effects:\n";
+        out() << "\nActive effects:\n";
         for (const auto &effect : effects)
         {
-            cout << "- " << effect.name << " (" << effect.duration << " turns";
+            out() << "- " << effect.getName() << " (" << entity->getEffectTurnsLeft(effect) << " turns";
             if (effect.value != 0)
             {
                 string sign = (effect.value > 0) ? "+" : "";
-                cout << ", " << sign << effect.value;
+                out() << ", " << sign << effect.value;
             }
-            cout << ")\n";
+            out() << ")\n";
         }
     }
     else
     {
-        cout << "\nActive effects: None\n";
+        out() << "\nActive effects: None\n";
     }
 
     if (isPlayer)
@@ -901,17 +1047,17 @@ void BattleSystem::displayEntityDetails(Entity *entity) const
 
         if (!abilities.empty())
         {
-            cout << "\nHero abilities:\n";
+            out() << "\nHero abilities:\n";
             for (int i = 0; i < abilities.size(); ++i)
             {
                 const AbilityInfo &info = HeroFactory::getAbilityInfo(abilities[i]);
-                cout << i + 1 << ". " << info.name << ": " << info.description << "\n";
-                cout << "   Effect: " << info.effect << "\n";
+                out() << i + 1 << ". " << info.name << ": " << info.description << "\n";
+                out() << "   Effect: " << info.effect << "\n";
             }
         }
         else
         {
-            cout << "\nAbilities: No available abilities\n";
+            out() << "\nAbilities: No available abilities\n";
         }
     }
     else
@@ -921,15 +1067,15 @@ void BattleSystem::displayEntityDetails(Entity *entity) const
         if (ability != AbilityType::NONE)
         {
             const AbilityInfo &info = HeroFactory::getAbilityInfo(ability);
-            cout << "\nAbility: " << info.name << ": " << info.description << "\n";
-            cout << "Effect: " << info.effect << "\n";
+            out() << "\nAbility: " << info.name << ": " << info.description << "\n";
+            out() << "Effect: " << info.effect << "\n";
         }
         else
         {
-            cout << "\nAbility: No special ability\n";
+            out() << "\nAbility: No special ability\n";
         }
     }
-    cout << "=====================================\n";
+    out() << "=====================================\n";
 }
 
 string BattleSystem::getAttackDescription(Entity *attacker, Entity *target) const
@@ -990,12 +1136,13 @@ string BattleSystem::getAttackDescription(Entity *attacker, Entity *target) cons
 
 void BattleSystem::printTurnOrder() const
 {
-    cout << "\nTurn order:\n";
+    out() << "\nTurn order:\n";
     for (int i = 0; i < turnOrder.size(); ++i)
     {
         string marker = (i == currentTurnIndex) ? " -> " : "    ";
-        cout << marker << i + 1 << ". " << turnOrder[i]->getName()
-             << " (Range: " << turnOrder[i]->getAttackRange() << ")\n";
+        Entity *entity = entities.get(turnOrder[i]);
+        out() << marker << i + 1 << ". " << entity->getName()
+             << " (Range: " << entity->getAttackRange() << ")\n";
     }
 }
 
@@ -1010,7 +1157,7 @@ void BattleSystem::applyAbilityEffect(Entity *attacker, Entity *target, int dama
         if (healAmount > 0)
         {
             attacker->heal(healAmount);
-            cout << attacker->getName() << " restores " << healAmount << " HP thanks to vampirism!\n";
+            out() << attacker->getName() << " restores " << healAmount << " HP thanks to vampirism!\n";
         }
         break;
     }
@@ -1024,7 +1171,7 @@ void BattleSystem::applyAbilityEffect(Entity *attacker, Entity *target, int dama
         // Poison: damage over time (simplified version)
         int poisonDamage = 5;
         target->takeDamage(poisonDamage);
-        cout << target->getName() << " takes " << poisonDamage << " damage from poison!\n";
+        out() << target->getName() << " takes " << poisonDamage << " damage from poison!\n";
         break;
     }
     case AbilityType::FIRE_DAMAGE:
@@ -1034,7 +1181,7 @@ void BattleSystem::applyAbilityEffect(Entity *attacker, Entity *target, int dama
         if (fireDamage > 0)
         {
             target->takeDamage(fireDamage);
-            cout << target->getName() << " takes " << fireDamage << " additional fire damage!\n";
+            out() << target->getName() << " takes " << fireDamage << " additional fire damage!\n";
         }
         break;
     }
@@ -1045,21 +1192,21 @@ void BattleSystem::applyAbilityEffect(Entity *attacker, Entity *target, int dama
         if (iceDamage > 0)
         {
             target->takeDamage(iceDamage);
-            target->setInitiative(max(1, target->getInitiative() - 1));
-            cout << target->getName() << " takes " << iceDamage << " ice damage and is slowed!\n";
+            target->addStatModifier(StatType::INITIATIVE, StatLayer::TEMPORARY, -1);
+            out() << target->getName() << " takes " << iceDamage << " ice damage and is slowed!\n";
         }
         break;
     }
     case AbilityType::LIGHTNING:
     {
         // Lightning: chance of chain reaction
-        if (rand() % 100 < 20) // 20% chance
+        if (rollIndex(100) < 20) // 20% chance
         {
             // Find another enemy and deal half damage
             bool isAttackerPlayer = false;
             for (const auto &pos : playerPositions)
             {
-                if (pos.entity == attacker)
+                if (entityAt(pos) == attacker)
                 {
                     isAttackerPlayer = true;
                     break;
@@ -1068,11 +1215,11 @@ void BattleSystem::applyAbilityEffect(Entity *attacker, Entity *target, int dama
             const vector<BattlePosition> &opponents = isAttackerPlayer ? enemyPositions : playerPositions;
             for (const auto &pos : opponents)
             {
-                if (pos.entity && pos.entity != target && pos.entity->getCurrentHealthPoint() > 0)
+                if (entityAt(pos) && entityAt(pos) != target && entityAt(pos)->getCurrentHealthPoint() > 0)
                 {
                     int chainDamage = damage / 2;
-                    pos.entity->takeDamage(chainDamage);
-                    cout << "Lightning jumps to " << pos.entity->getName() << " for " << chainDamage << " damage!\n";
+                    entityAt(pos)->takeDamage(chainDamage);
+                    out() << "Lightning jumps to " << entityAt(pos)->getName() << " for " << chainDamage << " damage!\n";
                     break;
                 }
             }
@@ -1098,7 +1245,7 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
     // Check stamina
     if (user->getCurrentStamina() < info.staminaCost)
     {
-        cout << "Недостаточно стамины для использования способности " << info.name << "! Требуется " << info.staminaCost << ", имеется " << user->getCurrentStamina() << ".\n";
+        out() << "Недостаточно стамины для использования способности " << info.name << "! Требуется " << info.staminaCost << ", имеется " << user->getCurrentStamina() << ".\n";
         return false;
     }
 
@@ -1106,7 +1253,7 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
     bool isPlayer = false;
     for (const auto &pos : playerPositions)
     {
-        if (pos.entity == user)
+        if (entityAt(pos) == user)
         {
             isPlayer = true;
             break;
@@ -1120,7 +1267,7 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         const vector<AbilityType> &available = player->getAvailableAbilities();
         if (find(available.begin(), available.end(), ability) == available.end())
         {
-            cout << "Ability unavailable!\n";
+            out() << "Ability unavailable!\n";
             return false;
         }
     }
@@ -1129,20 +1276,21 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         // For enemies check basic ability
         if (user->getAbility() != ability)
         {
-            cout << "Ability unavailable!\n";
+            out() << "Ability unavailable!\n";
             return false;
         }
     }
 
     // Apply ability effect
+    ++stateVersion;
     switch (ability)
     {
     case AbilityType::BERSERK:
     {
         // Increase damage and decrease defense
-        user->addEffect(Effect(EffectType::BUFF_DAMAGE, 8, 3, "Berserk"));
-        user->addEffect(Effect(EffectType::DEBUFF_DEFENSE, 2, 3, "Berserk"));
-        cout << user->getName() << " enters berserk state! Damage +8, defense -2 for 3 turns.\n";
+        addEffect(user, Effect(EffectType::BUFF_DAMAGE, 8, 3, abilityEffectNames().berserk));
+        addEffect(user, Effect(EffectType::DEBUFF_DEFENSE, 2, 3, abilityEffectNames().berserk));
+        out() << user->getName() << " enters berserk state! Damage +8, defense -2 for 3 turns.\n";
         break;
     }
     case AbilityType::HEALING_WAVE:
@@ -1151,10 +1299,10 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         vector<BattlePosition> &allies = isPlayer ? playerPositions : enemyPositions;
         for (auto &pos : allies)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
-                pos.entity->heal(60);
-                cout << pos.entity->getName() << " healed for 60 HP!\n";
+                entityAt(pos)->heal(60);
+                out() << entityAt(pos)->getName() << " healed for 60 HP!\n";
             }
         }
         break;
@@ -1162,8 +1310,8 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
     case AbilityType::TELEPORT:
     {
         // Teleport to random position (simplified version)
-        int newPos = rand() % 4;
-        movePosition(user, newPos);
+        int newPos = rollIndex(4);
+        abilityMove(user, newPos);
         break;
     }
     case AbilityType::FEAR:
@@ -1172,11 +1320,11 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         vector<BattlePosition> &opponents = isPlayer ? enemyPositions : playerPositions;
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
-                pos.entity->setInitiative(max(1, pos.entity->getInitiative() - 2));
-                pos.entity->setDamage(max(1, pos.entity->getDamage() - 4));
-                cout << pos.entity->getName() << " frightened! Initiative -2, damage -4.\n";
+                entityAt(pos)->addStatModifier(StatType::INITIATIVE, StatLayer::TEMPORARY, -2);
+                entityAt(pos)->addStatModifier(StatType::DAMAGE, StatLayer::TEMPORARY, -4);
+                out() << entityAt(pos)->getName() << " frightened! Initiative -2, damage -4.\n";
             }
         }
         break;
@@ -1187,11 +1335,11 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         vector<BattlePosition> &opponents = isPlayer ? enemyPositions : playerPositions;
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
                 int fireDamage = 10;
-                pos.entity->takeDamage(fireDamage);
-                cout << pos.entity->getName() << " получает " << fireDamage << " огненного урона!\n";
+                entityAt(pos)->takeDamage(fireDamage);
+                out() << entityAt(pos)->getName() << " получает " << fireDamage << " огненного урона!\n";
             }
         }
         break;
@@ -1202,12 +1350,12 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         vector<BattlePosition> &opponents = isPlayer ? enemyPositions : playerPositions;
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
                 int iceDamage = 8;
-                pos.entity->takeDamage(iceDamage);
-                pos.entity->setInitiative(max(1, pos.entity->getInitiative() - 3));
-                cout << pos.entity->getName() << " получает " << iceDamage << " ледяного урона и замедлен!\n";
+                entityAt(pos)->takeDamage(iceDamage);
+                entityAt(pos)->addStatModifier(StatType::INITIATIVE, StatLayer::TEMPORARY, -3);
+                out() << entityAt(pos)->getName() << " получает " << iceDamage << " ледяного урона и замедлен!\n";
             }
         }
         break;
@@ -1218,11 +1366,11 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         vector<BattlePosition> &opponents = isPlayer ? enemyPositions : playerPositions;
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
                 int lightningDamage = 35;
-                pos.entity->takeDamage(lightningDamage);
-                cout << pos.entity->getName() << " поражен молнией за " << lightningDamage << " урона!\n";
+                entityAt(pos)->takeDamage(lightningDamage);
+                out() << entityAt(pos)->getName() << " поражен молнией за " << lightningDamage << " урона!\n";
                 break; // Только один враг
             }
         }
@@ -1234,10 +1382,10 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         vector<BattlePosition> &opponents = isPlayer ? enemyPositions : playerPositions;
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
-                pos.entity->addEffect(Effect(EffectType::POISON_DAMAGE, 6, 3, "Яд"));
-                cout << pos.entity->getName() << " отравлен!\n";
+                addEffect(entityAt(pos), Effect(EffectType::POISON_DAMAGE, 6, 3, abilityEffectNames().poison));
+                out() << entityAt(pos)->getName() << " отравлен!\n";
             }
         }
         break;
@@ -1248,12 +1396,12 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         vector<BattlePosition> &opponents = isPlayer ? enemyPositions : playerPositions;
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
                 int stealDamage = 30;
-                pos.entity->takeDamage(stealDamage);
+                entityAt(pos)->takeDamage(stealDamage);
                 user->heal(stealDamage / 2);
-                cout << user->getName() << " крадет " << stealDamage << " HP у " << pos.entity->getName() << "!\n";
+                out() << user->getName() << " крадет " << stealDamage << " HP у " << entityAt(pos)->getName() << "!\n";
                 break; // Только один враг
             }
         }
@@ -1264,7 +1412,7 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         // Лечение: лечим себя
         int healAmount = 40;
         user->heal(healAmount);
-        cout << user->getName() << " лечит себя на " << healAmount << " HP!\n";
+        out() << user->getName() << " лечит себя на " << healAmount << " HP!\n";
         break;
     }
     case AbilityType::REGENERATION:
@@ -1272,21 +1420,21 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         // Регенерация: лечим себя
         int healAmount = 30;
         user->heal(healAmount);
-        cout << user->getName() << " регенерирует " << healAmount << " HP!\n";
+        out() << user->getName() << " регенерирует " << healAmount << " HP!\n";
         break;
     }
     case AbilityType::FLYING:
     {
         // Полет: перемещаемся на любую позицию
-        int newPos = rand() % 4;
-        movePosition(user, newPos);
-        cout << user->getName() << " взлетает и перемещается!\n";
+        int newPos = rollIndex(4);
+        abilityMove(user, newPos);
+        out() << user->getName() << " взлетает и перемещается!\n";
         break;
     }
     case AbilityType::INVISIBLE:
     {
         // Невидимость: пропускаем ход, но становимся невидимым (упрощенная версия)
-        cout << user->getName() << " становится невидимым!\n";
+        out() << user->getName() << " становится невидимым!\n";
         break;
     }
     case AbilityType::CHARGE:
@@ -1295,24 +1443,24 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         vector<BattlePosition> &opponents = isPlayer ? enemyPositions : playerPositions;
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
                 // Перемещаемся к цели (упрощенная версия - телепортация)
                 int targetPos = pos.position;
-                movePosition(user, targetPos);
+                abilityMove(user, targetPos);
 
                 // Атака с бонусом урона
                 int chargeDamage = static_cast<int>(user->getDamage() * 1.75); // +75% урон
-                pos.entity->takeDamage(chargeDamage);
+                entityAt(pos)->takeDamage(chargeDamage);
 
                 // Шанс оглушения (снижение инициативы)
-                if (rand() % 100 < 30) // 30% шанс
+                if (rollIndex(100) < 30) // 30% шанс
                 {
-                    pos.entity->setInitiative(max(1, pos.entity->getInitiative() - 2));
-                    cout << pos.entity->getName() << " оглушен!\n";
+                    entityAt(pos)->addStatModifier(StatType::INITIATIVE, StatLayer::TEMPORARY, -2);
+                    out() << entityAt(pos)->getName() << " оглушен!\n";
                 }
 
-                cout << user->getName() << " совершает рывок и наносит " << chargeDamage << " урона!\n";
+                out() << user->getName() << " совершает рывок и наносит " << chargeDamage << " урона!\n";
                 break; // Только одна цель
             }
         }
@@ -1322,9 +1470,8 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
     {
         // Стена щитов: блокирует урон на 2 хода
         // Упрощенная версия: временное увеличение защиты
-        user->setDefense(user->getDefense() + 5);
-        cout << user->getName() << " создает стену щитов! Защита +5 на 2 хода.\n";
-        // TODO: Реализовать таймер для снятия баффа через 2 хода
+        addEffect(user, Effect(EffectType::BUFF_DEFENSE, 5, 2, abilityEffectNames().shieldWall));
+        out() << user->getName() << " создает стену щитов! Защита +5 на 2 хода.\n";
         break;
     }
     case AbilityType::BATTLE_CRY:
@@ -1336,22 +1483,22 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         // Бафф союзников
         for (auto &pos : allies)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
-                pos.entity->addEffect(Effect(EffectType::BUFF_DAMAGE, 3, 2, "Боевой клич"));
-                pos.entity->addEffect(Effect(EffectType::BUFF_DEFENSE, 3, 2, "Боевой клич"));
-                cout << pos.entity->getName() << " воодушевлен боевым кличем!\n";
+                addEffect(entityAt(pos), Effect(EffectType::BUFF_DAMAGE, 3, 2, abilityEffectNames().battleCry));
+                addEffect(entityAt(pos), Effect(EffectType::BUFF_DEFENSE, 3, 2, abilityEffectNames().battleCry));
+                out() << entityAt(pos)->getName() << " воодушевлен боевым кличем!\n";
             }
         }
 
         // Страх врагов
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
-                pos.entity->addEffect(Effect(EffectType::DEBUFF_DAMAGE, 3, 2, "Страх"));
-                pos.entity->addEffect(Effect(EffectType::DEBUFF_INITIATIVE, 1, 2, "Страх"));
-                cout << pos.entity->getName() << " напуган боевым кличем!\n";
+                addEffect(entityAt(pos), Effect(EffectType::DEBUFF_DAMAGE, 3, 2, abilityEffectNames().fear));
+                addEffect(entityAt(pos), Effect(EffectType::DEBUFF_INITIATIVE, 1, 2, abilityEffectNames().fear));
+                out() << entityAt(pos)->getName() << " напуган боевым кличем!\n";
             }
         }
         break;
@@ -1362,11 +1509,11 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         vector<BattlePosition> &allies = isPlayer ? playerPositions : enemyPositions;
         for (auto &pos : allies)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
-                pos.entity->setInitiative(pos.entity->getInitiative() + 3);
-                pos.entity->setDamage(pos.entity->getDamage() + 2);
-                cout << pos.entity->getName() << " получает приказ! Инициатива +3, урон +2.\n";
+                entityAt(pos)->addStatModifier(StatType::INITIATIVE, StatLayer::TEMPORARY, 3);
+                entityAt(pos)->addStatModifier(StatType::DAMAGE, StatLayer::TEMPORARY, 2);
+                out() << entityAt(pos)->getName() << " получает приказ! Инициатива +3, урон +2.\n";
             }
         }
         break;
@@ -1374,17 +1521,17 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
     case AbilityType::FROST_ARMOR:
     {
         // Ледяная броня: защита +7, замедление врагов
-        user->setDefense(user->getDefense() + 7);
-        cout << user->getName() << " покрывается ледяной броней! Защита +7.\n";
+        user->addStatModifier(StatType::DEFENSE, StatLayer::TEMPORARY, 7);
+        out() << user->getName() << " покрывается ледяной броней! Защита +7.\n";
 
         // Замедление врагов
         vector<BattlePosition> &opponents = isPlayer ? enemyPositions : playerPositions;
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
-                pos.entity->setInitiative(max(1, pos.entity->getInitiative() - 2));
-                cout << pos.entity->getName() << " замедлен ледяной броней!\n";
+                entityAt(pos)->addStatModifier(StatType::INITIATIVE, StatLayer::TEMPORARY, -2);
+                out() << entityAt(pos)->getName() << " замедлен ледяной броней!\n";
             }
         }
         break;
@@ -1392,7 +1539,7 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
     case AbilityType::STEALTH:
     {
         // Скрытность: невидимость + критический удар x2
-        cout << user->getName() << " скрывается в тенях!\n";
+        out() << user->getName() << " скрывается в тенях!\n";
         // Упрощенная версия: следующая атака будет критической
         // TODO: Реализовать флаг stealth для следующей атаки
         break;
@@ -1403,16 +1550,16 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         vector<BattlePosition> &opponents = isPlayer ? enemyPositions : playerPositions;
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
                 // Телепортация к цели
                 int targetPos = pos.position;
-                movePosition(user, targetPos);
+                abilityMove(user, targetPos);
 
                 // Гарантированный удар (игнорируем защиту)
                 int shadowDamage = static_cast<int>(user->getDamage() * 2.5); // x2.5 урон
-                pos.entity->takeDamage(shadowDamage);
-                cout << user->getName() << " выныривает из тени и наносит " << shadowDamage << " урона!\n";
+                entityAt(pos)->takeDamage(shadowDamage);
+                out() << user->getName() << " выныривает из тени и наносит " << shadowDamage << " урона!\n";
 
                 // Проверка на смерть и окончание боя
                 removeDeadEntities();
@@ -1431,11 +1578,11 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         vector<BattlePosition> &opponents = isPlayer ? enemyPositions : playerPositions;
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
-                int arcaneDamage = 20 + (rand() % 16); // 20-35
-                pos.entity->takeDamage(arcaneDamage);
-                cout << user->getName() << " запускает магический снаряд за " << arcaneDamage << " урона!\n";
+                int arcaneDamage = 20 + rollIndex(16); // 20-35
+                entityAt(pos)->takeDamage(arcaneDamage);
+                out() << user->getName() << " запускает магический снаряд за " << arcaneDamage << " урона!\n";
                 break; // Одна цель
             }
         }
@@ -1448,10 +1595,10 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         int chainCount = 0;
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0 && chainCount < 3)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0 && chainCount < 3)
             {
-                pos.entity->takeDamage(15);
-                cout << pos.entity->getName() << " поражен цепной молнией за 15 урона!\n";
+                entityAt(pos)->takeDamage(15);
+                out() << entityAt(pos)->getName() << " поражен цепной молнией за 15 урона!\n";
                 chainCount++;
             }
         }
@@ -1464,10 +1611,10 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         vector<BattlePosition> &opponents = isPlayer ? enemyPositions : playerPositions;
         for (auto &pos : opponents)
         {
-            if (pos.entity && pos.entity->getCurrentHealthPoint() > 0)
+            if (entityAt(pos) && entityAt(pos)->getCurrentHealthPoint() > 0)
             {
-                pos.entity->takeDamage(18);
-                cout << pos.entity->getName() << " получает 18 урона от взрыва пламени!\n";
+                entityAt(pos)->takeDamage(18);
+                out() << entityAt(pos)->getName() << " получает 18 урона от взрыва пламени!\n";
             }
         }
         break;
@@ -1478,19 +1625,19 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
         if (user->getCurrentHealthPoint() > 30)
         {
             user->takeDamage(30);
-            user->setDamage(static_cast<int>(user->getDamage() * 1.75));
-            cout << user->getName() << " проводит кровавый ритуал! Жертвует 30 HP, урон +75%.\n";
-            // TODO: Реализовать таймер для снятия баффа через 3 хода
+            int ritualBonus = static_cast<int>(user->getDamage() * 0.75);
+            addEffect(user, Effect(EffectType::BUFF_DAMAGE, ritualBonus, 3, abilityEffectNames().bloodRitual));
+            out() << user->getName() << " проводит кровавый ритуал! Жертвует 30 HP, урон +75%.\n";
         }
         else
         {
-            cout << "Недостаточно здоровья для ритуала!\n";
+            out() << "Недостаточно здоровья для ритуала!\n";
             return false;
         }
         break;
     }
     default:
-        cout << "Способность не реализована.\n";
+        out() << "Способность не реализована.\n";
         return false;
     }
 
@@ -1500,6 +1647,15 @@ bool BattleSystem::useAbility(Entity *user, AbilityType ability)
     return true;
 }
 
+void BattleSystem::abilityMove(Entity *user, int newPosition)
+{
+    // Перемещение входит в цену способности: movePosition списывает очко выносливости, оно возвращается,
+    // иначе при выносливости, равной цене, итоговое списание цены бросает исключение
+    int stamina = user->getCurrentStamina();
+    movePosition(user, newPosition);
+    user->setCurrentStamina(stamina);
+}
+
 void BattleSystem::shiftPositionsAfterDeath(vector<BattlePosition> &positions, int deadPosition)
 {
     // Сдвигаем всех персонажей на позициях выше deadPosition на одну позицию ближе к бою
@@ -1508,7 +1664,7 @@ void BattleSystem::shiftPositionsAfterDeath(vector<BattlePosition> &positions, i
         // Найти позицию i
         auto it = find_if(positions.begin(), positions.end(),
                           [i](const BattlePosition &pos)
-                          { return pos.position == i && pos.entity != nullptr; });
+                          { return pos.position == i && pos.handle.isValid(); });
         if (it != positions.end())
         {
             it->position = i - 1;
@@ -1521,11 +1677,13 @@ bool BattleSystem::skipHalfTurn(Entity *entity)
     if (!battleActive || !entity)
         return false;
 
+    ++stateVersion;
+
     // Уменьшаем стамину наполовину (округляем вниз)
     int staminaCost = max(1, entity->getCurrentStamina() / 2);
     entity->setCurrentStamina(entity->getCurrentStamina() - staminaCost);
 
-    cout << entity->getName() << " пропускает половину хода! Потеряно " << staminaCost << " стамины.\n";
+    out() << entity->getName() << " пропускает половину хода! Потеряно " << staminaCost << " стамины.\n";
 
     return true;
 }
@@ -1,44 +1,71 @@
 #pragma once
 #include "entity.h"
+#include "EntityStore.h"
+#include "EffectScheduler.h"
+#include "ThreatMatrix.h"
 #include <vector>
 #include <queue>
 #include <algorithm>
 #include <random>
 #include <iostream>
+#include <cstdint>
 
 using namespace std;
 
 // Структура для хранения информации о позиции сущности в бою
+// Участник - дескриптор в хранилище боя (BattleSystem::getEntity)
 struct BattlePosition
 {
-    Entity *entity;
-    int position; // 0-3 (0 первая линия, 1 вторая, 2 третья)
-    int corpseHP; // HP трупа, если entity == nullptr
+    EntityHandle handle; // Пустой - на позиции труп
+    int position;        // 0-3 (0 первая линия, 1 вторая, 2 третья)
+    int corpseHP;        // HP трупа, если handle пуст
 
-    BattlePosition(Entity *e = nullptr, int pos = 0, int cHP = 0)
-        : entity(e), position(pos), corpseHP(cHP) {}
+    BattlePosition(EntityHandle h = EntityHandle(), int pos = 0, int cHP = 0)
+        : handle(h), position(pos), corpseHP(cHP) {}
 };
 
 // Структура для хранения информации о ходе
 struct TurnInfo
 {
-    Entity *entity;
+    EntityHandle handle;
     int priority; // Приоритет для сортировки очереди
 
-    TurnInfo(Entity *e = nullptr, int p = 0) : entity(e), priority(p) {}
+    TurnInfo(EntityHandle h = EntityHandle(), int p = 0) : handle(h), priority(p) {}
 };
 
 class BattleSystem
 {
 private:
+    EntityStore entities;                   // Участники боя (заимствованные у вызывающего startBattle)
     vector<BattlePosition> playerPositions; // Позиции игроков (до 4)
     vector<BattlePosition> enemyPositions;  // Позиции врагов (до 4)
-    vector<Entity *> turnOrder;             // Текущая очередь ходов
+    vector<EntityHandle> turnOrder;         // Текущая очередь ходов
     int currentTurnIndex;                // Индекс текущего хода
     bool battleActive;                      // Флаг активного боя
-
-    // Генератор случайных чисел
+    uint64_t stateVersion;                  // Версия состояния боя, растет при каждом изменении
+    uint64_t turnSerial;                    // Номер хода, растет при каждой смене текущего хода
+
+    // Кэши строковых представлений, пересобираются только при смене версии
+    mutable uint64_t turnOrderCacheVersion;
+    mutable string turnOrderCache;
+    mutable uint64_t battleStatusCacheVersion;
+    mutable string battleStatusCache;
+    mutable uint64_t entitiesStatusCacheVersion;
+    mutable vector<pair<Entity *, string>> entitiesStatusCache;
+
+    // Генератор случайных чисел (все броски боя идут через него)
     mt19937 randomGenerator;
+    bool antithetic; // Антитетичные броски: u -> 1 - u, индекс i -> count - 1 - i
+
+    // Тики и истечение эффектов всех участников
+    EffectScheduler effectScheduler;
+
+    // Матрица угроз для утилитарного ИИ (пересобирается в startBattle)
+    ThreatMatrix threatMatrix;
+
+    // Куда печатается ход боя (nullptr - бой идет молча)
+    ostream *output;
+    ostream &out() const;
 
     // Вспомогательные методы
     bool canAttackTarget(Entity *attacker, Entity *target) const;
@@ -49,7 +76,12 @@ private:
     vector<pair<Entity *, int>> getAvailableTargets(Entity *attacker, bool isPlayerAttacker) const;
     void regenerateStaminaForTurn();
     void applyAbilityEffect(Entity *attacker, Entity *target, int damage);
+    void addEffect(Entity *target, const Effect &effect); // Наложить эффект и поставить его в расписание
+    void abilityMove(Entity *user, int newPosition);      // Перемещение внутри способности (без своей цены)
     void shiftPositionsAfterDeath(vector<BattlePosition> &positions, int deadPosition);
+    string buildBattleStatus() const;
+    string buildTurnOrderString() const;
+    vector<pair<Entity *, string>> buildAllEntitiesWithStatus() const;
 
 public:
     void removeDeadEntities(); // Made public for testing
@@ -57,12 +89,34 @@ public:
 
 public:
     BattleSystem();
+    // Снимок боя (планировщик раунда): участники копируются вместе с хранилищем, дескрипторы позиций
+    // и очереди остаются прежними, расписание эффектов и матрица угроз переводятся на копии
+    BattleSystem(const BattleSystem &other);
+    BattleSystem &operator=(const BattleSystem &) = delete;
+
+    // Фиксированное зерно для воспроизводимых симуляций
+    void setRandomSeed(unsigned int seed);
+    // Антитетичный поток бросков: пара боев с одним зерном, обычный и антитетичный,
+    // дает отрицательно коррелированные исходы (снижение дисперсии в анализе статов)
+    void setAntithetic(bool value) { antithetic = value; }
+    double rollUnit();         // Бросок в диапазоне 0.0 - 1.0
+    int rollIndex(int count);  // Бросок в диапазоне 0 - count-1
+
+    // Вывод хода боя: по умолчанию cout, nullptr - без вывода (безголовые симуляции)
+    void setOutput(ostream *stream) { output = stream; }
 
     // Основные методы управления боем
     void startBattle(const vector<Entity *> &players, const vector<Entity *> &enemies);
     void endBattle();
     bool isBattleActive() const { return battleActive; }
 
+    // Версия состояния: меняется при любом изменении боя через методы BattleSystem
+    uint64_t getStateVersion() const { return stateVersion; }
+    // Отметить изменение участников в обход BattleSystem (сбрасывает кэши)
+    void touch() { ++stateVersion; }
+    // Номер текущего хода: отличает подряд идущие ходы одного персонажа
+    uint64_t getTurnSerial() const { return turnSerial; }
+
     // Методы для выполнения действий
     bool attack(Entity *attacker, Entity *target);
     bool movePosition(Entity *entity, int newPosition);
@@ -73,12 +127,18 @@ public:
     // Методы для получения информации
     Entity *getCurrentTurnEntity() const;
     vector<pair<Entity *, int>> getAvailableTargetsForCurrent() const;
-    vector<pair<Entity *, string>> getAllEntitiesWithStatus() const;
-    string getBattleStatus() const;
-    string getTurnOrderString() const;
+    const vector<pair<Entity *, string>> &getAllEntitiesWithStatus() const;
+    const string &getBattleStatus() const;
+    const string &getTurnOrderString() const;
     const vector<BattlePosition> &getPlayerPositions() const { return playerPositions; }
     const vector<BattlePosition> &getEnemyPositions() const { return enemyPositions; }
-    const vector<Entity *> &getTurnOrder() const { return turnOrder; }
+    const vector<EntityHandle> &getTurnOrder() const { return turnOrder; }
+    // Участник по дескриптору; nullptr - дескриптор из другого боя или участник уже убран
+    Entity *getEntity(EntityHandle handle) const { return entities.get(handle); }
+    Entity *entityAt(const BattlePosition &pos) const { return entities.get(pos.handle); }
+    EntityHandle getHandle(const Entity *entity) const { return entities.find(entity); }
+    const EntityStore &getEntities() const { return entities; }
+    ThreatMatrix &getThreatMatrix() { return threatMatrix; }
     void displayEntityDetails(Entity *entity) const;
     string getAttackDescription(Entity *attacker, Entity *target) const;
 
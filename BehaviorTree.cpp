@@ -0,0 +1,399 @@
+#include "BehaviorTree.h"
+#include "EnemyBehaviorData.h"
+#include "HeroTemplates.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    const pair<const char *, EffectType> effectNames[] = {
+        {"buff_damage", EffectType::BUFF_DAMAGE},
+        {"buff_defense", EffectType::BUFF_DEFENSE},
+        {"buff_initiative", EffectType::BUFF_INITIATIVE},
+        {"debuff_damage", EffectType::DEBUFF_DAMAGE},
+        {"debuff_defense", EffectType::DEBUFF_DEFENSE},
+        {"debuff_initiative", EffectType::DEBUFF_INITIATIVE},
+        {"poison", EffectType::POISON_DAMAGE},
+        {"regeneration", EffectType::REGENERATION},
+        {"stealth", EffectType::STEALTH},
+        {"invisible", EffectType::INVISIBLE},
+    };
+
+    // Выбор цели атаки
+    enum TargetChoice : uint8_t
+    {
+        TARGET_WEAKEST,
+        TARGET_STRONGEST,
+        TARGET_RANDOM
+    };
+
+    struct OpSyntax
+    {
+        const char *name;
+        BehaviorOp op;
+        int arguments; // 0 - без аргумента, 1 - один аргумент
+    };
+
+    const OpSyntax opSyntax[] = {
+        {"selector", BehaviorOp::SELECTOR, 0},
+        {"sequence", BehaviorOp::SEQUENCE, 0},
+        {"invert", BehaviorOp::INVERT, 0},
+        {"hp_below", BehaviorOp::HP_BELOW, 1},
+        {"has_effect", BehaviorOp::HAS_EFFECT, 1},
+        {"lacks_effect", BehaviorOp::LACKS_EFFECT, 1},
+        {"any_target_lacks", BehaviorOp::ANY_TARGET_LACKS, 1},
+        {"has_targets", BehaviorOp::HAS_TARGETS, 0},
+        {"can_use_ability", BehaviorOp::CAN_USE_ABILITY, 0},
+        {"chance", BehaviorOp::CHANCE, 1},
+        {"position_below", BehaviorOp::POSITION_BELOW, 1},
+        {"attack", BehaviorOp::ATTACK, 1},
+        {"use_ability", BehaviorOp::USE_ABILITY, 0},
+        {"move", BehaviorOp::MOVE, 1},
+        {"end_turn", BehaviorOp::END_TURN, 0},
+    };
+
+    bool isComposite(BehaviorOp op)
+    {
+        return op == BehaviorOp::SELECTOR || op == BehaviorOp::SEQUENCE || op == BehaviorOp::INVERT;
+    }
+
+    runtime_error syntaxError(int line, const string &message)
+    {
+        return runtime_error("enemy behaviors, line " + to_string(line) + ": " + message);
+    }
+
+    int parseNumber(int line, const string &text, int minValue, int maxValue)
+    {
+        size_t used = 0;
+        int value = 0;
+        try
+        {
+            value = stoi(text, &used);
+        }
+        catch (const exception &)
+        {
+            used = 0;
+        }
+        if (used != text.size() || value < minValue || value > maxValue)
+            throw syntaxError(line, "expected a number " + to_string(minValue) + ".." + to_string(maxValue) + ", got '" + text + "'");
+        return value;
+    }
+
+    BehaviorNode parseNode(int line, const vector<string> &tokens)
+    {
+        const OpSyntax *syntax = nullptr;
+        for (const OpSyntax &candidate : opSyntax)
+        {
+            if (tokens[0] == candidate.name)
+                syntax = &candidate;
+        }
+        if (!syntax)
+            throw syntaxError(line, "unknown node '" + tokens[0] + "'");
+        if (static_cast<int>(tokens.size()) != 1 + syntax->arguments)
+            throw syntaxError(line, "'" + tokens[0] + "' expects " + to_string(syntax->arguments) + " argument(s)");
+
+        BehaviorNode node = {static_cast<uint8_t>(syntax->op), 0, 0, 0};
+        switch (syntax->op)
+        {
+        case BehaviorOp::HP_BELOW:
+        case BehaviorOp::CHANCE:
+            node.value = parseNumber(line, tokens[1], 0, 100);
+            break;
+        case BehaviorOp::POSITION_BELOW:
+        case BehaviorOp::MOVE:
+            node.value = parseNumber(line, tokens[1], 1, 4);
+            break;
+        case BehaviorOp::HAS_EFFECT:
+        case BehaviorOp::LACKS_EFFECT:
+        case BehaviorOp::ANY_TARGET_LACKS:
+        {
+            bool found = false;
+            for (const auto &effect : effectNames)
+            {
+                if (tokens[1] == effect.first)
+                {
+                    node.arg = static_cast<uint8_t>(effect.second);
+                    found = true;
+                }
+            }
+            if (!found)
+                throw syntaxError(line, "unknown effect '" + tokens[1] + "'");
+            break;
+        }
+        case BehaviorOp::ATTACK:
+            if (tokens[1] == "weakest")
+                node.arg = TARGET_WEAKEST;
+            else if (tokens[1] == "strongest")
+                node.arg = TARGET_STRONGEST;
+            else if (tokens[1] == "random")
+                node.arg = TARGET_RANDOM;
+            else
+                throw syntaxError(line, "unknown target choice '" + tokens[1] + "'");
+            break;
+        default:
+            break;
+        }
+        return node;
+    }
+}
+
+struct BehaviorLibrary::TickContext
+{
+    BattleSystem &battle;
+    Entity *actor;
+    const vector<pair<Entity *, int>> &targets;
+    BattleAction &action;
+};
+
+const BehaviorLibrary &BehaviorLibrary::builtin()
+{
+    static const BehaviorLibrary library = []()
+    {
+        BehaviorLibrary compiled;
+        compiled.compile(defaultEnemyBehaviors);
+        return compiled;
+    }();
+    return library;
+}
+
+void BehaviorLibrary::compile(const string &source)
+{
+    struct OpenNode
+    {
+        int indent;
+        int index;
+        int line;
+    };
+
+    vector<BehaviorNode> compiled;
+    unordered_map<string, int> compiledRoots;
+    vector<OpenNode> open;
+    bool inTree = false;
+    bool hasRoot = false;
+    int treeLine = 0;
+
+    // Закрыть узел: поддерево кончается здесь, проверить число потомков
+    auto close = [&]()
+    {
+        OpenNode node = open.back();
+        open.pop_back();
+        compiled[node.index].end = static_cast<uint16_t>(compiled.size());
+
+        BehaviorOp op = static_cast<BehaviorOp>(compiled[node.index].op);
+        if (!isComposite(op))
+            return;
+        int children = 0;
+        for (int child = node.index + 1; child < static_cast<int>(compiled.size()); child = compiled[child].end)
+        {
+            ++children;
+        }
+        if (children == 0)
+            throw syntaxError(node.line, "composite node without children");
+        if (op == BehaviorOp::INVERT && children != 1)
+            throw syntaxError(node.line, "'invert' expects exactly one child");
+    };
+    auto finishTree = [&]()
+    {
+        while (!open.empty())
+        {
+            close();
+        }
+        if (inTree && !hasRoot)
+            throw syntaxError(treeLine, "empty tree");
+    };
+
+    istringstream input(source);
+    string text;
+    int line = 0;
+    while (getline(input, text))
+    {
+        ++line;
+        size_t comment = text.find('#');
+        if (comment != string::npos)
+            text.erase(comment);
+
+        int indent = 0;
+        while (indent < static_cast<int>(text.size()) && (text[indent] == ' ' || text[indent] == '\t'))
+        {
+            indent += 1;
+        }
+        istringstream words(text);
+        vector<string> tokens;
+        string word;
+        while (words >> word)
+        {
+            tokens.push_back(word);
+        }
+        if (tokens.empty())
+            continue;
+
+        if (tokens[0] == "tree")
+        {
+            finishTree();
+            if (tokens.size() < 2)
+                throw syntaxError(line, "'tree' expects at least one enemy type");
+            for (size_t i = 1; i < tokens.size(); ++i)
+            {
+                if (!compiledRoots.emplace(tokens[i], static_cast<int>(compiled.size())).second)
+                    throw syntaxError(line, "duplicate tree for '" + tokens[i] + "'");
+            }
+            inTree = true;
+            hasRoot = false;
+            treeLine = line;
+            continue;
+        }
+        if (!inTree)
+            throw syntaxError(line, "node outside of a tree");
+
+        while (!open.empty() && open.back().indent >= indent)
+        {
+            close();
+        }
+        if (open.empty() && hasRoot)
+            throw syntaxError(line, "a tree must have a single root");
+        if (!open.empty() && !isComposite(static_cast<BehaviorOp>(compiled[open.back().index].op)))
+            throw syntaxError(line, "only selector, sequence and invert can have children");
+
+        // Конец поддерева хранится в uint16_t: узлов не больше UINT16_MAX
+        if (compiled.size() >= UINT16_MAX)
+            throw syntaxError(line, "too many nodes (limit " + to_string(UINT16_MAX) + ")");
+        compiled.push_back(parseNode(line, tokens));
+        open.push_back({indent, static_cast<int>(compiled.size()) - 1, line});
+        hasRoot = true;
+    }
+    finishTree();
+
+    nodes.swap(compiled);
+    roots.swap(compiledRoots);
+}
+
+bool BehaviorLibrary::loadFile(const string &path)
+{
+    ifstream file(path);
+    if (!file)
+        return false;
+    stringstream buffer;
+    buffer << file.rdbuf();
+    compile(buffer.str());
+    return true;
+}
+
+int BehaviorLibrary::findTree(const string &enemyType) const
+{
+    auto it = roots.find(enemyType);
+    return it != roots.end() ? it->second : -1;
+}
+
+bool BehaviorLibrary::tick(int root, BattleSystem &battle, Entity *actor, const vector<pair<Entity *, int>> &targets,
+                           BattleAction &action) const
+{
+    if (root < 0 || root >= static_cast<int>(nodes.size()) || !actor)
+        return false;
+    TickContext context = {battle, actor, targets, action};
+    return run(root, context);
+}
+
+bool BehaviorLibrary::run(int index, TickContext &context) const
+{
+    const BehaviorNode &node = nodes[index];
+    Entity *actor = context.actor;
+    switch (static_cast<BehaviorOp>(node.op))
+    {
+    case BehaviorOp::SELECTOR:
+        for (int child = index + 1; child < node.end; child = nodes[child].end)
+        {
+            if (run(child, context))
+                return true;
+        }
+        return false;
+    case BehaviorOp::SEQUENCE:
+        for (int child = index + 1; child < node.end; child = nodes[child].end)
+        {
+            if (!run(child, context))
+                return false;
+        }
+        return true;
+    case BehaviorOp::INVERT:
+        return !run(index + 1, context);
+    case BehaviorOp::HP_BELOW:
+        return actor->getCurrentHealthPoint() * 100 < node.value * max(1, actor->getMaxHealthPoint());
+    case BehaviorOp::HAS_EFFECT:
+        return actor->hasEffect(static_cast<EffectType>(node.arg));
+    case BehaviorOp::LACKS_EFFECT:
+        return !actor->hasEffect(static_cast<EffectType>(node.arg));
+    case BehaviorOp::ANY_TARGET_LACKS:
+        for (const auto &target : context.targets)
+        {
+            if (!target.first->hasEffect(static_cast<EffectType>(node.arg)))
+                return true;
+        }
+        return false;
+    case BehaviorOp::HAS_TARGETS:
+        return !context.targets.empty();
+    case BehaviorOp::CAN_USE_ABILITY:
+        return actor->getAbility() != AbilityType::NONE &&
+               actor->getCurrentStamina() >= HeroFactory::getAbilityInfo(actor->getAbility()).staminaCost;
+    case BehaviorOp::CHANCE:
+        return context.battle.rollIndex(100) < node.value;
+    case BehaviorOp::POSITION_BELOW:
+    {
+        const vector<BattlePosition> &enemies = context.battle.getEnemyPositions();
+        const vector<BattlePosition> &players = context.battle.getPlayerPositions();
+        EntityHandle actorHandle = context.battle.getHandle(actor);
+        for (const vector<BattlePosition> *side : {&enemies, &players})
+        {
+            for (const BattlePosition &pos : *side)
+            {
+                if (actorHandle.isValid() && pos.handle == actorHandle)
+                    return pos.position + 1 < node.value;
+            }
+        }
+        return false;
+    }
+    case BehaviorOp::ATTACK:
+    {
+        const vector<pair<Entity *, int>> &targets = context.targets;
+        if (targets.empty())
+            return false;
+        size_t chosen = 0;
+        if (node.arg == TARGET_RANDOM)
+        {
+            chosen = static_cast<size_t>(context.battle.rollIndex(static_cast<int>(targets.size())));
+        }
+        else
+        {
+            for (size_t i = 1; i < targets.size(); ++i)
+            {
+                const Entity *candidate = targets[i].first;
+                const Entity *best = targets[chosen].first;
+                bool better = node.arg == TARGET_WEAKEST
+                                  ? candidate->getCurrentHealthPoint() < best->getCurrentHealthPoint()
+                                  : candidate->getDamage() > best->getDamage();
+                if (better)
+                    chosen = i;
+            }
+        }
+        context.action = BattleAction();
+        context.action.type = BattleActionType::ATTACK;
+        context.action.target = targets[chosen].first;
+        return true;
+    }
+    case BehaviorOp::USE_ABILITY:
+        if (actor->getAbility() == AbilityType::NONE)
+            return false;
+        context.action = BattleAction();
+        context.action.type = BattleActionType::USE_ABILITY;
+        context.action.ability = actor->getAbility();
+        return true;
+    case BehaviorOp::MOVE:
+        context.action = BattleAction();
+        context.action.type = BattleActionType::MOVE;
+        context.action.position = node.value - 1;
+        return true;
+    case BehaviorOp::END_TURN:
+        context.action = BattleAction();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "BattleSystem.h"
+#include "BattleAI.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Операция узла дерева поведения
+enum class BehaviorOp : uint8_t
+{
+    SELECTOR,
+    SEQUENCE,
+    INVERT,
+    HP_BELOW,
+    HAS_EFFECT,
+    LACKS_EFFECT,
+    ANY_TARGET_LACKS,
+    HAS_TARGETS,
+    CAN_USE_ABILITY,
+    CHANCE,
+    POSITION_BELOW,
+    ATTACK,
+    USE_ABILITY,
+    MOVE,
+    END_TURN
+};
+
+// Узел скомпилированного дерева поведения: 8 байт, дети лежат сразу за родителем (прямой обход),
+// end - индекс первого узла после поддерева. Интерпретатор ходит только по индексам.
+struct BehaviorNode
+{
+    uint8_t op;
+    uint8_t arg;   // Вариант выбора цели / тип эффекта
+    uint16_t end;
+    int32_t value; // Процент, позиция
+};
+
+// Библиотека деревьев поведения врагов по типу врага (Enemy::getEnemyType).
+// Деревья описываются текстом и компилируются в один плоский массив узлов для всех типов.
+// Новому архетипу нужен только шаблон в EnemyFactory и дерево в данных - без подклассов Enemy.
+//
+// Формат: строка "tree <тип> [<тип>...]" начинает дерево, узлы вложены отступом (пробелы),
+// "#" - комментарий. Узлы:
+//   selector / sequence / invert          - составные (invert - ровно один потомок)
+//   hp_below <pct>                        - свое HP ниже pct% от максимума
+//   has_effect <эффект> / lacks_effect <эффект>
+//   any_target_lacks <эффект>             - у кого-то из доступных целей нет эффекта
+//   has_targets / can_use_ability / chance <pct> / position_below <n>
+//   attack weakest|strongest|random       - атака (самое низкое HP / самый сильный удар / случайно)
+//   use_ability / move <позиция 1-4> / end_turn
+// Эффекты: buff_damage, buff_defense, buff_initiative, debuff_damage, debuff_defense,
+// debuff_initiative, poison, regeneration, stealth, invisible.
+class BehaviorLibrary
+{
+public:
+    // Встроенные деревья (EnemyBehaviorData.h)
+    static const BehaviorLibrary &builtin();
+
+    // Разобрать и скомпилировать описание; ошибка разбора - runtime_error с номером строки
+    void compile(const string &source);
+    // Загрузить описание из файла; false, если файла нет
+    bool loadFile(const string &path);
+
+    // Корень дерева для типа врага или -1
+    int findTree(const string &enemyType) const;
+
+    // Один тик дерева для ходящего персонажа; targets - getAvailableTargetsForCurrent().
+    // true, если дерево выбрало действие
+    bool tick(int root, BattleSystem &battle, Entity *actor, const vector<pair<Entity *, int>> &targets,
+              BattleAction &action) const;
+
+    size_t getNodeCount() const { return nodes.size(); }
+    size_t getTreeCount() const { return roots.size(); }
+
+private:
+    vector<BehaviorNode> nodes;
+    unordered_map<string, int> roots;
+
+    struct TickContext;
+    bool run(int index, TickContext &context) const;
+};
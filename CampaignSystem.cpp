@@ -2,6 +2,7 @@
 #include "utils.h"
 #include "ItemTemplates.h"
 #include "EnemyTemplates.h"
+#include "Log.h"
 #include <iostream>
 #include <algorithm>
 #include <ctime>
@@ -17,14 +18,14 @@ CampaignSystem::CampaignSystem()
 
 CampaignSystem::~CampaignSystem()
 {
-    cout << "[DEBUG] CampaignSystem destructor called\n";
+    LOG_DEBUG(CAMPAIGN, "CampaignSystem destructor called");
     cleanupParty();
     if (pendingTreasure)
     {
         delete pendingTreasure;
         pendingTreasure = nullptr;
     }
-    cout << "[DEBUG] CampaignSystem destructor completed\n";
+    LOG_DEBUG(CAMPAIGN, "CampaignSystem destructor completed");
 }
 
 void CampaignSystem::initializeLocations()
@@ -130,11 +131,11 @@ void CampaignSystem::createPlayerParty()
     int presetChoice = getSafeIntInput("Choose build (1-" + to_string(presets.size()) + "): ", 1, static_cast<int>(presets.size()));
 
     // Create party from selected preset
-    playerParty = HeroFactory::createPartyFromPreset(presetChoice - 1);
+    setParty(HeroFactory::createPartyFromPreset(presetChoice - 1));
 
     // Display information about created party
     cout << "\nCreated party:\n";
-    for (Player *hero : playerParty)
+    for (Player *hero : getPlayerParty())
     {
         const HeroTemplate &tmpl = HeroFactory::getHeroTemplate(hero->getHeroClass());
         cout << "- " << hero->getName() << " (" << tmpl.name << ")\n";
@@ -147,7 +148,7 @@ void CampaignSystem::createPlayerParty()
 void CampaignSystem::createPlayerPartyFromPreset(int presetIndex)
 {
     // Create party from selected preset without console output
-    playerParty = HeroFactory::createPartyFromPreset(presetIndex);
+    setParty(HeroFactory::createPartyFromPreset(presetIndex));
 }
 
 void CampaignSystem::runCampaignLoop()
@@ -166,7 +167,7 @@ void CampaignSystem::runCampaignLoop()
             // If first event is battle, replace with text or treasure
             currentEvent.type = EventType::TREASURE;
             currentEvent.description = "You found a hidden treasure!";
-            currentEvent.reward = new Item("Gold coin", "Valuable coin", ItemType::CONSUMABLE, EquipmentSlot::NONE, {{"health_restore", 10}});
+            currentEvent.reward = new Item("Gold coin", "Valuable coin", ItemType::CONSUMABLE, EquipmentSlot::NONE, {{StatType::HEALTH_RESTORE, 10}});
         }
 
         // Handle event
@@ -191,7 +192,7 @@ void CampaignSystem::runCampaignLoop()
 
         // Check if party is alive
         bool partyAlive = false;
-        for (Player *player : playerParty)
+        for (Player *player : getPlayerParty())
         {
             if (player->getCurrentHealthPoint() > 0)
             {
@@ -237,7 +238,7 @@ CampaignEvent CampaignSystem::generateRandomEvent()
         event.type = EventType::TREASURE;
         event.description = "You found a hidden treasure!";
         // Generate random item
-        Item randomItem = ItemFactory::createRandomItem();
+        Item randomItem = ItemFactory::createLoot(currentLocation.type, currentDifficulty);
         event.reward = new Item(randomItem);
     }
     else if (randomValue < 90)
@@ -261,34 +262,21 @@ CampaignEvent CampaignSystem::generateRandomEvent()
 void CampaignSystem::handleBattleEvent(const CampaignEvent &event)
 {
     // Create enemies based on difficulty
-    vector<Entity *> enemies;
+    vector<Enemy *> enemies;
     int enemyCount = 1 + (rand() % 4); // 1-4 enemies
     for (int i = 0; i < enemyCount; ++i)
     {
-        Enemy *enemy = EnemyFactory::createRandomEnemy(currentLocation.type, event.difficultyModifier);
-        enemies.push_back(enemy);
+        enemies.push_back(EnemyFactory::createRandomEnemy(currentLocation.type, event.difficultyModifier));
     }
 
     // Calculate total experience
     pendingExperience = 0;
-    for (Entity *enemy : enemies)
+    for (Enemy *enemy : enemies)
     {
-        pendingExperience += static_cast<Enemy *>(enemy)->getExperienceValue();
+        pendingExperience += enemy->getExperienceValue();
     }
 
-    // Convert Player* to Entity*
-    vector<Entity *> playerEntities;
-    for (Player *player : playerParty)
-    {
-        playerEntities.push_back(player);
-    }
-
-    // Create battle system
-    currentBattle = new BattleSystem();
-    currentBattle->startBattle(playerEntities, enemies);
-
-    // Set pending for GUI
-    pendingBattle = true;
+    startCampaignBattle(enemies);
 }
 
 void CampaignSystem::handleTreasureEvent(const CampaignEvent &event)
@@ -346,7 +334,7 @@ void CampaignSystem::handleExitEvent(const CampaignEvent &event)
                 currentDifficulty++;
 
                 // Restore health of all party members upon transitioning to new location
-                for (Player *player : playerParty)
+                for (Player *player : getPlayerParty())
                 {
                     if (player && player->getCurrentHealthPoint() > 0)
                     {
@@ -376,32 +364,46 @@ void CampaignSystem::handleExitEvent(const CampaignEvent &event)
 
 void CampaignSystem::handleBossBattleEvent(const CampaignEvent &event)
 {
-    // Create the final boss
-    vector<Entity *> bossParty;
-    Enemy *finalBoss = new Enemy("Lord of Darkness", 300, 25, 10, 8, 3, 3, 15, 2, AbilityType::LIFE_STEAL, 200, 5, "final_boss", 0.1);
-    bossParty.push_back(finalBoss);
+    // Create the final boss with a couple of minions
+    startCampaignBattle(EnemyFactory::createBossParty());
+}
 
-    // Add a couple of minions (not from the castle)
-    Enemy *minion1 = EnemyFactory::createEnemyByName("Vampire", 2);
-    Enemy *minion2 = EnemyFactory::createEnemyByName("Troglodyte", 2);
-    bossParty.push_back(minion1);
-    bossParty.push_back(minion2);
+void CampaignSystem::startCampaignBattle(const vector<Enemy *> &enemies)
+{
+    // A battle left pending is dropped together with its enemies
+    clearPendingBattle();
+
+    vector<Entity *> enemyEntities;
+    for (Enemy *enemy : enemies)
+    {
+        battleEnemies.push_back(entities.insert(unique_ptr<Entity>(enemy)));
+        enemyEntities.push_back(enemy);
+    }
 
     // Convert Player* to Entity*
     vector<Entity *> playerEntities;
-    for (Player *player : playerParty)
+    for (Player *player : getPlayerParty())
     {
         playerEntities.push_back(player);
     }
 
     // Create battle system
     currentBattle = new BattleSystem();
-    currentBattle->startBattle(playerEntities, bossParty);
+    currentBattle->startBattle(playerEntities, enemyEntities);
 
     // Set pending for GUI
     pendingBattle = true;
 }
 
+void CampaignSystem::releaseBattleEnemies()
+{
+    for (EntityHandle handle : battleEnemies)
+    {
+        entities.erase(handle);
+    }
+    battleEnemies.clear();
+}
+
 void CampaignSystem::displayLocationInfo()
 {
     cout << "\n+================================================================+\n";
@@ -483,17 +485,17 @@ void CampaignSystem::runMapMode()
         }
 
         // Проверяем, жив ли отряд
-        cout << "[DEBUG] Checking party status, party size: " << playerParty.size() << "\n";
+        LOG_DEBUG(MAP, "Checking party status, party size: " << playerParty.size());
         bool partyAlive = false;
-        for (Player *player : playerParty)
+        for (Player *player : getPlayerParty())
         {
             if (player)
             {
-                cout << "[DEBUG] Player " << player->getName() << " HP: " << player->getCurrentHealthPoint() << "\n";
+                LOG_TRACE(MAP, "Player " << player->getName() << " HP: " << player->getCurrentHealthPoint());
                 if (player->getCurrentHealthPoint() > 0)
                 {
                     partyAlive = true;
-                    cout << "[DEBUG] Found alive player: " << player->getName() << "\n";
+                    LOG_TRACE(MAP, "Found alive player: " << player->getName());
                     break;
                 }
             }
@@ -502,7 +504,7 @@ void CampaignSystem::runMapMode()
         if (!partyAlive)
         {
             cout << "\n[SKULL] Your party has fallen in battle! Game over.\n";
-            cout << "[DEBUG] Breaking from runMapMode loop\n";
+            LOG_DEBUG(MAP, "Breaking from runMapMode loop");
             break;
         }
     }
@@ -584,7 +586,7 @@ void CampaignSystem::handleNodeEvent(NodeType nodeType)
     }
     case NodeType::TREASURE:
     {
-        Item randomItem = ItemFactory::createRandomItem();
+        Item randomItem = ItemFactory::createLoot(currentLocation.type, currentDifficulty);
         CampaignEvent treasureEvent{EventType::TREASURE, "You have found a hidden treasure!", {}, {}, new Item(randomItem), 0};
         handleTreasureEvent(treasureEvent);
         break;
@@ -624,7 +626,7 @@ void CampaignSystem::handleNodeEvent(NodeType nodeType)
                 "In a stream fed by forest springs, a crystal of pure water gleams.",
                 "On the branches of a sacred tree hangs the fruit of eternal youth, a gift of nature."};
             int descIdx = rand() % 3;
-            Item randomItem = ItemFactory::createRandomItem();
+            Item randomItem = ItemFactory::createLoot(currentLocation.type, currentDifficulty);
             CampaignEvent treasureEvent{EventType::TREASURE, treasureDescs[descIdx], {}, {}, new Item(randomItem), 0};
             handleTreasureEvent(treasureEvent);
         }
@@ -637,7 +639,7 @@ void CampaignSystem::handleNodeEvent(NodeType nodeType)
         else
         {
             // Treasure variant
-            Item randomItem = ItemFactory::createRandomItemOfType(ItemType::ACCESSORY);
+            Item randomItem = ItemFactory::createLoot(currentLocation.type, currentDifficulty, ItemType::ACCESSORY);
             CampaignEvent treasureEvent{EventType::TREASURE, "In the thicket, you find a forgotten altar with a magical artifact.", {}, {}, new Item(randomItem), 0};
             handleTreasureEvent(treasureEvent);
         }
@@ -664,7 +666,7 @@ void CampaignSystem::handleNodeEvent(NodeType nodeType)
                 "Among the stalactites gleams an ancient crystal holding secrets of the underworld.",
                 "In an abandoned mine, you unearthed a magical gem capable of controlling the elements."};
             int descIdx = rand() % 3;
-            Item randomItem = ItemFactory::createRandomItem();
+            Item randomItem = ItemFactory::createLoot(currentLocation.type, currentDifficulty);
             CampaignEvent treasureEvent{EventType::TREASURE, treasureDescs[descIdx], {}, {}, new Item(randomItem), 0};
             handleTreasureEvent(treasureEvent);
         }
@@ -677,7 +679,7 @@ void CampaignSystem::handleNodeEvent(NodeType nodeType)
         else
         {
             // Treasure variant
-            Item randomItem = ItemFactory::createRandomItemOfType(ItemType::WEAPON);
+            Item randomItem = ItemFactory::createLoot(currentLocation.type, currentDifficulty, ItemType::WEAPON);
             CampaignEvent treasureEvent{EventType::TREASURE, "In a secret chamber, you find ancient weapons forgotten through the ages.", {}, {}, new Item(randomItem), 0};
             handleTreasureEvent(treasureEvent);
         }
@@ -704,7 +706,7 @@ void CampaignSystem::handleNodeEvent(NodeType nodeType)
                 "Among the dusty ruins gleams a golden amulet that protected ancient rulers.",
                 "In the city's forgotten treasury, you unearthed a magical artifact full of dark energy."};
             int descIdx = rand() % 3;
-            Item randomItem = ItemFactory::createRandomItem();
+            Item randomItem = ItemFactory::createLoot(currentLocation.type, currentDifficulty);
             CampaignEvent treasureEvent{EventType::TREASURE, treasureDescs[descIdx], {}, {}, new Item(randomItem), 0};
             handleTreasureEvent(treasureEvent);
         }
@@ -717,7 +719,7 @@ void CampaignSystem::handleNodeEvent(NodeType nodeType)
         else
         {
             // Treasure variant
-            Item randomItem = ItemFactory::createRandomItemOfType(ItemType::ARMOR);
+            Item randomItem = ItemFactory::createLoot(currentLocation.type, currentDifficulty, ItemType::ARMOR);
             CampaignEvent treasureEvent{EventType::TREASURE, "In the dungeons of the dead city, you find the armor of an ancient hero.", {}, {}, new Item(randomItem), 0};
             handleTreasureEvent(treasureEvent);
         }
@@ -745,9 +747,10 @@ void CampaignSystem::manageInventory(Player *player)
         // Character selection for inventory management
         cout << "\n=== CHARACTER SELECTION ===\n";
         cout << "Choose a character to manage inventory:\n";
-        for (int i = 0; i < playerParty.size(); ++i)
+        vector<Player *> party = getPlayerParty();
+        for (int i = 0; i < party.size(); ++i)
         {
-            cout << i + 1 << ". " << playerParty[i]->getName() << " (HP: " << playerParty[i]->getCurrentHealthPoint() << "/" << playerParty[i]->getMaxHealthPoint() << ")\n";
+            cout << i + 1 << ". " << party[i]->getName() << " (HP: " << party[i]->getCurrentHealthPoint() << "/" << party[i]->getMaxHealthPoint() << ")\n";
         }
         cout << playerParty.size() + 1 << ". Exit inventory management\n";
 
@@ -755,7 +758,7 @@ void CampaignSystem::manageInventory(Player *player)
 
         if (heroChoice > 0 && heroChoice <= static_cast<int>(playerParty.size()))
         {
-            player = playerParty[heroChoice - 1];
+            player = party[heroChoice - 1];
         }
         else if (heroChoice == playerParty.size() + 1)
         {
@@ -773,7 +776,7 @@ void CampaignSystem::manageInventory(Player *player)
     {
         cout << "\n=== INVENTORY MANAGEMENT ===\n";
         cout << "Hero: " << player->getName() << "\n\n";
-        cout << "[DEBUG] manageInventory called, partyInventory size: " << partyInventory.size() << ", player inventory size: " << player->getInventory().size() << "\n";
+        LOG_DEBUG(CAMPAIGN, "manageInventory called, partyInventory size: " << partyInventory.size() << ", player inventory size: " << player->getInventory().size());
 
         player->displayInventory();
         cout << "\n";
@@ -800,14 +803,14 @@ void CampaignSystem::manageInventory(Player *player)
             cout << "Choose item to equip:\n";
             for (int i = 0; i < player->getInventory().size(); ++i)
             {
-                cout << i + 1 << ". " << player->getInventory()[i].getName() << "\n";
+                cout << i + 1 << ". " << player->getInventory().at(i).getName() << "\n";
             }
 
             int itemChoice = getSafeIntInput("Choose item (1-" + to_string(player->getInventory().size()) + "): ", 1, static_cast<int>(player->getInventory().size()));
 
             if (itemChoice > 0 && itemChoice <= static_cast<int>(player->getInventory().size()))
             {
-                player->equipItem(itemChoice - 1);
+                player->equipItem(player->getInventory().handleAt(itemChoice - 1));
             }
             else
             {
@@ -883,14 +886,14 @@ void CampaignSystem::manageInventory(Player *player)
             cout << "Choose item to use:\n";
             for (int i = 0; i < player->getInventory().size(); ++i)
             {
-                cout << i + 1 << ". " << player->getInventory()[i].getName() << "\n";
+                cout << i + 1 << ". " << player->getInventory().at(i).getName() << "\n";
             }
 
             int itemChoice = getSafeIntInput("Choose item (1-" + to_string(player->getInventory().size()) + "): ", 1, static_cast<int>(player->getInventory().size()));
 
             if (itemChoice > 0 && itemChoice <= static_cast<int>(player->getInventory().size()))
             {
-                player->useConsumable(itemChoice - 1);
+                player->useConsumable(player->getInventory().handleAt(itemChoice - 1));
             }
             else
             {
@@ -909,15 +912,16 @@ void CampaignSystem::manageInventory(Player *player)
             cout << "Party inventory:\n";
             for (int i = 0; i < partyInventory.size(); ++i)
             {
-                cout << i + 1 << ". " << partyInventory[i].getName() << "\n";
+                cout << i + 1 << ". " << partyInventory.at(i).getName() << "\n";
             }
 
             int itemChoice = getSafeIntInput("Choose item to take (1-" + to_string(partyInventory.size()) + "): ", 1, static_cast<int>(partyInventory.size()));
 
             if (itemChoice > 0 && itemChoice <= static_cast<int>(partyInventory.size()))
             {
-                player->addItem(partyInventory[itemChoice - 1]);
-                partyInventory.erase(partyInventory.begin() + itemChoice - 1);
+                ItemHandle handle = partyInventory.handleAt(itemChoice - 1);
+                player->addItem(*partyInventory.find(handle));
+                partyInventory.erase(handle);
                 cout << "Item taken to personal inventory.\n";
             }
             else
@@ -971,7 +975,7 @@ void CampaignSystem::handleEventChoice(int choiceIndex)
         break;
     case EventType::TREASURE:
     {
-        Item randomItem = ItemFactory::createRandomItem();
+        Item randomItem = ItemFactory::createLoot(currentLocation.type, currentDifficulty);
         handleTreasureEvent(CampaignEvent{EventType::TREASURE, consequenceDescription, {}, {}, new Item(randomItem), 0});
         break;
     }
@@ -1000,7 +1004,7 @@ void CampaignSystem::handleExitChoice(int choiceIndex)
     currentDifficulty++;
 
     // Restore health of all party members upon transitioning to new location
-    for (Player *player : playerParty)
+    for (Player *player : getPlayerParty())
     {
         if (player && player->getCurrentHealthPoint() > 0)
         {
@@ -1011,16 +1015,22 @@ void CampaignSystem::handleExitChoice(int choiceIndex)
 
 void CampaignSystem::cleanupParty()
 {
-    cout << "[DEBUG] CampaignSystem::cleanupParty() called, party size: " << playerParty.size() << "\n";
-    for (Player *player : playerParty)
+    LOG_DEBUG(CAMPAIGN, "CampaignSystem::cleanupParty() called, party size: " << playerParty.size());
+    clearPendingBattle();
+    // The store owns every hero and enemy: clearing it deletes them and invalidates their handles
+    entities.clear();
+    playerParty.clear();
+    partyMembers.clear();
+    LOG_DEBUG(CAMPAIGN, "CampaignSystem::cleanupParty() completed");
+}
+
+void CampaignSystem::setParty(const vector<Player *> &heroes)
+{
+    cleanupParty();
+    for (Player *hero : heroes)
     {
-        if (player)
-        {
-            cout << "[DEBUG] Deleting player: " << player->getName() << "\n";
-            delete player;
-            player = nullptr;
-        }
+        playerParty.push_back(entities.insert(unique_ptr<Entity>(hero)));
+        if (hero)
+            partyMembers.push_back(hero);
     }
-    playerParty.clear();
-    cout << "[DEBUG] CampaignSystem::cleanupParty() completed\n";
 }
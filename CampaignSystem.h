@@ -1,6 +1,7 @@
 #pragma once
 #include "entity.h"
 #include "BattleSystem.h"
+#include "EntityStore.h"
 #include "EnemyTemplates.h"
 #include "HeroTemplates.h"
 #include "Map.h"
@@ -48,14 +49,17 @@ struct Location
 class CampaignSystem
 {
 private:
-    std::vector<Player *> playerParty;          // Player party
+    EntityStore entities;                       // Owns the party and the enemies of the current battle
+    std::vector<EntityHandle> playerParty;      // Player party
+    std::vector<Player *> partyMembers;         // playerParty resolved once; kept in step by setParty/cleanupParty
+    std::vector<EntityHandle> battleEnemies;    // Enemies of the current battle, released with it
     Location currentLocation;                   // Current location
     std::map<LocationType, Location> locations; // All locations
     Map gameMap;                                // Game map
     int currentDifficulty = 0;                  // Current difficulty
     bool gameCompleted = false;                 // Game completion flag
     std::map<Position, bool> visitedNodes;      // Visited nodes on map
-    std::vector<Item> partyInventory;           // Shared party inventory
+    Inventory partyInventory;                   // Shared party inventory
     Item *pendingTreasure = nullptr;            // Pending treasure for GUI
     CampaignEvent pendingEvent;                 // Pending event for GUI
     CampaignEvent pendingExit;                  // Pending exit for GUI
@@ -76,6 +80,9 @@ private:
     void displayAvailableConnections();
     bool moveToLocation(LocationType targetLocation);
     void cleanupParty();
+    void setParty(const std::vector<Player *> &heroes);
+    void startCampaignBattle(const std::vector<Enemy *> &enemies);
+    void releaseBattleEnemies();
     void runMapMode();
     char getPlayerMovementInput();
     void displayMap();
@@ -84,6 +91,9 @@ private:
 public:
     CampaignSystem();
     ~CampaignSystem();
+    // partyMembers points into the entity store, which a copy would clone
+    CampaignSystem(const CampaignSystem &) = delete;
+    CampaignSystem &operator=(const CampaignSystem &) = delete;
 
     // Main methods
     void startCampaign();
@@ -95,9 +105,10 @@ public:
     void setGameCompleted(bool completed) { gameCompleted = completed; }
 
     // Methods for getting information
-    const std::vector<Player *> &getPlayerParty() const { return playerParty; }
-    const std::vector<Item> &getPartyInventory() const { return partyInventory; }
-    std::vector<Item> &getPartyInventoryMutable() { return partyInventory; }
+    // Party members resolved from the entity store
+    const std::vector<Player *> &getPlayerParty() const { return partyMembers; }
+    const Inventory &getPartyInventory() const { return partyInventory; }
+    Inventory &getPartyInventoryMutable() { return partyInventory; }
     const Location &getCurrentLocation() const { return currentLocation; }
     const Location &getLocation(LocationType type) const { return locations.at(type); }
     int getCurrentDifficulty() const { return currentDifficulty; }
@@ -124,7 +135,7 @@ public:
     {
         if (pendingTreasure)
         {
-            partyInventory.push_back(*pendingTreasure);
+            partyInventory.insert(*pendingTreasure);
         }
         clearPendingTreasure();
     }
@@ -138,6 +149,7 @@ public:
             delete currentBattle;
             currentBattle = nullptr;
         }
+        releaseBattleEnemies();
     }
     void handleEventChoice(int choiceIndex);
     void handleExitChoice(int choiceIndex);
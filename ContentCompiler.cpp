@@ -0,0 +1,707 @@
+#include "Tools.h"
+#include "ContentPack.h"
+#include "HeroTemplates.h"
+#include "EnemyTemplates.h"
+#include "ItemTemplates.h"
+#include "mapPrototypesData.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Пакет контента (ContentPack.h): сборка из текстового описания и выгрузка встроенного контента в текст.
+//
+// Формат ("#" в начале строки - комментарий). Запись начинается строкой без отступа,
+// ее поля - строки с отступом вида "<ключ> <значение>":
+//   ability <способность>     name, description, effect <текст>; stamina <n>; area 0|1
+//   hero <класс>              name, description <текст>; progression <тип>; ability <способность>;
+//                             abilities <способность>...; hp, damage, defense, attack, stamina,
+//                             initiative, range <n>; loner 0|1; variance <x>
+//   preset <имя>              description <текст>; member <класс> <имя героя> - по строке на героя
+//   enemy <локация> <имя>     type <тип>; ability <способность>; hp, damage, defense, attack, stamina,
+//                             initiative, range, exp, difficulty, spawn <n>; variance <x>
+//   item <тип> <имя>          slot <слот>; description <текст>; stat <характеристика> <n>
+//   map <локация>             15 строк по 15 клеток (символы Map: . I B S P V ? F C D Z R)
+// Имена перечислений - как в коде, строчными буквами (shield_wall, dead_city, main_hand).
+// В текстах "\n" - перевод строки. Имя предмета пишется без описания статов: сборка дописывает
+// его так же, как ItemFactory, и игра видит те же имена.
+namespace
+{
+    const char *const abilityNames[] = {"none", "flying", "poison", "fire_damage", "ice_damage", "lightning", "heal",
+                                        "teleport", "invisible", "life_steal", "regeneration", "fear", "berserk",
+                                        "charge", "shield_wall", "battle_cry", "magic_missile", "chain_lightning",
+                                        "flame_burst", "blood_ritual", "healing_wave", "command", "frost_armor",
+                                        "stealth", "shadow_step", "arcane_missile"};
+    const char *const heroClassNames[] = {"warrior", "paladin", "barbarian", "rogue", "ranger",
+                                          "mage", "warlock", "druid", "loner"};
+    const char *const progressionNames[] = {"level_based", "skill_points", "mastery", "sacrifice", "transcendence"};
+    const char *const locationNames[] = {"forest", "cave", "dead_city", "castle"};
+    const char *const itemTypeNames[] = {"weapon", "armor", "accessory", "consumable"};
+    const char *const slotNames[] = {"head", "chest", "hands", "legs", "feet", "main_hand",
+                                     "off_hand", "neck", "ring1", "ring2", "none"};
+    const char mapCells[] = ".IBSPV?FCDZR";
+
+    static_assert(std::size(abilityNames) == ABILITY_TYPE_COUNT, "abilityNames must cover AbilityType");
+    static_assert(std::size(heroClassNames) == HERO_CLASS_COUNT, "heroClassNames must cover HeroClass");
+    static_assert(std::size(locationNames) == LOCATION_TYPE_COUNT, "locationNames must cover LocationType");
+    static_assert(std::size(itemTypeNames) == ITEM_TYPE_COUNT, "itemTypeNames must cover ItemType");
+    static_assert(std::size(slotNames) == static_cast<std::size_t>(EquipmentSlot::NONE) + 1, "slotNames must cover EquipmentSlot");
+
+    std::runtime_error syntaxError(int line, const std::string &message)
+    {
+        return std::runtime_error("content, line " + std::to_string(line) + ": " + message);
+    }
+
+    template <std::size_t N>
+    uint8_t parseName(int line, const char *const (&names)[N], const std::string &text, const char *what)
+    {
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            if (text == names[i])
+                return static_cast<uint8_t>(i);
+        }
+        throw syntaxError(line, std::string("unknown ") + what + " '" + text + "'");
+    }
+
+    int parseInt(int line, const std::string &text, int minValue, int maxValue)
+    {
+        std::size_t used = 0;
+        long long value = 0;
+        try
+        {
+            value = std::stoll(text, &used);
+        }
+        catch (const std::exception &)
+        {
+            used = 0;
+        }
+        if (used == 0 || used != text.size() || value < minValue || value > maxValue)
+            throw syntaxError(line, "expected an integer " + std::to_string(minValue) + ".." + std::to_string(maxValue) + ", got '" + text + "'");
+        return static_cast<int>(value);
+    }
+
+    double parseNumber(int line, const std::string &text)
+    {
+        std::size_t used = 0;
+        double value = -1.0;
+        try
+        {
+            value = std::stod(text, &used);
+        }
+        catch (const std::exception &)
+        {
+            used = 0;
+        }
+        if (used == 0 || used != text.size() || value < 0.0)
+            throw syntaxError(line, "expected a non-negative number, got '" + text + "'");
+        return value;
+    }
+
+    std::string escapeText(const std::string &text)
+    {
+        std::string result;
+        for (char c : text)
+        {
+            if (c == '\n')
+                result += "\\n";
+            else if (c == '\\')
+                result += "\\\\";
+            else
+                result += c;
+        }
+        return result;
+    }
+
+    std::string unescapeText(const std::string &text)
+    {
+        std::string result;
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] == '\\' && i + 1 < text.size() && (text[i + 1] == 'n' || text[i + 1] == '\\'))
+            {
+                result += text[i + 1] == 'n' ? '\n' : '\\';
+                ++i;
+            }
+            else
+            {
+                result += text[i];
+            }
+        }
+        return result;
+    }
+
+    // Кратчайшая запись, которая читается обратно в то же число
+    std::string formatNumber(double value)
+    {
+        std::ostringstream out;
+        out << value;
+        if (std::stod(out.str()) != value)
+        {
+            out.str("");
+            out.precision(17);
+            out << value;
+        }
+        return out.str();
+    }
+
+    // Имя шаблона предмета без описания статов: "Rusty Sword (attack +1, damage +8)" -> "Rusty Sword"
+    std::string baseItemName(const std::string &name)
+    {
+        std::size_t bracket = name.find(" (");
+        return bracket == std::string::npos ? name : name.substr(0, bracket);
+    }
+
+    // Строка текста, разобранная на ключ и остаток
+    struct SourceLine
+    {
+        int line;
+        std::string key;
+        std::string value; // Без ведущих и хвостовых пробелов
+    };
+
+    SourceLine splitLine(int line, const std::string &text)
+    {
+        std::size_t start = text.find_first_not_of(" \t");
+        std::size_t end = text.find_last_not_of(" \t\r");
+        std::string trimmed = text.substr(start, end - start + 1);
+        std::size_t space = trimmed.find_first_of(" \t");
+        if (space == std::string::npos)
+            return {line, trimmed, ""};
+        std::size_t valueStart = trimmed.find_first_not_of(" \t", space);
+        return {line, trimmed.substr(0, space), trimmed.substr(valueStart)};
+    }
+
+    // Первое слово значения и остаток: "dead_city Skeleton warrior" -> "dead_city", "Skeleton warrior"
+    std::pair<std::string, std::string> splitWord(const SourceLine &source, const char *what)
+    {
+        if (source.value.empty())
+            throw syntaxError(source.line, std::string("expected ") + what);
+        SourceLine parts = splitLine(source.line, source.value);
+        if (parts.value.empty())
+            throw syntaxError(source.line, std::string("expected ") + what);
+        return {parts.key, parts.value};
+    }
+
+    struct SourceRecord
+    {
+        SourceLine header;
+        std::vector<SourceLine> fields;
+    };
+
+    class StringPool
+    {
+    public:
+        StringPool() { m_data.push_back('\0'); } // Смещение 0 - пустая строка
+
+        PackString add(const std::string &text)
+        {
+            if (text.empty())
+                return 0;
+            auto it = m_offsets.find(text);
+            if (it != m_offsets.end())
+                return it->second;
+            PackString offset = static_cast<PackString>(m_data.size());
+            m_data.insert(m_data.end(), text.begin(), text.end());
+            m_data.push_back('\0');
+            m_offsets.emplace(text, offset);
+            return offset;
+        }
+
+        const std::vector<char> &data() const { return m_data; }
+
+    private:
+        std::vector<char> m_data;
+        std::unordered_map<std::string, PackString> m_offsets;
+    };
+
+    // Содержимое пакета до записи
+    struct PackContents
+    {
+        std::vector<PackAbility> abilities;
+        std::vector<PackHero> heroes;
+        std::vector<uint8_t> heroAbilities;
+        std::vector<PackPreset> presets;
+        std::vector<PackPresetMember> presetMembers;
+        std::vector<PackEnemy> enemies;
+        std::vector<PackItem> items;
+        std::vector<PackMapPrototype> mapPrototypes;
+        StringPool strings;
+    };
+
+    std::vector<SourceRecord> readRecords(std::istream &input)
+    {
+        std::vector<SourceRecord> records;
+        std::string text;
+        int line = 0;
+        while (std::getline(input, text))
+        {
+            ++line;
+            std::size_t start = text.find_first_not_of(" \t\r");
+            if (start == std::string::npos || text[start] == '#')
+                continue;
+            SourceLine source = splitLine(line, text);
+            if (start == 0)
+            {
+                records.push_back({source, {}});
+            }
+            else
+            {
+                if (records.empty())
+                    throw syntaxError(line, "field outside of a record");
+                records.back().fields.push_back(source);
+            }
+        }
+        return records;
+    }
+
+    void compileAbility(const SourceRecord &record, PackContents &pack)
+    {
+        PackAbility ability = {};
+        ability.type = parseName(record.header.line, abilityNames, record.header.value, "ability");
+        for (const SourceLine &field : record.fields)
+        {
+            if (field.key == "name")
+                ability.name = pack.strings.add(unescapeText(field.value));
+            else if (field.key == "description")
+                ability.description = pack.strings.add(unescapeText(field.value));
+            else if (field.key == "effect")
+                ability.effect = pack.strings.add(unescapeText(field.value));
+            else if (field.key == "stamina")
+                ability.staminaCost = static_cast<uint16_t>(parseInt(field.line, field.value, 0, 1000));
+            else if (field.key == "area")
+                ability.isAreaEffect = static_cast<uint8_t>(parseInt(field.line, field.value, 0, 1));
+            else
+                throw syntaxError(field.line, "unknown ability field '" + field.key + "'");
+        }
+        for (const PackAbility &other : pack.abilities)
+        {
+            if (other.type == ability.type)
+                throw syntaxError(record.header.line, "duplicate ability '" + record.header.value + "'");
+        }
+        pack.abilities.push_back(ability);
+    }
+
+    void compileHero(const SourceRecord &record, PackContents &pack)
+    {
+        PackHero hero = {};
+        hero.heroClass = parseName(record.header.line, heroClassNames, record.header.value, "hero class");
+        hero.damageVariance = 0.2;
+        hero.firstAbility = static_cast<uint32_t>(pack.heroAbilities.size());
+        for (const SourceLine &field : record.fields)
+        {
+            if (field.key == "name")
+                hero.name = pack.strings.add(unescapeText(field.value));
+            else if (field.key == "description")
+                hero.description = pack.strings.add(unescapeText(field.value));
+            else if (field.key == "progression")
+                hero.progressionType = parseName(field.line, progressionNames, field.value, "progression type");
+            else if (field.key == "ability")
+                hero.baseAbility = parseName(field.line, abilityNames, field.value, "ability");
+            else if (field.key == "abilities")
+            {
+                std::istringstream words(field.value);
+                std::string word;
+                while (words >> word)
+                {
+                    pack.heroAbilities.push_back(parseName(field.line, abilityNames, word, "ability"));
+                    ++hero.abilityCount;
+                }
+            }
+            else if (field.key == "hp")
+                hero.maxHP = parseInt(field.line, field.value, 1, 100000);
+            else if (field.key == "damage")
+                hero.damage = parseInt(field.line, field.value, 0, 100000);
+            else if (field.key == "defense")
+                hero.defense = parseInt(field.line, field.value, 0, 100000);
+            else if (field.key == "attack")
+                hero.attack = parseInt(field.line, field.value, 0, 100000);
+            else if (field.key == "stamina")
+                hero.maxStamina = parseInt(field.line, field.value, 0, 1000);
+            else if (field.key == "initiative")
+                hero.initiative = parseInt(field.line, field.value, 0, 1000);
+            else if (field.key == "range")
+                hero.attackRange = parseInt(field.line, field.value, 0, 100);
+            else if (field.key == "loner")
+                hero.isLoner = static_cast<uint8_t>(parseInt(field.line, field.value, 0, 1));
+            else if (field.key == "variance")
+                hero.damageVariance = parseNumber(field.line, field.value);
+            else
+                throw syntaxError(field.line, "unknown hero field '" + field.key + "'");
+        }
+        for (const PackHero &other : pack.heroes)
+        {
+            if (other.heroClass == hero.heroClass)
+                throw syntaxError(record.header.line, "duplicate hero class '" + record.header.value + "'");
+        }
+        pack.heroes.push_back(hero);
+    }
+
+    void compilePreset(const SourceRecord &record, PackContents &pack)
+    {
+        if (record.header.value.empty())
+            throw syntaxError(record.header.line, "'preset' expects a name");
+        PackPreset preset = {};
+        preset.name = pack.strings.add(record.header.value);
+        preset.firstMember = static_cast<uint32_t>(pack.presetMembers.size());
+        for (const SourceLine &field : record.fields)
+        {
+            if (field.key == "description")
+            {
+                preset.description = pack.strings.add(unescapeText(field.value));
+            }
+            else if (field.key == "member")
+            {
+                std::pair<std::string, std::string> member = splitWord(field, "a hero class and a name");
+                PackPresetMember packed = {};
+                packed.heroClass = parseName(field.line, heroClassNames, member.first, "hero class");
+                packed.name = pack.strings.add(member.second);
+                pack.presetMembers.push_back(packed);
+                ++preset.memberCount;
+            }
+            else
+            {
+                throw syntaxError(field.line, "unknown preset field '" + field.key + "'");
+            }
+        }
+        if (preset.memberCount == 0)
+            throw syntaxError(record.header.line, "preset has no members");
+        pack.presets.push_back(preset);
+    }
+
+    void compileEnemy(const SourceRecord &record, PackContents &pack)
+    {
+        std::pair<std::string, std::string> header = splitWord(record.header, "a location and a name");
+        PackEnemy enemy = {};
+        enemy.location = parseName(record.header.line, locationNames, header.first, "location");
+        enemy.name = pack.strings.add(header.second);
+        enemy.damageVariance = 0.2;
+        enemy.spawnWeight = 1;
+        for (const SourceLine &field : record.fields)
+        {
+            if (field.key == "type")
+                enemy.type = pack.strings.add(field.value);
+            else if (field.key == "ability")
+                enemy.ability = parseName(field.line, abilityNames, field.value, "ability");
+            else if (field.key == "hp")
+                enemy.maxHP = parseInt(field.line, field.value, 1, 100000);
+            else if (field.key == "damage")
+                enemy.damage = parseInt(field.line, field.value, 0, 100000);
+            else if (field.key == "defense")
+                enemy.defense = parseInt(field.line, field.value, 0, 100000);
+            else if (field.key == "attack")
+                enemy.attack = parseInt(field.line, field.value, 0, 100000);
+            else if (field.key == "stamina")
+                enemy.maxStamina = parseInt(field.line, field.value, 0, 1000);
+            else if (field.key == "initiative")
+                enemy.initiative = parseInt(field.line, field.value, 0, 1000);
+            else if (field.key == "range")
+                enemy.attackRange = parseInt(field.line, field.value, 0, 100);
+            else if (field.key == "exp")
+                enemy.expValue = parseInt(field.line, field.value, 0, 1000000);
+            else if (field.key == "difficulty")
+                enemy.difficulty = parseInt(field.line, field.value, 0, 1000);
+            else if (field.key == "spawn")
+                enemy.spawnWeight = static_cast<uint16_t>(parseInt(field.line, field.value, 0, 65535));
+            else if (field.key == "variance")
+                enemy.damageVariance = parseNumber(field.line, field.value);
+            else
+                throw syntaxError(field.line, "unknown enemy field '" + field.key + "'");
+        }
+        pack.enemies.push_back(enemy);
+    }
+
+    void compileItem(const SourceRecord &record, PackContents &pack)
+    {
+        std::pair<std::string, std::string> header = splitWord(record.header, "an item type and a name");
+        PackItem item = {};
+        item.type = parseName(record.header.line, itemTypeNames, header.first, "item type");
+        item.slot = static_cast<uint8_t>(EquipmentSlot::NONE);
+        std::map<std::string, int> stats;
+        for (const SourceLine &field : record.fields)
+        {
+            if (field.key == "slot")
+            {
+                item.slot = parseName(field.line, slotNames, field.value, "equipment slot");
+            }
+            else if (field.key == "description")
+            {
+                item.description = pack.strings.add(unescapeText(field.value));
+            }
+            else if (field.key == "stat")
+            {
+                std::pair<std::string, std::string> stat = splitWord(field, "a stat name and a value");
+                std::size_t index = 0;
+                while (index < static_cast<std::size_t>(StatType::COUNT) && stat.first != statTypeName(static_cast<StatType>(index)))
+                    ++index;
+                if (index == static_cast<std::size_t>(StatType::COUNT))
+                    throw syntaxError(field.line, "unknown stat '" + stat.first + "'");
+                item.stats[index] = parseInt(field.line, stat.second, -100000, 100000);
+                stats[stat.first] = item.stats[index];
+            }
+            else
+            {
+                throw syntaxError(field.line, "unknown item field '" + field.key + "'");
+            }
+        }
+        std::string abilityStr = ItemFactory::generateAbilityString(stats);
+        item.name = pack.strings.add(header.second + (abilityStr.empty() ? "" : " " + abilityStr));
+        pack.items.push_back(item);
+    }
+
+    void compileMap(const SourceRecord &record, PackContents &pack)
+    {
+        PackMapPrototype prototype = {};
+        prototype.location = parseName(record.header.line, locationNames, record.header.value, "location");
+        if (record.fields.size() != PackMapPrototype::ROWS)
+            throw syntaxError(record.header.line, "map needs " + std::to_string(PackMapPrototype::ROWS) + " rows");
+        for (int y = 0; y < PackMapPrototype::ROWS; ++y)
+        {
+            const SourceLine &row = record.fields[y];
+            std::string cells = row.key + row.value;
+            if (cells.size() != static_cast<std::size_t>(PackMapPrototype::ROWS) ||
+                cells.find_first_not_of(mapCells) != std::string::npos)
+                throw syntaxError(row.line, "map row must be " + std::to_string(PackMapPrototype::ROWS) + " cells of '" + mapCells + "'");
+            std::memcpy(prototype.rows[y], cells.c_str(), cells.size() + 1);
+        }
+        pack.mapPrototypes.push_back(prototype);
+    }
+
+    PackContents compileSource(std::istream &input)
+    {
+        PackContents pack;
+        for (const SourceRecord &record : readRecords(input))
+        {
+            const std::string &kind = record.header.key;
+            if (kind == "ability")
+                compileAbility(record, pack);
+            else if (kind == "hero")
+                compileHero(record, pack);
+            else if (kind == "preset")
+                compilePreset(record, pack);
+            else if (kind == "enemy")
+                compileEnemy(record, pack);
+            else if (kind == "item")
+                compileItem(record, pack);
+            else if (kind == "map")
+                compileMap(record, pack);
+            else
+                throw syntaxError(record.header.line, "unknown record '" + kind + "'");
+        }
+        return pack;
+    }
+
+    template <typename T>
+    void writeSection(std::ofstream &file, ContentSectionEntry &entry, uint64_t &offset, const std::vector<T> &records)
+    {
+        static const char padding[8] = {};
+        std::size_t bytes = records.size() * sizeof(T);
+        entry.offset = offset;
+        entry.count = static_cast<uint32_t>(records.size());
+        if (bytes > 0)
+            file.write(reinterpret_cast<const char *>(records.data()), static_cast<std::streamsize>(bytes));
+        std::size_t aligned = (bytes + 7) & ~static_cast<std::size_t>(7);
+        file.write(padding, static_cast<std::streamsize>(aligned - bytes));
+        offset += aligned;
+    }
+
+    void writePack(const std::string &path, const PackContents &pack)
+    {
+        const std::size_t sectionCount = static_cast<std::size_t>(ContentSection::COUNT);
+        ContentPackHeader header = {};
+        std::memcpy(header.magic, ContentPack::MAGIC, sizeof(header.magic));
+        header.version = ContentPack::FILE_VERSION;
+        header.sectionCount = static_cast<uint32_t>(sectionCount);
+        ContentSectionEntry sections[sectionCount] = {};
+        for (std::size_t i = 0; i < sectionCount; ++i)
+        {
+            sections[i].recordSize = ContentPack::recordSize(static_cast<ContentSection>(i));
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("cannot open " + path);
+        // Таблица разделов пишется заглушкой и переписывается, когда известны смещения
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(sections), sizeof(sections));
+        uint64_t offset = sizeof(header) + sizeof(sections);
+
+        auto section = [&](ContentSection id) -> ContentSectionEntry & { return sections[static_cast<std::size_t>(id)]; };
+        writeSection(file, section(ContentSection::ABILITIES), offset, pack.abilities);
+        writeSection(file, section(ContentSection::HEROES), offset, pack.heroes);
+        writeSection(file, section(ContentSection::HERO_ABILITIES), offset, pack.heroAbilities);
+        writeSection(file, section(ContentSection::PRESETS), offset, pack.presets);
+        writeSection(file, section(ContentSection::PRESET_MEMBERS), offset, pack.presetMembers);
+        writeSection(file, section(ContentSection::ENEMIES), offset, pack.enemies);
+        writeSection(file, section(ContentSection::ITEMS), offset, pack.items);
+        writeSection(file, section(ContentSection::MAP_PROTOTYPES), offset, pack.mapPrototypes);
+        writeSection(file, section(ContentSection::STRINGS), offset, pack.strings.data());
+
+        file.seekp(sizeof(header));
+        file.write(reinterpret_cast<const char *>(sections), sizeof(sections));
+        if (!file)
+            throw std::runtime_error("cannot write " + path);
+    }
+
+    void exportMaps(std::ostream &out, LocationType location, const char *(&prototypes)[4][15])
+    {
+        for (const auto &prototype : prototypes)
+        {
+            out << "map " << locationNames[static_cast<std::size_t>(location)] << "\n";
+            // Часть встроенных строк длиннее карты (Map читает только первые MAP_SIZE клеток),
+            // у одного прототипа замка не хватает последней строки - она выгружается пустой
+            for (const char *row : prototype)
+            {
+                std::string cells = row ? std::string(row).substr(0, PackMapPrototype::ROWS) : "";
+                cells.resize(PackMapPrototype::ROWS, '.');
+                out << "  " << cells << "\n";
+            }
+            out << "\n";
+        }
+    }
+
+    // Встроенный контент в текстовом формате: отправная точка для правок
+    void exportBuiltin(std::ostream &out)
+    {
+        out << "# The Hunter's Path content (HuntersPath.Tools content export).\n"
+            << "# Build: HuntersPath.Tools content build --source <this file> --out content.pack\n\n";
+
+        for (std::size_t i = 0; i < ABILITY_TYPE_COUNT; ++i)
+        {
+            const AbilityInfo &info = HeroFactory::getAbilityInfo(static_cast<AbilityType>(i));
+            if (info.name.empty())
+                continue;
+            out << "ability " << abilityNames[i] << "\n"
+                << "  name " << escapeText(info.name) << "\n"
+                << "  description " << escapeText(info.description) << "\n"
+                << "  effect " << escapeText(info.effect) << "\n"
+                << "  stamina " << info.staminaCost << "\n"
+                << "  area " << (info.isAreaEffect ? 1 : 0) << "\n\n";
+        }
+
+        for (HeroClass heroClass : HeroFactory::getAvailableClasses())
+        {
+            const HeroTemplate &tmpl = HeroFactory::getHeroTemplate(heroClass);
+            out << "hero " << heroClassNames[static_cast<std::size_t>(heroClass)] << "\n"
+                << "  name " << escapeText(tmpl.name) << "\n"
+                << "  description " << escapeText(tmpl.description) << "\n"
+                << "  progression " << progressionNames[static_cast<std::size_t>(tmpl.progressionType)] << "\n"
+                << "  ability " << abilityNames[static_cast<std::size_t>(tmpl.baseAbility)] << "\n"
+                << "  abilities";
+            for (AbilityType ability : tmpl.availableAbilities)
+            {
+                out << " " << abilityNames[static_cast<std::size_t>(ability)];
+            }
+            out << "\n  hp " << tmpl.baseMaxHP << "\n  damage " << tmpl.baseDamage << "\n  defense " << tmpl.baseDefense
+                << "\n  attack " << tmpl.baseAttack << "\n  stamina " << tmpl.baseMaxStamina
+                << "\n  initiative " << tmpl.baseInitiative << "\n  range " << tmpl.baseAttackRange
+                << "\n  loner " << (tmpl.isLoner ? 1 : 0) << "\n  variance " << formatNumber(tmpl.damageVariance) << "\n\n";
+        }
+
+        for (const PartyPreset &preset : HeroFactory::getPartyPresets())
+        {
+            out << "preset " << preset.name << "\n"
+                << "  description " << escapeText(preset.description) << "\n";
+            for (const auto &member : preset.heroes)
+            {
+                out << "  member " << heroClassNames[static_cast<std::size_t>(member.first)] << " " << member.second << "\n";
+            }
+            out << "\n";
+        }
+
+        for (LocationType location : toolLocations)
+        {
+            for (const EnemyTemplate &enemy : EnemyFactory::getTemplates(location))
+            {
+                out << "enemy " << locationNames[static_cast<std::size_t>(location)] << " " << enemy.name << "\n"
+                    << "  type " << enemy.type << "\n"
+                    << "  ability " << abilityNames[static_cast<std::size_t>(enemy.ability)] << "\n"
+                    << "  hp " << enemy.maxHP << "\n  damage " << enemy.damage << "\n  defense " << enemy.defense
+                    << "\n  attack " << enemy.attack << "\n  stamina " << enemy.maxStamina
+                    << "\n  initiative " << enemy.initiative << "\n  range " << enemy.attackRange
+                    << "\n  exp " << enemy.expValue << "\n  difficulty " << enemy.difficulty
+                    << "\n  spawn " << enemy.spawnWeight << "\n  variance " << formatNumber(enemy.damageVariance) << "\n\n";
+            }
+        }
+
+        for (const ItemTemplate &item : ItemFactory::getAllItems())
+        {
+            out << "item " << itemTypeNames[static_cast<std::size_t>(item.type)] << " " << baseItemName(item.name) << "\n"
+                << "  slot " << slotNames[static_cast<std::size_t>(item.slot)] << "\n"
+                << "  description " << escapeText(item.description) << "\n";
+            for (std::size_t stat = 0; stat < static_cast<std::size_t>(StatType::COUNT); ++stat)
+            {
+                int value = item.stats[static_cast<StatType>(stat)];
+                if (value != 0)
+                    out << "  stat " << statTypeName(static_cast<StatType>(stat)) << " " << value << "\n";
+            }
+            out << "\n";
+        }
+
+        exportMaps(out, LocationType::FOREST, forestPrototypes);
+        exportMaps(out, LocationType::CAVE, cavePrototypes);
+        exportMaps(out, LocationType::DEAD_CITY, deadCityPrototypes);
+        exportMaps(out, LocationType::CASTLE, castlePrototypes);
+    }
+}
+
+int runContentCompiler(int argc, char **argv)
+{
+    std::string action = argc > 0 ? argv[0] : "";
+    std::string sourcePath = "content.txt";
+    std::string outputPath;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--source" && value)
+        {
+            sourcePath = value;
+            ++i;
+        }
+        else if (arg == "--out" && value)
+        {
+            outputPath = value;
+            ++i;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+
+    if (action == "export")
+    {
+        // Шаблоны строятся из встроенных таблиц: пакет в инструментах не подключается
+        if (outputPath.empty())
+        {
+            exportBuiltin(std::cout);
+            return 0;
+        }
+        std::ofstream file(outputPath);
+        if (!file)
+            throw std::runtime_error("cannot open " + outputPath);
+        exportBuiltin(file);
+        return 0;
+    }
+    if (action == "build")
+    {
+        if (outputPath.empty())
+            outputPath = "content.pack";
+        std::ifstream source(sourcePath);
+        if (!source)
+            throw std::runtime_error("cannot open " + sourcePath);
+        PackContents pack = compileSource(source);
+        writePack(outputPath, pack);
+        std::cerr << "content: " << pack.heroes.size() << " heroes, " << pack.abilities.size() << " abilities, "
+                  << pack.presets.size() << " presets, " << pack.enemies.size() << " enemies, " << pack.items.size()
+                  << " items, " << pack.mapPrototypes.size() << " maps -> " << outputPath << "\n";
+        return 0;
+    }
+    throw std::invalid_argument("expected 'export' or 'build', got '" + action + "'");
+}
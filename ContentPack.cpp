@@ -0,0 +1,92 @@
+#include "ContentPack.h"
+#include <cstring>
+
+const char ContentPack::MAGIC[4] = {'H', 'P', 'C', 'P'};
+std::atomic<const ContentPack *> ContentPack::s_active{nullptr};
+
+uint32_t ContentPack::recordSize(ContentSection section)
+{
+    switch (section)
+    {
+    case ContentSection::ABILITIES:
+        return sizeof(PackAbility);
+    case ContentSection::HEROES:
+        return sizeof(PackHero);
+    case ContentSection::HERO_ABILITIES:
+        return sizeof(uint8_t);
+    case ContentSection::PRESETS:
+        return sizeof(PackPreset);
+    case ContentSection::PRESET_MEMBERS:
+        return sizeof(PackPresetMember);
+    case ContentSection::ENEMIES:
+        return sizeof(PackEnemy);
+    case ContentSection::ITEMS:
+        return sizeof(PackItem);
+    case ContentSection::MAP_PROTOTYPES:
+        return sizeof(PackMapPrototype);
+    case ContentSection::STRINGS:
+        return 1;
+    case ContentSection::COUNT:
+        break;
+    }
+    return 0;
+}
+
+bool ContentPack::open(const std::string &path)
+{
+    close();
+    if (!m_file.open(path))
+        return false;
+
+    const size_t sectionCount = static_cast<size_t>(ContentSection::COUNT);
+    const size_t tableEnd = sizeof(ContentPackHeader) + sectionCount * sizeof(ContentSectionEntry);
+    ContentPackHeader header;
+    if (m_file.size() < tableEnd)
+    {
+        close();
+        return false;
+    }
+    memcpy(&header, m_file.data(), sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != FILE_VERSION ||
+        header.sectionCount != sectionCount)
+    {
+        close();
+        return false;
+    }
+
+    memcpy(m_sections, m_file.data() + sizeof(header), sizeof(m_sections));
+    for (size_t i = 0; i < sectionCount; ++i)
+    {
+        const ContentSectionEntry &entry = m_sections[i];
+        uint32_t expectedSize = recordSize(static_cast<ContentSection>(i));
+        if (entry.recordSize != expectedSize || entry.offset % 8 != 0 || entry.offset < tableEnd ||
+            entry.offset > m_file.size() || entry.count > (m_file.size() - entry.offset) / expectedSize)
+        {
+            close();
+            return false;
+        }
+    }
+
+    // Раздел строк должен заканчиваться нулем: тогда любая ссылка внутри него - законченная строка
+    const ContentSectionEntry &strings = m_sections[static_cast<size_t>(ContentSection::STRINGS)];
+    if (strings.count == 0 || m_file.data()[strings.offset + strings.count - 1] != '\0')
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ContentPack::close()
+{
+    m_file.close();
+    memset(m_sections, 0, sizeof(m_sections));
+}
+
+const char *ContentPack::text(PackString ref) const
+{
+    const ContentSectionEntry &strings = m_sections[static_cast<size_t>(ContentSection::STRINGS)];
+    if (!isOpen() || ref >= strings.count)
+        return "";
+    return reinterpret_cast<const char *>(m_file.data() + strings.offset + ref);
+}
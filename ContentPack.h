@@ -0,0 +1,184 @@
+#pragma once
+#include "entity.h"
+#include "MappedFile.h"
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// Пакет контента: герои, способности, отряды, враги, предметы и прототипы карт в одном
+// двоичном файле (собирается из текста инструментом HuntersPath.Tools content build).
+// Файл отображается в память; записи и строки читаются прямо из отображения без копирования,
+// открытие проверяет только заголовок и таблицу разделов - время не зависит от объема контента.
+
+// Строка пакета: смещение в разделе STRINGS, строки заканчиваются нулем
+using PackString = uint32_t;
+
+enum class ContentSection : uint32_t
+{
+    ABILITIES,
+    HEROES,
+    HERO_ABILITIES, // Списки способностей героев подряд (PackHero::firstAbility)
+    PRESETS,
+    PRESET_MEMBERS, // Герои отрядов подряд (PackPreset::firstMember)
+    ENEMIES,
+    ITEMS,
+    MAP_PROTOTYPES,
+    STRINGS,
+    COUNT
+};
+
+struct PackAbility
+{
+    uint8_t type; // AbilityType
+    uint8_t isAreaEffect;
+    uint16_t staminaCost;
+    PackString name;
+    PackString description;
+    PackString effect;
+};
+static_assert(sizeof(PackAbility) == 16, "PackAbility layout is part of the file format");
+
+struct PackHero
+{
+    PackString name;
+    PackString description;
+    uint8_t heroClass;       // HeroClass
+    uint8_t progressionType; // ProgressionType
+    uint8_t baseAbility;     // AbilityType
+    uint8_t isLoner;
+    int32_t maxHP;
+    int32_t damage;
+    int32_t defense;
+    int32_t attack;
+    int32_t maxStamina;
+    int32_t initiative;
+    int32_t attackRange;
+    uint32_t firstAbility;
+    uint32_t abilityCount;
+    double damageVariance;
+};
+static_assert(sizeof(PackHero) == 56, "PackHero layout is part of the file format");
+
+struct PackPreset
+{
+    PackString name;
+    PackString description;
+    uint32_t firstMember;
+    uint32_t memberCount;
+};
+static_assert(sizeof(PackPreset) == 16, "PackPreset layout is part of the file format");
+
+struct PackPresetMember
+{
+    uint32_t heroClass; // HeroClass
+    PackString name;
+};
+static_assert(sizeof(PackPresetMember) == 8, "PackPresetMember layout is part of the file format");
+
+struct PackEnemy
+{
+    PackString name;
+    PackString type;
+    uint8_t location; // LocationType
+    uint8_t ability;  // AbilityType
+    uint16_t spawnWeight;
+    int32_t maxHP;
+    int32_t damage;
+    int32_t defense;
+    int32_t attack;
+    int32_t maxStamina;
+    int32_t initiative;
+    int32_t attackRange;
+    int32_t expValue;
+    int32_t difficulty;
+    double damageVariance;
+};
+static_assert(sizeof(PackEnemy) == 56, "PackEnemy layout is part of the file format");
+
+struct PackItem
+{
+    PackString name; // Полное имя с описанием статов, как у ItemFactory
+    PackString description;
+    uint8_t type; // ItemType
+    uint8_t slot; // EquipmentSlot
+    uint16_t reserved;
+    int32_t stats[static_cast<size_t>(StatType::COUNT)];
+};
+static_assert(static_cast<size_t>(StatType::COUNT) == 15, "New stat types change PackItem: bump ContentPack::FILE_VERSION");
+static_assert(sizeof(PackItem) == 72, "PackItem layout is part of the file format");
+
+struct PackMapPrototype
+{
+    static const int ROWS = 15; // Map::MAP_SIZE
+
+    uint8_t location; // LocationType
+    uint8_t reserved[3];
+    char rows[ROWS][ROWS + 1]; // Строки карты с нулем в конце
+};
+static_assert(sizeof(PackMapPrototype) == 244, "PackMapPrototype layout is part of the file format");
+
+// Заголовок файла: за ним таблица разделов по ContentSection, затем сами разделы (выровнены на 8)
+struct ContentPackHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint32_t reserved;
+};
+static_assert(sizeof(ContentPackHeader) == 16, "ContentPackHeader layout is part of the file format");
+
+struct ContentSectionEntry
+{
+    uint64_t offset;     // От начала файла
+    uint32_t count;      // Число записей (для STRINGS - байт)
+    uint32_t recordSize; // Проверяется при открытии: другая раскладка - другой формат
+};
+static_assert(sizeof(ContentSectionEntry) == 16, "ContentSectionEntry layout is part of the file format");
+
+class ContentPack
+{
+public:
+    static const uint32_t FILE_VERSION = 1;
+    static const char MAGIC[4];
+
+    // Отобразить пакет. false - файла нет, версия или раскладка записей не совпадает, разделы выходят за файл
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    std::span<const PackAbility> abilities() const { return records<PackAbility>(ContentSection::ABILITIES); }
+    std::span<const PackHero> heroes() const { return records<PackHero>(ContentSection::HEROES); }
+    std::span<const uint8_t> heroAbilities() const { return records<uint8_t>(ContentSection::HERO_ABILITIES); }
+    std::span<const PackPreset> presets() const { return records<PackPreset>(ContentSection::PRESETS); }
+    std::span<const PackPresetMember> presetMembers() const { return records<PackPresetMember>(ContentSection::PRESET_MEMBERS); }
+    std::span<const PackEnemy> enemies() const { return records<PackEnemy>(ContentSection::ENEMIES); }
+    std::span<const PackItem> items() const { return records<PackItem>(ContentSection::ITEMS); }
+    std::span<const PackMapPrototype> mapPrototypes() const { return records<PackMapPrototype>(ContentSection::MAP_PROTOTYPES); }
+
+    // Строка из отображения; "" для ссылки за пределами раздела
+    const char *text(PackString ref) const;
+
+    // Пакет, из которого фабрики и генератор карт берут контент; nullptr - встроенный контент.
+    // Ставится до первого обращения к фабрикам: их реестры строятся один раз
+    static void setActive(const ContentPack *pack) { s_active.store(pack, std::memory_order_release); }
+    static const ContentPack *active() { return s_active.load(std::memory_order_acquire); }
+
+    // Размер записи раздела в файле
+    static uint32_t recordSize(ContentSection section);
+
+private:
+    MappedFile m_file;
+    ContentSectionEntry m_sections[static_cast<size_t>(ContentSection::COUNT)] = {};
+
+    static std::atomic<const ContentPack *> s_active;
+
+    template <typename T>
+    std::span<const T> records(ContentSection section) const
+    {
+        const ContentSectionEntry &entry = m_sections[static_cast<size_t>(section)];
+        if (!isOpen() || entry.count == 0)
+            return {};
+        return {reinterpret_cast<const T *>(m_file.data() + entry.offset), entry.count};
+    }
+};
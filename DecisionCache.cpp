@@ -0,0 +1,107 @@
+#include "DecisionCache.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    const char decisionCacheMagic[4] = {'H', 'P', 'D', 'C'};
+}
+
+bool DecisionCache::open(const string &path)
+{
+    close();
+    if (!m_file.open(path))
+        return false;
+
+    if (m_file.size() < sizeof(DecisionCacheHeader))
+    {
+        close();
+        return false;
+    }
+    DecisionCacheHeader header;
+    memcpy(&header, m_file.data(), sizeof(header));
+    if (memcmp(header.magic, decisionCacheMagic, sizeof(header.magic)) != 0 || header.version != FILE_VERSION ||
+        header.count > (m_file.size() - sizeof(header)) / sizeof(DecisionRecord))
+    {
+        close();
+        return false;
+    }
+
+    m_records = reinterpret_cast<const DecisionRecord *>(m_file.data() + sizeof(header));
+    m_count = static_cast<size_t>(header.count);
+    return true;
+}
+
+void DecisionCache::close()
+{
+    m_file.close();
+    m_records = nullptr;
+    m_count = 0;
+}
+
+const DecisionRecord *DecisionCache::find(uint64_t key) const
+{
+    if (!m_records)
+        return nullptr;
+    const DecisionRecord *end = m_records + m_count;
+    const DecisionRecord *it = lower_bound(m_records, end, key, [](const DecisionRecord &record, uint64_t k)
+                                           { return record.key < k; });
+    return it != end && it->key == key ? it : nullptr;
+}
+
+uint16_t DecisionCache::encodeAction(const CanonicalBattleState &state, const BattleAction &action)
+{
+    switch (action.type)
+    {
+    case BattleActionType::ATTACK:
+        for (size_t rank = 0; rank < state.opponents.size(); ++rank)
+        {
+            if (state.opponents[rank] == action.target)
+                return static_cast<uint16_t>(ACTION_ATTACK + rank);
+        }
+        return ACTION_END_TURN;
+    case BattleActionType::USE_ABILITY:
+        return ACTION_ABILITY;
+    case BattleActionType::END_TURN:
+    case BattleActionType::MOVE:
+        break;
+    }
+    return ACTION_END_TURN;
+}
+
+BattleAction DecisionCache::decodeAction(const CanonicalBattleState &state, const Entity *actor, uint16_t code)
+{
+    BattleAction action;
+    if (code == ACTION_ABILITY)
+    {
+        action.type = BattleActionType::USE_ABILITY;
+        action.ability = actor->getAbility();
+    }
+    else if (code >= ACTION_ATTACK && static_cast<size_t>(code - ACTION_ATTACK) < state.opponents.size())
+    {
+        action.type = BattleActionType::ATTACK;
+        action.target = state.opponents[code - ACTION_ATTACK];
+    }
+    return action;
+}
+
+void DecisionCache::write(const string &path, vector<DecisionRecord> records)
+{
+    sort(records.begin(), records.end(), [](const DecisionRecord &a, const DecisionRecord &b)
+         { return a.key < b.key; });
+
+    DecisionCacheHeader header;
+    memcpy(header.magic, decisionCacheMagic, sizeof(header.magic));
+    header.version = FILE_VERSION;
+    header.count = records.size();
+
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file)
+        throw runtime_error("cannot open " + path);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (!records.empty())
+        file.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(DecisionRecord));
+    if (!file)
+        throw runtime_error("cannot write " + path);
+}
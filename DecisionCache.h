@@ -0,0 +1,57 @@
+#pragma once
+#include "BattleStateHash.h"
+#include "BattleAI.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Одна запись кэша решений ИИ: лучшее действие для канонического состояния
+struct DecisionRecord
+{
+    uint64_t key;      // BattleStateHash
+    float value;       // Оценка: доля побед стороны ходящего после этого действия
+    uint16_t visits;   // Сколько раз действие встретилось при прогреве (с насыщением)
+    uint16_t action;   // Код действия, см. DecisionCache::encodeAction
+};
+static_assert(sizeof(DecisionRecord) == 16, "DecisionRecord layout is part of the file format");
+
+// Заголовок файла: за ним count записей, отсортированных по key
+struct DecisionCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+};
+static_assert(sizeof(DecisionCacheHeader) == 16, "DecisionCacheHeader layout is part of the file format");
+
+// Кэш решений ИИ на диске. Файл отображается в память при запуске и не копируется,
+// поиск - двоичный по отсортированному массиву записей.
+class DecisionCache
+{
+public:
+    static const uint32_t FILE_VERSION = 1;
+    static const uint16_t ACTION_END_TURN = 0;
+    static const uint16_t ACTION_ABILITY = 1;
+    static const uint16_t ACTION_ATTACK = 2; // + ранг цели среди канонических противников
+
+    // Отобразить файл кэша. false - файла нет или формат не совпадает
+    bool open(const string &path);
+    void close();
+    bool isOpen() const { return m_records != nullptr; }
+    size_t size() const { return m_count; }
+
+    const DecisionRecord *find(uint64_t key) const;
+
+    // Перевод действия в код и обратно относительно канонического состояния
+    static uint16_t encodeAction(const CanonicalBattleState &state, const BattleAction &action);
+    static BattleAction decodeAction(const CanonicalBattleState &state, const Entity *actor, uint16_t code);
+
+    // Записать записи в файл (сортирует по ключу). Бросает runtime_error при ошибке записи
+    static void write(const string &path, vector<DecisionRecord> records);
+
+private:
+    MappedFile m_file;
+    const DecisionRecord *m_records = nullptr;
+    size_t m_count = 0;
+};
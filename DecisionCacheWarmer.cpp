@@ -0,0 +1,305 @@
+#include "Tools.h"
+#include "BattleSimulator.h"
+#include "DecisionCache.h"
+#include "HeroTemplates.h"
+#include "EnemyTemplates.h"
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Прогрев кэша решений ИИ врагов. Для частых составов (финальный бой и случайные
+// встречи каждой локации против каждого пресета) прогоняются бои обычным ИИ без кэша
+// (деревья поведения и базовые правила), каждое действие врага запоминается вместе
+// с каноническим ключом состояния. По исходам боев для ключа выбирается действие
+// с лучшей долей побед врагов. В бою BattleAI проверяет кэш раньше деревьев, поэтому
+// записанное действие заменяет решение дерева в этом состоянии - так же и в проверке ниже.
+
+namespace
+{
+    struct WarmOptions
+    {
+        int battles = 200;
+        int difficulties = 3;
+        int minVisits = 8;
+        unsigned int threads = 1;
+        unsigned int seed = 20240601u;
+        std::string outputPath = "ai_decisions.cache";
+    };
+
+    // Состав боя: пресет против финального боя или случайной группы локации
+    struct WarmEncounter
+    {
+        int preset = 0;
+        bool boss = false;
+        LocationType location = LocationType::FOREST;
+        int difficulty = 0;
+    };
+
+    struct ObservedStep
+    {
+        uint64_t key;
+        uint16_t action;
+    };
+
+    struct BattleRecord
+    {
+        std::vector<ObservedStep> steps;
+        double enemyScore = 0.0; // 1 - победа врагов, 0.5 - ничья, 0 - поражение
+    };
+
+    struct ActionStats
+    {
+        long long visits = 0;
+        double score = 0.0;
+    };
+
+    std::uint64_t mixSeed(std::uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    std::vector<WarmEncounter> makeEncounters(int presetCount, int difficulties)
+    {
+        std::vector<WarmEncounter> encounters;
+        for (int preset = 0; preset < presetCount; ++preset)
+        {
+            WarmEncounter boss;
+            boss.preset = preset;
+            boss.boss = true;
+            encounters.push_back(boss);
+            for (LocationType location : toolLocations)
+            {
+                for (int difficulty = 0; difficulty < difficulties; ++difficulty)
+                {
+                    encounters.push_back({preset, false, location, difficulty});
+                }
+            }
+        }
+        return encounters;
+    }
+
+    // Один бой; observer получает каждое действие
+    SimResult playEncounter(const WarmEncounter &encounter, const std::vector<std::vector<Player>> &parties,
+                            unsigned int seed, const SimStepObserver &observer)
+    {
+        SimEncounter battle;
+        for (const Player &hero : parties[encounter.preset])
+        {
+            battle.players.emplace_back(new Player(hero));
+        }
+
+        std::mt19937 picker(seed);
+        if (encounter.boss)
+        {
+            for (Enemy *enemy : EnemyFactory::createBossParty())
+            {
+                battle.enemies.emplace_back(enemy);
+            }
+        }
+        else
+        {
+            const std::vector<EnemyTemplate> &templates = EnemyFactory::getTemplates(encounter.location);
+            int enemyCount = 1 + static_cast<int>(picker() % 4);
+            for (int i = 0; i < enemyCount; ++i)
+            {
+                const EnemyTemplate &chosen = templates[picker() % templates.size()];
+                battle.enemies.emplace_back(EnemyFactory::createEnemy(chosen, encounter.difficulty, EnemyFactory::getScaling()));
+            }
+        }
+
+        std::vector<Entity *> players;
+        std::vector<Entity *> enemies;
+        for (auto &player : battle.players)
+        {
+            players.push_back(player.get());
+        }
+        for (auto &enemy : battle.enemies)
+        {
+            enemies.push_back(enemy.get());
+        }
+        return BattleSimulator::run(players, enemies, static_cast<unsigned int>(picker()), AIPolicy::DEFAULT,
+                                    BattleSimulator::DEFAULT_MAX_STEPS, observer);
+    }
+
+    double enemyScore(const SimResult &result)
+    {
+        if (result.playerDefeat)
+            return 1.0;
+        return result.playerVictory ? 0.0 : 0.5;
+    }
+
+    // Доля побед врагов на свежих зернах (с кэшем или без - решает BattleAI)
+    double measureEnemyScore(const std::vector<WarmEncounter> &encounters, const std::vector<std::vector<Player>> &parties,
+                             const WarmOptions &options, int battles, std::uint64_t salt)
+    {
+        std::vector<double> scores(encounters.size() * battles, 0.0);
+        parallelFor(scores.size(), options.threads, [&](std::size_t index)
+        {
+            unsigned int seed = static_cast<unsigned int>(mixSeed(options.seed ^ salt ^ mixSeed(index)));
+            scores[index] = enemyScore(playEncounter(encounters[index / battles], parties, seed, SimStepObserver()));
+        });
+        double sum = 0.0;
+        for (double score : scores)
+        {
+            sum += score;
+        }
+        return scores.empty() ? 0.0 : sum / scores.size();
+    }
+}
+
+int runDecisionCacheWarmer(int argc, char **argv)
+{
+    WarmOptions options;
+    int threads = 0;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--battles")
+        {
+            options.battles = parseIntOption(arg, value, 1, 1000000);
+            ++i;
+        }
+        else if (arg == "--difficulties")
+        {
+            options.difficulties = parseIntOption(arg, value, 1, 20);
+            ++i;
+        }
+        else if (arg == "--min-visits")
+        {
+            options.minVisits = parseIntOption(arg, value, 1, 65535);
+            ++i;
+        }
+        else if (arg == "--threads")
+        {
+            threads = parseIntOption(arg, value, 0, 1024);
+            ++i;
+        }
+        else if (arg == "--seed")
+        {
+            options.seed = static_cast<unsigned int>(parseIntOption(arg, value, 0, 2147483647));
+            ++i;
+        }
+        else if (arg == "--out" && value)
+        {
+            options.outputPath = value;
+            ++i;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+    options.threads = resolveThreadCount(threads);
+
+    // Прототипы отрядов готовятся в главном потоке
+    std::vector<std::vector<Player>> parties;
+    {
+        ScopedSilence silence;
+        int presetCount = static_cast<int>(HeroFactory::getPartyPresets().size());
+        for (int preset = 0; preset < presetCount; ++preset)
+        {
+            std::vector<Player> party;
+            for (Player *hero : HeroFactory::createPartyFromPreset(preset))
+            {
+                party.push_back(*hero);
+                delete hero;
+            }
+            parties.push_back(party);
+        }
+    }
+
+    // Прогрев идет без кэша: оцениваются действия базового ИИ
+    const DecisionCache *previousCache = BattleAI::getDecisionCache();
+    BattleAI::setDecisionCache(nullptr);
+
+    std::vector<WarmEncounter> encounters = makeEncounters(static_cast<int>(parties.size()), options.difficulties);
+    std::vector<BattleRecord> records(encounters.size() * options.battles);
+    parallelFor(records.size(), options.threads, [&](std::size_t index)
+    {
+        BattleRecord &record = records[index];
+        unsigned int seed = static_cast<unsigned int>(mixSeed(options.seed ^ mixSeed(index)));
+        SimResult result = playEncounter(encounters[index / options.battles], parties, seed,
+                                         [&](const BattleSystem &battle, Entity *actor, const BattleAction &action)
+                                         {
+                                             CanonicalBattleState state = BattleStateHash::canonicalize(battle, actor);
+                                             if (!state.actorIsPlayer)
+                                                 record.steps.push_back({state.key, DecisionCache::encodeAction(state, action)});
+                                         });
+        record.enemyScore = enemyScore(result);
+    });
+
+    // Сведение по ключам идет в одном потоке - результат не зависит от числа потоков
+    std::unordered_map<uint64_t, std::map<uint16_t, ActionStats>> stats;
+    long long observed = 0;
+    for (const BattleRecord &record : records)
+    {
+        for (const ObservedStep &step : record.steps)
+        {
+            ActionStats &action = stats[step.key][step.action];
+            ++action.visits;
+            action.score += record.enemyScore;
+            ++observed;
+        }
+    }
+
+    std::vector<DecisionRecord> decisions;
+    long long covered = 0;
+    for (const auto &state : stats)
+    {
+        const ActionStats *best = nullptr;
+        uint16_t bestAction = DecisionCache::ACTION_END_TURN;
+        long long stateVisits = 0;
+        for (const auto &action : state.second)
+        {
+            stateVisits += action.second.visits;
+            if (action.second.visits < options.minVisits)
+                continue;
+            if (!best || action.second.score / action.second.visits > best->score / best->visits)
+            {
+                best = &action.second;
+                bestAction = action.first;
+            }
+        }
+        if (!best)
+            continue;
+
+        DecisionRecord decision;
+        decision.key = state.first;
+        decision.value = static_cast<float>(best->score / best->visits);
+        decision.visits = static_cast<uint16_t>(std::min<long long>(best->visits, 65535));
+        decision.action = bestAction;
+        decisions.push_back(decision);
+        covered += stateVisits;
+    }
+    DecisionCache::write(options.outputPath, decisions);
+
+    // Проверка: файл читается через отображение, ИИ с кэшем сравнивается с базовым на новых боях
+    DecisionCache cache;
+    if (!cache.open(options.outputPath))
+        throw std::runtime_error("cannot map " + options.outputPath);
+    int checkBattles = std::max(1, options.battles / 4);
+    double baseline = measureEnemyScore(encounters, parties, options, checkBattles, 0xB15Eu);
+    BattleAI::setDecisionCache(&cache);
+    double cached = measureEnemyScore(encounters, parties, options, checkBattles, 0xB15Eu);
+    BattleAI::setDecisionCache(previousCache);
+
+    std::cout << std::fixed << std::setprecision(4)
+              << "warm-cache: " << records.size() << " battles, " << observed << " enemy decisions, "
+              << stats.size() << " distinct states\n"
+              << "  written " << decisions.size() << " records to " << options.outputPath
+              << " (" << sizeof(DecisionCacheHeader) + decisions.size() * sizeof(DecisionRecord) << " bytes)\n"
+              << "  decisions covered by cached states: " << (observed > 0 ? static_cast<double>(covered) / observed : 0.0) << "\n"
+              << "  enemy score on fresh battles: base AI " << baseline << ", cached AI " << cached << "\n";
+    return 0;
+}
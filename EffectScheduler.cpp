@@ -0,0 +1,138 @@
+#include "EffectScheduler.h"
+
+void EffectScheduler::clear()
+{
+    for (size_t i = 0; i < spokeCount; ++i)
+    {
+        spokes[i].owner = nullptr;
+        for (vector<Entry> &slot : spokes[i].slots)
+        {
+            slot.clear();
+        }
+    }
+    spokeCount = 0;
+}
+
+void EffectScheduler::remap(const EntityRemap &mapping)
+{
+    for (size_t i = 0; i < spokeCount; ++i)
+    {
+        for (const auto &entry : mapping)
+        {
+            if (spokes[i].owner == entry.first)
+            {
+                spokes[i].owner = entry.second;
+                break;
+            }
+        }
+    }
+}
+
+EffectScheduler::Spoke *EffectScheduler::findSpoke(const Entity *owner)
+{
+    for (size_t i = 0; i < spokeCount; ++i)
+    {
+        if (spokes[i].owner == owner)
+            return &spokes[i];
+    }
+    return nullptr;
+}
+
+EffectScheduler::Spoke &EffectScheduler::spokeFor(Entity *owner)
+{
+    if (Spoke *spoke = findSpoke(owner))
+        return *spoke;
+
+    if (spokeCount == spokes.size())
+        spokes.emplace_back();
+    Spoke &spoke = spokes[spokeCount++];
+    spoke.owner = owner;
+    return spoke;
+}
+
+void EffectScheduler::push(Spoke &spoke, const Entry &entry)
+{
+    spoke.slots[static_cast<size_t>(entry.dueTurn) % WHEEL_SIZE].push_back(entry);
+}
+
+void EffectScheduler::adopt(Entity *owner)
+{
+    if (!owner)
+        return;
+    spokeFor(owner);
+    for (const Effect &effect : owner->getActiveEffects())
+    {
+        schedule(owner, effect.id);
+    }
+}
+
+void EffectScheduler::schedule(Entity *owner, unsigned int effectId)
+{
+    const Effect *effect = owner ? owner->findEffect(effectId) : nullptr;
+    if (!effect)
+        return;
+
+    Spoke &spoke = spokeFor(owner);
+    int now = owner->getEffectClock();
+    int expiresAt = max(now + 1, effect->expiresAt);
+    if (effect->isPeriodic())
+        push(spoke, {effectId, now + 1, false});
+    push(spoke, {effectId, expiresAt, true});
+}
+
+void EffectScheduler::beginTurn(Entity *owner)
+{
+    if (!owner)
+        return;
+
+    int turn = owner->advanceEffectClock();
+    Spoke *found = findSpoke(owner);
+    if (!found)
+        return;
+    Spoke &spoke = *found;
+
+    // Записи текущего хода забираются из ячейки, записи следующих оборотов остаются
+    vector<Entry> &slot = spoke.slots[static_cast<size_t>(turn) % WHEEL_SIZE];
+    dueScratch.clear();
+    size_t kept = 0;
+    for (size_t i = 0; i < slot.size(); ++i)
+    {
+        if (slot[i].dueTurn == turn)
+            dueScratch.push_back(slot[i]);
+        else
+            slot[kept++] = slot[i];
+    }
+    slot.resize(kept);
+
+    // Сначала срабатывания, потом истечения: в последний ход эффект еще действует
+    for (const Entry &entry : dueScratch)
+    {
+        if (entry.expire)
+            continue;
+        const Effect *effect = owner->findEffect(entry.effectId);
+        if (!effect)
+            continue;
+        owner->tickEffect(entry.effectId);
+        if (turn + 1 <= effect->expiresAt)
+            push(spoke, {entry.effectId, turn + 1, false});
+    }
+    for (const Entry &entry : dueScratch)
+    {
+        if (entry.expire)
+            owner->expireEffect(entry.effectId);
+    }
+}
+
+size_t EffectScheduler::pendingCount() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < spokeCount; ++i)
+    {
+        const Spoke &spoke = spokes[i];
+        for (const vector<Entry> &slot : spoke.slots)
+        {
+            count += slot.size();
+        }
+    }
+    return count;
+}
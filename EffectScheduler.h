@@ -0,0 +1,55 @@
+#pragma once
+#include "entity.h"
+#include <array>
+#include <vector>
+
+// Расписание эффектов боя - колесо времени по ходам владельцев.
+// У каждого участника своя спица из WHEEL_SIZE ячеек, ячейка выбирается по номеру хода владельца.
+// В начале хода обрабатывается одна ячейка: срабатывания яда/регенерации и истечения,
+// назначенные на этот ход. Остальные эффекты не трогаются.
+class EffectScheduler
+{
+public:
+    static const int WHEEL_SIZE = 8;
+
+    // Сбросить расписание (новый бой). Участников в бою не больше восьми, поиск спицы линейный
+    void clear();
+
+    // Поставить в расписание эффекты, уже висящие на участнике (перенесенные из прошлого боя)
+    void adopt(Entity *owner);
+
+    // Запланировать эффект, только что добавленный через Entity::addEffect
+    void schedule(Entity *owner, unsigned int effectId);
+
+    // Начало хода владельца: сдвинуть его счетчик и выполнить то, что назначено на этот ход
+    void beginTurn(Entity *owner);
+
+    // Копия боя: перевести спицы на копии участников
+    void remap(const EntityRemap &mapping);
+
+    // Количество записей в колесе (для отладки и бенчмарков)
+    size_t pendingCount() const;
+
+private:
+    struct Entry
+    {
+        unsigned int effectId;
+        int dueTurn;  // Ход владельца; может быть дальше WHEEL_SIZE - тогда запись ждет оборота
+        bool expire;  // true - истечение, false - срабатывание
+    };
+
+    struct Spoke
+    {
+        Entity *owner = nullptr;
+        array<vector<Entry>, WHEEL_SIZE> slots;
+    };
+
+    // Спицы и ячейки переживают clear(): их память используется и в следующем бою
+    vector<Spoke> spokes;
+    size_t spokeCount = 0;
+    vector<Entry> dueScratch;
+
+    Spoke *findSpoke(const Entity *owner);
+    Spoke &spokeFor(Entity *owner);
+    static void push(Spoke &spoke, const Entry &entry);
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+// Встроенные деревья поведения врагов (формат описан в BehaviorTree.h).
+// Файл enemy_behaviors.txt рядом с игрой, если он есть, заменяет эти деревья.
+static const char *defaultEnemyBehaviors = R"(
+# Гоблин травит весь отряд, пока на ком-то нет яда, потом добивает самого слабого
+tree goblin
+  selector
+    sequence
+      can_use_ability
+      any_target_lacks poison
+      use_ability
+    attack weakest
+
+# Орк впадает в ярость, когда есть кого бить, и в ярости бьет самого опасного
+tree orc
+  selector
+    sequence
+      has_targets
+      lacks_effect buff_damage
+      can_use_ability
+      use_ability
+    attack strongest
+
+# Вампир пьет кровь, когда ранен, иначе охотится на слабых
+tree vampire
+  selector
+    sequence
+      hp_below 70
+      can_use_ability
+      use_ability
+    attack weakest
+
+# Виверна взлетает, если никого не достать, иначе пикирует на слабого
+tree wyvern wyvern_monarch
+  selector
+    sequence
+      invert
+        has_targets
+      can_use_ability
+      use_ability
+    attack weakest
+
+# Призрак, получив урон, уходит сквозь ряды в последнюю линию
+tree ghost ghost_guard
+  selector
+    sequence
+      hp_below 50
+      position_below 4
+      move 4
+    sequence
+      invert
+        has_targets
+      can_use_ability
+      use_ability
+    attack random
+
+# Троглодит регенерирует на половине здоровья
+tree troglodyte
+  selector
+    sequence
+      hp_below 50
+      can_use_ability
+      use_ability
+    attack weakest
+)";
@@ -1,180 +1,196 @@
 #include "EnemyTemplates.h"
 #include "entity.h"
+#include "ContentPack.h"
 #include <vector>
-#include <map>
 #include <random>
 #include <ctime>
 
-// Initialize static member
-std::map<LocationType, std::vector<EnemyTemplate>> EnemyFactory::enemyTemplates;
-std::vector<std::string> defaultEnemies = {"Goblin", "Orc", "Troll", "Wolf", "Bandit", "Robber"};
+const std::vector<std::string> defaultEnemies = {"Goblin", "Orc", "Troll", "Wolf", "Bandit", "Robber"};
+
+namespace
+{
+    template <typename T>
+    Enemy *constructEnemy(const EnemyTemplate &t, int maxHP, int damage, int defense, int expValue, int difficulty)
+    {
+        return new T(t.name, maxHP, damage, defense, t.attack, t.maxStamina, t.maxStamina, t.initiative,
+                     t.attackRange, t.ability, expValue, difficulty, t.type, t.damageVariance);
+    }
+
+    struct EnemyTypeEntry
+    {
+        const char *type;
+        EnemyConstructor constructor;
+    };
+
+    // Enemy subclasses by type string; entry 0 is every other type
+    constexpr EnemyTypeEntry enemyTypes[] = {
+        {"", &constructEnemy<Enemy>},
+        {"goblin", &constructEnemy<Goblin>},
+        {"orc", &constructEnemy<Orc>},
+        {"vampire", &constructEnemy<Vampire>},
+        {"wyvern", &constructEnemy<Wyvern>},
+        {"wyvern_monarch", &constructEnemy<Wyvern>},
+        {"ghost", &constructEnemy<Ghost>},
+        {"troglodyte", &constructEnemy<Troglodyte>},
+        {"infernal_troglodyte", &constructEnemy<Troglodyte>}};
+
+    constexpr size_t enemyTypeCount = sizeof(enemyTypes) / sizeof(enemyTypes[0]);
+}
+
+EnemyTypeId EnemyTypeRegistry::find(const std::string &type)
+{
+    for (size_t id = 1; id < enemyTypeCount; ++id)
+    {
+        if (type == enemyTypes[id].type)
+            return static_cast<EnemyTypeId>(id);
+    }
+    return 0;
+}
+
+EnemyConstructor EnemyTypeRegistry::constructorOf(EnemyTypeId id)
+{
+    return enemyTypes[id < enemyTypeCount ? id : 0].constructor;
+}
+
+const char *EnemyTypeRegistry::nameOf(EnemyTypeId id)
+{
+    return enemyTypes[id < enemyTypeCount ? id : 0].type;
+}
+
+EnemyFactory::Registry::Registry()
+{
+    if (const ContentPack *pack = ContentPack::active())
+        loadPack(*pack);
+    else
+        initializeTemplates(enemyTemplates);
+
+    for (size_t location = 0; location < enemyTemplates.size(); ++location)
+    {
+        std::vector<EnemyTemplate> &templates = enemyTemplates.values[location];
+        std::vector<uint16_t> indices;
+        std::vector<double> weights;
+        for (size_t i = 0; i < templates.size(); ++i)
+        {
+            EnemyTemplate &enemyTemplate = templates[i];
+            enemyTemplate.typeId = EnemyTypeRegistry::find(enemyTemplate.type);
+            // A name may repeat across locations; the first one wins, as before
+            templatesByName.emplace(enemyTemplate.name, &enemyTemplate);
+            if (enemyTemplate.spawnWeight > 0)
+            {
+                indices.push_back(static_cast<uint16_t>(i));
+                weights.push_back(enemyTemplate.spawnWeight);
+            }
+        }
+        spawnTables.values[location].build(indices, weights);
+    }
+}
+
+void EnemyFactory::Registry::loadPack(const ContentPack &pack)
+{
+    for (const PackEnemy &record : pack.enemies())
+    {
+        if (record.location >= LOCATION_TYPE_COUNT || record.ability >= ABILITY_TYPE_COUNT)
+        {
+            LOG_WARN(CAMPAIGN, "Content pack: invalid enemy record '" << pack.text(record.name) << "' skipped");
+            continue;
+        }
+        enemyTemplates[static_cast<LocationType>(record.location)].push_back(
+            {pack.text(record.name), record.maxHP, record.damage, record.defense, record.attack, record.maxStamina,
+             record.initiative, record.attackRange, static_cast<AbilityType>(record.ability), record.expValue,
+             record.difficulty, pack.text(record.type), record.damageVariance, record.spawnWeight});
+    }
+}
+
+const EnemyFactory::Registry &EnemyFactory::registry()
+{
+    static const Registry instance;
+    return instance;
+}
+
+void EnemyFactory::initializeTemplates(EnemyTemplateTable &enemyTemplates)
 
-void EnemyFactory::initializeTemplates()
 {
     // FOREST - flying and fast creatures
     enemyTemplates[LocationType::FOREST] = {
         // Wyvern - basic flying enemy
-        {"Wyvern", 80, 12, 3, 2, 2, 14, 1, AbilityType::FLYING, 40, 1, "wyvern", 0.25},
+        {"Wyvern", 80, 12, 3, 2, 2, 14, 1, AbilityType::FLYING, 40, 1, "wyvern", 0.25, 3},
 
         // Wyvern-monarch - improved version
-        {"Wyvern-monarch", 120, 16, 5, 3, 2, 16, 1, AbilityType::FLYING, 70, 2, "wyvern_monarch", 0.2},
+        {"Wyvern-monarch", 120, 16, 5, 3, 2, 16, 1, AbilityType::FLYING, 70, 2, "wyvern_monarch", 0.2, 1},
 
         // Serpent - poisonous flying snake
-        {"Serpent", 60, 10, 2, 1, 1, 12, 0, AbilityType::POISON, 35, 1, "serpent", 0.15},
+        {"Serpent", 60, 10, 2, 1, 1, 12, 0, AbilityType::POISON, 35, 1, "serpent", 0.15, 3},
 
         // Centaur - fast and aggressive
-        {"Centaur", 100, 14, 4, 3, 2, 18, 0, AbilityType::BERSERK, 55, 2, "centaur", 0.35}};
+        {"Centaur", 100, 14, 4, 3, 2, 18, 0, AbilityType::BERSERK, 55, 2, "centaur", 0.35, 2}};
 
     // CAVE - underground creatures
     enemyTemplates[LocationType::CAVE] = {
         // Troglodyte - basic cave dweller
-        {"Troglodyte", 90, 11, 4, 2, 1, 9, 0, AbilityType::REGENERATION, 45, 1, "troglodyte", 0.2},
+        {"Troglodyte", 90, 11, 4, 2, 1, 9, 0, AbilityType::REGENERATION, 45, 1, "troglodyte", 0.2, 3},
 
         // Infernal troglodyte - fire version
-        {"Infernal troglodyte", 110, 15, 5, 3, 2, 11, 1, AbilityType::FIRE_DAMAGE, 75, 2, "infernal_troglodyte", 0.25},
+        {"Infernal troglodyte", 110, 15, 5, 3, 2, 11, 1, AbilityType::FIRE_DAMAGE, 75, 2, "infernal_troglodyte", 0.25, 2},
 
         // Earth elemental - tanking enemy
-        {"Earth elemental", 150, 8, 8, 1, 1, 6, 0, AbilityType::REGENERATION, 80, 3, "earth_elemental", 0.1},
+        {"Earth elemental", 150, 8, 8, 1, 1, 6, 0, AbilityType::REGENERATION, 80, 3, "earth_elemental", 0.1, 1},
 
         // Familiar - fast and weak, but with magic
-        {"Familiar", 50, 6, 1, 2, 2, 15, 2, AbilityType::LIGHTNING, 30, 1, "familiar", 0.3}};
+        {"Familiar", 50, 6, 1, 2, 2, 15, 2, AbilityType::LIGHTNING, 30, 1, "familiar", 0.3, 3}};
 
     // CASTLE - final location, guards and knights
     enemyTemplates[LocationType::CASTLE] = {
         // Guard - basic castle defender
-        {"Guard", 100, 12, 6, 2, 1, 10, 0, AbilityType::NONE, 50, 2, "guard", 0.2},
+        {"Guard", 100, 12, 6, 2, 1, 10, 0, AbilityType::NONE, 50, 2, "guard", 0.2, 3},
 
         // Knight - heavy warrior
-        {"Knight", 140, 16, 8, 3, 1, 12, 0, AbilityType::BERSERK, 80, 3, "knight", 0.25},
+        {"Knight", 140, 16, 8, 3, 1, 12, 0, AbilityType::BERSERK, 80, 3, "knight", 0.25, 1},
 
         // Castle mage - magical enemy
-        {"Castle mage", 80, 10, 2, 2, 2, 14, 2, AbilityType::LIGHTNING, 60, 2, "castle_mage", 0.3},
+        {"Castle mage", 80, 10, 2, 2, 2, 14, 2, AbilityType::LIGHTNING, 60, 2, "castle_mage", 0.3, 2},
 
         // Ghost guard - immaterial defender
-        {"Ghost guard", 90, 11, 3, 2, 1, 16, 1, AbilityType::INVISIBLE, 70, 2, "ghost_guard", 0.15}};
+        {"Ghost guard", 90, 11, 3, 2, 1, 16, 1, AbilityType::INVISIBLE, 70, 2, "ghost_guard", 0.15, 2}};
 
     // DEAD_CITY - pure undead
     enemyTemplates[LocationType::DEAD_CITY] = {
         // Skeleton - basic skeleton
-        {"Skeleton", 40, 6, 1, 1, 1, 8, 0, AbilityType::NONE, 20, 1, "skeleton", 0.3},
+        {"Skeleton", 40, 6, 1, 1, 1, 8, 0, AbilityType::NONE, 20, 1, "skeleton", 0.3, 3},
 
         // Skeleton-warrior - armed skeleton
-        {"Skeleton-warrior", 70, 10, 3, 2, 1, 10, 0, AbilityType::NONE, 35, 1, "skeleton_warrior", 0.25},
+        {"Skeleton-warrior", 70, 10, 3, 2, 1, 10, 0, AbilityType::NONE, 35, 1, "skeleton_warrior", 0.25, 3},
 
         // Vampire - classic vampire
-        {"Vampire", 100, 14, 4, 3, 2, 14, 1, AbilityType::LIFE_STEAL, 65, 2, "vampire", 0.2},
+        {"Vampire", 100, 14, 4, 3, 2, 14, 1, AbilityType::LIFE_STEAL, 65, 2, "vampire", 0.2, 1},
 
         // Ghost - immaterial enemy
-        {"Ghost", 60, 8, 0, 2, 1, 12, 1, AbilityType::INVISIBLE, 50, 2, "ghost", 0.4}};
+        {"Ghost", 60, 8, 0, 2, 1, 12, 1, AbilityType::INVISIBLE, 50, 2, "ghost", 0.4, 2}};
+
 }
 
 Enemy *EnemyFactory::createRandomEnemy(LocationType location, int difficultyModifier)
 {
-    if (enemyTemplates.empty())
-    {
-        initializeTemplates();
-    }
-
-    auto it = enemyTemplates.find(location);
-    if (it == enemyTemplates.end() || it->second.empty())
+    const Registry &data = registry();
+    const std::vector<EnemyTemplate> &templates = data.enemyTemplates[location];
+    if (templates.empty())
     {
         int randomIndex = rand() % defaultEnemies.size();
         return new Enemy(defaultEnemies[randomIndex], 50, 8, 2, 2, 1, 1, 8, 0, AbilityType::NONE, 25, 1, "unknown", 0.2);
     }
 
-    const auto &templates = it->second;
-
-    // Choose template randomly
-    int index = rand() % templates.size();
-    const EnemyTemplate &selected = templates[index];
-
-    // Apply difficulty modifier
-    int modifiedHP = selected.maxHP + (difficultyModifier * 20);
-    int modifiedDamage = selected.damage + difficultyModifier;
-    int modifiedDefense = selected.defense + difficultyModifier;
-    int modifiedExp = selected.expValue + (difficultyModifier * 10);
-
-    // Create enemy of appropriate type
-    if (selected.name == "Goblin" || selected.type == "goblin")
-    {
-        return new Goblin(selected.name, modifiedHP, modifiedDamage, modifiedDefense, selected.attack,
-                          selected.maxStamina, selected.maxStamina, selected.initiative, selected.attackRange,
-                          selected.ability, modifiedExp, selected.difficulty + difficultyModifier, selected.type, selected.damageVariance);
-    }
-    else if (selected.name == "Orc" || selected.type == "orc")
-    {
-        return new Orc(selected.name, modifiedHP, modifiedDamage, modifiedDefense, selected.attack,
-                       selected.maxStamina, selected.maxStamina, selected.initiative, selected.attackRange,
-                       selected.ability, modifiedExp, selected.difficulty + difficultyModifier, selected.type, selected.damageVariance);
-    }
-    else if (selected.name == "Vampire" || selected.type == "vampire")
-    {
-        return new Vampire(selected.name, modifiedHP, modifiedDamage, modifiedDefense, selected.attack,
-                           selected.maxStamina, selected.maxStamina, selected.initiative, selected.attackRange,
-                           selected.ability, modifiedExp, selected.difficulty + difficultyModifier, selected.type, selected.damageVariance);
-    }
-    else if (selected.name == "Wyvern" || selected.type == "wyvern" || selected.name == "Wyvern-monarch" || selected.type == "wyvern_monarch")
-    {
-        return new Wyvern(selected.name, modifiedHP, modifiedDamage, modifiedDefense, selected.attack,
-                          selected.maxStamina, selected.maxStamina, selected.initiative, selected.attackRange,
-                          selected.ability, modifiedExp, selected.difficulty + difficultyModifier, selected.type, selected.damageVariance);
-    }
-    else if (selected.name == "Ghost" || selected.type == "ghost")
-    {
-        return new Ghost(selected.name, modifiedHP, modifiedDamage, modifiedDefense, selected.attack,
-                         selected.maxStamina, selected.maxStamina, selected.initiative, selected.attackRange,
-                         selected.ability, modifiedExp, selected.difficulty + difficultyModifier, selected.type, selected.damageVariance);
-    }
-    else if (selected.name == "Troglodyte" || selected.type == "troglodyte" || selected.name == "Infernal troglodyte" || selected.type == "infernal_troglodyte")
-    {
-        return new Troglodyte(selected.name, modifiedHP, modifiedDamage, modifiedDefense, selected.attack,
-                              selected.maxStamina, selected.maxStamina, selected.initiative, selected.attackRange,
-                              selected.ability, modifiedExp, selected.difficulty + difficultyModifier, selected.type, selected.damageVariance);
-    }
-    else
-    {
-        return new Enemy(selected.name, modifiedHP, modifiedDamage, modifiedDefense, selected.attack,
-                         selected.maxStamina, selected.maxStamina, selected.initiative, selected.attackRange,
-                         selected.ability, modifiedExp, selected.difficulty + difficultyModifier, selected.type, selected.damageVariance);
-    }
+    // Choose template by spawn weight; uniformly if no template has a positive weight
+    int index = data.spawnTables[location].sample();
+    if (index < 0)
+        index = rand() % templates.size();
+    return createEnemy(templates[index], difficultyModifier, difficultyScaling);
 }
 
 Enemy *EnemyFactory::createEnemyByName(const std::string &name, int difficultyModifier)
 {
-    if (enemyTemplates.empty())
+    const EnemyTemplate *enemyTemplate = findTemplate(name);
+    if (enemyTemplate)
     {
-        initializeTemplates();
-    }
-
-    // Search for enemy across all locations
-    for (const auto &locationPair : enemyTemplates)
-    {
-        for (const auto &enemyTemplate : locationPair.second)
-        {
-            if (enemyTemplate.name == name)
-            {
-                int modifiedHP = enemyTemplate.maxHP + (difficultyModifier * 20);
-                int modifiedDamage = enemyTemplate.damage + difficultyModifier;
-                int modifiedDefense = enemyTemplate.defense + difficultyModifier;
-                int modifiedExp = enemyTemplate.expValue + (difficultyModifier * 10);
-
-                return new Enemy(
-                    enemyTemplate.name,
-                    modifiedHP,
-                    modifiedDamage,
-                    modifiedDefense,
-                    enemyTemplate.attack,
-                    enemyTemplate.maxStamina,
-                    enemyTemplate.maxStamina,
-                    enemyTemplate.initiative,
-                    enemyTemplate.attackRange,
-                    enemyTemplate.ability,
-                    modifiedExp,
-                    enemyTemplate.difficulty + difficultyModifier,
-                    enemyTemplate.type,
-                    enemyTemplate.damageVariance);
-            }
-        }
+        return createEnemy(*enemyTemplate, difficultyModifier, difficultyScaling);
     }
 
     // If not found, return default enemy with random name
@@ -182,21 +198,51 @@ Enemy *EnemyFactory::createEnemyByName(const std::string &name, int difficultyMo
     return new Enemy(defaultEnemies[randomIndex], 50, 8, 2, 2, 1, 1, 8, 0, AbilityType::NONE, 25, 1, "unknown", 0.2);
 }
 
-std::vector<std::string> EnemyFactory::getAvailableEnemies(LocationType location)
+const EnemyTemplate *EnemyFactory::findTemplate(const std::string &name)
 {
-    if (enemyTemplates.empty())
-    {
-        initializeTemplates();
-    }
+    const Registry &data = registry();
+    auto it = data.templatesByName.find(name);
+    return it != data.templatesByName.end() ? it->second : nullptr;
+}
 
+std::vector<std::string> EnemyFactory::getAvailableEnemies(LocationType location)
+{
     std::vector<std::string> names;
-    auto it = enemyTemplates.find(location);
-    if (it != enemyTemplates.end())
+    for (const auto &enemyTemplate : registry().enemyTemplates[location])
     {
-        for (const auto &enemyTemplate : it->second)
-        {
-            names.push_back(enemyTemplate.name);
-        }
+        names.push_back(enemyTemplate.name);
     }
     return names;
 }
+
+const std::vector<EnemyTemplate> &EnemyFactory::getTemplates(LocationType location)
+{
+    return registry().enemyTemplates[location];
+}
+
+const EnemyScaling &EnemyFactory::getScaling()
+{
+    return difficultyScaling;
+}
+
+Enemy *EnemyFactory::createEnemy(const EnemyTemplate &enemyTemplate, int difficultyModifier, const EnemyScaling &scaling)
+{
+    int modifiedHP = enemyTemplate.maxHP + (difficultyModifier * scaling.hpPerLevel);
+    int modifiedDamage = enemyTemplate.damage + difficultyModifier * scaling.damagePerLevel;
+    int modifiedDefense = enemyTemplate.defense + difficultyModifier * scaling.defensePerLevel;
+    int modifiedExp = enemyTemplate.expValue + (difficultyModifier * scaling.expPerLevel);
+
+    // Subclass by type id; templates from elsewhere (typeId 0) become a plain Enemy
+    EnemyConstructor construct = EnemyTypeRegistry::constructorOf(enemyTemplate.typeId);
+    return construct(enemyTemplate, modifiedHP, modifiedDamage, modifiedDefense, modifiedExp,
+                     enemyTemplate.difficulty + difficultyModifier);
+}
+
+std::vector<Enemy *> EnemyFactory::createBossParty()
+{
+    std::vector<Enemy *> bossParty;
+    bossParty.push_back(new Enemy("Lord of Darkness", 300, 25, 10, 8, 3, 3, 15, 2, AbilityType::LIFE_STEAL, 200, 5, "final_boss", 0.1));
+    bossParty.push_back(createEnemyByName("Vampire", 2));
+    bossParty.push_back(createEnemyByName("Troglodyte", 2));
+    return bossParty;
+}
@@ -1,9 +1,15 @@
 #pragma once
 #include "entity.h"
+#include "AliasTable.h"
+#include "EnumArray.h"
+#include <cstdint>
 #include <vector>
-#include <map>
 #include <random>
 #include <ctime>
+#include <unordered_map>
+
+// Тип врага (Enemy::getEnemyType) числом. Строка типа разбирается один раз - при загрузке шаблонов
+using EnemyTypeId = uint16_t;
 
 // Структура шаблона врага
 struct EnemyTemplate
@@ -21,23 +27,80 @@ struct EnemyTemplate
     int difficulty;
     std::string type;
     double damageVariance = 0.2; // Разброс урона по умолчанию
+    int spawnWeight = 1;         // Относительная частота в случайных встречах локации (0 - не появляется)
+    EnemyTypeId typeId = 0;      // Заполняется при загрузке шаблонов (EnemyTypeRegistry::find(type))
+};
+
+// Конструктор врага по шаблону и уже масштабированным статам
+using EnemyConstructor = Enemy *(*)(const EnemyTemplate &enemyTemplate, int maxHP, int damage, int defense, int expValue, int difficulty);
+
+// Реестр типов врагов с собственным подклассом: строка типа -> номер, номер -> конструктор.
+// Постоянная таблица; номер 0 - любой другой тип (базовый Enemy)
+class EnemyTypeRegistry
+{
+public:
+    // Номер типа или 0, если у типа нет своего подкласса
+    static EnemyTypeId find(const std::string &type);
+    static EnemyConstructor constructorOf(EnemyTypeId id);
+    static const char *nameOf(EnemyTypeId id);
+};
+
+class ContentPack;
+
+// Усиление врага за каждый уровень модификатора сложности
+struct EnemyScaling
+{
+    int hpPerLevel = 20;
+    int damagePerLevel = 1;
+    int defensePerLevel = 1;
+    int expPerLevel = 10;
 };
 
 // Фабрика для создания врагов по шаблонам
 class EnemyFactory
 {
 private:
-    static std::map<LocationType, std::vector<EnemyTemplate>> enemyTemplates;
+    using EnemyTemplateTable = EnumArray<LocationType, std::vector<EnemyTemplate>, LOCATION_TYPE_COUNT>;
+
+    // Данные фабрики: строятся один раз при первом обращении (потокобезопасная инициализация
+    // статической переменной), дальше только читаются - общие для всех потоков без блокировок
+    struct Registry
+    {
+        EnemyTemplateTable enemyTemplates;
+        EnumArray<LocationType, AliasTable, LOCATION_TYPE_COUNT> spawnTables; // Номер шаблона локации по spawnWeight
+        std::unordered_map<std::string, const EnemyTemplate *> templatesByName;
+
+        Registry();
+        Registry(const Registry &) = delete; // templatesByName указывает внутрь enemyTemplates
+        void loadPack(const ContentPack &pack); // Шаблоны из активного пакета вместо встроенных
+        Registry &operator=(const Registry &) = delete;
+    };
+
+    static constexpr EnemyScaling difficultyScaling{};
 
-    static void initializeTemplates();
+    static const Registry &registry();
+    static void initializeTemplates(EnemyTemplateTable &enemyTemplates);
 
 public:
     // Получить случайного врага для локации
     static Enemy *createRandomEnemy(LocationType location, int difficultyModifier = 0);
 
-    // Получить конкретного врага по имени
+    // Получить конкретного врага по имени (поиск по хешу имени)
     static Enemy *createEnemyByName(const std::string &name, int difficultyModifier = 0);
 
+    // Шаблон по имени или nullptr
+    static const EnemyTemplate *findTemplate(const std::string &name);
+
     // Получить список доступных врагов для локации
     static std::vector<std::string> getAvailableEnemies(LocationType location);
+
+    // Шаблоны врагов локации и текущее масштабирование по сложности
+    static const std::vector<EnemyTemplate> &getTemplates(LocationType location);
+    static const EnemyScaling &getScaling();
+
+    // Создать врага по шаблону с заданным масштабированием (для инструментов баланса)
+    static Enemy *createEnemy(const EnemyTemplate &enemyTemplate, int difficultyModifier, const EnemyScaling &scaling);
+
+    // Финальный бой: Lord of Darkness и двое приспешников (не из замка)
+    static std::vector<Enemy *> createBossParty();
 };
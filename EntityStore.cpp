@@ -0,0 +1,122 @@
+#include "EntityStore.h"
+
+EntityStore::EntityStore(const EntityStore &other)
+    : m_slots(other.m_slots.size()), m_dense(other.m_dense), m_free(other.m_free)
+{
+    for (size_t i = 0; i < m_slots.size(); ++i)
+    {
+        const Slot &source = other.m_slots[i];
+        Slot &slot = m_slots[i];
+        slot.generation = source.generation;
+        slot.dense_pos = source.dense_pos;
+        if (source.entity)
+        {
+            slot.owned = source.entity->clone();
+            slot.entity = slot.owned.get();
+        }
+    }
+}
+
+EntityStore &EntityStore::operator=(const EntityStore &other)
+{
+    if (this != &other)
+    {
+        EntityStore copy(other);
+        *this = move(copy);
+    }
+    return *this;
+}
+
+EntityHandle EntityStore::place(Entity *entity, unique_ptr<Entity> owned)
+{
+    if (!entity)
+        return EntityHandle();
+
+    uint32_t index;
+    if (!m_free.empty())
+    {
+        index = m_free.back();
+        m_free.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_slots.size());
+        m_slots.emplace_back();
+    }
+
+    Slot &slot = m_slots[index];
+    slot.entity = entity;
+    slot.owned = move(owned);
+    slot.dense_pos = static_cast<uint32_t>(m_dense.size());
+    m_dense.push_back(index);
+    return handleOf(index);
+}
+
+EntityHandle EntityStore::insert(unique_ptr<Entity> entity)
+{
+    Entity *raw = entity.get();
+    return place(raw, move(entity));
+}
+
+EntityHandle EntityStore::attach(Entity *entity)
+{
+    return place(entity, nullptr);
+}
+
+bool EntityStore::erase(EntityHandle handle)
+{
+    if (!get(handle))
+        return false;
+
+    // Удаление без сдвига: на место записи встает последняя, ее ячейка запоминает новую позицию
+    Slot &slot = m_slots[handle.index];
+    uint32_t moved = m_dense.back();
+    m_dense[slot.dense_pos] = moved;
+    m_slots[moved].dense_pos = slot.dense_pos;
+    m_dense.pop_back();
+
+    slot.entity = nullptr;
+    slot.owned.reset();
+    ++slot.generation;
+    m_free.push_back(handle.index);
+    return true;
+}
+
+void EntityStore::clear()
+{
+    // Ячейки остаются, чтобы поколения продолжали расти и старые дескрипторы не ожили
+    for (uint32_t index : m_dense)
+    {
+        Slot &slot = m_slots[index];
+        slot.entity = nullptr;
+        slot.owned.reset();
+        ++slot.generation;
+        m_free.push_back(index);
+    }
+    m_dense.clear();
+}
+
+EntityHandle EntityStore::find(const Entity *entity) const
+{
+    if (!entity)
+        return EntityHandle();
+    for (uint32_t index : m_dense)
+    {
+        if (m_slots[index].entity == entity)
+            return handleOf(index);
+    }
+    return EntityHandle();
+}
+
+EntityRemap EntityStore::remapTo(const EntityStore &copy) const
+{
+    EntityRemap mapping;
+    mapping.reserve(m_dense.size());
+    for (uint32_t index : m_dense)
+    {
+        Entity *target = copy.get(handleOf(index));
+        if (target)
+            mapping.emplace_back(m_slots[index].entity, target);
+    }
+    return mapping;
+}
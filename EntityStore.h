@@ -0,0 +1,78 @@
+#pragma once
+#include "entity.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// Дескриптор сущности в EntityStore: ячейка и ее поколение. Удаление увеличивает поколение
+// ячейки, поэтому устаревший дескриптор распознается одним сравнением, даже если ячейку занял
+// другой участник
+struct EntityHandle
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != UINT32_MAX; }
+    bool operator==(const EntityHandle &other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const EntityHandle &other) const { return !(*this == other); }
+};
+
+// Хранилище сущностей - slot map, как Inventory: ячейки лежат одним массивом, поиск по дескриптору -
+// индекс и сравнение поколения. Записи бывают собственные (хранилище удаляет сущность вместе с записью)
+// и заимствованные (сущностью владеет вызывающий: герои кампании в бою, участники безголовых симуляций).
+// Копия хранилища - снимок: каждая сущность копируется (Entity::clone) в собственную запись той же
+// ячейки, так что дескрипторы оригинала действуют и в копии
+class EntityStore
+{
+public:
+    EntityStore() = default;
+    EntityStore(const EntityStore &other);
+    EntityStore &operator=(const EntityStore &other);
+    EntityStore(EntityStore &&) = default;
+    EntityStore &operator=(EntityStore &&) = default;
+
+    EntityHandle insert(unique_ptr<Entity> entity); // Собственная запись
+    EntityHandle attach(Entity *entity);             // Заимствованная запись
+    bool erase(EntityHandle handle);                 // false, если дескриптор устарел
+    void clear();
+
+    // nullptr, если дескриптор устарел
+    Entity *get(EntityHandle handle) const
+    {
+        if (handle.index >= m_slots.size())
+            return nullptr;
+        const Slot &slot = m_slots[handle.index];
+        return slot.generation == handle.generation ? slot.entity : nullptr;
+    }
+    bool contains(EntityHandle handle) const { return get(handle) != nullptr; }
+
+    // Дескриптор сущности из хранилища (проход по плотному списку); пустой, если ее там нет
+    EntityHandle find(const Entity *entity) const;
+
+    // Плотный список: позиция 0..size()-1. Позиции меняются при удалении, дескрипторы - нет
+    size_t size() const { return m_dense.size(); }
+    bool empty() const { return m_dense.empty(); }
+    Entity *at(size_t position) const { return m_slots[m_dense[position]].entity; }
+    EntityHandle handleAt(size_t position) const { return handleOf(m_dense[position]); }
+
+    // Пары "сущность этого хранилища -> сущность той же ячейки в копии" для кэшей, хранящих указатели
+    EntityRemap remapTo(const EntityStore &copy) const;
+
+private:
+    struct Slot
+    {
+        Entity *entity = nullptr; // nullptr - ячейка свободна
+        unique_ptr<Entity> owned; // Пусто у заимствованных записей
+        uint32_t generation = 0;
+        uint32_t dense_pos = 0;
+    };
+
+    vector<Slot> m_slots;
+    vector<uint32_t> m_dense; // Занятые ячейки
+    vector<uint32_t> m_free;  // Освобожденные ячейки для повторного использования
+
+    EntityHandle handleOf(uint32_t index) const { return {index, m_slots[index].generation}; }
+    EntityHandle place(Entity *entity, unique_ptr<Entity> owned);
+};
@@ -0,0 +1,22 @@
+#pragma once
+#include <array>
+#include <cstddef>
+
+// Плотный массив с индексом-перечислением: table[LocationType::CAVE] вместо map<LocationType, T>.
+// Поиск - одно смещение, без сравнений и аллокаций; агрегат, поэтому годится и для constexpr-таблиц
+template <typename Enum, typename T, std::size_t N>
+struct EnumArray
+{
+    std::array<T, N> values{};
+
+    constexpr T &operator[](Enum key) { return values[static_cast<std::size_t>(key)]; }
+    constexpr const T &operator[](Enum key) const { return values[static_cast<std::size_t>(key)]; }
+
+    static constexpr std::size_t size() { return N; }
+    static constexpr Enum keyAt(std::size_t index) { return static_cast<Enum>(index); }
+
+    T *begin() { return values.data(); }
+    T *end() { return values.data() + N; }
+    const T *begin() const { return values.data(); }
+    const T *end() const { return values.data() + N; }
+};
@@ -1,15 +1,84 @@
 #include "HeroTemplates.h"
+#include "ContentPack.h"
 #include "entity.h"
 #include <vector>
-#include <map>
 #include <string>
 
-// Initialize static members
-std::map<HeroClass, HeroTemplate> HeroFactory::heroTemplates;
-std::map<AbilityType, AbilityInfo> HeroFactory::abilityDatabase;
-std::vector<PartyPreset> HeroFactory::partyPresets;
+HeroFactory::Registry::Registry()
+{
+    if (const ContentPack *pack = ContentPack::active())
+    {
+        loadPack(*pack);
+        return;
+    }
+    initializeTemplates(heroTemplates);
+    initializeAbilities(abilityDatabase);
+    initializePartyPresets(partyPresets);
+}
+
+void HeroFactory::Registry::loadPack(const ContentPack &pack)
+{
+    // Records with out-of-range enums or lists are skipped: the pack is external data
+    for (const PackAbility &record : pack.abilities())
+    {
+        if (record.type >= ABILITY_TYPE_COUNT)
+        {
+            LOG_WARN(CAMPAIGN, "Content pack: ability record with unknown type " << int(record.type) << " skipped");
+            continue;
+        }
+        AbilityType type = static_cast<AbilityType>(record.type);
+        abilityDatabase[type] = {type, pack.text(record.name), pack.text(record.description), record.staminaCost,
+                                 pack.text(record.effect), record.isAreaEffect != 0};
+    }
+
+    std::span<const uint8_t> abilityLists = pack.heroAbilities();
+    for (const PackHero &record : pack.heroes())
+    {
+        if (record.heroClass >= HERO_CLASS_COUNT || record.progressionType > static_cast<uint8_t>(ProgressionType::TRANSCENDENCE) ||
+            record.baseAbility >= ABILITY_TYPE_COUNT || record.firstAbility > abilityLists.size() ||
+            record.abilityCount > abilityLists.size() - record.firstAbility)
+        {
+            LOG_WARN(CAMPAIGN, "Content pack: invalid hero record '" << pack.text(record.name) << "' skipped");
+            continue;
+        }
+        HeroClass heroClass = static_cast<HeroClass>(record.heroClass);
+        HeroTemplate &tmpl = heroTemplates[heroClass];
+        tmpl = {pack.text(record.name), pack.text(record.description), heroClass,
+                static_cast<ProgressionType>(record.progressionType), record.maxHP, record.damage, record.defense,
+                record.attack, record.maxStamina, record.initiative, record.attackRange,
+                static_cast<AbilityType>(record.baseAbility), {}, record.isLoner != 0, record.damageVariance};
+        for (uint8_t ability : abilityLists.subspan(record.firstAbility, record.abilityCount))
+        {
+            if (ability < ABILITY_TYPE_COUNT)
+                tmpl.availableAbilities.push_back(static_cast<AbilityType>(ability));
+        }
+    }
+
+    std::span<const PackPresetMember> members = pack.presetMembers();
+    for (const PackPreset &record : pack.presets())
+    {
+        if (record.firstMember > members.size() || record.memberCount > members.size() - record.firstMember)
+        {
+            LOG_WARN(CAMPAIGN, "Content pack: invalid party preset '" << pack.text(record.name) << "' skipped");
+            continue;
+        }
+        PartyPreset preset{pack.text(record.name), pack.text(record.description), {}};
+        for (const PackPresetMember &member : members.subspan(record.firstMember, record.memberCount))
+        {
+            if (member.heroClass < HERO_CLASS_COUNT)
+                preset.heroes.emplace_back(static_cast<HeroClass>(member.heroClass), pack.text(member.name));
+        }
+        partyPresets.push_back(preset);
+    }
+}
 
-void HeroFactory::initializeTemplates()
+const HeroFactory::Registry &HeroFactory::registry()
+{
+    static const Registry instance;
+    return instance;
+}
+
+void HeroFactory::initializeTemplates(HeroTemplateTable &heroTemplates)
 {
     // WARRIOR - tanky melee fighter
     heroTemplates[HeroClass::WARRIOR] = {
@@ -51,7 +120,7 @@ void HeroFactory::initializeTemplates()
     };
 }
 
-void HeroFactory::initializePartyPresets()
+void HeroFactory::initializePartyPresets(std::vector<PartyPreset> &partyPresets)
 {
     // Preset 1: Lone - Legendary hero
     partyPresets.push_back({"Legendary Lone Hero",
@@ -104,7 +173,7 @@ void HeroFactory::initializePartyPresets()
                             {{HeroClass::WARRIOR, "Arthur"}, {HeroClass::MAGE, "Merlin"}, {HeroClass::ROGUE, "Robin"}, {HeroClass::DRUID, "Morgana"}}});
 }
 
-void HeroFactory::initializeAbilities()
+void HeroFactory::initializeAbilities(AbilityTable &abilityDatabase)
 {
     abilityDatabase[AbilityType::CHARGE] = {
         AbilityType::CHARGE, "Charge", "Instant movement to target with powerful attack",
@@ -201,37 +270,22 @@ void HeroFactory::initializeAbilities()
 
 std::vector<HeroClass> HeroFactory::getAvailableClasses()
 {
-    if (heroTemplates.empty())
-    {
-        initializeTemplates();
-    }
-
     std::vector<HeroClass> classes;
-    for (const auto &pair : heroTemplates)
+    for (size_t i = 0; i < HeroTemplateTable::size(); ++i)
     {
-        classes.push_back(pair.first);
+        classes.push_back(HeroTemplateTable::keyAt(i));
     }
     return classes;
 }
 
 const HeroTemplate &HeroFactory::getHeroTemplate(HeroClass heroClass)
 {
-    if (heroTemplates.empty())
-    {
-        initializeTemplates();
-    }
-
-    return heroTemplates[heroClass];
+    return registry().heroTemplates[heroClass];
 }
 
 Player *HeroFactory::createHero(HeroClass heroClass, const std::string &customName)
 {
-    if (heroTemplates.empty())
-    {
-        initializeTemplates();
-    }
-
-    const HeroTemplate &tmpl = heroTemplates[heroClass];
+    const HeroTemplate &tmpl = registry().heroTemplates[heroClass];
     std::string heroName = customName.empty() ? tmpl.name : customName;
 
     Player *hero = new Player(
@@ -268,41 +322,22 @@ Player *HeroFactory::createHero(HeroClass heroClass, const std::string &customNa
 
 const AbilityInfo &HeroFactory::getAbilityInfo(AbilityType ability)
 {
-    if (abilityDatabase.empty())
-    {
-        initializeAbilities();
-    }
-
-    return abilityDatabase[ability];
+    return registry().abilityDatabase[ability];
 }
 
 std::vector<AbilityType> HeroFactory::getClassAbilities(HeroClass heroClass)
 {
-    if (heroTemplates.empty())
-    {
-        initializeTemplates();
-    }
-
-    return heroTemplates[heroClass].availableAbilities;
+    return registry().heroTemplates[heroClass].availableAbilities;
 }
 
 const std::vector<PartyPreset> &HeroFactory::getPartyPresets()
 {
-    if (partyPresets.empty())
-    {
-        initializePartyPresets();
-    }
-
-    return partyPresets;
+    return registry().partyPresets;
 }
 
 std::vector<Player *> HeroFactory::createPartyFromPreset(int presetIndex)
 {
-    if (partyPresets.empty())
-    {
-        initializePartyPresets();
-    }
-
+    const std::vector<PartyPreset> &partyPresets = registry().partyPresets;
     if (presetIndex < 0 || presetIndex >= static_cast<int>(partyPresets.size()))
     {
         return {};
@@ -1,7 +1,7 @@
 #pragma once
 #include "entity.h"
+#include "EnumArray.h"
 #include <vector>
-#include <map>
 #include <string>
 
 // Hero template structure
@@ -43,17 +43,32 @@ struct AbilityInfo
     bool isAreaEffect = false;
 };
 
+class ContentPack;
+
 // Factory for creating heroes
 class HeroFactory
 {
 private:
-    static std::map<HeroClass, HeroTemplate> heroTemplates;
-    static std::map<AbilityType, AbilityInfo> abilityDatabase;
-    static std::vector<PartyPreset> partyPresets;
+    using HeroTemplateTable = EnumArray<HeroClass, HeroTemplate, HERO_CLASS_COUNT>;
+    using AbilityTable = EnumArray<AbilityType, AbilityInfo, ABILITY_TYPE_COUNT>;
+
+    // Factory data: built once on first use (thread-safe static initialization), read-only afterwards,
+    // so any number of simulation threads share it without locks
+    struct Registry
+    {
+        HeroTemplateTable heroTemplates;
+        AbilityTable abilityDatabase; // Abilities without a description keep a default AbilityInfo
+        std::vector<PartyPreset> partyPresets;
+
+        Registry();
+        void loadPack(const ContentPack &pack); // Content from the active pack instead of the built-in tables
+    };
+
+    static const Registry &registry();
 
-    static void initializeTemplates();
-    static void initializeAbilities();
-    static void initializePartyPresets();
+    static void initializeTemplates(HeroTemplateTable &heroTemplates);
+    static void initializeAbilities(AbilityTable &abilityDatabase);
+    static void initializePartyPresets(std::vector<PartyPreset> &partyPresets);
 
 public:
     // Get list of available classes
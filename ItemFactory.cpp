@@ -1,4 +1,6 @@
 #include "ItemTemplates.h"
+#include "LootTables.h"
+#include "ContentPack.h"
 #include <vector>
 #include <map>
 #include <string>
@@ -6,7 +8,45 @@
 #include <ctime>
 
 // Initialize static members
-std::vector<ItemTemplate> ItemFactory::itemTemplates;
+std::atomic<const LootTables *> ItemFactory::lootTables{nullptr};
+
+ItemFactory::Registry::Registry()
+{
+    if (const ContentPack *pack = ContentPack::active())
+        loadPack(*pack);
+    else
+        initializeTemplates(itemTemplates);
+
+    for (size_t i = 0; i < itemTemplates.size(); ++i)
+    {
+        templatesByType[itemTemplates[i].type].push_back(static_cast<int>(i));
+    }
+}
+
+void ItemFactory::Registry::loadPack(const ContentPack &pack)
+{
+    for (const PackItem &record : pack.items())
+    {
+        if (record.type >= ITEM_TYPE_COUNT || record.slot > static_cast<uint8_t>(EquipmentSlot::NONE))
+        {
+            LOG_WARN(CAMPAIGN, "Content pack: invalid item record '" << pack.text(record.name) << "' skipped");
+            continue;
+        }
+        StatBlock stats;
+        for (size_t stat = 0; stat < static_cast<size_t>(StatType::COUNT); ++stat)
+        {
+            stats[static_cast<StatType>(stat)] = record.stats[stat];
+        }
+        itemTemplates.push_back({pack.text(record.name), pack.text(record.description), static_cast<ItemType>(record.type),
+                                 static_cast<EquipmentSlot>(record.slot), stats});
+    }
+}
+
+const ItemFactory::Registry &ItemFactory::registry()
+{
+    static const Registry instance;
+    return instance;
+}
 
 std::string ItemFactory::generateAbilityString(const std::map<std::string, int> &stats)
 {
@@ -25,299 +65,293 @@ std::string ItemFactory::generateAbilityString(const std::map<std::string, int>
     return result;
 }
 
-void ItemFactory::initializeTemplates()
+void ItemFactory::initializeTemplates(std::vector<ItemTemplate> &itemTemplates)
 {
     // WEAPONS
     {
         auto stats = std::map<std::string, int>{{"damage", 8}, {"attack", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Rusty Sword" + (abilityStr.empty() ? "" : " " + abilityStr), "Old but reliable sword that has seen better days", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, stats});
+        itemTemplates.push_back({"Rusty Sword" + (abilityStr.empty() ? "" : " " + abilityStr), "Old but reliable sword that has seen better days", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"damage", 12}, {"attack", 2}, {"initiative", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Elven Blade" + (abilityStr.empty() ? "" : " " + abilityStr), "Light and sharp sword forged by elven masters", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, stats});
+        itemTemplates.push_back({"Elven Blade" + (abilityStr.empty() ? "" : " " + abilityStr), "Light and sharp sword forged by elven masters", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"damage", 15}, {"attack", 3}, {"defense", -1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Hammer of Thunder" + (abilityStr.empty() ? "" : " " + abilityStr), "Heavy hammer charged with storm power", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, stats});
+        itemTemplates.push_back({"Hammer of Thunder" + (abilityStr.empty() ? "" : " " + abilityStr), "Heavy hammer charged with storm power", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"damage", 10}, {"attack", 2}, {"initiative", 2}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Bow of Shadows" + (abilityStr.empty() ? "" : " " + abilityStr), "A mysterious bow that shoots arrows of pure darkness", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, stats});
+        itemTemplates.push_back({"Bow of Shadows" + (abilityStr.empty() ? "" : " " + abilityStr), "A mysterious bow that shoots arrows of pure darkness", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"damage", 14}, {"attack", 3}, {"stamina", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Staff of Lightning" + (abilityStr.empty() ? "" : " " + abilityStr), "An ancient staff that conducts electrical energy", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, stats});
+        itemTemplates.push_back({"Staff of Lightning" + (abilityStr.empty() ? "" : " " + abilityStr), "An ancient staff that conducts electrical energy", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"damage", 6}, {"attack", 1}, {"initiative", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Assassin's Dagger" + (abilityStr.empty() ? "" : " " + abilityStr), "A cunning dagger coated with deadly poison", ItemType::WEAPON, EquipmentSlot::OFF_HAND, stats});
+        itemTemplates.push_back({"Assassin's Dagger" + (abilityStr.empty() ? "" : " " + abilityStr), "A cunning dagger coated with deadly poison", ItemType::WEAPON, EquipmentSlot::OFF_HAND, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"defense", 8}, {"attack", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Dragon Shield" + (abilityStr.empty() ? "" : " " + abilityStr), "A massive shield made of dragon scales", ItemType::WEAPON, EquipmentSlot::OFF_HAND, stats});
+        itemTemplates.push_back({"Dragon Shield" + (abilityStr.empty() ? "" : " " + abilityStr), "A massive shield made of dragon scales", ItemType::WEAPON, EquipmentSlot::OFF_HAND, StatBlock::fromNames(stats)});
     }
 
     // ARMOR
     {
         auto stats = std::map<std::string, int>{{"defense", 4}, {"health", 10}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Barbarian Helmet" + (abilityStr.empty() ? "" : " " + abilityStr), "A rough helmet made of animal skins and bones", ItemType::ARMOR, EquipmentSlot::HEAD, stats});
+        itemTemplates.push_back({"Barbarian Helmet" + (abilityStr.empty() ? "" : " " + abilityStr), "A rough helmet made of animal skins and bones", ItemType::ARMOR, EquipmentSlot::HEAD, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"defense", 2}, {"attack", 2}, {"initiative", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"King's Crown" + (abilityStr.empty() ? "" : " " + abilityStr), "A golden crown symbolizing power", ItemType::ARMOR, EquipmentSlot::HEAD, stats});
+        itemTemplates.push_back({"King's Crown" + (abilityStr.empty() ? "" : " " + abilityStr), "A golden crown symbolizing power", ItemType::ARMOR, EquipmentSlot::HEAD, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"defense", 10}, {"health", 20}, {"initiative", -1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Knight's Breastplate" + (abilityStr.empty() ? "" : " " + abilityStr), "Heavy armor that protects against any blows", ItemType::ARMOR, EquipmentSlot::CHEST, stats});
+        itemTemplates.push_back({"Knight's Breastplate" + (abilityStr.empty() ? "" : " " + abilityStr), "Heavy armor that protects against any blows", ItemType::ARMOR, EquipmentSlot::CHEST, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"defense", 3}, {"stamina", 2}, {"initiative", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Mage Robe" + (abilityStr.empty() ? "" : " " + abilityStr), "Light fabric imbued with magical energy", ItemType::ARMOR, EquipmentSlot::CHEST, stats});
+        itemTemplates.push_back({"Mage Robe" + (abilityStr.empty() ? "" : " " + abilityStr), "Light fabric imbued with magical energy", ItemType::ARMOR, EquipmentSlot::CHEST, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"damage", 3}, {"defense", 2}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Warrior Gloves" + (abilityStr.empty() ? "" : " " + abilityStr), "Reinforced gloves for powerful strikes", ItemType::ARMOR, EquipmentSlot::HANDS, stats});
+        itemTemplates.push_back({"Warrior Gloves" + (abilityStr.empty() ? "" : " " + abilityStr), "Reinforced gloves for powerful strikes", ItemType::ARMOR, EquipmentSlot::HANDS, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"defense", 3}, {"initiative", 2}, {"stamina", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Traveler's Boots" + (abilityStr.empty() ? "" : " " + abilityStr), "Comfortable footwear for long journeys", ItemType::ARMOR, EquipmentSlot::FEET, stats});
+        itemTemplates.push_back({"Traveler's Boots" + (abilityStr.empty() ? "" : " " + abilityStr), "Comfortable footwear for long journeys", ItemType::ARMOR, EquipmentSlot::FEET, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"defense", 6}, {"health", 15}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Guardian Greaves" + (abilityStr.empty() ? "" : " " + abilityStr), "Reliable greaves that protect the legs", ItemType::ARMOR, EquipmentSlot::LEGS, stats});
+        itemTemplates.push_back({"Guardian Greaves" + (abilityStr.empty() ? "" : " " + abilityStr), "Reliable greaves that protect the legs", ItemType::ARMOR, EquipmentSlot::LEGS, StatBlock::fromNames(stats)});
     }
 
     // ACCESSORIES
     {
         auto stats = std::map<std::string, int>{{"damage", 5}, {"attack", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Ring of Strength" + (abilityStr.empty() ? "" : " " + abilityStr), "A simple ring that enhances physical power", ItemType::ACCESSORY, EquipmentSlot::RING1, stats});
+        itemTemplates.push_back({"Ring of Strength" + (abilityStr.empty() ? "" : " " + abilityStr), "A simple ring that enhances physical power", ItemType::ACCESSORY, EquipmentSlot::RING1, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"defense", 5}, {"health", 10}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Amulet of Protection" + (abilityStr.empty() ? "" : " " + abilityStr), "A sacred amulet that wards off the blows of fate", ItemType::ACCESSORY, EquipmentSlot::NECK, stats});
+        itemTemplates.push_back({"Amulet of Protection" + (abilityStr.empty() ? "" : " " + abilityStr), "A sacred amulet that wards off the blows of fate", ItemType::ACCESSORY, EquipmentSlot::NECK, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"stamina", 3}, {"initiative", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Ring of Mana" + (abilityStr.empty() ? "" : " " + abilityStr), "A ring filled with magical energy", ItemType::ACCESSORY, EquipmentSlot::RING2, stats});
+        itemTemplates.push_back({"Ring of Mana" + (abilityStr.empty() ? "" : " " + abilityStr), "A ring filled with magical energy", ItemType::ACCESSORY, EquipmentSlot::RING2, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"attack", 2}, {"initiative", 2}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Ring of Shadows" + (abilityStr.empty() ? "" : " " + abilityStr), "A mysterious ring that grants the power of shadows", ItemType::ACCESSORY, EquipmentSlot::RING1, stats});
+        itemTemplates.push_back({"Ring of Shadows" + (abilityStr.empty() ? "" : " " + abilityStr), "A mysterious ring that grants the power of shadows", ItemType::ACCESSORY, EquipmentSlot::RING1, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"health", 25}, {"defense", 2}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Necklace of Life" + (abilityStr.empty() ? "" : " " + abilityStr), "A precious necklace pulsing with life force", ItemType::ACCESSORY, EquipmentSlot::NECK, stats});
+        itemTemplates.push_back({"Necklace of Life" + (abilityStr.empty() ? "" : " " + abilityStr), "A precious necklace pulsing with life force", ItemType::ACCESSORY, EquipmentSlot::NECK, StatBlock::fromNames(stats)});
     }
 
     // CONSUMABLES
     {
         auto stats = std::map<std::string, int>{{"health_restore", 50}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Health Potion" + (abilityStr.empty() ? "" : " " + abilityStr), "Red liquid that restores vital forces", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats});
+        itemTemplates.push_back({"Health Potion" + (abilityStr.empty() ? "" : " " + abilityStr), "Red liquid that restores vital forces", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"stamina_restore", 2}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Stamina Potion" + (abilityStr.empty() ? "" : " " + abilityStr), "Blue liquid that restores energy", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats});
+        itemTemplates.push_back({"Stamina Potion" + (abilityStr.empty() ? "" : " " + abilityStr), "Blue liquid that restores energy", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"health_restore", 100}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Greater Health Potion" + (abilityStr.empty() ? "" : " " + abilityStr), "A powerful potion that fully heals wounds", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats});
+        itemTemplates.push_back({"Greater Health Potion" + (abilityStr.empty() ? "" : " " + abilityStr), "A powerful potion that fully heals wounds", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"damage", 20}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Poison" + (abilityStr.empty() ? "" : " " + abilityStr), "Deadly poison that deals damage over time", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats}); // For use on enemies
+        itemTemplates.push_back({"Poison" + (abilityStr.empty() ? "" : " " + abilityStr), "Deadly poison that deals damage over time", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)}); // For use on enemies
     }
 
     {
         auto stats = std::map<std::string, int>{{"damage", 10}, {"attack", 2}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Elixir of Strength" + (abilityStr.empty() ? "" : " " + abilityStr), "Temporary boost to physical abilities", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats}); // Temporary effect
+        itemTemplates.push_back({"Elixir of Strength" + (abilityStr.empty() ? "" : " " + abilityStr), "Temporary boost to physical abilities", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)}); // Temporary effect
     }
 
     {
         auto stats = std::map<std::string, int>{{"teleport", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Teleportation Scroll" + (abilityStr.empty() ? "" : " " + abilityStr), "A magical scroll for instant relocation", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats}); // Special effect
+        itemTemplates.push_back({"Teleportation Scroll" + (abilityStr.empty() ? "" : " " + abilityStr), "A magical scroll for instant relocation", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)}); // Special effect
     }
 
     {
         auto stats = std::map<std::string, int>{{"invisible", 3}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Invisibility Potion" + (abilityStr.empty() ? "" : " " + abilityStr), "Makes invisible for a short time", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats}); // In seconds or turns
+        itemTemplates.push_back({"Invisibility Potion" + (abilityStr.empty() ? "" : " " + abilityStr), "Makes invisible for a short time", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)}); // In seconds or turns
     }
 
     {
         auto stats = std::map<std::string, int>{{"stamina_restore", 10}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Energy Crystal" + (abilityStr.empty() ? "" : " " + abilityStr), "Restores all stamina", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats});
+        itemTemplates.push_back({"Energy Crystal" + (abilityStr.empty() ? "" : " " + abilityStr), "Restores all stamina", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"health_restore", 200}, {"stamina_restore", 5}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Fruit of Life" + (abilityStr.empty() ? "" : " " + abilityStr), "A mystical fruit that grants eternal youth", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats});
+        itemTemplates.push_back({"Fruit of Life" + (abilityStr.empty() ? "" : " " + abilityStr), "A mystical fruit that grants eternal youth", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"health_restore", 30}, {"stamina_restore", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Restoration Powder" + (abilityStr.empty() ? "" : " " + abilityStr), "Magical powder for quick healing", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats});
+        itemTemplates.push_back({"Restoration Powder" + (abilityStr.empty() ? "" : " " + abilityStr), "Magical powder for quick healing", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)});
     }
 
     // Additional unique items
     {
         auto stats = std::map<std::string, int>{{"damage", 18}, {"attack", 3}, {"fire_damage", 5}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Sword of Flame" + (abilityStr.empty() ? "" : " " + abilityStr), "A blade engulfed in eternal fire", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, stats});
+        itemTemplates.push_back({"Sword of Flame" + (abilityStr.empty() ? "" : " " + abilityStr), "A blade engulfed in eternal fire", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"damage", 16}, {"attack", 2}, {"ice_damage", 7}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Ice Staff" + (abilityStr.empty() ? "" : " " + abilityStr), "A staff radiating cold energy", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, stats});
+        itemTemplates.push_back({"Ice Staff" + (abilityStr.empty() ? "" : " " + abilityStr), "A staff radiating cold energy", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"defense", 8}, {"health", 15}, {"attack", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Dragon Helmet" + (abilityStr.empty() ? "" : " " + abilityStr), "A helmet from the head of an ancient dragon", ItemType::ARMOR, EquipmentSlot::HEAD, stats});
+        itemTemplates.push_back({"Dragon Helmet" + (abilityStr.empty() ? "" : " " + abilityStr), "A helmet from the head of an ancient dragon", ItemType::ARMOR, EquipmentSlot::HEAD, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"attack", 3}, {"initiative", 2}, {"command", 1}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Ring of Dominion" + (abilityStr.empty() ? "" : " " + abilityStr), "A ring that gives control over minds", ItemType::ACCESSORY, EquipmentSlot::RING1, stats});
+        itemTemplates.push_back({"Ring of Dominion" + (abilityStr.empty() ? "" : " " + abilityStr), "A ring that gives control over minds", ItemType::ACCESSORY, EquipmentSlot::RING1, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"health", 20}, {"regeneration", 5}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Amulet of Regeneration" + (abilityStr.empty() ? "" : " " + abilityStr), "An amulet that accelerates natural healing", ItemType::ACCESSORY, EquipmentSlot::NECK, stats});
+        itemTemplates.push_back({"Amulet of Regeneration" + (abilityStr.empty() ? "" : " " + abilityStr), "An amulet that accelerates natural healing", ItemType::ACCESSORY, EquipmentSlot::NECK, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"damage", 15}, {"attack", 3}, {"defense", -2}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Rage Potion" + (abilityStr.empty() ? "" : " " + abilityStr), "Causes uncontrollable rage", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats}); // Temporary berserk
+        itemTemplates.push_back({"Rage Potion" + (abilityStr.empty() ? "" : " " + abilityStr), "Causes uncontrollable rage", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)}); // Temporary berserk
     }
 
     {
         auto stats = std::map<std::string, int>{{"fire_damage", 50}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Fireball Scroll" + (abilityStr.empty() ? "" : " " + abilityStr), "Summons a fireball", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats});
+        itemTemplates.push_back({"Fireball Scroll" + (abilityStr.empty() ? "" : " " + abilityStr), "Summons a fireball", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)});
     }
 
     {
         auto stats = std::map<std::string, int>{{"ice_damage", 40}, {"freeze", 2}};
         std::string abilityStr = generateAbilityString(stats);
-        itemTemplates.push_back({"Ice Crystal" + (abilityStr.empty() ? "" : " " + abilityStr), "Freezes enemies", ItemType::CONSUMABLE, EquipmentSlot::NONE, stats}); // Freeze for turns
+        itemTemplates.push_back({"Ice Crystal" + (abilityStr.empty() ? "" : " " + abilityStr), "Freezes enemies", ItemType::CONSUMABLE, EquipmentSlot::NONE, StatBlock::fromNames(stats)}); // Freeze for turns
     }
 }
 
 const std::vector<ItemTemplate> &ItemFactory::getAllItems()
 {
-    if (itemTemplates.empty())
-    {
-        initializeTemplates();
-    }
-    return itemTemplates;
+    return registry().itemTemplates;
 }
 
 std::vector<ItemTemplate> ItemFactory::getItemsByType(ItemType type)
 {
-    if (itemTemplates.empty())
-    {
-        initializeTemplates();
-    }
-
+    const Registry &data = registry();
     std::vector<ItemTemplate> filtered;
-    for (const auto &item : itemTemplates)
+    for (int index : data.templatesByType[type])
     {
-        if (item.type == type)
-        {
-            filtered.push_back(item);
-        }
+        filtered.push_back(data.itemTemplates[index]);
     }
     return filtered;
 }
 
 Item ItemFactory::createItem(int index)
 {
-    if (itemTemplates.empty())
-    {
-        initializeTemplates();
-    }
-
+    const std::vector<ItemTemplate> &itemTemplates = registry().itemTemplates;
     if (index < 0 || index >= static_cast<int>(itemTemplates.size()))
     {
         return Item(); // Return default item
     }
 
-    const ItemTemplate &tmpl = itemTemplates[index];
-    return Item(tmpl.name, tmpl.description, tmpl.type, tmpl.slot, tmpl.stats);
+    return Item(itemTemplates[index]);
 }
 
 Item ItemFactory::createRandomItem()
 {
-    if (itemTemplates.empty())
-    {
-        initializeTemplates();
-    }
-
-    int index = rand() % itemTemplates.size();
+    int index = rand() % registry().itemTemplates.size();
     return createItem(index);
 }
 
 Item ItemFactory::createRandomItemOfType(ItemType type)
 {
-    std::vector<ItemTemplate> typeItems = getItemsByType(type);
+    const std::vector<int> &typeItems = registry().templatesByType[type];
     if (typeItems.empty())
     {
         return Item(); // Return default item
     }
 
     int index = rand() % typeItems.size();
-    const ItemTemplate &tmpl = typeItems[index];
-    return Item(tmpl.name, tmpl.description, tmpl.type, tmpl.slot, tmpl.stats);
-}
\ No newline at end of file
+    return createItem(typeItems[index]);
+}
+
+Item ItemFactory::createLoot(LocationType location, int difficulty)
+{
+    const LootTables *active = lootTables.load(std::memory_order_acquire);
+    const LootTables &tables = active ? *active : LootTables::builtin();
+    int index = tables.roll(location, difficulty);
+    return index >= 0 ? createItem(index) : createRandomItem();
+}
+
+Item ItemFactory::createLoot(LocationType location, int difficulty, ItemType type)
+{
+    const LootTables *active = lootTables.load(std::memory_order_acquire);
+    const LootTables &tables = active ? *active : LootTables::builtin();
+    int index = tables.roll(location, difficulty, type);
+    return index >= 0 ? createItem(index) : createRandomItemOfType(type);
+}
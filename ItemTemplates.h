@@ -1,26 +1,36 @@
 #pragma once
 #include "entity.h"
+#include "EnumArray.h"
+#include <atomic>
 #include <vector>
 #include <map>
 #include <string>
 
-// Item template structure
-struct ItemTemplate
-{
-    std::string name = "";
-    std::string description = "";
-    ItemType type = ItemType::CONSUMABLE;
-    EquipmentSlot slot = EquipmentSlot::NONE;
-    std::map<std::string, int> stats = {};
-};
+// Item template: immutable data shared by every item created from it
+using ItemTemplate = ItemData;
+
+class LootTables;
+class ContentPack;
 
 // Factory for creating items
 class ItemFactory
 {
 private:
-    static std::vector<ItemTemplate> itemTemplates;
+    // Catalog: built once on first use (thread-safe static initialization), read-only afterwards,
+    // so simulation threads share it without locks
+    struct Registry
+    {
+        std::vector<ItemTemplate> itemTemplates;
+        EnumArray<ItemType, std::vector<int>, ITEM_TYPE_COUNT> templatesByType; // Template indices per ItemType
+
+        Registry();
+        void loadPack(const ContentPack &pack); // Catalog from the active pack instead of the built-in one
+    };
 
-    static void initializeTemplates();
+    static std::atomic<const LootTables *> lootTables;
+
+    static const Registry &registry();
+    static void initializeTemplates(std::vector<ItemTemplate> &itemTemplates);
 
 public:
     // Get list of all items
@@ -29,7 +39,7 @@ public:
     // Get items by type
     static std::vector<ItemTemplate> getItemsByType(ItemType type);
 
-    // Create item by index
+    // Create item by index (the item refers to the template, nothing is copied)
     static Item createItem(int index);
 
     // Create random item
@@ -38,6 +48,14 @@ public:
     // Create random item of specific type
     static Item createRandomItemOfType(ItemType type);
 
+    // Loot for a location and difficulty, rolled from the active loot tables (O(1), no allocation).
+    // Falls back to a uniform roll when the location has no table
+    static Item createLoot(LocationType location, int difficulty);
+    static Item createLoot(LocationType location, int difficulty, ItemType type);
+
+    // Loot tables used by createLoot; nullptr - built-in tables. The tables must outlive their use
+    static void setLootTables(const LootTables *tables) { lootTables.store(tables, std::memory_order_release); }
+
     // Generate ability string
     static std::string generateAbilityString(const std::map<std::string, int>& stats);
 };
\ No newline at end of file
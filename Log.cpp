@@ -0,0 +1,290 @@
+#include "Log.h"
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+std::atomic<uint8_t> Log::s_levels[static_cast<size_t>(LogCategory::COUNT)] = {
+    {static_cast<uint8_t>(LogLevel::INFO)},
+    {static_cast<uint8_t>(LogLevel::INFO)},
+    {static_cast<uint8_t>(LogLevel::INFO)},
+    {static_cast<uint8_t>(LogLevel::INFO)}};
+
+namespace
+{
+    struct Record
+    {
+        LogLevel level = LogLevel::INFO;
+        LogCategory category = LogCategory::BATTLE;
+        std::string text;
+    };
+
+    // Ограниченная очередь без блокировок (схема Вьюкова): у каждой ячейки счетчик поколения,
+    // писатели занимают ячейку CAS по позиции записи. Читатель один - поток записи
+    class RecordQueue
+    {
+    public:
+        static const size_t CAPACITY = 4096; // Степень двойки
+
+        RecordQueue()
+        {
+            for (size_t i = 0; i < CAPACITY; ++i)
+            {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        bool push(Record &&record)
+        {
+            size_t position = m_enqueue.load(std::memory_order_relaxed);
+            Cell *cell;
+            for (;;)
+            {
+                cell = &m_cells[position & (CAPACITY - 1)];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (difference == 0)
+                {
+                    if (m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (difference < 0)
+                {
+                    return false; // Очередь полна
+                }
+                else
+                {
+                    position = m_enqueue.load(std::memory_order_relaxed);
+                }
+            }
+            cell->record = std::move(record);
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(Record &record)
+        {
+            Cell &cell = m_cells[m_dequeue & (CAPACITY - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != m_dequeue + 1)
+                return false;
+            record = std::move(cell.record);
+            cell.sequence.store(m_dequeue + CAPACITY, std::memory_order_release);
+            ++m_dequeue;
+            return true;
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            Record record;
+        };
+
+        std::array<Cell, CAPACITY> m_cells;
+        alignas(64) std::atomic<size_t> m_enqueue{0};
+        alignas(64) size_t m_dequeue = 0;
+    };
+
+    // Фоновый поток записи. Живет до конца программы; деструктор выводит остаток очереди
+    class Writer
+    {
+    public:
+        Writer() : m_thread(&Writer::run, this) {}
+
+        ~Writer()
+        {
+            m_stopping.store(true, std::memory_order_release);
+            wake();
+            m_thread.join();
+        }
+
+        void submit(Record &&record)
+        {
+            if (!m_queue.push(std::move(record)))
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            m_submitted.fetch_add(1, std::memory_order_release);
+            wake();
+        }
+
+        void flush()
+        {
+            uint64_t target = m_submitted.load(std::memory_order_acquire);
+            while (m_written.load(std::memory_order_acquire) < target)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        RecordQueue m_queue;
+        std::atomic<uint32_t> m_signal{0};
+        std::atomic<bool> m_stopping{false};
+        std::atomic<uint64_t> m_submitted{0};
+        std::atomic<uint64_t> m_written{0};
+        std::atomic<uint64_t> m_dropped{0};
+        std::thread m_thread;
+
+        void wake()
+        {
+            m_signal.fetch_add(1, std::memory_order_release);
+            m_signal.notify_one();
+        }
+
+        void run()
+        {
+            Record record;
+            for (;;)
+            {
+                uint32_t seen = m_signal.load(std::memory_order_acquire);
+                bool wrote = false;
+                while (m_queue.pop(record))
+                {
+                    std::fprintf(stdout, "[%s][%s] %s\n", Log::levelName(record.level),
+                                 Log::categoryName(record.category), record.text.c_str());
+                    m_written.fetch_add(1, std::memory_order_release);
+                    wrote = true;
+                }
+                if (wrote)
+                    std::fflush(stdout);
+                if (m_stopping.load(std::memory_order_acquire))
+                {
+                    // Запись могла встать в очередь между разбором и флагом остановки
+                    if (m_written.load(std::memory_order_acquire) >= m_submitted.load(std::memory_order_acquire))
+                        return;
+                    continue;
+                }
+                m_signal.wait(seen, std::memory_order_acquire);
+            }
+        }
+    };
+
+    Writer &writer()
+    {
+        static Writer instance;
+        return instance;
+    }
+
+    LogLevel parseLevel(const std::string &name)
+    {
+        for (int level = 0; level <= static_cast<int>(LogLevel::OFF); ++level)
+        {
+            std::string candidate = Log::levelName(static_cast<LogLevel>(level));
+            for (char &c : candidate)
+            {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            if (candidate == name)
+                return static_cast<LogLevel>(level);
+        }
+        throw std::invalid_argument("Unknown log level: " + name);
+    }
+}
+
+void Log::setLevel(LogCategory category, LogLevel level)
+{
+    s_levels[static_cast<size_t>(category)].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+void Log::setLevel(LogLevel level)
+{
+    for (auto &threshold : s_levels)
+    {
+        threshold.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+    }
+}
+
+LogLevel Log::getLevel(LogCategory category)
+{
+    return static_cast<LogLevel>(s_levels[static_cast<size_t>(category)].load(std::memory_order_relaxed));
+}
+
+void Log::configure(const std::string &spec)
+{
+    size_t start = 0;
+    while (start <= spec.size())
+    {
+        size_t end = spec.find(',', start);
+        if (end == std::string::npos)
+            end = spec.size();
+        std::string entry = spec.substr(start, end - start);
+        start = end + 1;
+        if (entry.empty())
+            continue;
+
+        size_t equals = entry.find('=');
+        if (equals == std::string::npos)
+        {
+            setLevel(parseLevel(entry));
+            continue;
+        }
+        std::string name = entry.substr(0, equals);
+        LogLevel level = parseLevel(entry.substr(equals + 1));
+        int category = 0;
+        while (category < static_cast<int>(LogCategory::COUNT) && name != categoryName(static_cast<LogCategory>(category)))
+            ++category;
+        if (category == static_cast<int>(LogCategory::COUNT))
+            throw std::invalid_argument("Unknown log category: " + name);
+        setLevel(static_cast<LogCategory>(category), level);
+    }
+}
+
+void Log::write(LogLevel level, LogCategory category, std::string text)
+{
+    writer().submit(Record{level, category, std::move(text)});
+}
+
+void Log::flush()
+{
+    writer().flush();
+}
+
+uint64_t Log::getDroppedCount()
+{
+    return writer().dropped();
+}
+
+const char *Log::levelName(LogLevel level)
+{
+    switch (level)
+    {
+    case LogLevel::TRACE:
+        return "TRACE";
+    case LogLevel::DEBUG:
+        return "DEBUG";
+    case LogLevel::INFO:
+        return "INFO";
+    case LogLevel::WARN:
+        return "WARN";
+    case LogLevel::ERR:
+        return "ERROR";
+    case LogLevel::OFF:
+        return "OFF";
+    }
+    return "?";
+}
+
+const char *Log::categoryName(LogCategory category)
+{
+    switch (category)
+    {
+    case LogCategory::BATTLE:
+        return "battle";
+    case LogCategory::MAP:
+        return "map";
+    case LogCategory::CAMPAIGN:
+        return "campaign";
+    case LogCategory::GUI:
+        return "gui";
+    case LogCategory::COUNT:
+        break;
+    }
+    return "?";
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// Журнал с уровнями и категориями подсистем.
+// Уровни ниже LOG_MIN_LEVEL вырезаются при компиляции: тело макроса LOG_* оказывается в ветке
+// if constexpr, которая не попадает в код, и аргументы не вычисляются. Остальные записи сверяются
+// с порогом своей категории (меняется во время работы); прошедшие проверку форматируются
+// и уходят в неблокирующую очередь, которую разбирает фоновый поток записи.
+enum class LogLevel : uint8_t
+{
+    TRACE,
+    DEBUG,
+    INFO,
+    WARN,
+    ERR, // Не ERROR: в windows.h это макрос
+    OFF
+};
+
+enum class LogCategory : uint8_t
+{
+    BATTLE,
+    MAP,
+    CAMPAIGN,
+    GUI,
+    COUNT
+};
+
+// Нижний уровень, который вообще попадает в сборку (номер в LogLevel).
+// По умолчанию отладочная сборка оставляет DEBUG, релизная - начиная с INFO
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL 2
+#else
+#define LOG_MIN_LEVEL 1
+#endif
+#endif
+
+class Log
+{
+public:
+    // Порог категории: записи ниже него отбрасываются до форматирования. По умолчанию INFO
+    static void setLevel(LogCategory category, LogLevel level);
+    static void setLevel(LogLevel level); // Для всех категорий
+    static LogLevel getLevel(LogCategory category);
+
+    // Пороги из строки вида "battle=debug,map=off" или "debug" (все категории).
+    // Неизвестное имя - invalid_argument
+    static void configure(const std::string &spec);
+
+    static bool enabled(LogCategory category, LogLevel level)
+    {
+        return static_cast<uint8_t>(level) >= s_levels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+    }
+
+    // Поставить запись в очередь; поток записи запускается при первой записи.
+    // Очередь ограничена: при переполнении запись отбрасывается, вызывающий не ждет
+    static void write(LogLevel level, LogCategory category, std::string text);
+
+    // Дождаться, пока поток записи выведет все поставленные записи
+    static void flush();
+
+    // Сколько записей отброшено из-за переполнения очереди
+    static uint64_t getDroppedCount();
+
+    static const char *levelName(LogLevel level);
+    static const char *categoryName(LogCategory category);
+
+private:
+    static std::atomic<uint8_t> s_levels[static_cast<size_t>(LogCategory::COUNT)];
+};
+
+#define LOG_AT(level, category, message)                                           \
+    do                                                                             \
+    {                                                                              \
+        if constexpr (static_cast<int>(LogLevel::level) >= LOG_MIN_LEVEL)          \
+        {                                                                          \
+            if (Log::enabled(LogCategory::category, LogLevel::level))              \
+            {                                                                      \
+                std::ostringstream logStream;                                      \
+                logStream << message;                                              \
+                Log::write(LogLevel::level, LogCategory::category, logStream.str()); \
+            }                                                                      \
+        }                                                                          \
+    } while (false)
+
+#define LOG_TRACE(category, message) LOG_AT(TRACE, category, message)
+#define LOG_DEBUG(category, message) LOG_AT(DEBUG, category, message)
+#define LOG_INFO(category, message) LOG_AT(INFO, category, message)
+#define LOG_WARN(category, message) LOG_AT(WARN, category, message)
+#define LOG_ERROR(category, message) LOG_AT(ERR, category, message)
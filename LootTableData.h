@@ -0,0 +1,88 @@
+#pragma once
+
+// Встроенные таблицы добычи (формат описан в LootTables.h).
+// Файл loot_tables.txt рядом с игрой, если он есть, заменяет эти таблицы.
+static const char *defaultLootTables = R"(
+# Редкость шаблонов
+item uncommon Elven Blade
+item uncommon Bow of Shadows
+item uncommon Dragon Shield
+item rare Hammer of Thunder
+item rare Staff of Lightning
+item epic Sword of Flame
+item epic Ice Staff
+
+item uncommon Barbarian Helmet
+item rare Guardian Greaves
+item epic Dragon Helmet
+item epic Knight's Breastplate
+
+item uncommon Ring of Strength
+item uncommon Ring of Dominion
+item uncommon Amulet of Protection
+item epic Amulet of Regeneration
+item epic Necklace of Life
+
+item uncommon Elixir of Strength
+item uncommon Rage Potion
+item uncommon Poison
+item uncommon Restoration Powder
+item rare Greater Health Potion
+item rare Ice Crystal
+item rare Fireball Scroll
+item legendary Fruit of Life
+
+# Лес: в основном простые вещи, у лесных алтарей чаще украшения
+table forest 0
+  common 70
+  uncommon 25
+  rare 5
+  type accessory 1.5
+
+table forest 3
+  common 55
+  uncommon 30
+  rare 12
+  epic 3
+  type accessory 1.5
+
+# Пещеры: оружие забытых воинов
+table cave 0
+  common 55
+  uncommon 30
+  rare 12
+  epic 3
+  type weapon 1.5
+
+table cave 4
+  common 40
+  uncommon 35
+  rare 18
+  epic 6
+  legendary 1
+  type weapon 1.5
+
+# Мертвый город: доспехи павших героев
+table dead_city 0
+  common 40
+  uncommon 35
+  rare 18
+  epic 6
+  legendary 1
+  type armor 1.5
+
+table dead_city 5
+  common 25
+  uncommon 35
+  rare 25
+  epic 12
+  legendary 3
+  type armor 1.5
+
+table castle 0
+  common 20
+  uncommon 30
+  rare 28
+  epic 17
+  legendary 5
+)";
@@ -0,0 +1,271 @@
+#include "LootTables.h"
+#include "LootTableData.h"
+#include "ItemTemplates.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    const char *const rarityNames[] = {"common", "uncommon", "rare", "epic", "legendary"};
+    const char *const locationNames[] = {"forest", "cave", "dead_city", "castle"};
+    const char *const typeNames[] = {"weapon", "armor", "accessory", "consumable"};
+
+    runtime_error syntaxError(int line, const string &message)
+    {
+        return runtime_error("loot tables, line " + to_string(line) + ": " + message);
+    }
+
+    template <size_t N>
+    int parseName(int line, const char *const (&names)[N], const string &text, const char *what)
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (text == names[i])
+                return static_cast<int>(i);
+        }
+        throw syntaxError(line, string("unknown ") + what + " '" + text + "'");
+    }
+
+    double parseWeight(int line, const string &text)
+    {
+        size_t used = 0;
+        double value = -1.0;
+        try
+        {
+            value = stod(text, &used);
+        }
+        catch (const exception &)
+        {
+            used = 0;
+        }
+        if (used != text.size() || value < 0.0)
+            throw syntaxError(line, "expected a non-negative number, got '" + text + "'");
+        return value;
+    }
+
+    // Имя шаблона без описания статов: "Rusty Sword (attack +1, damage +8)" -> "Rusty Sword"
+    string baseName(const string &name)
+    {
+        size_t bracket = name.find(" (");
+        return bracket == string::npos ? name : name.substr(0, bracket);
+    }
+
+    // Описание таблицы до сборки
+    struct TableSpec
+    {
+        LocationType location;
+        int minDifficulty;
+        array<double, static_cast<size_t>(ItemRarity::COUNT)> rarityWeights{};
+        array<double, static_cast<size_t>(ItemType::CONSUMABLE) + 1> typeMultipliers;
+        int line;
+
+        TableSpec() { typeMultipliers.fill(1.0); }
+    };
+}
+
+const LootTables &LootTables::builtin()
+{
+    static const LootTables tables = []()
+    {
+        LootTables compiled;
+        compiled.compile(defaultLootTables);
+        return compiled;
+    }();
+    return tables;
+}
+
+const char *LootTables::rarityName(ItemRarity rarity)
+{
+    return rarity < ItemRarity::COUNT ? rarityNames[static_cast<size_t>(rarity)] : "?";
+}
+
+void LootTables::compile(const string &source)
+{
+    const vector<ItemTemplate> &catalog = ItemFactory::getAllItems();
+    vector<ItemRarity> compiledRarities(catalog.size(), ItemRarity::COMMON);
+    vector<TableSpec> specs;
+
+    istringstream input(source);
+    string text;
+    int line = 0;
+    while (getline(input, text))
+    {
+        ++line;
+        size_t comment = text.find('#');
+        if (comment != string::npos)
+            text.erase(comment);
+        istringstream words(text);
+        vector<string> tokens;
+        string word;
+        while (words >> word)
+        {
+            tokens.push_back(word);
+        }
+        if (tokens.empty())
+            continue;
+
+        if (tokens[0] == "item")
+        {
+            if (tokens.size() < 3)
+                throw syntaxError(line, "'item' expects a rarity and a template name");
+            ItemRarity rarity = static_cast<ItemRarity>(parseName(line, rarityNames, tokens[1], "rarity"));
+            string name = tokens[2];
+            for (size_t i = 3; i < tokens.size(); ++i)
+            {
+                name += " " + tokens[i];
+            }
+            bool found = false;
+            for (size_t i = 0; i < catalog.size(); ++i)
+            {
+                if (baseName(catalog[i].name) == name)
+                {
+                    compiledRarities[i] = rarity;
+                    found = true;
+                }
+            }
+            if (!found)
+                throw syntaxError(line, "unknown item template '" + name + "'");
+        }
+        else if (tokens[0] == "table")
+        {
+            if (tokens.size() != 3)
+                throw syntaxError(line, "'table' expects a location and a difficulty");
+            TableSpec spec;
+            spec.location = static_cast<LocationType>(parseName(line, locationNames, tokens[1], "location"));
+            double difficulty = parseWeight(line, tokens[2]);
+            spec.minDifficulty = static_cast<int>(difficulty);
+            if (spec.minDifficulty != difficulty || spec.minDifficulty > 1000)
+                throw syntaxError(line, "difficulty must be an integer 0..1000");
+            spec.line = line;
+            for (const TableSpec &other : specs)
+            {
+                if (other.location == spec.location && other.minDifficulty == spec.minDifficulty)
+                    throw syntaxError(line, "duplicate table for '" + tokens[1] + "' " + tokens[2]);
+            }
+            specs.push_back(spec);
+        }
+        else if (specs.empty())
+        {
+            throw syntaxError(line, "weight outside of a table");
+        }
+        else if (tokens[0] == "type")
+        {
+            if (tokens.size() != 3)
+                throw syntaxError(line, "'type' expects an item type and a multiplier");
+            int type = parseName(line, typeNames, tokens[1], "item type");
+            specs.back().typeMultipliers[type] = parseWeight(line, tokens[2]);
+        }
+        else
+        {
+            if (tokens.size() != 2)
+                throw syntaxError(line, "expected '<rarity> <weight>'");
+            int rarity = parseName(line, rarityNames, tokens[0], "rarity");
+            specs.back().rarityWeights[rarity] = parseWeight(line, tokens[1]);
+        }
+    }
+
+    vector<Table> compiledTables;
+    for (const TableSpec &spec : specs)
+    {
+        // Вес редкости делится между ее предметами пропорционально множителям типов
+        array<double, static_cast<size_t>(ItemRarity::COUNT)> rarityShares{};
+        for (size_t i = 0; i < catalog.size(); ++i)
+        {
+            rarityShares[static_cast<size_t>(compiledRarities[i])] += spec.typeMultipliers[static_cast<size_t>(catalog[i].type)];
+        }
+        vector<uint16_t> candidates;
+        vector<double> weights;
+        for (size_t i = 0; i < catalog.size(); ++i)
+        {
+            size_t rarity = static_cast<size_t>(compiledRarities[i]);
+            double weight = spec.rarityWeights[rarity] * spec.typeMultipliers[static_cast<size_t>(catalog[i].type)];
+            if (weight > 0.0)
+            {
+                candidates.push_back(static_cast<uint16_t>(i));
+                weights.push_back(weight / rarityShares[rarity]);
+            }
+        }
+        if (candidates.empty())
+            throw syntaxError(spec.line, "table has no items with a positive weight");
+
+        Table table;
+        table.any.build(candidates, weights);
+        for (size_t type = 0; type < table.byType.size(); ++type)
+        {
+            vector<uint16_t> typed;
+            vector<double> typedWeights;
+            for (size_t i = 0; i < candidates.size(); ++i)
+            {
+                if (static_cast<size_t>(catalog[candidates[i]].type) == type)
+                {
+                    typed.push_back(candidates[i]);
+                    typedWeights.push_back(weights[i]);
+                }
+            }
+            table.byType[type].build(typed, typedWeights);
+        }
+        compiledTables.push_back(move(table));
+    }
+
+    // Сложность -> таблица: действует таблица с наибольшей начальной сложностью, не выше текущей
+    array<vector<int>, static_cast<size_t>(LocationType::CASTLE) + 1> compiledIndex;
+    for (size_t location = 0; location < compiledIndex.size(); ++location)
+    {
+        int maxDifficulty = -1;
+        for (const TableSpec &spec : specs)
+        {
+            if (static_cast<size_t>(spec.location) == location)
+                maxDifficulty = max(maxDifficulty, spec.minDifficulty);
+        }
+        compiledIndex[location].assign(maxDifficulty + 1, -1);
+        for (int difficulty = 0; difficulty <= maxDifficulty; ++difficulty)
+        {
+            int best = -1;
+            for (size_t i = 0; i < specs.size(); ++i)
+            {
+                if (static_cast<size_t>(specs[i].location) == location && specs[i].minDifficulty <= difficulty &&
+                    (best < 0 || specs[i].minDifficulty > specs[best].minDifficulty))
+                    best = static_cast<int>(i);
+            }
+            compiledIndex[location][difficulty] = best;
+        }
+    }
+
+    rarities.swap(compiledRarities);
+    tables.swap(compiledTables);
+    byDifficulty.swap(compiledIndex);
+}
+
+bool LootTables::loadFile(const string &path)
+{
+    ifstream file(path);
+    if (!file)
+        return false;
+    stringstream buffer;
+    buffer << file.rdbuf();
+    compile(buffer.str());
+    return true;
+}
+
+const LootTables::Table *LootTables::find(LocationType location, int difficulty) const
+{
+    const vector<int> &index = byDifficulty[static_cast<size_t>(location)];
+    if (index.empty())
+        return nullptr;
+    int table = index[min(max(difficulty, 0), static_cast<int>(index.size()) - 1)];
+    return table >= 0 ? &tables[table] : nullptr;
+}
+
+int LootTables::roll(LocationType location, int difficulty) const
+{
+    const Table *table = find(location, difficulty);
+    return table ? table->any.sample() : -1;
+}
+
+int LootTables::roll(LocationType location, int difficulty, ItemType type) const
+{
+    const Table *table = find(location, difficulty);
+    return table ? table->byType[static_cast<size_t>(type)].sample() : -1;
+}
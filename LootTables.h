@@ -0,0 +1,66 @@
+#pragma once
+#include "entity.h"
+#include "AliasTable.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class ItemRarity : uint8_t
+{
+    COMMON,
+    UNCOMMON,
+    RARE,
+    EPIC,
+    LEGENDARY,
+    COUNT
+};
+
+// Таблицы добычи по локации и сложности. Описание задается текстом и компилируется в таблицы
+// псевдонимов (AliasTable): бросок - два rand() и одно сравнение, без аллокаций и перебора каталога.
+// Для каждой таблицы отдельно собраны таблицы по типу предмета (награда "оружие" и т.п.).
+//
+// Формат ("#" - комментарий):
+//   item <редкость> <имя шаблона>         - редкость шаблона ItemFactory; имя без описания статов
+//                                           в скобках. Не перечисленные шаблоны - common
+//   table <локация> <сложность>          - таблица действует с этой сложности до следующей таблицы
+//                                           той же локации
+//     <редкость> <вес>                    - доля редкости в таблице, делится поровну между ее предметами
+//     type <тип> <множитель>              - множитель веса предметов типа внутри редкости
+// Редкости: common, uncommon, rare, epic, legendary. Локации: forest, cave, dead_city, castle.
+// Типы: weapon, armor, accessory, consumable.
+class LootTables
+{
+public:
+    // Встроенные таблицы (LootTableData.h)
+    static const LootTables &builtin();
+
+    // Разобрать и скомпилировать описание; ошибка - runtime_error с номером строки
+    void compile(const string &source);
+    // Загрузить описание из файла; false, если файла нет
+    bool loadFile(const string &path);
+
+    // Индекс шаблона в каталоге ItemFactory или -1, если для локации нет таблицы
+    // (или в таблице нет предметов нужного типа)
+    int roll(LocationType location, int difficulty) const;
+    int roll(LocationType location, int difficulty, ItemType type) const;
+
+    ItemRarity getRarity(int templateIndex) const { return rarities[templateIndex]; }
+    size_t getTableCount() const { return tables.size(); }
+
+    static const char *rarityName(ItemRarity rarity);
+
+private:
+    struct Table
+    {
+        AliasTable any;
+        array<AliasTable, static_cast<size_t>(ItemType::CONSUMABLE) + 1> byType;
+    };
+
+    vector<ItemRarity> rarities; // По индексу шаблона
+    vector<Table> tables;
+    // Локация -> номер таблицы для сложности 0, 1, ...; старше последней - последняя
+    array<vector<int>, static_cast<size_t>(LocationType::CASTLE) + 1> byDifficulty;
+
+    const Table *find(LocationType location, int difficulty) const;
+};
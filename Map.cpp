@@ -1,4 +1,5 @@
 #include "Map.h"
+#include "ContentPack.h"
 #include <iostream>
 #include <algorithm>
 #include <queue>
@@ -107,11 +108,38 @@ void Map::generate()
         break;
     }
 
-    // Select a prototype variant randomly [0..3]
-    int variantIndex = rng() % 4;
+    // Prototypes from the active content pack replace the built-in ones for this map type.
+    // Rows are read straight from the mapped file
+    static const LocationType mapLocations[4] = {LocationType::FOREST, LocationType::DEAD_CITY, LocationType::CAVE, LocationType::CASTLE};
+    std::vector<const PackMapPrototype *> packPrototypes;
+    if (const ContentPack *pack = ContentPack::active())
+    {
+        for (const PackMapPrototype &prototype : pack->mapPrototypes())
+        {
+            if (prototype.location == static_cast<uint8_t>(mapLocations[mapTypeIndex]))
+                packPrototypes.push_back(&prototype);
+        }
+    }
 
-    // Parse the selected prototype into grid with randomization for 'R'
-    parsePrototype((const char **)selectedPrototypes[variantIndex]);
+    if (!packPrototypes.empty())
+    {
+        static_assert(PackMapPrototype::ROWS == MAP_SIZE, "Map size is part of the content pack format");
+        const PackMapPrototype *prototype = packPrototypes[rng() % packPrototypes.size()];
+        const char *rows[MAP_SIZE];
+        for (int y = 0; y < MAP_SIZE; ++y)
+        {
+            rows[y] = prototype->rows[y];
+        }
+        parsePrototype(rows);
+    }
+    else
+    {
+        // Select a prototype variant randomly [0..3]
+        int variantIndex = rng() % 4;
+
+        // Parse the selected prototype into grid with randomization for 'R'
+        parsePrototype((const char **)selectedPrototypes[variantIndex]);
+    }
 
     // Add points of interest based on map type
     std::vector<Position> emptyPositions;
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Файл, отображенный в память только для чтения.
+// Данные не копируются: страницы подгружаются системой по мере обращения.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Отобразить файл целиком. false - файла нет, он пуст или отображение не удалось
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const unsigned char *data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    const unsigned char *m_data = nullptr;
+    std::size_t m_size = 0;
+#ifdef _WIN32
+    void *m_file = nullptr;
+    void *m_mapping = nullptr;
+#endif
+};
@@ -0,0 +1,394 @@
+#include "RoundPlanner.h"
+#include "HeroTemplates.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace
+{
+    // Оценка исхода: победа/поражение перекрывают любую разницу в HP
+    const double OUTCOME_BONUS = 2.0;
+    const double KILL_WEIGHT = 0.5;
+    // Страховка от бесконечного раунда (ходы без действий)
+    const int SETTLE_LIMIT = 256;
+
+    // Одна выборка: снимок боя со своими копиями участников
+    struct World
+    {
+        BattleSystem battle; // Дескрипторы участников те же, что в исходном бою
+        uint32_t acted = 0;  // Участники, чей ход в этом раунде уже прошел
+        bool roundOver = false;
+
+        explicit World(const BattleSystem &source)
+            : battle(source)
+        {
+            battle.setOutput(nullptr);
+        }
+    };
+
+    struct Node
+    {
+        vector<unique_ptr<World>> worlds;
+        vector<PlannedAction> steps;
+        double score = 0.0;
+        double victoryChance = 0.0;
+        bool valid = false;
+    };
+
+    struct Search
+    {
+        vector<Entity *> participants; // Участники исходного боя, сначала герои
+        vector<EntityHandle> handles;  // Их дескрипторы - действуют и в каждой выборке
+        int heroCount = 0;
+
+        int indexOf(const Entity *entity) const
+        {
+            for (size_t i = 0; i < participants.size(); ++i)
+            {
+                if (participants[i] == entity)
+                    return static_cast<int>(i);
+            }
+            return -1;
+        }
+
+        // Номер участника выборки
+        int indexIn(const World &world, const Entity *entity) const
+        {
+            EntityHandle handle = world.battle.getHandle(entity);
+            for (size_t i = 0; i < handles.size(); ++i)
+            {
+                if (handle.isValid() && handles[i] == handle)
+                    return static_cast<int>(i);
+            }
+            return -1;
+        }
+
+        Entity *entityIn(const World &world, int index) const { return world.battle.getEntity(handles[index]); }
+    };
+
+    // Довести выборку до решения героя: ходы врагов играет ИИ, истощенные передают ход.
+    // Раунд кончается, когда ход снова доходит до участника, который в нем уже ходил
+    void settle(World &world, const Search &search)
+    {
+        for (int guard = 0; guard < SETTLE_LIMIT && world.battle.isBattleActive(); ++guard)
+        {
+            Entity *actor = world.battle.getCurrentTurnEntity();
+            int index = search.indexIn(world, actor);
+            if (index < 0 || (world.acted & (1u << index)))
+                break;
+
+            if (actor->getCurrentStamina() <= 0)
+            {
+                world.acted |= 1u << index;
+                world.battle.nextTurn();
+                continue;
+            }
+            if (index < search.heroCount)
+                return;
+
+            BattleAction action = BattleAI::chooseAction(world.battle, actor);
+            if (!BattleAI::perform(world.battle, actor, action))
+                world.acted |= 1u << index;
+        }
+        world.roundOver = true;
+    }
+
+    // Выполнить шаг плана в выборке. Если броски развели выборку с планом и сейчас ходит
+    // другой герой, он действует сам (утилитарный ИИ) - план продолжается со следующего решения
+    void applyStep(World &world, const Search &search, const PlannedAction &step)
+    {
+        if (world.roundOver)
+            return;
+
+        Entity *actor = world.battle.getCurrentTurnEntity();
+        int index = search.indexIn(world, actor);
+        BattleAction action;
+        if (index == search.indexOf(step.actor))
+        {
+            action = step.action;
+            if (action.target)
+                action.target = search.entityIn(world, search.indexOf(action.target));
+        }
+        else
+        {
+            action = BattleAI::chooseAction(world.battle, actor, AIPolicy::UTILITY);
+        }
+
+        if (!BattleAI::perform(world.battle, actor, action))
+            world.acted |= 1u << index;
+        settle(world, search);
+    }
+
+    double evaluate(const World &world, const Search &search)
+    {
+        double heroHP = 0.0, heroMaxHP = 0.0, enemyHP = 0.0, enemyMaxHP = 0.0;
+        int heroesDown = 0, enemiesDown = 0;
+        for (size_t i = 0; i < search.participants.size(); ++i)
+        {
+            const Entity &entity = *search.entityIn(world, static_cast<int>(i));
+            int hp = max(0, entity.getCurrentHealthPoint());
+            bool hero = static_cast<int>(i) < search.heroCount;
+            (hero ? heroHP : enemyHP) += hp;
+            (hero ? heroMaxHP : enemyMaxHP) += entity.getMaxHealthPoint();
+            if (hp == 0)
+                ++(hero ? heroesDown : enemiesDown);
+        }
+
+        int enemyCount = static_cast<int>(search.participants.size()) - search.heroCount;
+        double score = heroHP / max(1.0, heroMaxHP) - enemyHP / max(1.0, enemyMaxHP) +
+                       KILL_WEIGHT * (static_cast<double>(enemiesDown) / max(1, enemyCount) -
+                                      static_cast<double>(heroesDown) / max(1, search.heroCount));
+        if (!world.battle.isBattleActive())
+        {
+            if (world.battle.isPlayerVictory())
+                score += OUTCOME_BONUS;
+            else if (world.battle.isPlayerDefeat())
+                score -= OUTCOME_BONUS;
+        }
+        return score;
+    }
+
+    void score(Node &node, const Search &search)
+    {
+        node.score = 0.0;
+        node.victoryChance = 0.0;
+        for (const auto &world : node.worlds)
+        {
+            node.score += evaluate(*world, search);
+            if (!world->battle.isBattleActive() && world->battle.isPlayerVictory())
+                node.victoryChance += 1.0;
+        }
+        node.score /= node.worlds.size();
+        node.victoryChance /= node.worlds.size();
+    }
+
+    // Ходы героя, который сейчас ходит в первой выборке узла
+    vector<PlannedAction> candidateSteps(const World &world, const Search &search)
+    {
+        vector<PlannedAction> steps;
+        Entity *actor = world.battle.getCurrentTurnEntity();
+        int index = search.indexIn(world, actor);
+        if (index < 0 || index >= search.heroCount)
+            return steps;
+
+        PlannedAction step;
+        step.actor = search.participants[index];
+        for (const auto &target : world.battle.getAvailableTargetsForCurrent())
+        {
+            step.action = BattleAction();
+            step.action.type = BattleActionType::ATTACK;
+            step.action.target = search.participants[search.indexIn(world, target.first)];
+            steps.push_back(step);
+        }
+        for (AbilityType ability : static_cast<const Player *>(actor)->getAvailableAbilities())
+        {
+            if (actor->getCurrentStamina() < HeroFactory::getAbilityInfo(ability).staminaCost)
+                continue;
+            step.action = BattleAction();
+            step.action.type = BattleActionType::USE_ABILITY;
+            step.action.ability = ability;
+            steps.push_back(step);
+        }
+        step.action = BattleAction();
+        steps.push_back(step);
+        return steps;
+    }
+
+    bool isComplete(const Node &node, int maxSteps)
+    {
+        return node.worlds.front()->roundOver || static_cast<int>(node.steps.size()) >= maxSteps;
+    }
+
+    RoundPlan toPlan(const Node &node)
+    {
+        RoundPlan plan;
+        plan.steps = node.steps;
+        plan.score = node.score;
+        plan.victoryChance = node.victoryChance;
+        return plan;
+    }
+}
+
+RoundPlanner::RoundPlanner(unsigned int threads)
+    : pool(threads > 0 ? threads : max(1u, thread::hardware_concurrency()))
+{
+}
+
+vector<RoundPlan> RoundPlanner::plan(const BattleSystem &battle)
+{
+    using Clock = chrono::steady_clock;
+    Clock::time_point deadline = Clock::now() + chrono::milliseconds(options.timeBudgetMs);
+    expanded = 0;
+    truncated = false;
+
+    vector<RoundPlan> plans;
+    Search search;
+    for (const auto &pos : battle.getPlayerPositions())
+    {
+        if (Entity *entity = battle.entityAt(pos))
+        {
+            search.participants.push_back(entity);
+            search.handles.push_back(pos.handle);
+        }
+    }
+    search.heroCount = static_cast<int>(search.participants.size());
+    for (const auto &pos : battle.getEnemyPositions())
+    {
+        if (Entity *entity = battle.entityAt(pos))
+        {
+            search.participants.push_back(entity);
+            search.handles.push_back(pos.handle);
+        }
+    }
+    int current = search.indexOf(battle.getCurrentTurnEntity());
+    if (!battle.isBattleActive() || current < 0 || current >= search.heroCount)
+        return plans;
+
+    // Выборки отличаются только зерном; зерно зависит от хода, поэтому повторный запрос дает те же планы
+    Node root;
+    for (int sample = 0; sample < max(1, options.samples); ++sample)
+    {
+        root.worlds.push_back(make_unique<World>(battle));
+        root.worlds.back()->battle.setRandomSeed(static_cast<unsigned int>(
+            battle.getTurnSerial() * 0x9E3779B1u + battle.getStateVersion() * 0x85EBCA77u + sample * 0xC2B2AE3Du));
+    }
+    score(root, search);
+
+    vector<Node> beam;
+    beam.push_back(move(root));
+    vector<Node> finished;
+    while (!beam.empty())
+    {
+        struct Job
+        {
+            size_t parent;
+            PlannedAction step;
+        };
+        vector<Job> jobs;
+        for (size_t parent = 0; parent < beam.size(); ++parent)
+        {
+            for (const PlannedAction &step : candidateSteps(*beam[parent].worlds.front(), search))
+            {
+                jobs.push_back({parent, step});
+            }
+        }
+
+        vector<Node> children(jobs.size());
+        for (size_t j = 0; j < jobs.size(); ++j)
+        {
+            pool.submit([&, j]()
+                        {
+                if (Clock::now() >= deadline)
+                    return;
+                const Node &parent = beam[jobs[j].parent];
+                Node &child = children[j];
+                child.steps = parent.steps;
+                child.steps.push_back(jobs[j].step);
+                for (const auto &world : parent.worlds)
+                {
+                    child.worlds.push_back(make_unique<World>(*world));
+                    applyStep(*child.worlds.back(), search, jobs[j].step);
+                }
+                score(child, search);
+                child.valid = true; });
+        }
+        pool.wait();
+
+        vector<Node> next;
+        for (Node &child : children)
+        {
+            if (!child.valid)
+            {
+                truncated = true;
+                continue;
+            }
+            ++expanded;
+            if (isComplete(child, options.maxSteps))
+            {
+                child.worlds.clear();
+                finished.push_back(move(child));
+            }
+            else
+            {
+                next.push_back(move(child));
+            }
+        }
+        sort(next.begin(), next.end(), [](const Node &a, const Node &b)
+             { return a.score > b.score; });
+        if (static_cast<int>(next.size()) > options.beamWidth)
+            next.resize(options.beamWidth);
+
+        // Время вышло: недоигранные планы идут в ответ как есть
+        if (Clock::now() >= deadline && !next.empty())
+        {
+            truncated = true;
+            for (Node &node : next)
+            {
+                finished.push_back(move(node));
+            }
+            next.clear();
+        }
+        beam = move(next);
+    }
+
+    sort(finished.begin(), finished.end(), [](const Node &a, const Node &b)
+         { return a.score > b.score; });
+    for (size_t i = 0; i < finished.size() && static_cast<int>(plans.size()) < options.planCount; ++i)
+    {
+        // Перестановки одних и тех же действий часто дают тот же исход во всех выборках - показываем один
+        if (!plans.empty() && plans.back().score == finished[i].score &&
+            plans.back().victoryChance == finished[i].victoryChance)
+            continue;
+        plans.push_back(toPlan(finished[i]));
+    }
+    return plans;
+}
+
+void RoundPlanner::startPlanning(const BattleSystem &battle)
+{
+    // Предыдущий поиск нужно дождаться: он занимает pool и пишет статистику поиска
+    if (pending.valid())
+        pending.wait();
+    if (!background)
+        background.reset(new WorkStealingPool(1));
+
+    // Копия снимается здесь, в потоке вызывающего: фоновый поток не трогает исходный бой и его участников
+    shared_ptr<BattleSystem> copy = make_shared<BattleSystem>(battle);
+    copy->setOutput(nullptr);
+    snapshot = copy;
+    snapshotSource = &battle;
+
+    // Пул хранит копируемые задачи, поэтому задача поиска лежит в shared_ptr
+    auto task = make_shared<packaged_task<vector<RoundPlan>()>>([this, copy]()
+                                                                { return plan(*copy); });
+    pending = task->get_future();
+    background->submit([task]()
+                       { (*task)(); });
+}
+
+bool RoundPlanner::takePlans(const BattleSystem &battle, vector<RoundPlan> &plans)
+{
+    if (!pending.valid() || pending.wait_for(chrono::seconds(0)) != future_status::ready)
+        return false;
+
+    vector<RoundPlan> found = pending.get();
+    shared_ptr<const BattleSystem> searched = move(snapshot);
+    const BattleSystem *source = snapshotSource;
+    snapshotSource = nullptr;
+    if (source != &battle || searched->getStateVersion() != battle.getStateVersion())
+        return false;
+
+    // Участники копии и исходного боя имеют одни и те же дескрипторы
+    for (RoundPlan &plan : found)
+    {
+        for (PlannedAction &step : plan.steps)
+        {
+            step.actor = battle.getEntity(searched->getHandle(step.actor));
+            if (step.action.target)
+                step.action.target = battle.getEntity(searched->getHandle(step.action.target));
+        }
+    }
+    plans = move(found);
+    return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "BattleSystem.h"
+#include "BattleAI.h"
+#include "WorkStealingPool.h"
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+
+// Шаг плана: действие героя. Указатели - участники исходного боя
+struct PlannedAction
+{
+    Entity *actor = nullptr;
+    BattleAction action;
+};
+
+// План раунда для всего отряда
+struct RoundPlan
+{
+    vector<PlannedAction> steps;
+    double score = 0.0;         // Средняя оценка исхода раунда по выборкам бросков
+    double victoryChance = 0.0; // Доля выборок, в которых бой выигран до конца раунда
+};
+
+// Помощник "спланировать раунд": лучевой поиск последовательностей действий всех живых героев
+// до конца текущего раунда. Каждый узел поиска - несколько копий боя (выборок) с разными бросками;
+// действия героев применяются во всех выборках, ходы врагов играет обычный ИИ (BattleAI, DEFAULT).
+// Узел оценивается средним исходом по выборкам, на каждой глубине остается beamWidth лучших.
+// Раскрытия узлов одной глубины выполняются параллельно; по истечении бюджета времени
+// недоисследованные планы возвращаются как есть.
+//
+// Ходы героев: атака каждой доступной цели, каждая доступная способность, конец хода.
+// Перемещения не перебираются - они умножают ветвление, а выгода от них видна только через раунд.
+class RoundPlanner
+{
+public:
+    struct Options
+    {
+        int beamWidth = 8;     // Узлов на глубине
+        int planCount = 3;     // Сколько лучших планов вернуть
+        int samples = 8;       // Выборок бросков на узел
+        int timeBudgetMs = 50; // Бюджет поиска
+        int maxSteps = 24;     // Действий героев в плане
+    };
+
+    // threads = 0 - по числу ядер
+    explicit RoundPlanner(unsigned int threads = 0);
+
+    void setOptions(const Options &value) { options = value; }
+    const Options &getOptions() const { return options; }
+
+    // Лучшие планы для боя, в котором сейчас ходит герой (иначе пусто). Бой не меняется
+    vector<RoundPlan> plan(const BattleSystem &battle);
+
+    // Тот же поиск в фоновом потоке, чтобы не задерживать поток окна. Ищется по копии боя, снятой
+    // при запуске, так что исходный бой можно менять, пока поиск идет. Незабранный результат
+    // предыдущего запуска отбрасывается
+    void startPlanning(const BattleSystem &battle);
+    bool isPlanning() const { return pending.valid(); }
+
+    // Забрать результат фонового поиска: true, если поиск закончен и бой с его запуска не менялся,
+    // тогда указатели планов переведены на участников battle. Устаревший результат отбрасывается
+    bool takePlans(const BattleSystem &battle, vector<RoundPlan> &plans);
+
+    // Статистика последнего поиска (фонового - после takePlans)
+    long long getExpandedCount() const { return expanded; }
+    bool wasTruncated() const { return truncated; }
+
+private:
+    Options options;
+    WorkStealingPool pool;
+    long long expanded = 0;
+    bool truncated = false;
+
+    // Фоновый поиск. Поток создается при первом запуске и объявлен после pool: при разрушении
+    // он дожидается своей задачи раньше, чем останавливается pool
+    unique_ptr<WorkStealingPool> background;
+    shared_ptr<const BattleSystem> snapshot;  // Копия боя, по которой идет поиск
+    const BattleSystem *snapshotSource = nullptr;
+    future<vector<RoundPlan>> pending;
+};
@@ -0,0 +1,367 @@
+#include "Tools.h"
+#include "BattleSimulator.h"
+#include "BatchBattleKernel.h"
+#include "HeroTemplates.h"
+#include "EnemyTemplates.h"
+#include "ItemTemplates.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Цена очка характеристики и предметов в доле побед.
+// Каждый класс героя (в одиночку) играет против каждого шаблона врага всех локаций.
+// Базовый герой и герой с одним измененным статом (или надетым предметом) играют
+// с одними и теми же зернами (общие случайные числа): исходы пары почти всегда совпадают,
+// поэтому шум разности намного меньше шума самих долей побед. Каждое зерно играется
+// еще и антитетично (броски 1 - u), результаты обычного и антитетичного боя усредняются.
+// Ошибка считается по слоям (шаблонам врагов), каждый слой - равная доля пула.
+
+namespace
+{
+    using SensitivityClock = std::chrono::steady_clock;
+
+    // Характеристики героя, которые дают предметы: первые StatType до INITIATIVE включительно
+    const int STAT_COUNT = static_cast<int>(StatType::INITIATIVE) + 1;
+
+    struct SensitivityOptions
+    {
+        int pairs = 100;
+        int difficulty = 0;
+        int enemyCount = 1;
+        unsigned int threads = 1;
+        unsigned int seed = 20240601u;
+        AIPolicy policy = sweepPolicy;
+        bool antithetic = true;
+        std::string outputPath;
+    };
+
+    // Изменение героя: +1 к одному стату или бонусы предмета
+    struct Variant
+    {
+        std::string kind; // stat / item
+        std::string name;
+        StatBlock bonus;
+    };
+
+    struct Opponent
+    {
+        LocationType location = LocationType::FOREST;
+        EnemyTemplate enemy;
+    };
+
+    // Суммы по парам одного слоя (класс x шаблон врага)
+    struct StratumSums
+    {
+        double baselineWins = 0.0;
+        std::vector<double> sum;   // По вариантам: сумма разностей исходов
+        std::vector<double> sumSq; // Сумма квадратов разностей
+    };
+
+    struct VariantEstimate
+    {
+        const Variant *variant = nullptr;
+        double delta = 0.0;
+        double stdError = 0.0;
+        double linearEstimate = 0.0; // Сумма цен статов предмета (для предметов)
+    };
+
+    std::uint64_t mixSeed(std::uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    std::vector<Variant> makeVariants()
+    {
+        std::vector<Variant> variants;
+        for (int stat = 0; stat < STAT_COUNT; ++stat)
+        {
+            Variant variant;
+            variant.kind = "stat";
+            variant.name = std::string(statTypeName(static_cast<StatType>(stat))) + " +1";
+            variant.bonus[static_cast<StatType>(stat)] = 1;
+            variants.push_back(variant);
+        }
+
+        // Предметы без боевых статов (расходники, только особые свойства) в бою ничего не меняют
+        for (const ItemTemplate &item : ItemFactory::getAllItems())
+        {
+            if (item.type == ItemType::CONSUMABLE || item.slot == EquipmentSlot::NONE)
+                continue;
+            Variant variant;
+            variant.kind = "item";
+            variant.name = item.name;
+            bool changesStats = false;
+            for (int stat = 0; stat < STAT_COUNT; ++stat)
+            {
+                StatType type = static_cast<StatType>(stat);
+                variant.bonus[type] = item.stats[type];
+                changesStats = changesStats || variant.bonus[type] != 0;
+            }
+            if (changesStats)
+                variants.push_back(variant);
+        }
+        return variants;
+    }
+
+    // Бонусы как от надетого в пустой слот предмета; статы не выходят за допустимые сеттерами пределы
+    void applyBonus(Player &hero, const StatBlock &bonus)
+    {
+        hero.setMaxHealthPoint(std::max(1, hero.getMaxHealthPoint() + bonus[StatType::HEALTH]));
+        hero.setCurrentHealthPoint(hero.getMaxHealthPoint());
+        hero.setDamage(std::max(1, hero.getDamage() + bonus[StatType::DAMAGE]));
+        hero.setDefense(std::max(0, hero.getDefense() + bonus[StatType::DEFENSE]));
+        hero.setAttack(std::max(0, hero.getAttack() + bonus[StatType::ATTACK]));
+        hero.setMaxStamina(std::max(1, hero.getMaxStamina() + bonus[StatType::STAMINA]));
+        hero.setInitiative(std::max(1, hero.getInitiative() + bonus[StatType::INITIATIVE]));
+    }
+
+    SweepBattle makeBattle(const Player &hero, const Opponent &opponent, const SensitivityOptions &options,
+                           const EnemyScaling &scaling, unsigned int seed, bool antithetic)
+    {
+        SweepBattle battle;
+        battle.encounter.players.emplace_back(new Player(hero));
+        for (int i = 0; i < options.enemyCount; ++i)
+        {
+            battle.encounter.enemies.emplace_back(EnemyFactory::createEnemy(opponent.enemy, options.difficulty, scaling));
+        }
+        battle.seed = seed;
+        battle.antithetic = antithetic;
+        return battle;
+    }
+
+    void runAnalysis(const SensitivityOptions &options, std::ostream &out)
+    {
+        std::vector<HeroClass> classes;
+        std::vector<Player> prototypes;
+        std::vector<Opponent> opponents;
+        std::vector<Variant> variants;
+        {
+            // Фабрики прогреваются в главном потоке, отладочный вывод героев не нужен
+            ScopedSilence silence;
+            classes = HeroFactory::getAvailableClasses();
+            for (HeroClass heroClass : classes)
+            {
+                std::unique_ptr<Player> hero(HeroFactory::createHero(heroClass));
+                prototypes.push_back(*hero);
+            }
+            for (LocationType location : toolLocations)
+            {
+                for (const EnemyTemplate &enemy : EnemyFactory::getTemplates(location))
+                {
+                    opponents.push_back({location, enemy});
+                }
+            }
+            variants = makeVariants();
+        }
+        const EnemyScaling scaling = EnemyFactory::getScaling();
+
+        // Герои с изменением готовятся заранее: в слое копируются только прототипы
+        std::vector<std::vector<Player>> changedHeroes(classes.size());
+        for (std::size_t c = 0; c < classes.size(); ++c)
+        {
+            for (const Variant &variant : variants)
+            {
+                changedHeroes[c].push_back(prototypes[c]);
+                applyBonus(changedHeroes[c].back(), variant.bonus);
+            }
+        }
+
+        const std::size_t strata = classes.size() * opponents.size();
+        const int phases = options.antithetic ? 2 : 1;
+        std::vector<StratumSums> sums(strata);
+        SensitivityClock::time_point started = SensitivityClock::now();
+
+        parallelFor(strata, options.threads, [&](std::size_t stratum)
+        {
+            std::size_t c = stratum / opponents.size();
+            std::size_t o = stratum % opponents.size();
+            StratumSums &result = sums[stratum];
+            result.sum.assign(variants.size(), 0.0);
+            result.sumSq.assign(variants.size(), 0.0);
+
+            std::vector<double> changed(variants.size());
+            std::vector<SweepBattle> battles;
+            for (int pair = 0; pair < options.pairs; ++pair)
+            {
+                // Зерно зависит только от шаблона врага и номера пары - общее для всех классов и вариантов
+                unsigned int seed = static_cast<unsigned int>(mixSeed(mixSeed(options.seed ^ o) ^ static_cast<std::uint64_t>(pair)));
+
+                // Бои пары одной пачкой: по фазам сначала прототип, затем варианты
+                battles.clear();
+                for (int phase = 0; phase < phases; ++phase)
+                {
+                    bool antithetic = phase == 1;
+                    battles.push_back(makeBattle(prototypes[c], opponents[o], options, scaling, seed, antithetic));
+                    for (std::size_t v = 0; v < variants.size(); ++v)
+                    {
+                        battles.push_back(makeBattle(changedHeroes[c][v], opponents[o], options, scaling, seed, antithetic));
+                    }
+                }
+                std::vector<SimResult> results = BatchBattleKernel::runSweep(battles, options.policy);
+
+                double baseline = 0.0;
+                std::fill(changed.begin(), changed.end(), 0.0);
+                for (int phase = 0; phase < phases; ++phase)
+                {
+                    std::size_t first = static_cast<std::size_t>(phase) * (variants.size() + 1);
+                    baseline += results[first].playerVictory ? 1.0 : 0.0;
+                    for (std::size_t v = 0; v < variants.size(); ++v)
+                    {
+                        changed[v] += results[first + 1 + v].playerVictory ? 1.0 : 0.0;
+                    }
+                }
+
+                result.baselineWins += baseline / phases;
+                for (std::size_t v = 0; v < variants.size(); ++v)
+                {
+                    double delta = (changed[v] - baseline) / phases;
+                    result.sum[v] += delta;
+                    result.sumSq[v] += delta * delta;
+                }
+            }
+        });
+        double seconds = std::chrono::duration<double>(SensitivityClock::now() - started).count();
+
+        out << "class,rank,kind,name,delta_win_rate,std_error,ci_low,ci_high,linear_estimate,baseline_win_rate,pairs\n";
+        const double n = options.pairs;
+        const double layers = static_cast<double>(opponents.size());
+        for (std::size_t c = 0; c < classes.size(); ++c)
+        {
+            double baselineWins = 0.0;
+            for (std::size_t o = 0; o < opponents.size(); ++o)
+            {
+                baselineWins += sums[c * opponents.size() + o].baselineWins;
+            }
+            double baselineRate = baselineWins / (n * layers);
+
+            // Слои равновесны: среднее - среднее по слоям, дисперсия - сумма дисперсий слоев / слоев^2
+            std::vector<VariantEstimate> estimates(variants.size());
+            for (std::size_t v = 0; v < variants.size(); ++v)
+            {
+                double mean = 0.0;
+                double variance = 0.0;
+                for (std::size_t o = 0; o < opponents.size(); ++o)
+                {
+                    const StratumSums &s = sums[c * opponents.size() + o];
+                    double layerMean = s.sum[v] / n;
+                    mean += layerMean;
+                    if (options.pairs > 1)
+                        variance += std::max(0.0, (s.sumSq[v] - n * layerMean * layerMean) / (n - 1.0)) / n;
+                }
+                estimates[v].variant = &variants[v];
+                estimates[v].delta = mean / layers;
+                estimates[v].stdError = std::sqrt(variance) / layers;
+            }
+            for (VariantEstimate &estimate : estimates)
+            {
+                if (estimate.variant->kind != "item")
+                    continue;
+                for (int stat = 0; stat < STAT_COUNT; ++stat)
+                {
+                    estimate.linearEstimate += estimate.variant->bonus[static_cast<StatType>(stat)] * estimates[stat].delta;
+                }
+            }
+
+            std::stable_sort(estimates.begin(), estimates.end(), [](const VariantEstimate &a, const VariantEstimate &b)
+                             { return a.delta > b.delta; });
+            double resolution = 0.0;
+            for (std::size_t i = 0; i < estimates.size(); ++i)
+            {
+                const VariantEstimate &e = estimates[i];
+                resolution = std::max(resolution, 1.96 * e.stdError);
+                out << heroClassName(classes[c]) << "," << i + 1 << "," << e.variant->kind << ",\"" << e.variant->name << "\","
+                    << std::fixed << std::setprecision(5) << e.delta << "," << e.stdError << ","
+                    << e.delta - 1.96 * e.stdError << "," << e.delta + 1.96 * e.stdError << ",";
+                if (e.variant->kind == "item")
+                    out << e.linearEstimate;
+                out << "," << std::setprecision(4) << baselineRate << "," << options.pairs * opponents.size() << "\n";
+            }
+            std::cerr << "  " << heroClassName(classes[c]) << ": baseline win rate " << std::fixed << std::setprecision(3)
+                      << baselineRate << ", 95% resolution +-" << std::setprecision(3) << resolution * 100.0 << "%\n";
+        }
+
+        long long battles = static_cast<long long>(strata) * options.pairs * phases * (variants.size() + 1);
+        std::cerr << "sensitivity: " << battles << " battles in " << std::fixed << std::setprecision(2) << seconds
+                  << " s on " << options.threads << " threads, " << variants.size() << " variants, "
+                  << (options.antithetic ? "antithetic pairs, " : "") << aiPolicyName(options.policy) << " AI\n";
+    }
+}
+
+int runStatSensitivity(int argc, char **argv)
+{
+    SensitivityOptions options;
+    int threads = 0;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--pairs")
+        {
+            options.pairs = parseIntOption(arg, value, 1, 10000000);
+            ++i;
+        }
+        else if (arg == "--difficulty")
+        {
+            options.difficulty = parseIntOption(arg, value, 0, 20);
+            ++i;
+        }
+        else if (arg == "--enemies")
+        {
+            options.enemyCount = parseIntOption(arg, value, 1, 4);
+            ++i;
+        }
+        else if (arg == "--threads")
+        {
+            threads = parseIntOption(arg, value, 0, 1024);
+            ++i;
+        }
+        else if (arg == "--policy")
+        {
+            options.policy = parsePolicyOption(arg, value);
+            ++i;
+        }
+        else if (arg == "--seed")
+        {
+            options.seed = static_cast<unsigned int>(parseIntOption(arg, value, 0, 2147483647));
+            ++i;
+        }
+        else if (arg == "--no-antithetic")
+        {
+            options.antithetic = false;
+        }
+        else if (arg == "--out" && value)
+        {
+            options.outputPath = value;
+            ++i;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+    options.threads = resolveThreadCount(threads);
+
+    if (options.outputPath.empty())
+    {
+        runAnalysis(options, std::cout);
+    }
+    else
+    {
+        std::ofstream file(options.outputPath);
+        if (!file)
+            throw std::runtime_error("cannot open " + options.outputPath);
+        runAnalysis(options, file);
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include "ThreatMatrix.h"
+
+void ThreatMatrix::reset(const vector<Entity *> &players, const vector<Entity *> &enemies)
+{
+    count = 0;
+    // Как и в BattleSystem::startBattle, в бой выходят первые четыре участника каждой стороны
+    for (const vector<Entity *> *side : {&players, &enemies})
+    {
+        for (size_t i = 0; i < side->size() && i < MAX_COMBATANTS / 2; ++i)
+        {
+            Entity *entity = (*side)[i];
+            if (entity)
+            {
+                combatants[count] = Combatant();
+                combatants[count].entity = entity;
+                ++count;
+            }
+        }
+    }
+    for (int slot = 0; slot < count; ++slot)
+    {
+        refresh(slot);
+    }
+}
+
+void ThreatMatrix::remap(const EntityRemap &mapping)
+{
+    for (int slot = 0; slot < count; ++slot)
+    {
+        for (const auto &entry : mapping)
+        {
+            if (combatants[slot].entity == entry.first)
+            {
+                combatants[slot].entity = entry.second;
+                break;
+            }
+        }
+    }
+}
+
+int ThreatMatrix::slotOf(const Entity *entity) const
+{
+    for (int slot = 0; slot < count; ++slot)
+    {
+        if (combatants[slot].entity == entity)
+            return slot;
+    }
+    return -1;
+}
+
+int ThreatMatrix::sync(Entity *entity)
+{
+    int slot = slotOf(entity);
+    if (slot >= 0 && combatants[slot].version != entity->getCombatVersion())
+        refresh(slot);
+    return slot;
+}
+
+void ThreatMatrix::refresh(int slot)
+{
+    Combatant &combatant = combatants[slot];
+    Entity *entity = combatant.entity;
+    combatant.version = entity->getCombatVersion();
+    combatant.hp = entity->getCurrentHealthPoint();
+    combatant.threat = static_cast<double>(entity->getDamage()) * entity->getInitiative();
+    ++refreshes;
+
+    // Изменились статы одного участника - пересчитываются только его строка и столбец
+    for (int other = 0; other < count; ++other)
+    {
+        updateCell(slot, other);
+        updateCell(other, slot);
+    }
+
+    maxThreat = 1.0;
+    for (int i = 0; i < count; ++i)
+    {
+        maxThreat = max(maxThreat, combatants[i].threat);
+    }
+}
+
+void ThreatMatrix::updateCell(int attacker, int target)
+{
+    const Entity *from = combatants[attacker].entity;
+    const Entity *to = combatants[target].entity;
+    int defense = to->getDefense();
+    int minDamage = from->attack(defense, 0.0);
+    int maxDamage = from->attack(defense, 1.0);
+    int hp = to->getCurrentHealthPoint();
+
+    // Бросок разброса равномерный - урон растет с броском почти линейно
+    Cell &cell = cells[attacker][target];
+    cell.expectedDamage = from->attack(defense, 0.5);
+    if (hp <= minDamage)
+        cell.killChance = 1.0;
+    else if (hp > maxDamage)
+        cell.killChance = 0.0;
+    else
+        cell.killChance = static_cast<double>(maxDamage - hp + 1) / (maxDamage - minDamage + 1);
+}
+
+double ThreatMatrix::utility(Entity *attacker, Entity *target, int position)
+{
+    int from = sync(attacker);
+    int to = sync(target);
+    double positionScore = weights.position * (3 - min(3, max(0, position))) / 3.0;
+    if (from < 0 || to < 0)
+        return positionScore;
+
+    const Cell &cell = cells[from][to];
+    double hp = max(1, combatants[to].hp);
+    return weights.damage * min(1.0, cell.expectedDamage / hp) +
+           weights.kill * cell.killChance +
+           weights.threat * combatants[to].threat / maxThreat +
+           positionScore;
+}
+
+Entity *ThreatMatrix::chooseTarget(Entity *attacker, const vector<pair<Entity *, int>> &targets)
+{
+    Entity *best = nullptr;
+    double bestScore = 0.0;
+    for (const auto &target : targets)
+    {
+        double score = utility(attacker, target.first, target.second);
+        if (!best || score > bestScore)
+        {
+            best = target.first;
+            bestScore = score;
+        }
+    }
+    return best;
+}
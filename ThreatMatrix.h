@@ -0,0 +1,71 @@
+#pragma once
+#include "entity.h"
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Матрица угроз боя для утилитарного ИИ.
+// Для каждой пары (атакующий, цель) хранится ожидаемый урон и вероятность убить одним ударом,
+// для каждого участника - его угроза (урон x инициатива). Строка и столбец участника
+// пересчитываются только когда меняется его версия боевых статов (Entity::getCombatVersion),
+// поэтому выбор цели не обходит геттеры Entity и стоит O(число целей).
+class ThreatMatrix
+{
+public:
+    static const int MAX_COMBATANTS = 8;
+
+    // Веса слагаемых полезности цели
+    struct Weights
+    {
+        double damage = 1.0;   // Доля HP цели, снимаемая ударом
+        double kill = 2.0;     // Вероятность убить ударом
+        double threat = 1.0;   // Угроза цели относительно самой опасной
+        double position = 0.25; // Первая линия важнее последней
+    };
+
+    // Новый бой: участники регистрируются заново
+    void reset(const vector<Entity *> &players, const vector<Entity *> &enemies);
+
+    // Копия боя: перевести строки на копии участников (версии статов у копий те же)
+    void remap(const EntityRemap &mapping);
+
+    // Лучшая цель атаки из доступных (позиции берутся из списка целей); nullptr, если целей нет
+    Entity *chooseTarget(Entity *attacker, const vector<pair<Entity *, int>> &targets);
+
+    // Полезность атаки attacker -> target, стоящего на позиции position (0 - первая линия)
+    double utility(Entity *attacker, Entity *target, int position);
+
+    void setWeights(const Weights &value) { weights = value; }
+    const Weights &getWeights() const { return weights; }
+
+    // Сколько раз пересчитывался участник (для бенчмарка)
+    long long getRefreshCount() const { return refreshes; }
+
+private:
+    struct Combatant
+    {
+        Entity *entity = nullptr;
+        uint32_t version = 0;
+        double threat = 0.0;
+        int hp = 0;
+    };
+
+    struct Cell
+    {
+        double expectedDamage = 0.0;
+        double killChance = 0.0;
+    };
+
+    array<Combatant, MAX_COMBATANTS> combatants;
+    array<array<Cell, MAX_COMBATANTS>, MAX_COMBATANTS> cells;
+    int count = 0;
+    double maxThreat = 1.0;
+    Weights weights;
+    long long refreshes = 0;
+
+    int slotOf(const Entity *entity) const;
+    int sync(Entity *entity); // Слот участника с актуальными строкой и столбцом, -1 если не в бою
+    void refresh(int slot);
+    void updateCell(int attacker, int target);
+};
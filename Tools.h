@@ -0,0 +1,68 @@
+#pragma once
+#include "entity.h"
+#include "BattleAI.h"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <streambuf>
+#include <string>
+
+// Общие части консольного проекта инструментов (HuntersPath.Tools)
+
+// Счетчик вызовов глобального operator new (подменяется в ToolsMain.cpp)
+extern std::atomic<std::size_t> g_allocationCount;
+
+// Поток-заглушка: движок боя печатает каждый шаг, инструментам этот вывод не нужен
+class NullStreamBuffer : public std::streambuf
+{
+protected:
+    int overflow(int ch) override { return traits_type::not_eof(ch); }
+    std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+};
+
+// Глушит std::cout на время жизни объекта
+class ScopedSilence
+{
+public:
+    ScopedSilence() : m_previous(std::cout.rdbuf(&m_sink)) {}
+    ~ScopedSilence() { std::cout.rdbuf(m_previous); }
+    ScopedSilence(const ScopedSilence &) = delete;
+    ScopedSilence &operator=(const ScopedSilence &) = delete;
+
+private:
+    NullStreamBuffer m_sink;
+    std::streambuf *m_previous;
+};
+
+// Все локации в порядке объявления LocationType
+extern const LocationType toolLocations[4];
+
+// Имена перечислений для отчетов (совпадают с идентификаторами в коде)
+const char *abilityTypeName(AbilityType ability);
+const char *locationTypeName(LocationType location);
+const char *heroClassName(HeroClass heroClass);
+
+// Разбор числового аргумента командной строки с проверкой диапазона
+int parseIntOption(const std::string &option, const char *value, int minValue, int maxValue);
+
+// Политика ИИ для массовых прогонов: default, attack-only, utility
+AIPolicy parsePolicyOption(const std::string &option, const char *value);
+// Политика прогонов tune, tournament и sensitivity, если --policy не задан
+extern const AIPolicy sweepPolicy;
+const char *aiPolicyName(AIPolicy policy);
+
+// Количество рабочих потоков: 0 - по числу ядер
+unsigned int resolveThreadCount(int requested);
+
+// Параллельный цикл по индексам 0..count-1. Результат не зависит от числа потоков,
+// если body пишет только в свой элемент.
+void parallelFor(std::size_t count, unsigned int threads, const std::function<void(std::size_t)> &body);
+
+// Подкоманды инструментов
+int runBenchmark(int argc, char **argv);
+int runBalanceTuner(int argc, char **argv);
+int runTournament(int argc, char **argv);
+int runDecisionCacheWarmer(int argc, char **argv);
+int runStatSensitivity(int argc, char **argv);
+int runContentCompiler(int argc, char **argv);
@@ -0,0 +1,191 @@
+#include "Tools.h"
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+const LocationType toolLocations[4] = {
+    LocationType::FOREST,
+    LocationType::CAVE,
+    LocationType::DEAD_CITY,
+    LocationType::CASTLE,
+};
+
+const char *abilityTypeName(AbilityType ability)
+{
+    switch (ability)
+    {
+    case AbilityType::NONE: return "NONE";
+    case AbilityType::FLYING: return "FLYING";
+    case AbilityType::POISON: return "POISON";
+    case AbilityType::FIRE_DAMAGE: return "FIRE_DAMAGE";
+    case AbilityType::ICE_DAMAGE: return "ICE_DAMAGE";
+    case AbilityType::LIGHTNING: return "LIGHTNING";
+    case AbilityType::HEAL: return "HEAL";
+    case AbilityType::TELEPORT: return "TELEPORT";
+    case AbilityType::INVISIBLE: return "INVISIBLE";
+    case AbilityType::LIFE_STEAL: return "LIFE_STEAL";
+    case AbilityType::REGENERATION: return "REGENERATION";
+    case AbilityType::FEAR: return "FEAR";
+    case AbilityType::BERSERK: return "BERSERK";
+    case AbilityType::CHARGE: return "CHARGE";
+    case AbilityType::SHIELD_WALL: return "SHIELD_WALL";
+    case AbilityType::BATTLE_CRY: return "BATTLE_CRY";
+    case AbilityType::MAGIC_MISSILE: return "MAGIC_MISSILE";
+    case AbilityType::CHAIN_LIGHTNING: return "CHAIN_LIGHTNING";
+    case AbilityType::FLAME_BURST: return "FLAME_BURST";
+    case AbilityType::BLOOD_RITUAL: return "BLOOD_RITUAL";
+    case AbilityType::HEALING_WAVE: return "HEALING_WAVE";
+    case AbilityType::COMMAND: return "COMMAND";
+    case AbilityType::FROST_ARMOR: return "FROST_ARMOR";
+    case AbilityType::STEALTH: return "STEALTH";
+    case AbilityType::SHADOW_STEP: return "SHADOW_STEP";
+    case AbilityType::ARCANE_MISSILE: return "ARCANE_MISSILE";
+    }
+    return "UNKNOWN";
+}
+
+const char *locationTypeName(LocationType location)
+{
+    switch (location)
+    {
+    case LocationType::FOREST: return "FOREST";
+    case LocationType::CAVE: return "CAVE";
+    case LocationType::DEAD_CITY: return "DEAD_CITY";
+    case LocationType::CASTLE: return "CASTLE";
+    }
+    return "UNKNOWN";
+}
+
+const char *heroClassName(HeroClass heroClass)
+{
+    switch (heroClass)
+    {
+    case HeroClass::WARRIOR: return "WARRIOR";
+    case HeroClass::PALADIN: return "PALADIN";
+    case HeroClass::BARBARIAN: return "BARBARIAN";
+    case HeroClass::ROGUE: return "ROGUE";
+    case HeroClass::RANGER: return "RANGER";
+    case HeroClass::MAGE: return "MAGE";
+    case HeroClass::WARLOCK: return "WARLOCK";
+    case HeroClass::DRUID: return "DRUID";
+    case HeroClass::LONER: return "LONER";
+    }
+    return "UNKNOWN";
+}
+
+int parseIntOption(const std::string &option, const char *value, int minValue, int maxValue)
+{
+    if (!value)
+        throw std::invalid_argument(option + " requires a value");
+
+    size_t used = 0;
+    int parsed = 0;
+    try
+    {
+        parsed = std::stoi(value, &used);
+    }
+    catch (const std::exception &)
+    {
+        used = 0;
+    }
+    if (used == 0 || value[used] != '\0')
+        throw std::invalid_argument(option + ": not a number: " + value);
+    if (parsed < minValue || parsed > maxValue)
+        throw std::out_of_range(option + " must be in " + std::to_string(minValue) + ".." + std::to_string(maxValue));
+    return parsed;
+}
+
+// Массовые прогоны идут через BatchBattleKernel, а он поддерживает только ATTACK_ONLY;
+// utility и default - через --policy, тогда каждый бой проводит BattleSimulator
+const AIPolicy sweepPolicy = AIPolicy::ATTACK_ONLY;
+
+AIPolicy parsePolicyOption(const std::string &option, const char *value)
+{
+    if (!value)
+        throw std::invalid_argument(option + " requires a value");
+    std::string name = value;
+    if (name == "default")
+        return AIPolicy::DEFAULT;
+    if (name == "attack-only")
+        return AIPolicy::ATTACK_ONLY;
+    if (name == "utility")
+        return AIPolicy::UTILITY;
+    throw std::invalid_argument(option + ": unknown policy " + name + " (default, attack-only, utility)");
+}
+
+const char *aiPolicyName(AIPolicy policy)
+{
+    switch (policy)
+    {
+    case AIPolicy::DEFAULT: return "default";
+    case AIPolicy::ATTACK_ONLY: return "attack-only";
+    case AIPolicy::UTILITY: return "utility";
+    }
+    return "unknown";
+}
+
+unsigned int resolveThreadCount(int requested)
+{
+    if (requested > 0)
+        return static_cast<unsigned int>(requested);
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? hardware : 1;
+}
+
+void parallelFor(std::size_t count, unsigned int threads, const std::function<void(std::size_t)> &body)
+{
+    if (threads <= 1 || count <= 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            body(i);
+        }
+        return;
+    }
+
+    // Индексы раздаются небольшими порциями через общий счетчик
+    const std::size_t chunk = 8;
+    std::atomic<std::size_t> next{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto worker = [&]()
+    {
+        try
+        {
+            while (true)
+            {
+                std::size_t first = next.fetch_add(chunk);
+                if (first >= count)
+                    break;
+                std::size_t last = first + chunk < count ? first + chunk : count;
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    body(i);
+                }
+            }
+        }
+        catch (...)
+        {
+            // Остальные потоки дорабатывают, первая ошибка пробрасывается вызывающему
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = std::current_exception();
+            next.store(count);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < threads; ++t)
+    {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : pool)
+    {
+        thread.join();
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
@@ -0,0 +1,84 @@
+#include "Tools.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+std::atomic<std::size_t> g_allocationCount{0};
+
+// Подсчет выделений памяти для отчетов allocs/op
+void *operator new(std::size_t size)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+    struct ToolCommand
+    {
+        const char *name;
+        int (*run)(int, char **);
+        const char *description;
+    };
+
+    const ToolCommand commands[] = {
+        {"bench", runBenchmark, "Benchmark the battle engine, JSON report (--out <file>, --quick)"},
+        {"tune", runBalanceTuner, "Tune enemy templates to target win rates (--samples, --rounds, --difficulties, --threads, --seed, --policy, --location, --out, --report)"},
+        {"tournament", runTournament, "Class/preset x enemy template matrix, streaming CSV (--battles, --max-difficulty, --enemies, --threads, --seed, --policy, --out, --heatmap)"},
+        {"warm-cache", runDecisionCacheWarmer, "Warm the enemy AI decision cache from simulated battles (--battles, --difficulties, --min-visits, --threads, --seed, --out)"},
+        {"sensitivity", runStatSensitivity, "Win-rate value of stat points and items per hero class, ranked CSV (--pairs, --difficulty, --enemies, --threads, --seed, --policy, --no-antithetic, --out)"},
+        {"content", runContentCompiler, "Content pack: 'export' the built-in content as text, 'build' a binary pack from text (--source, --out)"},
+    };
+
+    void printUsage()
+    {
+        std::cerr << "Usage: HuntersPath.Tools <command> [options]\n\nCommands:\n";
+        for (const ToolCommand &command : commands)
+        {
+            std::cerr << "  " << command.name << "\t" << command.description << "\n";
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 1;
+    }
+
+    for (const ToolCommand &command : commands)
+    {
+        if (std::strcmp(argv[1], command.name) == 0)
+        {
+            try
+            {
+                // Подкоманда получает свои аргументы без имени программы
+                return command.run(argc - 2, argv + 2);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << command.name << ": " << e.what() << "\n";
+                return 1;
+            }
+        }
+    }
+
+    std::cerr << "Unknown command: " << argv[1] << "\n";
+    printUsage();
+    return 1;
+}
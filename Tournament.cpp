@@ -0,0 +1,363 @@
+#include "Tools.h"
+#include "BattleSimulator.h"
+#include "BatchBattleKernel.h"
+#include "HeroTemplates.h"
+#include "EnemyTemplates.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Турнирная матрица: каждый класс героя (в одиночку) и каждый пресет отряда
+// против каждого шаблона врага на уровнях сложности 0..N.
+// Ячейки сильно различаются по стоимости (одиночный герой против одного скелета
+// или отряд из четырех против рыцарей), поэтому они раздаются пулу с кражей работы.
+// Строка CSV пишется сразу по завершении ячейки - порядок строк зависит от потоков,
+// по столбцу cell их можно упорядочить.
+
+namespace
+{
+    using TournamentClock = std::chrono::steady_clock;
+
+    struct TournamentOptions
+    {
+        int battles = 100;
+        int maxDifficulty = 3;
+        int enemyCount = 1;
+        unsigned int threads = 1;
+        unsigned int seed = 20240601u;
+        AIPolicy policy = sweepPolicy;
+        std::string outputPath;
+        std::string heatmapPath;
+    };
+
+    // Участник со стороны игрока: прототипы героев копируются в каждый бой
+    struct Contestant
+    {
+        std::string kind;   // class / preset
+        std::string name;
+        std::vector<Player> heroes;
+    };
+
+    struct Opponent
+    {
+        LocationType location = LocationType::FOREST;
+        EnemyTemplate enemy;
+    };
+
+    struct CellStats
+    {
+        int wins = 0;
+        int losses = 0;
+        int draws = 0;
+        long long steps = 0;
+        long long heroHPLeft = 0;
+        long long enemyHPLeft = 0;
+    };
+
+    std::uint64_t mixSeed(std::uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    // Доверительный интервал Уилсона для доли побед (95%)
+    void wilsonInterval(int wins, int total, double &low, double &high)
+    {
+        if (total == 0)
+        {
+            low = 0.0;
+            high = 1.0;
+            return;
+        }
+        const double z = 1.96;
+        double p = static_cast<double>(wins) / total;
+        double denominator = 1.0 + z * z / total;
+        double center = (p + z * z / (2.0 * total)) / denominator;
+        double margin = z * std::sqrt(p * (1.0 - p) / total + z * z / (4.0 * total * total)) / denominator;
+        low = std::max(0.0, center - margin);
+        high = std::min(1.0, center + margin);
+    }
+
+    std::string csvQuote(const std::string &text)
+    {
+        std::string quoted = "\"";
+        for (char c : text)
+        {
+            if (c == '"')
+                quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    std::vector<Contestant> makeContestants()
+    {
+        std::vector<Contestant> contestants;
+        for (HeroClass heroClass : HeroFactory::getAvailableClasses())
+        {
+            Contestant contestant;
+            contestant.kind = "class";
+            contestant.name = heroClassName(heroClass);
+            std::unique_ptr<Player> hero(HeroFactory::createHero(heroClass));
+            contestant.heroes.push_back(*hero);
+            contestants.push_back(contestant);
+        }
+
+        const std::vector<PartyPreset> &presets = HeroFactory::getPartyPresets();
+        for (int preset = 0; preset < static_cast<int>(presets.size()); ++preset)
+        {
+            Contestant contestant;
+            contestant.kind = "preset";
+            contestant.name = presets[preset].name;
+            for (Player *hero : HeroFactory::createPartyFromPreset(preset))
+            {
+                contestant.heroes.push_back(*hero);
+                delete hero;
+            }
+            contestants.push_back(contestant);
+        }
+        return contestants;
+    }
+
+    std::vector<Opponent> makeOpponents()
+    {
+        std::vector<Opponent> opponents;
+        for (LocationType location : toolLocations)
+        {
+            for (const EnemyTemplate &enemy : EnemyFactory::getTemplates(location))
+            {
+                opponents.push_back({location, enemy});
+            }
+        }
+        return opponents;
+    }
+
+    // Пишет строки по мере готовности ячеек; сброс после каждой строки,
+    // чтобы частичный результат был виден во время долгого прогона
+    class CsvStream
+    {
+    public:
+        explicit CsvStream(std::ostream &out) : m_out(out)
+        {
+            m_out << "cell,kind,contestant,location,enemy,difficulty,battles,wins,losses,draws,"
+                     "win_rate,win_low,win_high,avg_steps,avg_hero_hp_left,avg_enemy_hp_left,worker,ms\n";
+            m_out.flush();
+        }
+
+        void write(const std::string &row)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_out << row;
+            m_out.flush();
+        }
+
+    private:
+        std::ostream &m_out;
+        std::mutex m_mutex;
+    };
+
+    void writeHeatmap(std::ostream &out, const std::vector<Contestant> &contestants, const std::vector<Opponent> &opponents,
+                      const std::vector<double> &winRates, int difficulties)
+    {
+        // Сводная таблица: средняя доля побед по всем уровням сложности
+        out << "contestant";
+        for (const Opponent &opponent : opponents)
+        {
+            out << "," << csvQuote(opponent.enemy.name);
+        }
+        out << "\n" << std::fixed << std::setprecision(3);
+        for (std::size_t c = 0; c < contestants.size(); ++c)
+        {
+            out << csvQuote(contestants[c].name);
+            for (std::size_t o = 0; o < opponents.size(); ++o)
+            {
+                double sum = 0.0;
+                for (int difficulty = 0; difficulty < difficulties; ++difficulty)
+                {
+                    sum += winRates[(c * opponents.size() + o) * difficulties + difficulty];
+                }
+                out << "," << sum / difficulties;
+            }
+            out << "\n";
+        }
+    }
+
+    void runMatrix(const TournamentOptions &options, std::ostream &csv)
+    {
+        std::vector<Contestant> contestants;
+        std::vector<Opponent> opponents;
+        {
+            // Фабрики прогреваются в главном потоке, отладочный вывод героев не нужен
+            ScopedSilence silence;
+            contestants = makeContestants();
+            opponents = makeOpponents();
+        }
+        const EnemyScaling scaling = EnemyFactory::getScaling();
+        const int difficulties = options.maxDifficulty + 1;
+        const std::size_t cellCount = contestants.size() * opponents.size() * difficulties;
+
+        CsvStream stream(csv);
+        std::vector<double> winRates(cellCount, 0.0);
+        TournamentClock::time_point started = TournamentClock::now();
+
+        WorkStealingPool pool(options.threads);
+        for (std::size_t cell = 0; cell < cellCount; ++cell)
+        {
+            pool.submit([&, cell]()
+            {
+                std::size_t c = cell / (opponents.size() * difficulties);
+                std::size_t o = (cell / difficulties) % opponents.size();
+                int difficulty = static_cast<int>(cell % difficulties);
+                const Contestant &contestant = contestants[c];
+                const Opponent &opponent = opponents[o];
+
+                TournamentClock::time_point cellStarted = TournamentClock::now();
+                std::vector<SweepBattle> battles(static_cast<std::size_t>(options.battles));
+                for (int battle = 0; battle < options.battles; ++battle)
+                {
+                    SweepBattle &sweep = battles[static_cast<std::size_t>(battle)];
+                    for (const Player &hero : contestant.heroes)
+                    {
+                        sweep.encounter.players.emplace_back(new Player(hero));
+                    }
+                    for (int i = 0; i < options.enemyCount; ++i)
+                    {
+                        sweep.encounter.enemies.emplace_back(EnemyFactory::createEnemy(opponent.enemy, difficulty, scaling));
+                    }
+                    sweep.seed = static_cast<unsigned int>(mixSeed(mixSeed(options.seed ^ cell) ^ static_cast<std::uint64_t>(battle)));
+                }
+
+                // ATTACK_ONLY идет пачками через пакетное ядро, остальные политики - через симулятор
+                CellStats stats;
+                for (const SimResult &result : BatchBattleKernel::runSweep(battles, options.policy))
+                {
+                    if (result.playerVictory)
+                        ++stats.wins;
+                    else if (result.playerDefeat)
+                        ++stats.losses;
+                    else
+                        ++stats.draws;
+                    stats.steps += result.steps;
+                    stats.heroHPLeft += result.playerHPLeft;
+                    stats.enemyHPLeft += result.enemyHPLeft;
+                }
+                double elapsedMs = std::chrono::duration<double, std::milli>(TournamentClock::now() - cellStarted).count();
+
+                double n = options.battles;
+                double low = 0.0;
+                double high = 1.0;
+                wilsonInterval(stats.wins, options.battles, low, high);
+                winRates[cell] = stats.wins / n;
+
+                std::ostringstream row;
+                row << cell << "," << contestant.kind << "," << csvQuote(contestant.name) << ","
+                    << locationTypeName(opponent.location) << "," << csvQuote(opponent.enemy.name) << ","
+                    << difficulty << "," << options.battles << "," << stats.wins << "," << stats.losses << ","
+                    << stats.draws << "," << std::fixed << std::setprecision(4) << winRates[cell] << "," << low << ","
+                    << high << "," << std::setprecision(2) << stats.steps / n << "," << stats.heroHPLeft / n << ","
+                    << stats.enemyHPLeft / n << "," << pool.currentWorker() << "," << elapsedMs << "\n";
+                stream.write(row.str());
+            });
+        }
+        pool.wait();
+
+        double seconds = std::chrono::duration<double>(TournamentClock::now() - started).count();
+        std::cerr << "tournament: " << cellCount << " cells, " << cellCount * options.battles << " battles in "
+                  << std::fixed << std::setprecision(2) << seconds << " s on " << pool.size() << " threads, " << aiPolicyName(options.policy) << " AI\n";
+        for (unsigned int worker = 0; worker < pool.size(); ++worker)
+        {
+            std::cerr << "  worker " << worker << ": " << pool.executedBy(worker) << " cells, "
+                      << pool.stolenBy(worker) << " stolen\n";
+        }
+
+        if (!options.heatmapPath.empty())
+        {
+            std::ofstream heatmap(options.heatmapPath);
+            if (!heatmap)
+                throw std::runtime_error("cannot open " + options.heatmapPath);
+            writeHeatmap(heatmap, contestants, opponents, winRates, difficulties);
+        }
+    }
+}
+
+int runTournament(int argc, char **argv)
+{
+    TournamentOptions options;
+    int threads = 0;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--battles")
+        {
+            options.battles = parseIntOption(arg, value, 1, 1000000);
+            ++i;
+        }
+        else if (arg == "--max-difficulty")
+        {
+            options.maxDifficulty = parseIntOption(arg, value, 0, 20);
+            ++i;
+        }
+        else if (arg == "--enemies")
+        {
+            options.enemyCount = parseIntOption(arg, value, 1, 4);
+            ++i;
+        }
+        else if (arg == "--threads")
+        {
+            threads = parseIntOption(arg, value, 0, 1024);
+            ++i;
+        }
+        else if (arg == "--policy")
+        {
+            options.policy = parsePolicyOption(arg, value);
+            ++i;
+        }
+        else if (arg == "--seed")
+        {
+            options.seed = static_cast<unsigned int>(parseIntOption(arg, value, 0, 2147483647));
+            ++i;
+        }
+        else if (arg == "--out" && value)
+        {
+            options.outputPath = value;
+            ++i;
+        }
+        else if (arg == "--heatmap" && value)
+        {
+            options.heatmapPath = value;
+            ++i;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+    options.threads = resolveThreadCount(threads);
+
+    if (options.outputPath.empty())
+    {
+        runMatrix(options, std::cout);
+    }
+    else
+    {
+        std::ofstream file(options.outputPath);
+        if (!file)
+            throw std::runtime_error("cannot open " + options.outputPath);
+        runMatrix(options, file);
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "WorkStealingPool.h"
+
+namespace
+{
+    // Пул и номер рабочего для текущего потока
+    thread_local const WorkStealingPool *t_pool = nullptr;
+    thread_local int t_worker = -1;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned int threads)
+    : m_queued(0), m_pending(0), m_nextQueue(0), m_stopping(false)
+{
+    if (threads == 0)
+        threads = 1;
+    for (unsigned int i = 0; i < threads; ++i)
+    {
+        m_queues.emplace_back(new WorkerQueue());
+    }
+    for (unsigned int i = 0; i < threads; ++i)
+    {
+        m_threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread &thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+int WorkStealingPool::currentWorker() const
+{
+    return t_pool == this ? t_worker : -1;
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    unsigned int target;
+    int worker = currentWorker();
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        ++m_pending;
+        target = worker >= 0 ? static_cast<unsigned int>(worker)
+                             : static_cast<unsigned int>(m_nextQueue++ % m_queues.size());
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queues[target]->mutex);
+        m_queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        // Счетчик меняется под m_stateMutex, чтобы засыпающий рабочий не пропустил пробуждение
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        ++m_queued;
+    }
+    m_wake.notify_one();
+}
+
+void WorkStealingPool::wait()
+{
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(m_stateMutex);
+        m_idle.wait(lock, [this]() { return m_pending == 0; });
+        error = m_error;
+        m_error = nullptr;
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+bool WorkStealingPool::popLocal(unsigned int worker, Task &task)
+{
+    WorkerQueue &queue = *m_queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned int thief, Task &task)
+{
+    // Обход начинается с соседа, чтобы воры не толпились у одной очереди
+    unsigned int count = size();
+    for (unsigned int offset = 1; offset < count; ++offset)
+    {
+        WorkerQueue &victim = *m_queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty())
+            continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned int worker)
+{
+    t_pool = this;
+    t_worker = static_cast<int>(worker);
+    WorkerQueue &own = *m_queues[worker];
+
+    while (true)
+    {
+        Task task;
+        bool found = popLocal(worker, task);
+        if (found)
+        {
+            ++own.executed;
+        }
+        else if (steal(worker, task))
+        {
+            found = true;
+            ++own.executed;
+            ++own.stolen;
+        }
+
+        if (!found)
+        {
+            std::unique_lock<std::mutex> lock(m_stateMutex);
+            m_wake.wait(lock, [this]() { return m_stopping || m_queued.load() > 0; });
+            if (m_stopping && m_queued.load() == 0)
+                return;
+            continue;
+        }
+
+        --m_queued;
+        std::exception_ptr error;
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        if (error && !m_error)
+            m_error = error;
+        if (--m_pending == 0)
+            m_idle.notify_all();
+    }
+}
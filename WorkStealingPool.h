@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с кражей работы: у каждого рабочего своя очередь задач.
+// Владелец берет задачи с конца своей очереди, свободные рабочие крадут с начала чужих.
+// Подходит для задач сильно разной стоимости (ячейки турнирной матрицы).
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(unsigned int threads);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    // Добавить задачу. Из рабочего потока - в его очередь, иначе по кругу
+    void submit(Task task);
+
+    // Дождаться выполнения всех добавленных задач. Первое исключение из задач пробрасывается здесь
+    void wait();
+
+    unsigned int size() const { return static_cast<unsigned int>(m_queues.size()); }
+
+    // Номер рабочего текущего потока или -1 вне пула
+    int currentWorker() const;
+
+    // Сколько задач рабочий выполнил и сколько из них украл
+    std::size_t executedBy(unsigned int worker) const { return m_queues[worker]->executed; }
+    std::size_t stolenBy(unsigned int worker) const { return m_queues[worker]->stolen; }
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::size_t executed = 0;
+        std::size_t stolen = 0;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_stateMutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::atomic<long> m_queued;         // Задачи в очередях (может кратко уйти ниже нуля между push и счетчиком)
+    std::size_t m_pending;              // Добавленные, но еще не выполненные задачи
+    std::size_t m_nextQueue;
+    bool m_stopping;
+    std::exception_ptr m_error;
+
+    bool popLocal(unsigned int worker, Task &task);
+    bool steal(unsigned int thief, Task &task);
+    void workerLoop(unsigned int worker);
+};
@@ -1,4 +1,159 @@
 #include "entity.h"
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+const EffectDescriptor *EffectRegistry::intern(const string &name)
+{
+	// deque не перемещает записи - указатели остаются действительными
+	static mutex registryMutex;
+	static deque<EffectDescriptor> descriptors;
+	static unordered_map<string, const EffectDescriptor *> byName;
+
+	lock_guard<mutex> lock(registryMutex);
+	auto it = byName.find(name);
+	if (it != byName.end())
+		return it->second;
+	descriptors.push_back({name, static_cast<uint16_t>(descriptors.size())});
+	byName[name] = &descriptors.back();
+	return &descriptors.back();
+}
+
+ItemHandle Inventory::insert(const Item &item)
+{
+	uint32_t index;
+	if (!m_free.empty())
+	{
+		index = m_free.back();
+		m_free.pop_back();
+	}
+	else
+	{
+		index = static_cast<uint32_t>(m_slots.size());
+		m_slots.emplace_back();
+	}
+
+	Slot &slot = m_slots[index];
+	slot.item = item;
+	slot.occupied = true;
+	ItemHandle handle = handleOf(index);
+
+	vector<ItemHandle> &byType = m_by_type[static_cast<size_t>(item.getType())];
+	vector<ItemHandle> &bySlot = m_by_slot[static_cast<size_t>(item.getSlot())];
+	slot.dense_pos = static_cast<uint32_t>(m_dense.size());
+	slot.type_pos = static_cast<uint32_t>(byType.size());
+	slot.slot_pos = static_cast<uint32_t>(bySlot.size());
+	m_dense.push_back(index);
+	byType.push_back(handle);
+	bySlot.push_back(handle);
+
+	for (size_t stat = 0; stat < m_by_stat.size(); ++stat)
+	{
+		if (m_sorted_stats & (1u << stat))
+		{
+			vector<ItemHandle> &sorted = m_by_stat[stat];
+			sorted.insert(upper_bound(sorted.begin(), sorted.end(), handle, [&](ItemHandle a, ItemHandle b)
+									  { return statOrder(static_cast<StatType>(stat), a, b); }),
+						  handle);
+		}
+	}
+
+	++m_version;
+	return handle;
+}
+
+bool Inventory::erase(ItemHandle handle)
+{
+	if (!find(handle))
+		return false;
+
+	Slot &slot = m_slots[handle.index];
+	for (size_t stat = 0; stat < m_by_stat.size(); ++stat)
+	{
+		if (m_sorted_stats & (1u << stat))
+		{
+			vector<ItemHandle> &sorted = m_by_stat[stat];
+			sorted.erase(lower_bound(sorted.begin(), sorted.end(), handle, [&](ItemHandle a, ItemHandle b)
+									 { return statOrder(static_cast<StatType>(stat), a, b); }));
+		}
+	}
+
+	// Удаление без сдвига: на место записи встает последняя, ее ячейка запоминает новую позицию
+	uint32_t moved = m_dense.back();
+	m_dense[slot.dense_pos] = moved;
+	m_slots[moved].dense_pos = slot.dense_pos;
+	m_dense.pop_back();
+
+	vector<ItemHandle> &byType = m_by_type[static_cast<size_t>(slot.item.getType())];
+	byType[slot.type_pos] = byType.back();
+	m_slots[byType[slot.type_pos].index].type_pos = slot.type_pos;
+	byType.pop_back();
+
+	vector<ItemHandle> &bySlot = m_by_slot[static_cast<size_t>(slot.item.getSlot())];
+	bySlot[slot.slot_pos] = bySlot.back();
+	m_slots[bySlot[slot.slot_pos].index].slot_pos = slot.slot_pos;
+	bySlot.pop_back();
+
+	slot.item = Item();
+	slot.occupied = false;
+	++slot.generation;
+	m_free.push_back(handle.index);
+	++m_version;
+	return true;
+}
+
+void Inventory::clear()
+{
+	// Ячейки остаются, чтобы поколения продолжали расти и старые дескрипторы не ожили
+	for (uint32_t index : m_dense)
+	{
+		m_slots[index].item = Item();
+		m_slots[index].occupied = false;
+		++m_slots[index].generation;
+		m_free.push_back(index);
+	}
+	m_dense.clear();
+	for (auto &list : m_by_type)
+		list.clear();
+	for (auto &list : m_by_slot)
+		list.clear();
+	for (auto &list : m_by_stat)
+		list.clear();
+	++m_version;
+}
+
+const Item *Inventory::find(ItemHandle handle) const
+{
+	if (handle.index >= m_slots.size())
+		return nullptr;
+	const Slot &slot = m_slots[handle.index];
+	return slot.occupied && slot.generation == handle.generation ? &slot.item : nullptr;
+}
+
+const vector<ItemHandle> &Inventory::sortedBy(StatType stat) const
+{
+	size_t index = static_cast<size_t>(stat);
+	if (!(m_sorted_stats & (1u << index)))
+	{
+		vector<ItemHandle> &sorted = m_by_stat[index];
+		sorted.clear();
+		for (uint32_t slot : m_dense)
+		{
+			sorted.push_back(handleOf(slot));
+		}
+		sort(sorted.begin(), sorted.end(), [&](ItemHandle a, ItemHandle b)
+			 { return statOrder(stat, a, b); });
+		m_sorted_stats |= 1u << index;
+	}
+	return m_by_stat[index];
+}
+
+bool Inventory::statOrder(StatType stat, ItemHandle a, ItemHandle b) const
+{
+	int first = m_slots[a.index].item.getStat(stat);
+	int second = m_slots[b.index].item.getStat(stat);
+	return first != second ? first > second : a.index < b.index;
+}
 
 map<EquipmentSlot, string> Player::slotNames = {
 	{EquipmentSlot::HEAD, "Head"},
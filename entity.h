@@ -6,7 +6,13 @@
 #include <map>
 #include <vector>
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstdlib>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include "Log.h"
 
 using namespace std;
 
@@ -18,6 +24,9 @@ enum class ItemType
 	CONSUMABLE
 };
 
+// Число значений перечислений - размеры плотных таблиц, индексируемых ими (EnumArray)
+constexpr size_t ITEM_TYPE_COUNT = static_cast<size_t>(ItemType::CONSUMABLE) + 1;
+
 enum class EquipmentSlot
 {
 	HEAD,
@@ -63,6 +72,8 @@ enum class AbilityType
 	ARCANE_MISSILE
 };
 
+constexpr size_t ABILITY_TYPE_COUNT = static_cast<size_t>(AbilityType::ARCANE_MISSILE) + 1;
+
 enum class EffectType
 {
 	BUFF_DAMAGE,
@@ -77,15 +88,72 @@ enum class EffectType
 	INVISIBLE
 };
 
+// Интернированное имя эффекта: одна запись на имя на всю программу, эффекты хранят указатель
+struct EffectDescriptor
+{
+	string name;
+	uint16_t id;
+};
+
+class EffectRegistry
+{
+public:
+	// Найти или завести запись. Потокобезопасно; аллоцирует только при первом появлении имени
+	static const EffectDescriptor *intern(const string &name);
+};
+
 struct Effect
 {
 	EffectType type;
 	int value;
 	int duration; // в ходах
-	std::string name;
+	const EffectDescriptor *descriptor;
+	unsigned int id = 0; // Номер эффекта у владельца (выдается в addEffect)
+	int expiresAt = 0;	 // Ход владельца, на котором эффект истекает
 
+	Effect(EffectType t = EffectType::BUFF_DAMAGE, int v = 0, int d = 0, const EffectDescriptor *desc = nullptr)
+		: type(t), value(v), duration(d), descriptor(desc) {}
 	Effect(EffectType t, int v, int d, const std::string &n)
-		: type(t), value(v), duration(d), name(n) {}
+		: type(t), value(v), duration(d), descriptor(EffectRegistry::intern(n)) {}
+
+	const string &getName() const
+	{
+		static const string unnamed;
+		return descriptor ? descriptor->name : unnamed;
+	}
+
+	// Яд и регенерация срабатывают каждый ход, остальные эффекты меняют статы один раз
+	bool isPeriodic() const { return type == EffectType::POISON_DAMAGE || type == EffectType::REGENERATION; }
+};
+
+// Активные эффекты участника: фиксированный буфер внутри объекта, без кучи
+class EffectBuffer
+{
+public:
+	static const size_t CAPACITY = 8;
+
+	size_t size() const { return m_count; }
+	bool empty() const { return m_count == 0; }
+	bool full() const { return m_count == CAPACITY; }
+	const Effect &operator[](size_t index) const { return m_items[index]; }
+	Effect &operator[](size_t index) { return m_items[index]; }
+	const Effect *begin() const { return m_items.data(); }
+	const Effect *end() const { return m_items.data() + m_count; }
+	Effect &back() { return m_items[m_count - 1]; }
+
+	void push_back(const Effect &effect) { m_items[m_count++] = effect; }
+	// Удаление без сдвига: на место записи встает последняя
+	void swapRemove(size_t index)
+	{
+		if (index + 1 < m_count)
+			m_items[index] = m_items[m_count - 1];
+		--m_count;
+	}
+	void clear() { m_count = 0; }
+
+private:
+	array<Effect, CAPACITY> m_items;
+	size_t m_count = 0;
 };
 
 enum class HeroClass
@@ -101,6 +169,8 @@ enum class HeroClass
 	LONER
 };
 
+constexpr size_t HERO_CLASS_COUNT = static_cast<size_t>(HeroClass::LONER) + 1;
+
 enum class ProgressionType
 {
 	LEVEL_BASED,
@@ -118,40 +188,165 @@ enum class LocationType
 	CASTLE
 };
 
+constexpr size_t LOCATION_TYPE_COUNT = static_cast<size_t>(LocationType::CASTLE) + 1;
+
+// Характеристики предметов. Первые шесть - бонусы экипировки к статам героя
+enum class StatType : uint8_t
+{
+	HEALTH,
+	DAMAGE,
+	DEFENSE,
+	ATTACK,
+	STAMINA,
+	INITIATIVE,
+	HEALTH_RESTORE,
+	STAMINA_RESTORE,
+	FIRE_DAMAGE,
+	ICE_DAMAGE,
+	REGENERATION,
+	COMMAND,
+	FREEZE,
+	INVISIBLE,
+	TELEPORT,
+	COUNT
+};
+
+// Ключ характеристики в описаниях контента ("health", "fire_damage", ...)
+inline const char *statTypeName(StatType stat)
+{
+	static const char *const names[] = {"health", "damage", "defense", "attack", "stamina", "initiative",
+										"health_restore", "stamina_restore", "fire_damage", "ice_damage",
+										"regeneration", "command", "freeze", "invisible", "teleport"};
+	return stat < StatType::COUNT ? names[static_cast<size_t>(stat)] : "unknown";
+}
+
+// Набор характеристик: непрерывный массив int по StatType, без строк и кучи.
+// Сложение наборов - поэлементное по всему массиву (компилятор векторизует).
+// Строковые ключи разбираются только при загрузке контента (fromNames)
+class StatBlock
+{
+public:
+	static const size_t CAPACITY = 16; // StatType::COUNT с запасом до четырех векторов по 4 int
+
+	StatBlock() : m_values() {}
+	StatBlock(initializer_list<pair<StatType, int>> stats) : m_values()
+	{
+		for (const auto &stat : stats)
+		{
+			(*this)[stat.first] += stat.second;
+		}
+	}
+
+	// Разбор описания контента; неизвестный ключ - ошибка данных
+	static StatBlock fromNames(const map<string, int> &stats)
+	{
+		StatBlock block;
+		for (const auto &stat : stats)
+		{
+			size_t index = 0;
+			while (index < static_cast<size_t>(StatType::COUNT) && stat.first != statTypeName(static_cast<StatType>(index)))
+				++index;
+			if (index == static_cast<size_t>(StatType::COUNT))
+				throw invalid_argument("Unknown item stat: " + stat.first);
+			block.m_values[index] += stat.second;
+		}
+		return block;
+	}
+
+	int operator[](StatType stat) const { return m_values[static_cast<size_t>(stat)]; }
+	int &operator[](StatType stat) { return m_values[static_cast<size_t>(stat)]; }
+
+	StatBlock &operator+=(const StatBlock &other)
+	{
+		for (size_t i = 0; i < CAPACITY; ++i)
+		{
+			m_values[i] += other.m_values[i];
+		}
+		return *this;
+	}
+	StatBlock &operator-=(const StatBlock &other)
+	{
+		for (size_t i = 0; i < CAPACITY; ++i)
+		{
+			m_values[i] -= other.m_values[i];
+		}
+		return *this;
+	}
+	friend StatBlock operator+(StatBlock left, const StatBlock &right) { return left += right; }
+	friend StatBlock operator-(StatBlock left, const StatBlock &right) { return left -= right; }
+	bool operator==(const StatBlock &other) const { return m_values == other.m_values; }
+
+	bool empty() const
+	{
+		for (int value : m_values)
+		{
+			if (value != 0)
+				return false;
+		}
+		return true;
+	}
+
+private:
+	alignas(16) array<int32_t, CAPACITY> m_values;
+};
+
+// Неизменяемые данные предмета. Каталог ItemFactory хранит их по одной записи на шаблон
+struct ItemData
+{
+	string name = "";
+	string description = "";
+	ItemType type = ItemType::CONSUMABLE;
+	EquipmentSlot slot = EquipmentSlot::NONE;
+	StatBlock stats;
+};
+
+// Предмет - легкий дескриптор: указатель на данные шаблона, которые живут до конца программы.
+// Копирование и перемещение между инвентарями не копируют имя, описание и статы.
+// Предметы вне каталога (награды событий, переопределенные статы) держат собственные данные
 class Item
 {
 private:
-	string m_name;
-	string m_description;
-	ItemType m_type;
-	EquipmentSlot m_slot;
-	map<string, int> m_stats;
+	const ItemData *m_data;
+	shared_ptr<const ItemData> m_own; // Пусто у предметов из каталога
+
+	static const ItemData &emptyData()
+	{
+		static const ItemData data;
+		return data;
+	}
 
 public:
-	Item() : m_name(""), m_description(""), m_type(ItemType::CONSUMABLE),
-			 m_slot(EquipmentSlot::NONE), m_stats() {}
+	Item() : m_data(&emptyData()) {}
+
+	// Предмет каталога: данные не копируются, шаблон должен жить дольше предмета
+	explicit Item(const ItemData &data) : m_data(&data) {}
 
 	Item(const string &name, const string &description,
 		 ItemType type, EquipmentSlot slot,
-		 map<string, int> stats)
-		: m_name(name), m_description(description),
-		  m_type(type), m_slot(slot), m_stats(stats) {}
+		 const StatBlock &stats)
+		: m_data(nullptr), m_own(make_shared<const ItemData>(ItemData{name, description, type, slot, stats}))
+	{
+		m_data = m_own.get();
+	}
 
-	string getName() const { return m_name; }
-	string getDescription() const { return m_description; }
-	ItemType getType() const { return m_type; }
-	EquipmentSlot getSlot() const { return m_slot; }
-	int getStat(const string &statName) const
+	// Копия предмета с другими статами (остальные данные берутся из исходного)
+	Item withStats(const StatBlock &stats) const
 	{
-		auto it = m_stats.find(statName);
-		return it != m_stats.end() ? it->second : 0;
+		return Item(m_data->name, m_data->description, m_data->type, m_data->slot, stats);
 	}
 
+	const string &getName() const { return m_data->name; }
+	const string &getDescription() const { return m_data->description; }
+	ItemType getType() const { return m_data->type; }
+	EquipmentSlot getSlot() const { return m_data->slot; }
+	int getStat(StatType stat) const { return m_data->stats[stat]; }
+	const StatBlock &getStats() const { return m_data->stats; }
+
 	void displayInfo() const
 	{
-		cout << "=== " << m_name << " ===\n";
+		cout << "=== " << m_data->name << " ===\n";
 		cout << "Type: ";
-		switch (m_type)
+		switch (m_data->type)
 		{
 		case ItemType::WEAPON:
 			cout << "Weapon";
@@ -167,7 +362,7 @@ public:
 			break;
 		}
 		cout << "\nSlot: ";
-		switch (m_slot)
+		switch (m_data->slot)
 		{
 		case EquipmentSlot::HEAD:
 			cout << "Head";
@@ -203,66 +398,259 @@ public:
 			cout << "None";
 			break;
 		}
-		cout << "\nDescription: " << m_description << "\n";
+		cout << "\nDescription: " << m_data->description << "\n";
 		cout << "Stats:\n";
-		for (const auto &stat : m_stats)
+		for (size_t i = 0; i < static_cast<size_t>(StatType::COUNT); ++i)
 		{
-			cout << "  " << stat.first << ": " << stat.second << "\n";
+			StatType stat = static_cast<StatType>(i);
+			if (m_data->stats[stat] != 0)
+				cout << "  " << statTypeName(stat) << ": " << m_data->stats[stat] << "\n";
 		}
 		cout << "==================\n";
 	}
 };
 
+// Дескриптор предмета в инвентаре: ячейка и ее поколение. При удалении предмета поколение
+// ячейки растет, и старые дескрипторы перестают ее находить, даже если ячейку занял другой предмет
+struct ItemHandle
+{
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+
+	bool operator==(const ItemHandle &other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const ItemHandle &other) const { return !(*this == other); }
+};
+
+// Инвентарь - slot map: вставка и удаление за O(1), дескрипторы переживают удаление соседей.
+// Предметы лежат плотным списком (на место удаленного встает последний). Рядом поддерживаются
+// списки по типу и слоту экипировки и отсортированные по стату списки - интерфейс фильтрует
+// и сортирует склад, читая готовый список, а не пересобирая его каждый кадр
+class Inventory
+{
+public:
+	ItemHandle insert(const Item &item);
+	bool erase(ItemHandle handle); // false, если дескриптор устарел
+	void clear();
+
+	const Item *find(ItemHandle handle) const; // nullptr, если дескриптор устарел
+	bool contains(ItemHandle handle) const { return find(handle) != nullptr; }
+
+	// Плотный список: позиция 0..size()-1. Позиции меняются при удалении, дескрипторы - нет
+	size_t size() const { return m_dense.size(); }
+	bool empty() const { return m_dense.empty(); }
+	const Item &at(size_t position) const { return m_slots[m_dense[position]].item; }
+	ItemHandle handleAt(size_t position) const { return handleOf(m_dense[position]); }
+
+	const vector<ItemHandle> &ofType(ItemType type) const { return m_by_type[static_cast<size_t>(type)]; }
+	const vector<ItemHandle> &ofSlot(EquipmentSlot slot) const { return m_by_slot[static_cast<size_t>(slot)]; }
+
+	// По убыванию стата, при равенстве - по номеру ячейки. Список строится при первом запросе,
+	// дальше обновляется вставками и удалениями (двоичный поиск места)
+	const vector<ItemHandle> &sortedBy(StatType stat) const;
+
+	// Растет при каждом изменении содержимого
+	uint32_t getVersion() const { return m_version; }
+
+private:
+	struct Slot
+	{
+		Item item;
+		uint32_t generation = 0;
+		uint32_t dense_pos = 0;
+		uint32_t type_pos = 0;
+		uint32_t slot_pos = 0;
+		bool occupied = false;
+	};
+
+	vector<Slot> m_slots;
+	vector<uint32_t> m_dense; // Занятые ячейки
+	vector<uint32_t> m_free;  // Освобожденные ячейки для повторного использования
+	array<vector<ItemHandle>, static_cast<size_t>(ItemType::CONSUMABLE) + 1> m_by_type;
+	array<vector<ItemHandle>, static_cast<size_t>(EquipmentSlot::NONE) + 1> m_by_slot;
+	mutable array<vector<ItemHandle>, static_cast<size_t>(StatType::COUNT)> m_by_stat;
+	mutable uint32_t m_sorted_stats = 0; // Маска статов, для которых список построен
+	uint32_t m_version = 0;
+
+	ItemHandle handleOf(uint32_t index) const { return {index, m_slots[index].generation}; }
+	bool statOrder(StatType stat, ItemHandle a, ItemHandle b) const;
+};
+
+// Слои модификаторов статов в порядке наложения
+enum class StatLayer : uint8_t
+{
+	BASE,	   // Шаблон героя или врага; сеттеры Entity пишут сюда
+	LEVEL,	   // Прирост за уровни
+	EQUIPMENT, // Сумма надетых предметов
+	EFFECTS,   // Активные баффы и дебаффы
+	TEMPORARY, // Разовые модификаторы способностей, снимаются в конце боя
+	COUNT
+};
+
+// Статы Entity, собираемые из слоев: первые значения StatType (HEALTH - максимум HP, STAMINA - максимум стамины)
+constexpr size_t COMBAT_STAT_COUNT = static_cast<size_t>(StatType::INITIATIVE) + 1;
+
+// Итог стата - сумма слоев, ограниченная снизу минимумом стата. Слои хранят вклад как есть, без
+// ограничений, поэтому снятие модификатора в точности отменяет его наложение. Итог считается лениво:
+// изменение слоя помечает только свой стат, первое чтение пересчитывает и кеширует его
+class StatStack
+{
+public:
+	StatStack() : m_layers(), m_values() {}
+
+	int get(StatType stat) const
+	{
+		size_t index = static_cast<size_t>(stat);
+		if (m_dirty & (1u << index))
+		{
+			int total = 0;
+			for (int value : m_layers[index])
+			{
+				total += value;
+			}
+			m_values[index] = max(minimum(stat), total);
+			m_dirty &= ~(1u << index);
+		}
+		return m_values[index];
+	}
+
+	int layer(StatType stat, StatLayer layer) const
+	{
+		return m_layers[static_cast<size_t>(stat)][static_cast<size_t>(layer)];
+	}
+
+	// false, если вклад слоя не изменился
+	bool setLayer(StatType stat, StatLayer layer, int value)
+	{
+		int &current = m_layers[static_cast<size_t>(stat)][static_cast<size_t>(layer)];
+		if (current == value)
+			return false;
+		current = value;
+		m_dirty |= 1u << static_cast<size_t>(stat);
+		return true;
+	}
+
+	bool addLayer(StatType stat, StatLayer layer, int delta)
+	{
+		return setLayer(stat, layer, this->layer(stat, layer) + delta);
+	}
+
+	// Обнулить слой у всех статов; false, если он и так пуст
+	bool clearLayer(StatLayer layer)
+	{
+		bool changed = false;
+		for (size_t stat = 0; stat < COMBAT_STAT_COUNT; ++stat)
+		{
+			changed = setLayer(static_cast<StatType>(stat), layer, 0) || changed;
+		}
+		return changed;
+	}
+
+	// Пересчитать все помеченные статы сразу. После этого get() только читает, и стек можно
+	// читать из нескольких потоков, пока его никто не меняет
+	void settle() const
+	{
+		for (size_t stat = 0; stat < COMBAT_STAT_COUNT; ++stat)
+		{
+			get(static_cast<StatType>(stat));
+		}
+	}
+
+	// Наименьший итог, который принимают сеттеры Entity
+	static int minimum(StatType stat)
+	{
+		return stat == StatType::DEFENSE || stat == StatType::ATTACK ? 0 : 1;
+	}
+
+private:
+	array<array<int, static_cast<size_t>(StatLayer::COUNT)>, COMBAT_STAT_COUNT> m_layers;
+	mutable array<int, COMBAT_STAT_COUNT> m_values;
+	mutable uint32_t m_dirty = (1u << COMBAT_STAT_COUNT) - 1;
+};
+
 class Entity
 {
 public:
 	virtual ~Entity() = default;
 
+	// Копия с сохранением динамического типа (снимок боя копирует участников через EntityStore)
+	virtual unique_ptr<Entity> clone() const { return make_unique<Entity>(*this); }
+
 protected:
 	string m_name;
 	AbilityType m_ability;
-	int m_max_healthpoint;
+	StatStack m_stats;				// Максимум HP, урон, защита, атака, максимум стамины, инициатива
 	int m_current_healthpoint;
-	int m_damage;
-	int m_defense;
-	int m_attack;
-	int m_max_stamina;
 	int m_current_stamina;
-	int m_initiative;
 	int m_attack_range;
 	double m_damage_variance;		// Разброс урона (0.0 - без разброса, 1.0 - полный разброс)
-	vector<Effect> m_activeEffects; // Активные эффекты
+	EffectBuffer m_activeEffects;	// Активные эффекты
+	uint32_t m_effectMask = 0;		// Бит на каждый EffectType, у которого есть активный эффект
+	array<uint8_t, 16> m_effectTypeCounts = {};
+	int m_effectClock = 0;			// Счетчик ходов владельца для расписания эффектов
+	unsigned int m_nextEffectId = 1;
+	uint32_t m_combatVersion = 0;	// Растет при изменении боевых статов (HP, урон, защита, инициатива, эффекты)
 
 public:
 	Entity(const string &name = "Entity", int max_hp = 100, int damage = 10, int defense = 0,
 		   int attack = 0, int max_stamina = 1, int c_stamina = 1, int initiative = 10,
 		   int attack_range = 0, AbilityType ability = AbilityType::NONE, double damage_variance = 0.2)
-		: m_name(name), m_max_healthpoint(max_hp), m_current_healthpoint(max_hp),
-		  m_damage(damage), m_defense(defense), m_attack(attack),
-		  m_max_stamina(max_stamina), m_current_stamina(c_stamina), m_initiative(initiative),
-		  m_attack_range(attack_range), m_ability(ability), m_damage_variance(damage_variance), m_activeEffects() {}
+		: m_name(name), m_current_healthpoint(max_hp), m_current_stamina(c_stamina),
+		  m_attack_range(attack_range), m_ability(ability), m_damage_variance(damage_variance), m_activeEffects()
+	{
+		m_stats.setLayer(StatType::HEALTH, StatLayer::BASE, max_hp);
+		m_stats.setLayer(StatType::DAMAGE, StatLayer::BASE, damage);
+		m_stats.setLayer(StatType::DEFENSE, StatLayer::BASE, defense);
+		m_stats.setLayer(StatType::ATTACK, StatLayer::BASE, attack);
+		m_stats.setLayer(StatType::STAMINA, StatLayer::BASE, max_stamina);
+		m_stats.setLayer(StatType::INITIATIVE, StatLayer::BASE, initiative);
+	}
 
 	// Геттеры
 	string getName() const { return m_name; }
-	int getMaxHealthPoint() const { return m_max_healthpoint; }
+	int getMaxHealthPoint() const { return m_stats.get(StatType::HEALTH); }
 	int getCurrentHealthPoint() const { return m_current_healthpoint; }
-	int getDamage() const { return m_damage; }
-	int getDefense() const { return m_defense; }
-	int getAttack() const { return m_attack; }
-	int getMaxStamina() const { return m_max_stamina; }
+	int getDamage() const { return m_stats.get(StatType::DAMAGE); }
+	int getDefense() const { return m_stats.get(StatType::DEFENSE); }
+	int getAttack() const { return m_stats.get(StatType::ATTACK); }
+	int getMaxStamina() const { return m_stats.get(StatType::STAMINA); }
 	int getCurrentStamina() const { return m_current_stamina; }
-	int getInitiative() const { return m_initiative; }
+	int getInitiative() const { return m_stats.get(StatType::INITIATIVE); }
 	int getAttackRange() const { return m_attack_range; }
 	AbilityType getAbility() const { return m_ability; }
 	double getDamageVariance() const { return m_damage_variance; }
+	// Версия боевых статов: кэши боя (матрица угроз) пересчитывают участника только при ее смене
+	uint32_t getCombatVersion() const { return m_combatVersion; }
 
-	// Сеттеры
+	// Пересчитать ленивые статы заранее - перед чтением из другого потока (см. BattleDriver)
+	void settleStats() const { m_stats.settle(); }
+
+	// Слои статов (stat - от HEALTH до INITIATIVE)
+	int getStatLayer(StatType stat, StatLayer layer) const { return m_stats.layer(stat, layer); }
+	void addStatModifier(StatType stat, StatLayer layer, int delta)
+	{
+		if (m_stats.addLayer(stat, layer, delta))
+			++m_combatVersion;
+	}
+	void setStatLayer(StatType stat, StatLayer layer, int value)
+	{
+		if (m_stats.setLayer(stat, layer, value))
+			++m_combatVersion;
+	}
+	// Конец боя: модификаторы способностей не переносятся в следующий бой
+	void clearTemporaryModifiers()
+	{
+		if (m_stats.clearLayer(StatLayer::TEMPORARY))
+			++m_combatVersion;
+	}
+
+	// Сеттеры. Статы из слоев задаются в слое BASE: активные эффекты и экипировка остаются поверх
 	void setName(const string &name) { m_name = name; }
 	void setMaxHealthPoint(int max_hp)
 	{
 		if (max_hp > 0)
 		{
-			m_max_healthpoint = max_hp;
+			m_stats.setLayer(StatType::HEALTH, StatLayer::BASE, max_hp);
+			++m_combatVersion;
 		}
 		else
 		{
@@ -271,9 +659,10 @@ public:
 	}
 	void setCurrentHealthPoint(int c_hp)
 	{
-		if (c_hp >= 0 && c_hp <= m_max_healthpoint)
+		if (c_hp >= 0 && c_hp <= getMaxHealthPoint())
 		{
 			m_current_healthpoint = c_hp;
+			++m_combatVersion;
 		}
 		else
 		{
@@ -284,7 +673,8 @@ public:
 	{
 		if (dmg > 0)
 		{
-			m_damage = dmg;
+			m_stats.setLayer(StatType::DAMAGE, StatLayer::BASE, dmg);
+			++m_combatVersion;
 		}
 		else
 		{
@@ -295,7 +685,8 @@ public:
 	{
 		if (def >= 0)
 		{
-			m_defense = def;
+			m_stats.setLayer(StatType::DEFENSE, StatLayer::BASE, def);
+			++m_combatVersion;
 		}
 		else
 		{
@@ -306,7 +697,8 @@ public:
 	{
 		if (atk >= 0)
 		{
-			m_attack = atk;
+			m_stats.setLayer(StatType::ATTACK, StatLayer::BASE, atk);
+			++m_combatVersion;
 		}
 		else
 		{
@@ -317,7 +709,7 @@ public:
 	{
 		if (max_stam > 0)
 		{
-			m_max_stamina = max_stam;
+			m_stats.setLayer(StatType::STAMINA, StatLayer::BASE, max_stam);
 		}
 		else
 		{
@@ -326,7 +718,7 @@ public:
 	}
 	void setCurrentStamina(int c_stam)
 	{
-		if (c_stam >= 0 && c_stam <= m_max_stamina)
+		if (c_stam >= 0 && c_stam <= getMaxStamina())
 		{
 			m_current_stamina = c_stam;
 		}
@@ -339,7 +731,8 @@ public:
 	{
 		if (init > 0)
 		{
-			m_initiative = init;
+			m_stats.setLayer(StatType::INITIATIVE, StatLayer::BASE, init);
+			++m_combatVersion;
 		}
 		else
 		{
@@ -351,6 +744,7 @@ public:
 		if (range >= 0 && range <= 3)
 		{
 			m_attack_range = range;
+			++m_combatVersion;
 		}
 		else
 		{
@@ -363,6 +757,7 @@ public:
 		if (variance >= 0.0 && variance <= 1.0)
 		{
 			m_damage_variance = variance;
+			++m_combatVersion;
 		}
 		else
 		{
@@ -370,63 +765,101 @@ public:
 		}
 	}
 
-	// Методы эффектов
-	void addEffect(const Effect &effect)
+	// Методы эффектов. Тики и истечение планирует EffectScheduler боя
+	unsigned int addEffect(const Effect &effect)
 	{
+		if (m_activeEffects.full())
+		{
+			// Буфер полон: досрочно снимается эффект, который истек бы раньше всех
+			size_t soonest = 0;
+			for (size_t i = 1; i < m_activeEffects.size(); ++i)
+			{
+				if (m_activeEffects[i].expiresAt < m_activeEffects[soonest].expiresAt)
+					soonest = i;
+			}
+			removeEffectAt(soonest);
+		}
+
 		m_activeEffects.push_back(effect);
-		applyEffect(effect); // Применить эффект сразу
+		Effect &added = m_activeEffects.back();
+		added.id = m_nextEffectId++;
+		added.expiresAt = m_effectClock + effect.duration;
+		size_t type = static_cast<size_t>(effect.type);
+		++m_effectTypeCounts[type];
+		m_effectMask |= 1u << type;
+		applyEffect(added); // Применить эффект сразу
+		return added.id;
 	}
 
 	void removeEffect(size_t index)
 	{
 		if (index < m_activeEffects.size())
 		{
-			m_activeEffects.erase(m_activeEffects.begin() + index);
+			removeEffectAt(index);
 		}
 	}
 
-	void updateEffects()
+	bool hasEffect(EffectType type) const { return (m_effectMask & (1u << static_cast<size_t>(type))) != 0; }
+	uint32_t getEffectMask() const { return m_effectMask; }
+
+	// Начало хода владельца: возвращает номер нового хода
+	int advanceEffectClock() { return ++m_effectClock; }
+	int getEffectClock() const { return m_effectClock; }
+	int getEffectTurnsLeft(const Effect &effect) const { return max(0, effect.expiresAt - m_effectClock); }
+
+	const Effect *findEffect(unsigned int id) const
 	{
-		// Применить эффекты в начале хода и уменьшить длительность
-		for (auto it = m_activeEffects.begin(); it != m_activeEffects.end();)
+		for (const Effect &effect : m_activeEffects)
 		{
-			applyEffect(*it);
-			it->duration--;
+			if (effect.id == id)
+				return &effect;
+		}
+		return nullptr;
+	}
 
-			if (it->duration <= 0)
-			{
-				// Эффект истек, снять его
-				removeEffectStats(*it);
-				it = m_activeEffects.erase(it);
-			}
-			else
+	// Очередное срабатывание периодического эффекта
+	void tickEffect(unsigned int id)
+	{
+		const Effect *effect = findEffect(id);
+		if (effect && effect->isPeriodic())
+			applyEffect(*effect);
+	}
+
+	// Снять истекший эффект: статы возвращаются, запись меняется местами с последней
+	void expireEffect(unsigned int id)
+	{
+		for (size_t i = 0; i < m_activeEffects.size(); ++i)
+		{
+			if (m_activeEffects[i].id == id)
 			{
-				++it;
+				removeEffectAt(i);
+				return;
 			}
 		}
 	}
 
+	void removeEffectAt(size_t index)
+	{
+		const Effect &effect = m_activeEffects[index];
+		removeEffectStats(effect);
+		size_t type = static_cast<size_t>(effect.type);
+		if (--m_effectTypeCounts[type] == 0)
+			m_effectMask &= ~(1u << type);
+		m_activeEffects.swapRemove(index);
+	}
+
 	void applyEffect(const Effect &effect)
 	{
+		++m_combatVersion;
 		switch (effect.type)
 		{
 		case EffectType::BUFF_DAMAGE:
-			m_damage += effect.value;
-			break;
 		case EffectType::BUFF_DEFENSE:
-			m_defense += effect.value;
-			break;
 		case EffectType::BUFF_INITIATIVE:
-			m_initiative += effect.value;
-			break;
 		case EffectType::DEBUFF_DAMAGE:
-			m_damage = max(1, m_damage - effect.value);
-			break;
 		case EffectType::DEBUFF_DEFENSE:
-			m_defense = max(0, m_defense - effect.value);
-			break;
 		case EffectType::DEBUFF_INITIATIVE:
-			m_initiative = max(1, m_initiative - effect.value);
+			m_stats.addLayer(effectStat(effect.type), StatLayer::EFFECTS, effectDelta(effect));
 			break;
 		case EffectType::POISON_DAMAGE:
 			takeDamage(effect.value);
@@ -443,42 +876,61 @@ public:
 
 	void removeEffectStats(const Effect &effect)
 	{
+		++m_combatVersion;
 		switch (effect.type)
 		{
 		case EffectType::BUFF_DAMAGE:
-			m_damage -= effect.value;
-			break;
 		case EffectType::BUFF_DEFENSE:
-			m_defense -= effect.value;
-			break;
 		case EffectType::BUFF_INITIATIVE:
-			m_initiative -= effect.value;
-			break;
 		case EffectType::DEBUFF_DAMAGE:
-			m_damage += effect.value;
-			break;
 		case EffectType::DEBUFF_DEFENSE:
-			m_defense += effect.value;
-			break;
 		case EffectType::DEBUFF_INITIATIVE:
-			m_initiative += effect.value;
+			m_stats.addLayer(effectStat(effect.type), StatLayer::EFFECTS, -effectDelta(effect));
 			break;
 		case EffectType::POISON_DAMAGE:
 		case EffectType::REGENERATION:
 		case EffectType::STEALTH:
 		case EffectType::INVISIBLE:
-			// Эти эффекты не меняют базовые статы
+			// Эти эффекты не меняют статы
 			break;
 		}
 	}
 
-	const vector<Effect> &getActiveEffects() const { return m_activeEffects; }
+	// Стат и знак вклада баффа/дебаффа в слой EFFECTS
+	static StatType effectStat(EffectType type)
+	{
+		switch (type)
+		{
+		case EffectType::BUFF_DAMAGE:
+		case EffectType::DEBUFF_DAMAGE:
+			return StatType::DAMAGE;
+		case EffectType::BUFF_DEFENSE:
+		case EffectType::DEBUFF_DEFENSE:
+			return StatType::DEFENSE;
+		default:
+			return StatType::INITIATIVE;
+		}
+	}
+	static int effectDelta(const Effect &effect)
+	{
+		bool debuff = effect.type == EffectType::DEBUFF_DAMAGE || effect.type == EffectType::DEBUFF_DEFENSE ||
+					  effect.type == EffectType::DEBUFF_INITIATIVE;
+		return debuff ? -effect.value : effect.value;
+	}
+
+	const EffectBuffer &getActiveEffects() const { return m_activeEffects; }
 
 	// Методы действий
 	int attack(int recipient_protection)
+	{
+		return attack(recipient_protection, static_cast<double>(rand()) / RAND_MAX);
+	}
+
+	// Расчет урона по заранее выбранному броску разброса (roll в диапазоне 0.0 - 1.0)
+	int attack(int recipient_protection, double roll) const
 	{
 		// Расчет множителя атаки/защиты
-		int attackDefenseDiff = m_attack - recipient_protection;
+		int attackDefenseDiff = getAttack() - recipient_protection;
 		double multiplier = 1.0;
 
 		if (attackDefenseDiff > 0)
@@ -497,20 +949,20 @@ public:
 		double minMultiplier = 1.0 - varianceRange;
 		double maxMultiplier = 1.0 + varianceRange;
 
-		// Генерация случайного множителя разброса
-		double randomMultiplier = minMultiplier + (static_cast<double>(rand()) / RAND_MAX) * (maxMultiplier - minMultiplier);
+		// Случайный множитель разброса
+		double randomMultiplier = minMultiplier + roll * (maxMultiplier - minMultiplier);
 
 		// Применение разброса и множителя атаки/защиты
-		double finalDamage = m_damage * randomMultiplier * multiplier;
+		double finalDamage = getDamage() * randomMultiplier * multiplier;
 
 		return max(1, static_cast<int>(finalDamage)); // Минимум 1 урона
 	}
 
 	void heal(int heal_amount)
 	{
-		if (m_current_healthpoint + heal_amount >= m_max_healthpoint)
+		if (m_current_healthpoint + heal_amount >= getMaxHealthPoint())
 		{
-			setCurrentHealthPoint(m_max_healthpoint);
+			setCurrentHealthPoint(getMaxHealthPoint());
 		}
 		else
 		{
@@ -520,6 +972,7 @@ public:
 
 	void takeDamage(int received_damage)
 	{
+		++m_combatVersion;
 		m_current_healthpoint -= received_damage;
 		if (m_current_healthpoint < 0)
 			m_current_healthpoint = 0;
@@ -527,7 +980,7 @@ public:
 
 	void regenerateStamina()
 	{
-		m_current_stamina = m_max_stamina;
+		m_current_stamina = getMaxStamina();
 	}
 
 	void spendStamina()
@@ -552,9 +1005,10 @@ public:
 	{
 		int barWidth = 20;
 		int filled = 0;
-		if (m_max_healthpoint > 0)
+		int maxHealthPoint = getMaxHealthPoint();
+		if (maxHealthPoint > 0)
 		{
-			filled = (m_current_healthpoint * barWidth) / m_max_healthpoint;
+			filled = (m_current_healthpoint * barWidth) / maxHealthPoint;
 		}
 		if (filled < 0)
 			filled = 0;
@@ -570,7 +1024,7 @@ public:
 		{
 			bar += ".";
 		}
-		bar += "] " + to_string(m_current_healthpoint) + "/" + to_string(m_max_healthpoint) + " HP";
+		bar += "] " + to_string(m_current_healthpoint) + "/" + to_string(maxHealthPoint) + " HP";
 		return bar;
 	}
 
@@ -580,6 +1034,9 @@ public:
 	}
 };
 
+// Участники боя и их копии (копия боя для планировщика): исходный -> копия
+using EntityRemap = vector<pair<const Entity *, Entity *>>;
+
 class Player : public Entity
 {
 private:
@@ -592,16 +1049,41 @@ private:
 	map<AbilityType, int> m_ability_levels;
 	bool m_is_loner;
 
-	// Base stats from template
-	int m_base_max_hp;
-	int m_base_damage;
-	int m_base_defense;
-	int m_base_attack;
-	int m_base_max_stamina;
-	int m_base_initiative;
-
-	vector<Item> m_inventory;
+	Inventory m_inventory;
 	map<EquipmentSlot, Item> m_equipment;
+	StatBlock m_equipment_bonuses;	 // Сумма статов надетых предметов, правится разностью при смене слота
+	uint32_t m_equipment_version = 0; // Растет при каждой смене предмета в слоте
+
+	// Пустой слот: общие данные на все экземпляры Player
+	static const Item &emptySlotItem(EquipmentSlot slot)
+	{
+		static const array<ItemData, 10> data = {{
+			{"None", "No item", ItemType::ARMOR, EquipmentSlot::HEAD, {}},
+			{"None", "No item", ItemType::ARMOR, EquipmentSlot::CHEST, {}},
+			{"None", "No item", ItemType::ARMOR, EquipmentSlot::HANDS, {}},
+			{"None", "No item", ItemType::ARMOR, EquipmentSlot::LEGS, {}},
+			{"None", "No item", ItemType::ARMOR, EquipmentSlot::FEET, {}},
+			{"None", "No item", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, {}},
+			{"None", "No item", ItemType::WEAPON, EquipmentSlot::OFF_HAND, {}},
+			{"None", "No item", ItemType::ACCESSORY, EquipmentSlot::NECK, {}},
+			{"None", "No item", ItemType::ACCESSORY, EquipmentSlot::RING1, {}},
+			{"None", "No item", ItemType::ACCESSORY, EquipmentSlot::RING2, {}}}};
+		static const array<Item, 10> items = {
+			Item(data[0]), Item(data[1]), Item(data[2]), Item(data[3]), Item(data[4]),
+			Item(data[5]), Item(data[6]), Item(data[7]), Item(data[8]), Item(data[9])};
+		static const Item none;
+		return slot < EquipmentSlot::NONE ? items[static_cast<size_t>(slot)] : none;
+	}
+
+	// Единственное место, где меняется слот: итог бонусов обновляется разностью, без обхода экипировки
+	void setSlotItem(EquipmentSlot slot, const Item &item)
+	{
+		Item &current = m_equipment[slot];
+		m_equipment_bonuses -= current.getStats();
+		m_equipment_bonuses += item.getStats();
+		current = item;
+		++m_equipment_version;
+	}
 
 	void increaseRequiredExperience()
 	{
@@ -609,37 +1091,23 @@ private:
 		m_required_experience = 250 + (m_level - 1) * 25;
 	}
 
+	// Бонусы экипировки переносятся в слой EQUIPMENT; база, уровни и эффекты не трогаются
 	void recalculateStats()
 	{
-		std::cout << "[DEBUG] Player " << m_name << " recalculating stats\n";
-		int healthBonus = 0;
-		int damageBonus = 0;
-		int defenseBonus = 0;
-		int attackBonus = 0;
-		int staminaBonus = 0;
-		int initiativeBonus = 0;
-
-		for (const auto &item : m_equipment)
+		LOG_TRACE(CAMPAIGN, "Player " << m_name << " recalculating stats");
+		for (size_t stat = 0; stat < COMBAT_STAT_COUNT; ++stat)
 		{
-			healthBonus += item.second.getStat("health");
-			damageBonus += item.second.getStat("damage");
-			defenseBonus += item.second.getStat("defense");
-			attackBonus += item.second.getStat("attack");
-			staminaBonus += item.second.getStat("stamina");
-			initiativeBonus += item.second.getStat("initiative");
+			StatType type = static_cast<StatType>(stat);
+			setStatLayer(type, StatLayer::EQUIPMENT, m_equipment_bonuses[type]);
 		}
 
-		Entity::setMaxHealthPoint(m_base_max_hp + healthBonus);
-		Entity::setDamage(m_base_damage + damageBonus);
-		Entity::setDefense(m_base_defense + defenseBonus);
-		Entity::setAttack(m_base_attack + attackBonus);
-		Entity::setMaxStamina(m_base_max_stamina + staminaBonus);
-		Entity::setInitiative(m_base_initiative + initiativeBonus);
-
 		regenerateStamina();
-		std::cout << "[DEBUG] Player " << m_name << " stats recalculated\n";
+		LOG_TRACE(CAMPAIGN, "Player " << m_name << " stats recalculated");
 	}
 
+	// Base stats without equipment: template + level gains
+	int baseStat(StatType stat) const { return getStatLayer(stat, StatLayer::BASE) + getStatLayer(stat, StatLayer::LEVEL); }
+
 public:
 	static map<EquipmentSlot, string> slotNames;
 
@@ -652,22 +1120,13 @@ public:
 		   AbilityType base_ability = AbilityType::NONE, double damage_variance = 0.2)
 		: Entity(name, max_hp, damage, defense, attack, max_stamina, c_stamina, initiative, attack_range, base_ability, damage_variance),
 		  m_level(level), m_required_experience(required_experience), m_received_experience(received_experience),
-		  m_hero_class(hero_class), m_progression_type(progression_type), m_is_loner(false),
-		  m_base_max_hp(max_hp), m_base_damage(damage), m_base_defense(defense), m_base_attack(attack),
-		  m_base_max_stamina(max_stamina), m_base_initiative(initiative)
-	{
-
-		m_equipment = {
-			{EquipmentSlot::HEAD, Item("None", "No item", ItemType::ARMOR, EquipmentSlot::HEAD, {})},
-			{EquipmentSlot::CHEST, Item("None", "No item", ItemType::ARMOR, EquipmentSlot::CHEST, {})},
-			{EquipmentSlot::HANDS, Item("None", "No item", ItemType::ARMOR, EquipmentSlot::HANDS, {})},
-			{EquipmentSlot::LEGS, Item("None", "No item", ItemType::ARMOR, EquipmentSlot::LEGS, {})},
-			{EquipmentSlot::FEET, Item("None", "No item", ItemType::ARMOR, EquipmentSlot::FEET, {})},
-			{EquipmentSlot::MAIN_HAND, Item("None", "No item", ItemType::WEAPON, EquipmentSlot::MAIN_HAND, {})},
-			{EquipmentSlot::OFF_HAND, Item("None", "No item", ItemType::WEAPON, EquipmentSlot::OFF_HAND, {})},
-			{EquipmentSlot::NECK, Item("None", "No item", ItemType::ACCESSORY, EquipmentSlot::NECK, {})},
-			{EquipmentSlot::RING1, Item("None", "No item", ItemType::ACCESSORY, EquipmentSlot::RING1, {})},
-			{EquipmentSlot::RING2, Item("None", "No item", ItemType::ACCESSORY, EquipmentSlot::RING2, {})}};
+		  m_hero_class(hero_class), m_progression_type(progression_type), m_is_loner(false)
+	{
+
+		for (int slot = 0; slot < static_cast<int>(EquipmentSlot::NONE); ++slot)
+		{
+			m_equipment.emplace(static_cast<EquipmentSlot>(slot), emptySlotItem(static_cast<EquipmentSlot>(slot)));
+		}
 
 		// Calculate required experience for current level
 		increaseRequiredExperience();
@@ -688,28 +1147,17 @@ public:
 	}
 
 	// Base stats getters
-	int getBaseMaxHP() const { return m_base_max_hp; }
-	int getBaseDamage() const { return m_base_damage; }
-	int getBaseDefense() const { return m_base_defense; }
-	int getBaseAttack() const { return m_base_attack; }
-	int getBaseMaxStamina() const { return m_base_max_stamina; }
-	int getBaseInitiative() const { return m_base_initiative; }
-
-	// Equipment bonuses
-	std::map<std::string, int> getEquipmentBonuses() const
-	{
-		std::map<std::string, int> bonuses;
-		for (const auto &item : m_equipment)
-		{
-			bonuses["health"] += item.second.getStat("health");
-			bonuses["damage"] += item.second.getStat("damage");
-			bonuses["defense"] += item.second.getStat("defense");
-			bonuses["attack"] += item.second.getStat("attack");
-			bonuses["stamina"] += item.second.getStat("stamina");
-			bonuses["initiative"] += item.second.getStat("initiative");
-		}
-		return bonuses;
-	}
+	int getBaseMaxHP() const { return baseStat(StatType::HEALTH); }
+	int getBaseDamage() const { return baseStat(StatType::DAMAGE); }
+	int getBaseDefense() const { return baseStat(StatType::DEFENSE); }
+	int getBaseAttack() const { return baseStat(StatType::ATTACK); }
+	int getBaseMaxStamina() const { return baseStat(StatType::STAMINA); }
+	int getBaseInitiative() const { return baseStat(StatType::INITIATIVE); }
+
+	// Equipment bonuses: готовый итог, O(1). Версия меняется при каждой смене экипировки -
+	// по ней читатели узнают, что закешированные от бонусов значения устарели
+	const StatBlock &getEquipmentBonuses() const { return m_equipment_bonuses; }
+	uint32_t getEquipmentVersion() const { return m_equipment_version; }
 
 	const std::map<EquipmentSlot, Item> &getEquipment() const { return m_equipment; }
 
@@ -756,28 +1204,28 @@ public:
 	void setAbilityLevel(AbilityType ability, int level) { m_ability_levels[ability] = level; }
 
 	// Методы инвентаря и экипировки
-	void addItem(const Item &item)
+	ItemHandle addItem(const Item &item)
 	{
-		m_inventory.push_back(item);
+		return m_inventory.insert(item);
 	}
 
-	void removeItem(int index)
+	void removeItem(ItemHandle handle)
 	{
-		if (index >= m_inventory.size())
+		if (!m_inventory.erase(handle))
 		{
-			throw out_of_range("Invalid inventory index");
+			throw out_of_range("Invalid inventory handle");
 		}
-		m_inventory.erase(m_inventory.begin() + index);
 	}
 
-	void equipItem(int inventoryIndex)
+	void equipItem(ItemHandle handle)
 	{
-		if (inventoryIndex < 0 || inventoryIndex >= m_inventory.size())
+		const Item *found = m_inventory.find(handle);
+		if (!found)
 		{
-			throw out_of_range("Invalid inventory index");
+			throw out_of_range("Invalid inventory handle");
 		}
 
-		Item item = m_inventory[inventoryIndex];
+		Item item = *found;
 		EquipmentSlot slot = item.getSlot();
 
 		if (slot == EquipmentSlot::NONE)
@@ -791,8 +1239,8 @@ public:
 			unequipItem(slot);
 		}
 
-		m_equipment[slot] = item;
-		m_inventory.erase(m_inventory.begin() + inventoryIndex);
+		setSlotItem(slot, item);
+		m_inventory.erase(handle);
 
 		recalculateStats();
 
@@ -807,11 +1255,9 @@ public:
 			return;
 		}
 
-		m_inventory.push_back(m_equipment[slot]);
+		m_inventory.insert(m_equipment[slot]);
 
-		m_equipment[slot] = Item("None", "No item",
-								 slot == EquipmentSlot::MAIN_HAND || slot == EquipmentSlot::OFF_HAND ? ItemType::WEAPON : ItemType::ARMOR,
-								 slot, {});
+		setSlotItem(slot, emptySlotItem(slot));
 
 		recalculateStats();
 
@@ -829,7 +1275,7 @@ public:
 		{
 			for (int i = 0; i < m_inventory.size(); ++i)
 			{
-				cout << i << ": " << m_inventory[i].getName() << "\n";
+				cout << i << ": " << m_inventory.at(i).getName() << "\n";
 			}
 		}
 		cout << "=================\n";
@@ -845,33 +1291,34 @@ public:
 		cout << "=================\n";
 	}
 
-	void useConsumable(int inventoryIndex)
+	void useConsumable(ItemHandle handle)
 	{
-		if (inventoryIndex < 0 || inventoryIndex >= m_inventory.size())
+		const Item *found = m_inventory.find(handle);
+		if (!found)
 		{
-			throw out_of_range("Invalid inventory index");
+			throw out_of_range("Invalid inventory handle");
 		}
 
-		Item item = m_inventory[inventoryIndex];
+		Item item = *found;
 		if (item.getType() != ItemType::CONSUMABLE)
 		{
 			cout << "This item is not consumable.\n";
 			return;
 		}
 
-		int healthRestore = item.getStat("health_restore");
+		int healthRestore = item.getStat(StatType::HEALTH_RESTORE);
 		if (healthRestore > 0)
 		{
 			heal(healthRestore);
 		}
 
-		int staminaRestore = item.getStat("stamina_restore");
+		int staminaRestore = item.getStat(StatType::STAMINA_RESTORE);
 		if (staminaRestore > 0)
 		{
 			setCurrentStamina(min(getMaxStamina(), getCurrentStamina() + staminaRestore));
 		}
 
-		m_inventory.erase(m_inventory.begin() + inventoryIndex);
+		m_inventory.erase(handle);
 
 		cout << "Used: " << item.getName() << "\n";
 	}
@@ -912,26 +1359,28 @@ public:
 	{
 		while (m_required_experience > 0 && m_received_experience >= m_required_experience)
 		{
-			std::cout << "[DEBUG] Player " << m_name << " leveling up from " << m_level << " to " << m_level + 1 << "\n";
+			LOG_DEBUG(CAMPAIGN, "Player " << m_name << " leveling up from " << m_level << " to " << m_level + 1);
 			setReceivedExperience(m_received_experience - m_required_experience);
 			setLevel(m_level + 1);
 
-			// Increase base stats on level up
-			m_base_max_hp += 10;
-			m_base_damage += 1;
-			m_base_defense += 1;
-			m_base_attack += 1;
-			m_base_initiative += 1;
-			m_base_max_stamina += 1;
+			// Level gains go to their own layer on top of the template stats
+			addStatModifier(StatType::HEALTH, StatLayer::LEVEL, 10);
+			addStatModifier(StatType::DAMAGE, StatLayer::LEVEL, 1);
+			addStatModifier(StatType::DEFENSE, StatLayer::LEVEL, 1);
+			addStatModifier(StatType::ATTACK, StatLayer::LEVEL, 1);
+			addStatModifier(StatType::INITIATIVE, StatLayer::LEVEL, 1);
+			addStatModifier(StatType::STAMINA, StatLayer::LEVEL, 1);
 
 			increaseRequiredExperience();
 
-			recalculateStats();
-			std::cout << "[DEBUG] Player " << m_name << " leveled up to " << m_level << "\n";
+			regenerateStamina();
+			LOG_DEBUG(CAMPAIGN, "Player " << m_name << " leveled up to " << m_level);
 		}
 	}
 
-	const vector<Item> &getInventory() const { return m_inventory; }
+	const Inventory &getInventory() const { return m_inventory; }
+
+	unique_ptr<Entity> clone() const override { return make_unique<Player>(*this); }
 };
 
 class Enemy : public Entity
@@ -996,6 +1445,8 @@ public:
 		// Default: no ability
 		cout << getName() << " has no special ability.\n";
 	}
+
+	unique_ptr<Entity> clone() const override { return make_unique<Enemy>(*this); }
 };
 
 // Goblin - быстрый и слабый враг, специализирующийся на яде
@@ -1019,6 +1470,8 @@ public:
 		target.takeDamage(poisonDamage);
 		cout << target.getName() << " takes " << poisonDamage << " poison damage!\n";
 	}
+
+	unique_ptr<Entity> clone() const override { return make_unique<Goblin>(*this); }
 };
 
 // Orc - сильный и медленный враг, специализирующийся на берсерке
@@ -1038,10 +1491,12 @@ public:
 		// Berserk ability: increases damage but reduces defense
 		cout << getName() << " enters Berserk mode!\n";
 		// Temporarily increase damage and decrease defense
-		setDamage(getDamage() + 5);
-		setDefense(max(0, getDefense() - 2));
+		addStatModifier(StatType::DAMAGE, StatLayer::TEMPORARY, 5);
+		addStatModifier(StatType::DEFENSE, StatLayer::TEMPORARY, -2);
 		cout << getName() << "'s damage increased, defense decreased!\n";
 	}
+
+	unique_ptr<Entity> clone() const override { return make_unique<Orc>(*this); }
 };
 
 // Vampire - вампир с вампиризмом
@@ -1064,6 +1519,8 @@ public:
 		heal(stealDamage / 2);
 		cout << getName() << " drains " << stealDamage << " HP from " << target.getName() << "!\n";
 	}
+
+	unique_ptr<Entity> clone() const override { return make_unique<Vampire>(*this); }
 };
 
 // Wyvern - летающий враг
@@ -1084,6 +1541,8 @@ public:
 		cout << getName() << " takes to the skies and repositions!\n";
 		// Simplified: just a reposition (handled in BattleSystem)
 	}
+
+	unique_ptr<Entity> clone() const override { return make_unique<Wyvern>(*this); }
 };
 
 // Ghost - призрак с невидимостью
@@ -1103,6 +1562,8 @@ public:
 		// Invisible: become undetectable
 		cout << getName() << " fades into invisibility!\n";
 	}
+
+	unique_ptr<Entity> clone() const override { return make_unique<Ghost>(*this); }
 };
 
 // Troglodyte - троглодит с регенерацией
@@ -1124,4 +1585,6 @@ public:
 		heal(healAmount);
 		cout << getName() << " regenerates " << healAmount << " HP!\n";
 	}
+
+	unique_ptr<Entity> clone() const override { return make_unique<Troglodyte>(*this); }
 };
@@ -4,9 +4,21 @@
 #include <vector>
 #include <string>
 #include <ctime>
+#include <memory>
+#include <sstream>
+#include <iomanip>
 #include "GUI.h"
 #include "CampaignSystem.h"
 #include "HeroTemplates.h"
+#include "BattleAI.h"
+#include "BattleDriver.h"
+#include "BehaviorTree.h"
+#include "DecisionCache.h"
+#include "ContentPack.h"
+#include "Log.h"
+#include "ItemTemplates.h"
+#include "LootTables.h"
+#include "RoundPlanner.h"
 #include "utils.h"
 
 using namespace std;
@@ -36,14 +48,133 @@ enum class BattleState
     SELECT_TARGET_ABILITY,
     SELECT_POSITION_MOVE,
     SELECT_ABILITY,
-    CONFIRM_ABILITY
+    CONFIRM_ABILITY,
+    PLAN_ROUND
 };
 
-int main()
+// What the battle screen was last built from. The menu and texts are rebuilt only when one
+// of these changes, so an idle battle screen formats no strings between frames
+struct BattleScreenKey
+{
+    const BattleSystem *battle = nullptr;
+    uint64_t version = 0;
+    BattleState state = BattleState::MAIN_MENU;
+    int driverPhase = -1;
+
+    // Remember the current screen; true if it differs from the one built last time
+    bool update(const BattleSystem *currentBattle, BattleState currentState, const BattleDriver *driver)
+    {
+        uint64_t currentVersion = currentBattle ? currentBattle->getStateVersion() : 0;
+        int currentPhase = !driver ? 0 : driver->isThinking() ? 1 : driver->isAnimating() ? 2 : 0;
+        if (currentBattle == battle && currentVersion == version && currentState == state && currentPhase == driverPhase)
+            return false;
+        battle = currentBattle;
+        version = currentVersion;
+        state = currentState;
+        driverPhase = currentPhase;
+        return true;
+    }
+    void invalidate() { driverPhase = -1; }
+};
+
+// Player actions go to the battle driver: the current turn coroutine applies them
+static void submitPlayerAction(BattleDriver *driver, BattleActionType type, Entity *target = nullptr,
+                               AbilityType ability = AbilityType::NONE, int position = -1)
+{
+    if (!driver)
+        return;
+    BattleAction action;
+    action.type = type;
+    action.target = target;
+    action.ability = ability;
+    action.position = position;
+    driver->submit(action);
+}
+
+// Text for an action being shown (enemy turn or a step of a round plan)
+static string describeAIAction(const Entity *actor, const BattleAction &action)
+{
+    switch (action.type)
+    {
+    case BattleActionType::ATTACK:
+        return actor->getName() + " attacks " + (action.target ? action.target->getName() : string("?"));
+    case BattleActionType::USE_ABILITY:
+        return actor->getName() + " uses " + HeroFactory::getAbilityInfo(action.ability).name;
+    case BattleActionType::MOVE:
+        return actor->getName() + " moves to position " + to_string(action.position + 1);
+    case BattleActionType::END_TURN:
+        break;
+    }
+    return actor->getName() + " ends the turn";
+}
+
+int main(int argc, char *argv[])
 {
     // Initialize random number generator
     srand(static_cast<unsigned int>(time(nullptr)));
 
+    // Debug builds show debug messages of every subsystem; --log <spec> (e.g. "battle=trace,map=off")
+    // overrides per category. Levels below LOG_MIN_LEVEL are not compiled in at all
+#ifndef NDEBUG
+    Log::setLevel(LogLevel::DEBUG);
+#endif
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (string(argv[i]) != "--log")
+            continue;
+        try
+        {
+            Log::configure(argv[i + 1]);
+        }
+        catch (const exception &e)
+        {
+            LOG_WARN(GUI, e.what());
+        }
+    }
+
+    // Content pack (HuntersPath.Tools content build): replaces the built-in heroes, enemies, items and maps.
+    // Must be active before the first factory call, the factories read it once
+    ContentPack content;
+    if (content.open("content.pack"))
+    {
+        ContentPack::setActive(&content);
+    }
+
+    // Enemy AI decisions warmed offline (HuntersPath.Tools warm-cache); the game works without the file
+    DecisionCache aiDecisions;
+    if (aiDecisions.open("ai_decisions.cache"))
+    {
+        BattleAI::setDecisionCache(&aiDecisions);
+    }
+
+    // Enemy behavior trees: enemy_behaviors.txt next to the game replaces the built-in ones
+    BehaviorLibrary enemyBehaviors;
+    try
+    {
+        if (enemyBehaviors.loadFile("enemy_behaviors.txt"))
+        {
+            BattleAI::setBehaviorLibrary(&enemyBehaviors);
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << "\n";
+    }
+
+    // Loot tables: loot_tables.txt next to the game replaces the built-in ones
+    LootTables lootTables;
+    try
+    {
+        if (lootTables.loadFile("loot_tables.txt"))
+        {
+            ItemFactory::setLootTables(&lootTables);
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << "\n";
+    }
+
     // Create full-screen window
     sf::VideoMode desktop = sf::VideoMode::getDesktopMode();
     sf::RenderWindow window(desktop, "The Hunter's Path", sf::Style::Fullscreen);
@@ -56,7 +187,8 @@ int main()
         // Try to load system font with Cyrillic support
         if (!font.loadFromFile("C:/Windows/Fonts/tahoma.ttf"))
         {
-            cerr << "Font loading error: system calibri.ttf and tahoma.ttf" << endl;
+            LOG_ERROR(GUI, "Font loading error: system calibri.ttf and tahoma.ttf");
+            Log::flush();
             return -1;
         }
     }
@@ -66,11 +198,13 @@ int main()
 
     // Battle state variables
     BattleState battleState = BattleState::MAIN_MENU;
+    BattleScreenKey battleScreen;
     AbilityType selectedAbility = AbilityType::NONE;
     int selectedTargetIndex = -1;
     int selectedPosition = -1;
     std::string pendingExpMessage;
     int selectedHeroIndex = -1;
+    int partyInventorySort = -1; // StatType to sort the party stash by, -1 keeps stash order
 
     // Main menu
     Menu mainMenu(window, font);
@@ -160,6 +294,17 @@ int main()
     characterConfirmationTitle.setPosition(windowSize.x * 0.2f, windowSize.y * 0.03f);
     characterConfirmationTitle.setFillColor(sf::Color::Yellow);
 
+    // Battle turns run as coroutines; the driver is recreated for every new battle
+    unique_ptr<BattleDriver> battleDriver;
+    BattleSystem *drivenBattle = nullptr;
+    sf::Clock frameClock;
+
+    // "Plan Round" assistant; plans are recomputed on a background thread when the battle state changes
+    RoundPlanner roundPlanner;
+    vector<RoundPlan> roundPlans;
+    const BattleSystem *plannedBattle = nullptr;
+    uint64_t plannedVersion = 0;
+
     while (window.isOpen())
     {
         sf::Event event;
@@ -316,7 +461,7 @@ int main()
                                     }
                                     if (keyNum >= 0 && keyNum < (int)targets.size())
                                     {
-                                        battle->attack(currentEntity, targets[keyNum].first);
+                                        submitPlayerAction(battleDriver.get(), BattleActionType::ATTACK, targets[keyNum].first);
                                         battleState = BattleState::MAIN_MENU;
                                     }
                                 }
@@ -335,13 +480,13 @@ int main()
                                     }
                                     if (keyNum >= 0 && keyNum < (int)targets.size())
                                     {
-                                        battle->useAbility(currentEntity, selectedAbility);
+                                        submitPlayerAction(battleDriver.get(), BattleActionType::USE_ABILITY, nullptr, selectedAbility);
                                         battleState = BattleState::MAIN_MENU;
                                     }
                                     else if (targets.empty())
                                     {
                                         // Use ability without target
-                                        battle->useAbility(currentEntity, selectedAbility);
+                                        submitPlayerAction(battleDriver.get(), BattleActionType::USE_ABILITY, nullptr, selectedAbility);
                                         battleState = BattleState::MAIN_MENU;
                                     }
                                 }
@@ -359,18 +504,17 @@ int main()
                                     }
                                     if (keyNum >= 0 && keyNum < 4)
                                     {
-                                        battle->movePosition(currentEntity, keyNum);
+                                        submitPlayerAction(battleDriver.get(), BattleActionType::MOVE, nullptr, AbilityType::NONE, keyNum);
                                         battleState = BattleState::MAIN_MENU;
                                     }
                                 }
                             }
                             else
                             {
-                                // Enemy turn - space to skip
-                                if (event.key.code == sf::Keyboard::Space)
+                                // Enemy turn - space to skip the animation
+                                if (event.key.code == sf::Keyboard::Space && battleDriver)
                                 {
-                                    // Skip enemy turn
-                                    battle->nextTurn();
+                                    battleDriver->skipAnimation();
                                 }
                             }
                         }
@@ -409,6 +553,37 @@ int main()
 
         window.clear(sf::Color::Black);
 
+        // Advance the battle driver: AI decisions and animations finish without blocking the window
+        {
+            BattleSystem *activeBattle = currentState == GameState::BATTLE && campaign.hasPendingBattle() ? campaign.getCurrentBattle() : nullptr;
+            if (activeBattle != drivenBattle || (battleDriver && battleDriver->isFinished() && activeBattle->isBattleActive()))
+            {
+                battleDriver.reset();
+                drivenBattle = activeBattle;
+                if (activeBattle)
+                {
+                    battleDriver.reset(new BattleDriver(*activeBattle, BattleDriverMode::INTERACTIVE));
+                    battleDriver->start();
+                }
+            }
+            float frameSeconds = frameClock.restart().asSeconds();
+            if (battleDriver)
+                battleDriver->update(frameSeconds);
+
+            // Finished round plans are kept only if the battle has not changed since the search started;
+            // either way the battle screen is rebuilt to show them or to start a new search
+            if (roundPlanner.isPlanning() && activeBattle)
+            {
+                if (roundPlanner.takePlans(*activeBattle, roundPlans))
+                {
+                    plannedBattle = activeBattle;
+                    plannedVersion = activeBattle->getStateVersion();
+                }
+                if (!roundPlanner.isPlanning())
+                    battleScreen.invalidate();
+            }
+        }
+
         // Update confirmation menu if necessary
         if (currentState == GameState::CHARACTER_CONFIRMATION && selectedPresetIndex != static_cast<size_t>(-1))
         {
@@ -568,7 +743,9 @@ int main()
         }
 
         // Update battle menu
-        if (currentState == GameState::BATTLE && campaign.hasPendingBattle())
+        if (currentState != GameState::BATTLE || !campaign.hasPendingBattle())
+            battleScreen.invalidate();
+        else if (battleScreen.update(campaign.getCurrentBattle(), battleState, battleDriver.get()))
         {
             battleMenu.clear();
             battleTexts.clear();
@@ -662,16 +839,21 @@ int main()
                                 battleMenu.addButton("Move", sf::Vector2f(buttonX, yPos), sf::Vector2f(buttonWidth, buttonHeight), [&]()
                                                      { battleState = BattleState::SELECT_POSITION_MOVE; });
                                 yPos += buttonHeight + spacing;
-                                battleMenu.addButton("Skip Turn", sf::Vector2f(buttonX, yPos), sf::Vector2f(buttonWidth, buttonHeight), [&]()
+                                battleMenu.addButton("Plan Round", sf::Vector2f(buttonX, yPos), sf::Vector2f(buttonWidth, buttonHeight), [&]()
+                                                     { battleState = BattleState::PLAN_ROUND; });
+                                yPos += buttonHeight + spacing;
+                                battleMenu.addButton("Skip Turn", sf::Vector2f(buttonX, yPos), sf::Vector2f(buttonWidth, buttonHeight), [&, battle, currentEntity]()
                                                      {
-                                 // Skip turn
+                                 // Skip turn (stamina changes outside BattleSystem, so the battle is told)
                                  currentEntity->setCurrentStamina(0);
+                                 battle->touch();
+                                 submitPlayerAction(battleDriver.get(), BattleActionType::END_TURN);
                                  battleState = BattleState::MAIN_MENU; });
                                 yPos += buttonHeight + spacing;
                                 battleMenu.addButton("End Turn", sf::Vector2f(buttonX, yPos), sf::Vector2f(buttonWidth, buttonHeight), [&]()
                                                      {
                                  // End turn
-                                 battle->nextTurn();
+                                 submitPlayerAction(battleDriver.get(), BattleActionType::END_TURN);
                                  battleState = BattleState::MAIN_MENU; });
                             }
                             else if (battleState == BattleState::SELECT_TARGET_ATTACK)
@@ -687,7 +869,7 @@ int main()
                                         string targetText = to_string(i + 1) + ". " + targets[i].first->getName() + " (HP: " + to_string(targets[i].first->getCurrentHealthPoint()) + ")";
                                         battleMenu.addButton(targetText, sf::Vector2f((windowSize.x - windowSize.x * 0.35f) / 2, yPos), sf::Vector2f(windowSize.x * 0.35f, windowSize.y * 0.04f), [&, i, targets]()
                                                              {
-                                            battle->attack(currentEntity, targets[i].first);
+                                            submitPlayerAction(battleDriver.get(), BattleActionType::ATTACK, targets[i].first);
                                             battleState = BattleState::MAIN_MENU; });
                                         yPos += windowSize.y * 0.045f;
                                     }
@@ -748,7 +930,7 @@ int main()
                                                      {
                                                          const AbilityInfo &info = HeroFactory::getAbilityInfo(selectedAbility);
                                                          if (info.isAreaEffect) {
-                                                             battle->useAbility(currentEntity, selectedAbility);
+                                                             submitPlayerAction(battleDriver.get(), BattleActionType::USE_ABILITY, nullptr, selectedAbility);
                                                              battleState = BattleState::MAIN_MENU;
                                                          } else {
                                                              battleState = BattleState::SELECT_TARGET_ABILITY;
@@ -770,7 +952,7 @@ int main()
                                         string targetText = to_string(i + 1) + ". " + targets[i].first->getName();
                                         battleMenu.addButton(targetText, sf::Vector2f((windowSize.x - windowSize.x * 0.25f) / 2, yPos), sf::Vector2f(windowSize.x * 0.25f, windowSize.y * 0.04f), [&, i, targets]()
                                                              {
-                                            battle->useAbility(currentEntity, selectedAbility);
+                                            submitPlayerAction(battleDriver.get(), BattleActionType::USE_ABILITY, nullptr, selectedAbility);
                                             battleState = BattleState::MAIN_MENU; });
                                         yPos += windowSize.y * 0.045f;
                                     }
@@ -780,7 +962,7 @@ int main()
                                     // Use ability without target
                                     battleMenu.addButton("Use Ability", sf::Vector2f((windowSize.x - windowSize.x * 0.15f) / 2, yPos), sf::Vector2f(windowSize.x * 0.15f, windowSize.y * 0.04f), [&]()
                                                          {
-                                        battle->useAbility(currentEntity, selectedAbility);
+                                        submitPlayerAction(battleDriver.get(), BattleActionType::USE_ABILITY, nullptr, selectedAbility);
                                         battleState = BattleState::MAIN_MENU; });
                                     yPos += windowSize.y * 0.045f;
                                 }
@@ -788,6 +970,54 @@ int main()
                                                      { battleState = BattleState::CONFIRM_ABILITY; });
                                 battleMenu.setScrollable(true, windowSize.y * 0.5f);
                             }
+                            else if (battleState == BattleState::PLAN_ROUND)
+                            {
+                                // Best action sequences for the whole party until the end of the round.
+                                // The search runs in the background; the screen is rebuilt when it finishes
+                                bool planning = plannedBattle != battle || plannedVersion != battle->getStateVersion();
+                                if (planning && !roundPlanner.isPlanning())
+                                    roundPlanner.startPlanning(*battle);
+                                battleTexts.emplace_back(planning ? "Planning..." : "Suggested plans for this round:", font, static_cast<unsigned int>(20 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
+                                yPos += windowSize.y * 0.035f;
+                                for (size_t i = 0; !planning && i < roundPlans.size(); ++i)
+                                {
+                                    const RoundPlan &plan = roundPlans[i];
+                                    ostringstream header;
+                                    header << "Plan " << i + 1 << " (score " << fixed << setprecision(2) << plan.score
+                                           << ", win " << static_cast<int>(plan.victoryChance * 100 + 0.5) << "%):";
+                                    battleTexts.emplace_back(header.str(), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::Yellow);
+                                    // Following a plan performs its first step; the plan is rebuilt for the next decision
+                                    if (!plan.steps.empty() && plan.steps.front().actor == currentEntity)
+                                    {
+                                        const PlannedAction first = plan.steps.front();
+                                        battleMenu.addButton("Follow plan " + to_string(i + 1), sf::Vector2f(windowSize.x * 0.6f, yPos), sf::Vector2f(windowSize.x * 0.15f, windowSize.y * 0.03f), [&, first]()
+                                                             {
+                                            submitPlayerAction(battleDriver.get(), first.action.type, first.action.target, first.action.ability, first.action.position);
+                                            battleState = BattleState::MAIN_MENU; });
+                                    }
+                                    yPos += windowSize.y * 0.035f;
+                                    string line;
+                                    for (size_t step = 0; step < plan.steps.size(); ++step)
+                                    {
+                                        line += (step % 3 == 0 ? "" : " -> ") + describeAIAction(plan.steps[step].actor, plan.steps[step].action);
+                                        if (step % 3 == 2 || step + 1 == plan.steps.size())
+                                        {
+                                            battleTexts.emplace_back("    " + line, font, static_cast<unsigned int>(16 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
+                                            yPos += windowSize.y * 0.022f;
+                                            line.clear();
+                                        }
+                                    }
+                                    yPos += windowSize.y * 0.01f;
+                                }
+                                if (!planning && roundPlans.empty())
+                                {
+                                    battleTexts.emplace_back("No plans found!", font, static_cast<unsigned int>(20 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::Red);
+                                    yPos += windowSize.y * 0.035f;
+                                }
+                                battleMenu.addButton("Back", sf::Vector2f((windowSize.x - windowSize.x * 0.1f) / 2, yPos), sf::Vector2f(windowSize.x * 0.1f, windowSize.y * 0.04f), [&]()
+                                                     { battleState = BattleState::MAIN_MENU; });
+                                battleMenu.setScrollable(true, windowSize.y * 0.5f);
+                            }
                             else if (battleState == BattleState::SELECT_POSITION_MOVE)
                             {
                                 // Show position buttons
@@ -802,7 +1032,7 @@ int main()
                                     string posText = "Position " + to_string(pos + 1);
                                     battleMenu.addButton(posText, sf::Vector2f(buttonX, yPos), sf::Vector2f(buttonWidth, buttonHeight), [&, pos]()
                                                          {
-                                         battle->movePosition(currentEntity, pos);
+                                         submitPlayerAction(battleDriver.get(), BattleActionType::MOVE, nullptr, AbilityType::NONE, pos);
                                          battleState = BattleState::MAIN_MENU; });
                                     yPos += buttonHeight + spacing;
                                 }
@@ -812,42 +1042,21 @@ int main()
                         }
                         else
                         {
-                            // AI turn - simulate
-                            if (currentEntity->getCurrentStamina() <= 0)
-                            {
-                                // Automatically skip turn if no stamina
-                                battle->nextTurn();
-                            }
-                            else
-                            {
-                                battleTexts.emplace_back("AI Turn - Press Next to continue", font, static_cast<unsigned int>(20 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::Yellow);
-                                float buttonWidth = windowSize.x * 0.2f;
-                                float buttonHeight = windowSize.y * 0.04f;
-                                float buttonX = windowSize.x * 0.4f;
-                                float spacing = windowSize.y * 0.01f;
-                                float aiYPos = yPos + windowSize.y * 0.035f;
-                                battleMenu.addButton("Next", sf::Vector2f(buttonX, aiYPos), sf::Vector2f(buttonWidth, buttonHeight), [&]()
-                                                     {
-                                     // Simple AI: attack if possible, else use ability if available, else skip turn
-                                     vector<pair<Entity *, int>> targets = battle->getAvailableTargetsForCurrent();
-                                     if (!targets.empty()) {
-                                         int targetIndex = rand() % targets.size();
-                                         battle->attack(currentEntity, targets[targetIndex].first);
-                                     } else if (currentEntity->getAbility() != AbilityType::NONE) {
-                                         // Try to use ability if no attack targets
-                                         const AbilityInfo &info = HeroFactory::getAbilityInfo(currentEntity->getAbility());
-                                         if (currentEntity->getCurrentStamina() >= info.staminaCost) {
-                                             battle->useAbility(currentEntity, currentEntity->getAbility());
-                                         } else {
-                                             battle->nextTurn();
-                                         }
-                                     } else {
-                                         battle->nextTurn();
-                                     } });
-                                aiYPos += buttonHeight + spacing;
-                                battleMenu.addButton("End AI Turn", sf::Vector2f(buttonX, aiYPos), sf::Vector2f(buttonWidth, buttonHeight), [&]()
-                                                     { battle->nextTurn(); });
-                            }
+                            // AI turn - the driver decides on a worker thread and plays the action back
+                            string aiText = "AI Turn...";
+                            if (battleDriver && battleDriver->isThinking())
+                                aiText = currentEntity->getName() + " is thinking...";
+                            else if (battleDriver && battleDriver->isAnimating())
+                                aiText = describeAIAction(currentEntity, battleDriver->getShownAction());
+                            battleTexts.emplace_back(aiText, font, static_cast<unsigned int>(20 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::Yellow);
+                            float buttonWidth = windowSize.x * 0.2f;
+                            float buttonHeight = windowSize.y * 0.04f;
+                            float buttonX = windowSize.x * 0.4f;
+                            float aiYPos = yPos + windowSize.y * 0.035f;
+                            battleMenu.addButton("Next", sf::Vector2f(buttonX, aiYPos), sf::Vector2f(buttonWidth, buttonHeight), [&]()
+                                                 {
+                                 if (battleDriver)
+                                     battleDriver->skipAnimation(); });
                         }
                     }
                 }
@@ -891,21 +1100,21 @@ int main()
                 inventoryTexts.emplace_back("Hero: " + hero->getName(), font, static_cast<unsigned int>(30 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, windowSize.y * 0.05f), sf::Color::Yellow);
 
                 // Stats
-                auto bonuses = hero->getEquipmentBonuses();
+                const StatBlock &bonuses = hero->getEquipmentBonuses();
                 float yPos = windowSize.y * 0.1f;
                 inventoryTexts.emplace_back("Stats:", font, static_cast<unsigned int>(24 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::Cyan);
                 yPos += windowSize.y * 0.03f;
-                inventoryTexts.emplace_back("HP: " + std::to_string(hero->getBaseMaxHP()) + " + " + std::to_string(bonuses["health"]) + " = " + std::to_string(hero->getMaxHealthPoint()), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
+                inventoryTexts.emplace_back("HP: " + std::to_string(hero->getBaseMaxHP()) + " + " + std::to_string(bonuses[StatType::HEALTH]) + " = " + std::to_string(hero->getMaxHealthPoint()), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
                 yPos += windowSize.y * 0.025f;
-                inventoryTexts.emplace_back("Damage: " + std::to_string(hero->getBaseDamage()) + " + " + std::to_string(bonuses["damage"]) + " = " + std::to_string(hero->getDamage()), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
+                inventoryTexts.emplace_back("Damage: " + std::to_string(hero->getBaseDamage()) + " + " + std::to_string(bonuses[StatType::DAMAGE]) + " = " + std::to_string(hero->getDamage()), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
                 yPos += windowSize.y * 0.025f;
-                inventoryTexts.emplace_back("Defense: " + std::to_string(hero->getBaseDefense()) + " + " + std::to_string(bonuses["defense"]) + " = " + std::to_string(hero->getDefense()), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
+                inventoryTexts.emplace_back("Defense: " + std::to_string(hero->getBaseDefense()) + " + " + std::to_string(bonuses[StatType::DEFENSE]) + " = " + std::to_string(hero->getDefense()), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
                 yPos += windowSize.y * 0.025f;
-                inventoryTexts.emplace_back("Attack: " + std::to_string(hero->getBaseAttack()) + " + " + std::to_string(bonuses["attack"]) + " = " + std::to_string(hero->getAttack()), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
+                inventoryTexts.emplace_back("Attack: " + std::to_string(hero->getBaseAttack()) + " + " + std::to_string(bonuses[StatType::ATTACK]) + " = " + std::to_string(hero->getAttack()), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
                 yPos += windowSize.y * 0.025f;
-                inventoryTexts.emplace_back("Stamina: " + std::to_string(hero->getBaseMaxStamina()) + " + " + std::to_string(bonuses["stamina"]) + " = " + std::to_string(hero->getMaxStamina()), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
+                inventoryTexts.emplace_back("Stamina: " + std::to_string(hero->getBaseMaxStamina()) + " + " + std::to_string(bonuses[StatType::STAMINA]) + " = " + std::to_string(hero->getMaxStamina()), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
                 yPos += windowSize.y * 0.025f;
-                inventoryTexts.emplace_back("Initiative: " + std::to_string(hero->getBaseInitiative()) + " + " + std::to_string(bonuses["initiative"]) + " = " + std::to_string(hero->getInitiative()), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
+                inventoryTexts.emplace_back("Initiative: " + std::to_string(hero->getBaseInitiative()) + " + " + std::to_string(bonuses[StatType::INITIATIVE]) + " = " + std::to_string(hero->getInitiative()), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
                 yPos += windowSize.y * 0.04f;
 
                 // Equipment
@@ -920,7 +1129,7 @@ int main()
                     // Add unequip button if not None
                     if (itemName != "None")
                     {
-                        inventoryMenu.addButton("Unequip", sf::Vector2f(windowSize.x * 0.4f, yPos), sf::Vector2f(windowSize.x * 0.1f, windowSize.y * 0.03f), [&, slot]()
+                        inventoryMenu.addButton("Unequip", sf::Vector2f(windowSize.x * 0.4f, yPos), sf::Vector2f(windowSize.x * 0.1f, windowSize.y * 0.03f), [hero, slot]()
                                                 { hero->unequipItem(slot.first); });
                     }
                     yPos += windowSize.y * 0.025f;
@@ -930,21 +1139,25 @@ int main()
                 // Inventory
                 inventoryTexts.emplace_back("Inventory:", font, static_cast<unsigned int>(24 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::Cyan);
                 yPos += windowSize.y * 0.03f;
+                // Buttons capture item handles, not positions: a click that lands after another
+                // item was removed either hits the same item or does nothing
                 const auto &inv = hero->getInventory();
                 for (size_t i = 0; i < inv.size(); ++i)
                 {
-                    inventoryTexts.emplace_back(std::to_string(i + 1) + ". " + inv[i].getName(), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
+                    const Item &item = inv.at(i);
+                    ItemHandle handle = inv.handleAt(i);
+                    inventoryTexts.emplace_back(std::to_string(i + 1) + ". " + item.getName(), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
                     // Add equip button if equippable
-                    if (inv[i].getSlot() != EquipmentSlot::NONE)
+                    if (item.getSlot() != EquipmentSlot::NONE)
                     {
-                        inventoryMenu.addButton("Equip", sf::Vector2f(windowSize.x * 0.4f, yPos), sf::Vector2f(windowSize.x * 0.08f, windowSize.y * 0.03f), [&, i]()
-                                                { hero->equipItem(i); });
+                        inventoryMenu.addButton("Equip", sf::Vector2f(windowSize.x * 0.4f, yPos), sf::Vector2f(windowSize.x * 0.08f, windowSize.y * 0.03f), [hero, handle]()
+                                                { if (hero->getInventory().contains(handle)) hero->equipItem(handle); });
                     }
                     // Add use button if consumable
-                    if (inv[i].getType() == ItemType::CONSUMABLE)
+                    if (item.getType() == ItemType::CONSUMABLE)
                     {
-                        inventoryMenu.addButton("Use", sf::Vector2f(windowSize.x * 0.5f, yPos), sf::Vector2f(windowSize.x * 0.08f, windowSize.y * 0.03f), [&, i]()
-                                                { hero->useConsumable(i); });
+                        inventoryMenu.addButton("Use", sf::Vector2f(windowSize.x * 0.5f, yPos), sf::Vector2f(windowSize.x * 0.08f, windowSize.y * 0.03f), [hero, handle]()
+                                                { if (hero->getInventory().contains(handle)) hero->useConsumable(handle); });
                     }
                     yPos += windowSize.y * 0.025f;
                 }
@@ -952,13 +1165,31 @@ int main()
 
                 // Party inventory
                 inventoryTexts.emplace_back("Party Inventory:", font, static_cast<unsigned int>(24 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::Cyan);
+                // Cycle the stash order: as stored, then by damage, defense, health
+                std::string sortLabel = partyInventorySort < 0 ? "Sort: none" : std::string("Sort: ") + statTypeName(static_cast<StatType>(partyInventorySort));
+                inventoryMenu.addButton(sortLabel, sf::Vector2f(windowSize.x * 0.4f, yPos), sf::Vector2f(windowSize.x * 0.12f, windowSize.y * 0.03f), [&]()
+                                        {
+                    static const int order[] = {-1, static_cast<int>(StatType::DAMAGE), static_cast<int>(StatType::DEFENSE), static_cast<int>(StatType::HEALTH)};
+                    size_t next = 0;
+                    while (next < 4 && order[next] != partyInventorySort)
+                        ++next;
+                    partyInventorySort = order[(next + 1) % 4]; });
                 yPos += windowSize.y * 0.03f;
+                // The sorted list is maintained by the inventory itself; nothing is sorted per frame
                 const auto &partyInv = campaign.getPartyInventory();
+                const std::vector<ItemHandle> *sorted = partyInventorySort < 0 ? nullptr : &partyInv.sortedBy(static_cast<StatType>(partyInventorySort));
                 for (size_t i = 0; i < partyInv.size(); ++i)
                 {
-                    inventoryTexts.emplace_back(std::to_string(i + 1) + ". " + partyInv[i].getName(), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
-                    inventoryMenu.addButton("Take", sf::Vector2f(windowSize.x * 0.4f, yPos), sf::Vector2f(windowSize.x * 0.08f, windowSize.y * 0.03f), [&, i]()
-                                            { hero->addItem(partyInv[i]); campaign.getPartyInventoryMutable().erase(campaign.getPartyInventoryMutable().begin() + i); });
+                    ItemHandle handle = sorted ? (*sorted)[i] : partyInv.handleAt(i);
+                    inventoryTexts.emplace_back(std::to_string(i + 1) + ". " + partyInv.find(handle)->getName(), font, static_cast<unsigned int>(18 * (windowSize.y / 768.0f)), sf::Vector2f(windowSize.x * 0.05f, yPos), sf::Color::White);
+                    inventoryMenu.addButton("Take", sf::Vector2f(windowSize.x * 0.4f, yPos), sf::Vector2f(windowSize.x * 0.08f, windowSize.y * 0.03f), [&, hero, handle]()
+                                            {
+                        Inventory &stash = campaign.getPartyInventoryMutable();
+                        if (const Item *item = stash.find(handle))
+                        {
+                            hero->addItem(*item);
+                            stash.erase(handle);
+                        } });
                     yPos += windowSize.y * 0.025f;
                 }
 